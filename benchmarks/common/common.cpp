@@ -9,9 +9,12 @@
 #include <IR.h>
 #include <InstructionVectorization.h>
 #include <ModuleBuilder.h>
+#include <OptimizationCache.h>
+#include <VectorizationCostModel.h>
 #include <libcircuit/simple_circuit.h>
 
 
+#include <array>
 #include <bitset>
 #include <filesystem>
 #include <fstream>
@@ -772,15 +775,30 @@ void zipCircs(const std::string& sourcePath, const std::string& goalPath, bool b
     }
 }
 
+// parameters of the cached optimizations, their cache descriptions are derived from these
+constexpr int kFsrTimeoutSeconds = 60 * 5;  // 5 mins
+constexpr int kFsrTryModes = 1;
+constexpr int kFsrPatternUpper = 20;
+constexpr int kFsrPatternLower = 2;
+constexpr int kVectorizationMinGates = 64;
+constexpr int kVectorizationMaxDistance = 1;
+constexpr bool kVectorizationMulti = false;
+constexpr std::array kVectorizedOperations{fuse::core::ir::PrimitiveOperation::Xor, fuse::core::ir::PrimitiveOperation::And,
+                                           fuse::core::ir::PrimitiveOperation::Not, fuse::core::ir::PrimitiveOperation::Or};
+
 fuse::core::ModuleContext fsrOnFuseIr(fuse::core::CircuitContext& circ) {
-    auto mutableCirc = circ.getMutableCircuitWrapper();
-    constexpr int timeoutSeconds = 60 * 5;  // 5 mins
-    constexpr int try_modes = 1;
-    auto modContext = fuse::passes::automaticallyReplaceFrequentSubcircuits(circ, try_modes, timeoutSeconds);
+    auto modContext = fuse::passes::automaticallyReplaceFrequentSubcircuits(circ, kFsrTryModes, kFsrTimeoutSeconds, kFsrPatternUpper, kFsrPatternLower);
     // auto modContext = fuse::passes::replaceFrequentSubcircuits(circ, 28, 0);
     return modContext;
 }
 
+std::string fsrDescription() {
+    return "fsr:auto:try_modes=" + std::to_string(kFsrTryModes) +
+           ":timeout=" + std::to_string(kFsrTimeoutSeconds) +
+           ":pattern_upper=" + std::to_string(kFsrPatternUpper) +
+           ":pattern_lower=" + std::to_string(kFsrPatternLower);
+}
+
 void fsr() {
     std::fstream out(kOutputPath + "fsr_sizes_log.txt", std::ios::in | std::ios::out | std::ios::app);
     out.seekg(0, std::ios::end);
@@ -789,6 +807,8 @@ void fsr() {
         out << "circuit, size_before, number_of_nodes_before_fsr, size_after, number_of_nodes_after_fsr" << std::endl;
     }
 
+    fuse::util::OptimizationCache cache(kPathToOptimizationCache);
+
     for (const auto& name : kToOptimize) {
         fuse::core::CircuitContext cont;
         cont.readCircuitFromFile(kPathToFuseIr + name + kCircId);
@@ -805,7 +825,7 @@ void fsr() {
             << numNodesBefore << kSep;
         out.flush();
 
-        auto mod = fsrOnFuseIr(cont);
+        auto mod = cache.getOrComputeModule(cont, fsrDescription(), fsrOnFuseIr);
         mod.writeModuleToFile(kPathToFsrFuseIr + name + kModId);
         size_t numNodesAfter = mod.getReadOnlyModule()->getEntryCircuit()->getNumberOfNodes();
         size_t sizeAfter = std::filesystem::file_size(kPathToFsrFuseIr + name + kModId);
@@ -818,13 +838,20 @@ void fsr() {
 
 
 void vectorizeFuseIr(fuse::core::CircuitObjectWrapper& mutableCirc) {
-    constexpr int minGates = 64;
-    constexpr int maxDepth = 1;
+    for (auto operation : kVectorizedOperations) {
+        fuse::passes::vectorizeInstructions(mutableCirc, operation, kVectorizationMinGates, kVectorizationMaxDistance, kVectorizationMulti);
+    }
+}
 
-    fuse::passes::vectorizeInstructions(mutableCirc, fuse::core::ir::PrimitiveOperation::Xor, minGates, maxDepth, false);
-    fuse::passes::vectorizeInstructions(mutableCirc, fuse::core::ir::PrimitiveOperation::And, minGates, maxDepth, false);
-    fuse::passes::vectorizeInstructions(mutableCirc, fuse::core::ir::PrimitiveOperation::Not, minGates, maxDepth, false);
-    fuse::passes::vectorizeInstructions(mutableCirc, fuse::core::ir::PrimitiveOperation::Or, minGates, maxDepth, false);
+std::string vectorizationDescription() {
+    std::string description = "vectorization:operations=";
+    for (auto operation : kVectorizedOperations) {
+        description += std::string(fuse::core::ir::EnumNamePrimitiveOperation(operation)) + ",";
+    }
+    return description +
+           ":minGates=" + std::to_string(kVectorizationMinGates) +
+           ":maxDistance=" + std::to_string(kVectorizationMaxDistance) +
+           ":multi=" + std::to_string(kVectorizationMulti);
 }
 
 void vectorization() {
@@ -835,6 +862,8 @@ void vectorization() {
         out << "circuit, size_before, number_of_nodes_before_vec, size_after, number_of_nodes_after_vec" << std::endl;
     }
 
+    fuse::util::OptimizationCache cache(kPathToOptimizationCache);
+
     for (const auto& name : kToOptimize) {
         fuse::core::CircuitContext cont;
         cont.readCircuitFromFile(kPathToFuseIr + name + kCircId);
@@ -847,8 +876,10 @@ void vectorization() {
             << numNodesBefore << kSep;
         out.flush();
 
-        auto mutableCirc = cont.getMutableCircuitWrapper();
-        vectorizeFuseIr(mutableCirc);
+        cache.getOrComputeCircuit(cont, vectorizationDescription(), [](fuse::core::CircuitContext& circ) {
+            auto mutableCirc = circ.getMutableCircuitWrapper();
+            vectorizeFuseIr(mutableCirc);
+        });
         cont.writeCircuitToFile(kPathToVectorizedFuseIr + name + kCircId);
 
         size_t numNodesAfter = cont.getReadOnlyCircuit()->getNumberOfNodes();
@@ -860,6 +891,20 @@ void vectorization() {
     }
 }
 
+void tunedVectorization() {
+    for (const auto& model : {fuse::passes::VectorizationCostModel::booleanGMW(), fuse::passes::VectorizationCostModel::BMR()}) {
+        const std::string outputDir = kPathToTunedVect + model.protocol + "/";
+        std::filesystem::create_directory(outputDir);
+        for (const auto& name : kToOptimize) {
+            fuse::core::CircuitContext cont;
+            cont.readCircuitFromFile(kPathToFuseIr + name + kCircId);
+            auto mutableCirc = cont.getMutableCircuitWrapper();
+            fuse::passes::vectorizeWithCostModel(mutableCirc, model);
+            cont.writeCircuitToFile(outputDir + name + kCircId);
+        }
+    }
+}
+
 void optimizeFuseIrCircs() {
     for (const auto& dirEntry : std::filesystem::recursive_directory_iterator(kPathToFuseIr)) {
         if (dirEntry.exists() && !dirEntry.path().empty()) {
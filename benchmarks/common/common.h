@@ -22,6 +22,7 @@ void generateFuseFromHycc();
 void optimizeFuseIrCircs();
 void fsr();
 void vectorization();
+void tunedVectorization();
 void zipBristolCircs();
 void zipFuseIrCircs();
 void zipOptimizedFuseIrCircs();
@@ -56,6 +57,10 @@ const std::string kPathToVect8 = "../../../benchmarks/resources/fuse_ir_vect_8/"
 const std::string kPathToVect16 = "../../../benchmarks/resources/fuse_ir_vect_16/";
 const std::string kPathToVect32 = "../../../benchmarks/resources/fuse_ir_vect_32/";
 const std::string kPathToVect64 = "../../../benchmarks/resources/fuse_ir_vect_64/";
+// cost model driven vectorization, suffixed by the protocol profile
+const std::string kPathToTunedVect = "../../../benchmarks/resources/fuse_ir_vect_tuned_";
+// content-addressed cache of optimization results, see OptimizationCache
+const std::string kPathToOptimizationCache = "../../../benchmarks/resources/optimization_cache/";
 
 
 const std::string kCircId = ".cfs";
@@ -46,6 +46,7 @@
 #include "verify.hh"
 #include "proof.hh"
 #include <boost/program_options.hpp>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <ctime>
@@ -53,6 +54,7 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <vector>
 #include <unistd.h>
 
@@ -513,11 +515,10 @@ std::string frequentSubgraphMining(std::string output_dir, int ctr, std::string
     return output_filename;
 }
 
-boost::multiprecision::cpp_int glasglowSubgraphFinding(std::string output_dir, int ctr, std::string graphFile, std::string patternFile){
+namespace {
 
-        /* Read in the graphs */
-        auto pattern = read_file_format("auto", patternFile);
-        auto target = read_file_format("auto", graphFile);
+// enumerates all embeddings of the pattern in the target and writes them to mappingsfile, one mapping per line
+boost::multiprecision::cpp_int findAllEmbeddings(const InputGraph& pattern, const InputGraph& target, const std::string& mappingsfile){
 
         HomomorphismParams params;
         
@@ -540,7 +541,6 @@ boost::multiprecision::cpp_int glasglowSubgraphFinding(std::string output_dir, i
         /* print all solutions */
         params.count_solutions = 1;
 
-        std::string mappingsfile = output_dir + "mappings" + std::to_string(ctr);
         std::ofstream of;
         of.open(mappingsfile, std::ios::trunc);
         params.enumerate_callback = [&] (const VertexToVertexMapping & mapping) -> bool {
@@ -563,6 +563,59 @@ boost::multiprecision::cpp_int glasglowSubgraphFinding(std::string output_dir, i
         return result.solution_count;
 }
 
+}  // namespace
+
+boost::multiprecision::cpp_int glasglowSubgraphFinding(std::string output_dir, int ctr, std::string graphFile, std::string patternFile){
+
+        /* Read in the graphs */
+        auto pattern = read_file_format("auto", patternFile);
+        auto target = read_file_format("auto", graphFile);
+
+        return findAllEmbeddings(pattern, target, output_dir + "mappings" + std::to_string(ctr));
+}
+
+std::vector<boost::multiprecision::cpp_int> glasgowParallelSubgraphFinding(std::string output_dir, int ctr, std::string graphFile, const std::vector<std::string>& patternFiles, unsigned num_threads){
+
+        /* Read in the target graph once, it is shared read-only between all workers */
+        const auto target = read_file_format("auto", graphFile);
+
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        num_threads = std::min<unsigned>(num_threads, patternFiles.size());
+
+        // every pattern writes into its own mappings file, so the results do not depend on the scheduling
+        std::vector<boost::multiprecision::cpp_int> counts(patternFiles.size());
+        std::vector<std::exception_ptr> errors(patternFiles.size());
+        std::atomic<size_t> next_pattern = 0;
+        auto worker = [&]() {
+            for (size_t i = next_pattern++; i < patternFiles.size(); i = next_pattern++) {
+                try {
+                    auto pattern = read_file_format("auto", patternFiles[i]);
+                    counts[i] = findAllEmbeddings(pattern, target, output_dir + "mappings" + std::to_string(ctr) + "_" + std::to_string(i));
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < num_threads; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        return counts;
+}
+
 boost::multiprecision::cpp_int glasglowSubgraphCounting(std::string output_dir, int ctr, std::string graphFile, std::string patternFile){
 
         /* Read in the graphs */
@@ -44,6 +44,14 @@ std::vector<uint64_t> translateMappingToNodevec(std::string DistgraphMapping);
 
 boost::multiprecision::cpp_int glasglowSubgraphFinding(std::string output_dir, int ctr, std::string graphFile, std::string patternFile);
 
+/**
+ * @brief Searches the embeddings of all patterns in the target graph in parallel. The target graph is only read once.
+ * The mappings of the i-th pattern are written to output_dir/mappings<ctr>_<i>, the i-th returned value is their count.
+ * num_threads = 0 uses all hardware threads, num_threads = 1 searches sequentially.
+ * Every search has its own solver parameters, timeout and mappings file, the shared target graph is only read.
+ */
+std::vector<boost::multiprecision::cpp_int> glasgowParallelSubgraphFinding(std::string output_dir, int ctr, std::string graphFile, const std::vector<std::string>& patternFiles, unsigned num_threads = 0);
+
 boost::multiprecision::cpp_int glasglowSubgraphCounting(std::string output_dir, int ctr, std::string graphFile, std::string patternFile);
 
 std::string frequentSubgraphMining(std::string output_dir, int ctr, std::string filename, int frequency_threshold);
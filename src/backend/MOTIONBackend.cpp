@@ -22,8 +22,16 @@
 
 // FUSE
 #include "MOTIONBackend.h"
+#include "BitWidthNarrowing.h"
+#include "CostEstimation.h"
+#include "LivenessAnalysis.h"
+#include "OperandWidths.h"
 
+#include <map>
+#include <optional>
 #include <regex>
+#include <span>
+#include <tuple>
 
 // MOTION
 #include "base/backend.h"
@@ -183,7 +191,7 @@ void MOTIONBackend::visit(const core::NodeReadOnly& node) {
         }
 
         case op::Loop:
-            throw motion_error("not yet implemented");
+            throw motion_error("Loop nodes must be unrolled before evaluation (see passes::unrollLoops), node ID: " + std::to_string(node.getNodeID()));
 
         // Operations not supportable: throw exception
         case op::Div:
@@ -242,6 +250,8 @@ using Offset = uint32_t;
 
 struct Environment {
     std::unordered_map<Identifier, ShareVector> nodeToOutputShares{};
+    // inputs of annotated nodes converted into the assigned protocol, by (node, offset, protocol)
+    std::map<std::tuple<Identifier, Offset, mo::MpcProtocol>, Share> convertedShares{};
 };
 
 /**
@@ -404,6 +414,108 @@ void checkIfValuesPresent(const core::CircuitReadOnly& parentCircuit, uint64_t n
     }
 }
 
+Share convertShare(const Share& share, mo::MpcProtocol protocol) {
+    switch (protocol) {
+        case mo::MpcProtocol::kArithmeticGmw:
+            return share.Convert<mo::MpcProtocol::kArithmeticGmw>();
+        case mo::MpcProtocol::kBooleanGmw:
+            return share.Convert<mo::MpcProtocol::kBooleanGmw>();
+        case mo::MpcProtocol::kBmr:
+            return share.Convert<mo::MpcProtocol::kBmr>();
+        default:
+            throw std::runtime_error("Conversion into the given protocol is not supported");
+    }
+}
+
+/**
+ * @brief Truncates or zero-extends the shared unsigned value to the given number of bits, e.g. for nodes narrowed by passes::narrowBitWidths.
+ * Boolean shares are resized locally. Arithmetic shares are resized on their Boolean representation, which needs a conversion in both directions.
+ */
+Share convertBitWidth(const Share& share, size_t bitWidth) {
+    const auto protocol = share->GetProtocol();
+    const bool isArithmetic = protocol == mo::MpcProtocol::kArithmeticGmw;
+    auto bits = (isArithmetic ? share.Convert<mo::MpcProtocol::kBooleanGmw>() : share).Split();
+    if (bits.size() > bitWidth) {
+        bits.resize(bitWidth);
+    } else if (bits.size() < bitWidth) {
+        // x XOR x is a share of zero that needs no communication
+        auto zero = bits.at(0) ^ bits.at(0);
+        bits.resize(bitWidth, zero);
+    }
+    auto converted = mo::ShareWrapper::Concatenate(bits);
+    return isArithmetic ? converted.Convert<mo::MpcProtocol::kArithmeticGmw>() : converted;
+}
+
+/**
+ * @brief Returns the protocol given by the "protocol" annotation of the node, if there is one.
+ */
+std::optional<mo::MpcProtocol> getAssignedProtocol(const core::NodeReadOnly& node) {
+    auto protocolName = node.getStringValueForAttribute("protocol");
+    if (protocolName.empty()) {
+        return std::nullopt;
+    }
+    if (protocolName == "ArithmeticGmw") {
+        return mo::MpcProtocol::kArithmeticGmw;
+    } else if (protocolName == "BooleanGmw") {
+        return mo::MpcProtocol::kBooleanGmw;
+    } else if (protocolName == "Bmr") {
+        return mo::MpcProtocol::kBmr;
+    } else {
+        throw std::runtime_error("Unknown protocol in node annotations: " + protocolName);
+    }
+}
+
+/**
+ * @brief Returns the share of the given input in the assigned protocol, i.e. the converted share if the input had to be converted
+ * and the computed share otherwise.
+ */
+const Share& getInputShare(Identifier in, Offset offset, const std::optional<mo::MpcProtocol>& protocol, const Environment& env) {
+    if (protocol) {
+        auto converted = env.convertedShares.find({in, offset, *protocol});
+        if (converted != env.convertedShares.end()) {
+            return converted->second;
+        }
+    }
+    return env.nodeToOutputShares.at(in).at(offset);
+}
+
+/**
+ * @brief Converts the input shares of the node into the protocol given by its "protocol" annotation, if there is one.
+ * The converted shares are cached in the environment next to the computed shares, so every value is converted at most once per protocol
+ * and nodes without annotation keep using the computed shares.
+ *
+ * @param parentCircuit contains the node
+ * @param node whose inputs are converted
+ * @param party is the MOTION party that evaluates the circuit
+ * @param env stores the mapping from nodes to shares
+ */
+void convertInputsToAssignedProtocol(const core::CircuitReadOnly& parentCircuit, const core::NodeReadOnly& node,
+                                     const mo::PartyPointer& party,
+                                     Environment& env) {
+    auto protocol = getAssignedProtocol(node);
+    if (!protocol) {
+        return;
+    }
+
+    auto inputs = node.getInputNodeIDs();
+    auto offsets = node.getInputOffsets();
+    for (int i = 0; i < node.getNumberOfInputs(); ++i) {
+        auto in = inputs[i];
+        Offset offset = offsets.empty() ? 0 : offsets[i];
+        checkIfValuesPresent(parentCircuit, in, party, env);
+
+        const auto& share = env.nodeToOutputShares.at(in).at(offset);
+        auto currentProtocol = share->GetProtocol();
+        // constant shares can be combined with shares of any protocol
+        if (currentProtocol == *protocol || currentProtocol == mo::MpcProtocol::kArithmeticConstant || currentProtocol == mo::MpcProtocol::kBooleanConstant) {
+            continue;
+        }
+        if (!env.convertedShares.contains({in, offset, *protocol})) {
+            env.convertedShares.emplace(std::make_tuple(in, offset, *protocol), convertShare(share, *protocol));
+        }
+    }
+}
+
 std::array<Share, 3> getSimdifiedMuxInputs(const core::CircuitReadOnly& parentCircuit, const core::NodeReadOnly& node,
                                            const mo::PartyPointer& party,
                                            Environment& env) {
@@ -413,6 +525,7 @@ std::array<Share, 3> getSimdifiedMuxInputs(const core::CircuitReadOnly& parentCi
     // inputs correspond to the wires -> gather all wires for one share, then construct share from this
     auto inputs = node.getInputNodeIDs();
     auto offsets = node.getInputOffsets();
+    auto protocol = getAssignedProtocol(node);
 
     // condition values
     auto condSize = std::stoi(node.getStringValueForAttribute("cond"));
@@ -434,11 +547,11 @@ std::array<Share, 3> getSimdifiedMuxInputs(const core::CircuitReadOnly& parentCi
         checkIfValuesPresent(parentCircuit, in, party, env);
 
         if (counter < condSize) {
-            simd1.push_back(env.nodeToOutputShares[in].at(offset));
+            simd1.push_back(getInputShare(in, offset, protocol, env));
         } else if (counter < condSize + valSize) {
-            simd2.push_back(env.nodeToOutputShares[in].at(offset));
+            simd2.push_back(getInputShare(in, offset, protocol, env));
         } else {
-            simd3.push_back(env.nodeToOutputShares[in].at(offset));
+            simd3.push_back(getInputShare(in, offset, protocol, env));
         }
     }
     return {mo::ShareWrapper::Simdify(simd1), mo::ShareWrapper::Simdify(simd2), mo::ShareWrapper::Simdify(simd3)};
@@ -452,6 +565,7 @@ std::array<Share, 2> getBinarySimdifiedInputs(const core::CircuitReadOnly& paren
     // inputs correspond to the wires -> gather all wires for one share, then construct share from this
     auto inputs = node.getInputNodeIDs();
     auto offsets = node.getInputOffsets();
+    auto protocol = getAssignedProtocol(node);
 
     for (int i = 0; i < node.getNumberOfInputs(); ++i) {
         auto in = inputs[i];
@@ -460,9 +574,9 @@ std::array<Share, 2> getBinarySimdifiedInputs(const core::CircuitReadOnly& paren
         checkIfValuesPresent(parentCircuit, in, party, env);
 
         if (i % 2 == 0) {
-            simd1.push_back(env.nodeToOutputShares.at(in).at(offset));
+            simd1.push_back(getInputShare(in, offset, protocol, env));
         } else {
-            simd2.push_back(env.nodeToOutputShares.at(in).at(offset));
+            simd2.push_back(getInputShare(in, offset, protocol, env));
         }
     }
     return {mo::ShareWrapper::Simdify(simd1), mo::ShareWrapper::Simdify(simd2)};
@@ -475,6 +589,7 @@ Share getUnarySimdifiedInputs(const core::CircuitReadOnly& parentCircuit, const
     // inputs correspond to the wires -> gather all wires for one share, then construct share from this
     auto inputs = node.getInputNodeIDs();
     auto offsets = node.getInputOffsets();
+    auto protocol = getAssignedProtocol(node);
 
     for (int i = 0; i < node.getNumberOfInputs(); ++i) {
         auto in = inputs[i];
@@ -482,7 +597,7 @@ Share getUnarySimdifiedInputs(const core::CircuitReadOnly& parentCircuit, const
 
         checkIfValuesPresent(parentCircuit, in, party, env);
 
-        simd.push_back(env.nodeToOutputShares.at(in).at(offset));
+        simd.push_back(getInputShare(in, offset, protocol, env));
     }
     return mo::ShareWrapper::Simdify(simd);
 }
@@ -529,6 +644,7 @@ ShareVector getInputShares(const core::CircuitReadOnly& parentCircuit, const cor
     // inputs correspond to the wires -> gather all wires for one share, then construct share from this
     auto inputs = node.getInputNodeIDs();
     auto offsets = node.getInputOffsets();
+    auto protocol = getAssignedProtocol(node);
 
     assert(inputs.size() == numberOfInputShares * numberOfWiresPerInputShare);
 
@@ -546,7 +662,7 @@ ShareVector getInputShares(const core::CircuitReadOnly& parentCircuit, const cor
             checkIfValuesPresent(parentCircuit, inNode, party, env);
 
             // add wires for share to be constructed
-            auto inShareWires = env.nodeToOutputShares.at(inNode).at(inOffset).Get()->GetWires();
+            auto inShareWires = getInputShare(inNode, inOffset, protocol, env).Get()->GetWires();
             wiresForShare.insert(wiresForShare.end(), inShareWires.begin(), inShareWires.end());
         }
         Share currentInShareToConstruct = wiresToShareWrapper(wiresForShare);
@@ -570,6 +686,7 @@ void evaluateNode(const core::CircuitReadOnly& parentCircuit,
 
     Identifier nodeId = node.getNodeID();
     ShareVector nodeOutput;
+    convertInputsToAssignedProtocol(parentCircuit, node, party, env);
 
     using op = core::ir::PrimitiveOperation;
     switch (node.getOperation()) {
@@ -712,6 +829,9 @@ void evaluateNode(const core::CircuitReadOnly& parentCircuit,
             } else if (opName == "Unsimdify") {
                 auto inputs = getInputShares(parentCircuit, node, env, party, 1);
                 nodeOutput = inputs.at(0).Unsimdify();
+            } else if (opName == passes::kConvertOperationName) {
+                auto inputs = getInputShares(parentCircuit, node, env, party, 1);
+                nodeOutput.push_back(convertBitWidth(inputs.at(0), passes::getPrimitiveTypeBitWidth(node.getOutputDataTypeAt(0)->getPrimitiveType())));
             } else {
                 throw std::runtime_error("Unsupported CUSTOM operation for MOTION backend at node with ID: " + std::to_string(node.getNodeID()) + " called " + opName);
             }
@@ -736,14 +856,29 @@ void evaluateNode(const core::CircuitReadOnly& parentCircuit,
     env.nodeToOutputShares[nodeId] = nodeOutput;
 }
 
+/**
+ * @brief Removes the shares of the given nodes (including converted shares) from the environment.
+ */
+void freeValues(std::span<const uint64_t> nodeIDs, Environment& env) {
+    for (auto id : nodeIDs) {
+        env.nodeToOutputShares.erase(id);
+        env.convertedShares.erase(env.convertedShares.lower_bound({id, 0, mo::MpcProtocol{}}),
+                                  env.convertedShares.lower_bound({id + 1, 0, mo::MpcProtocol{}}));
+    }
+}
+
 std::unordered_map<Identifier, ShareVector> evaluate(const core::CircuitReadOnly& circuit,
                                                      const mo::PartyPointer& party) {
     Environment env;
     evaluateInputGates(circuit, party, env);
+    // shares are freed after their last use, so only the outputs remain in the environment
+    auto liveness = passes::analyzeLiveness(circuit);
+    size_t position = 0;
     circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
         if (!node.isInputNode()) {
             evaluateNode(circuit, node, party, env);
         }
+        freeValues(liveness.getValuesFreedAfter(position++), env);
     });
     return env.nodeToOutputShares;
 }
@@ -753,6 +888,10 @@ void evaluateCircuit(const core::CircuitReadOnly& circuit,
                      const mo::PartyPointer& party,
                      Environment& env);
 
+/**
+ * @brief Evaluates the callee of a call node. For SIMD calls (created by call vectorization), the inputs of the i-th callee input
+ * of all calls are simdified, the callee is evaluated once and its outputs are unsimdified again.
+ */
 void evaluateCall(const core::NodeReadOnly& node,
                   const core::ModuleReadOnly& parentModule,
                   const mo::PartyPointer& party,
@@ -762,25 +901,56 @@ void evaluateCall(const core::NodeReadOnly& node,
     }
     Identifier nodeId = node.getNodeID();
     auto callee = parentModule.getCircuitWithName(node.getSubCircuitName());
+    auto numOfInputs = callee->getNumberOfInputs();
+    auto numOfOutputs = callee->getNumberOfOutputs();
+    // SIMD calls (see passes::vectorizeCalls) contain the inputs of several calls in order, calls without inputs are never SIMD calls
+    if (numOfInputs == 0 ? node.getNumberOfInputs() != 0 : node.getNumberOfInputs() % numOfInputs != 0) {
+        throw std::runtime_error("Call to " + node.getSubCircuitName() + " with " + std::to_string(node.getNumberOfInputs()) +
+                                 " inputs is neither a call nor a SIMD call of a subcircuit with " + std::to_string(numOfInputs) + " inputs");
+    }
+    const size_t simdWidth = numOfInputs == 0 ? 1 : node.getNumberOfInputs() / numOfInputs;
+
+    // gather the input shares of all calls
+    ShareVector inputShares;
+    auto inputs = node.getInputNodeIDs();
+    auto offsets = node.getInputOffsets();
+    for (size_t i = 0; i < node.getNumberOfInputs(); ++i) {
+        auto offset = offsets.empty() ? 0 : offsets[i];
+        inputShares.push_back(env.nodeToOutputShares.at(inputs[i]).at(offset));
+    }
 
     // prepare input environment
     Environment calleeEnv;
-    auto inputShares = env.nodeToOutputShares[nodeId];
-    auto numOfInputs = callee->getNumberOfInputs();
-    assert(inputShares.size() == numOfInputs);
-    for (int i = 0; i < numOfInputs; ++i) {
-        calleeEnv.nodeToOutputShares[callee->getInputNodeIDs()[i]].push_back(inputShares.at(i));
+    for (size_t i = 0; i < numOfInputs; ++i) {
+        Identifier calleeInputID = callee->getInputNodeIDs()[i];
+        if (simdWidth == 1) {
+            calleeEnv.nodeToOutputShares[calleeInputID].push_back(inputShares.at(i));
+        } else {
+            ShareVector simd;
+            for (size_t call = 0; call < simdWidth; ++call) {
+                simd.push_back(inputShares.at(call * numOfInputs + i));
+            }
+            calleeEnv.nodeToOutputShares[calleeInputID].push_back(mo::ShareWrapper::Simdify(simd));
+        }
     }
 
     // evaluate subcircuit
     evaluateCircuit(*callee, parentModule, party, calleeEnv);
 
-    // read out output values from call
-    ShareVector nodeOutput;
-    for (auto calleeOutputID : callee->getOutputNodeIDs()) {
-        auto outputVec = calleeEnv.nodeToOutputShares[calleeOutputID];
+    // read out output values from call: the outputs of the j-th call start at j * numOfOutputs
+    ShareVector nodeOutput(simdWidth * numOfOutputs);
+    for (size_t o = 0; o < numOfOutputs; ++o) {
+        auto outputVec = calleeEnv.nodeToOutputShares[callee->getOutputNodeIDs()[o]];
         assert(outputVec.size() == 1);
-        nodeOutput.push_back(outputVec[0]);
+        if (simdWidth == 1) {
+            nodeOutput[o] = outputVec[0];
+        } else {
+            auto unsimdified = outputVec[0].Unsimdify();
+            assert(unsimdified.size() == simdWidth);
+            for (size_t call = 0; call < simdWidth; ++call) {
+                nodeOutput[call * numOfOutputs + o] = unsimdified[call];
+            }
+        }
     }
 
     env.nodeToOutputShares[nodeId] = nodeOutput;
@@ -790,6 +960,8 @@ void evaluateCircuit(const core::CircuitReadOnly& circuit,
                      const core::ModuleReadOnly& parentModule,
                      const mo::PartyPointer& party,
                      Environment& env) {
+    auto liveness = passes::analyzeLiveness(circuit);
+    size_t position = 0;
     circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
         if (!node.isInputNode()) {
             if (node.isSubcircuitNode()) {
@@ -798,6 +970,7 @@ void evaluateCircuit(const core::CircuitReadOnly& circuit,
                 evaluateNode(circuit, node, party, env);
             }
         }
+        freeValues(liveness.getValuesFreedAfter(position++), env);
     });
 }
 
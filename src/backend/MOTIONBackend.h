@@ -27,6 +27,7 @@
 // FUSE
 #include "BaseVisitor.h"
 #include "ModuleWrapper.h"
+#include "PlaintextInterpreter.hpp"
 
 // MOTION
 #include "base/party.h"
@@ -80,6 +81,35 @@ std::unordered_map<Identifier, ShareVector> evaluate(const core::ModuleReadOnly&
                                                      const encrypto::motion::PartyPointer& party,
                                                      const core::CircuitReadOnly& main);
 
+/**
+ * @brief Evaluates the local circuit of a party created by passes::hoistLocalComputations in cleartext,
+ * before the party shares its inputs of the main circuit with MOTION.
+ * The backend receives already shared inputs (see MOTIONInterpreter::setInputShares), so whoever creates the input shares
+ * calls this helper first and shares the returned values like the party's other inputs.
+ *
+ * @param main the circuit whose local computations have been hoisted
+ * @param localCircuit the party's local circuit
+ * @param inputs the values of the party's inputs by the IDs of the input nodes
+ * @return the values of main's inputs that are provided by the local circuit, which the party shares like its other inputs
+ */
+template <typename value_type>
+std::unordered_map<Identifier, value_type> evaluateLocalCircuit(const core::CircuitReadOnly& main,
+                                                                const core::CircuitReadOnly& localCircuit,
+                                                                std::unordered_map<Identifier, value_type> inputs) {
+    PlaintextInterpreter<value_type> interpreter;
+    interpreter.evaluate(localCircuit, inputs);
+    auto localOutputs = localCircuit.getOutputNodeIDs();
+    std::unordered_map<Identifier, value_type> hoistedValues;
+    for (auto inputID : main.getInputNodeIDs()) {
+        auto input = main.getNodeWithID(inputID);
+        if (input->getStringValueForAttribute("local_circuit") == localCircuit.getName()) {
+            const auto output = std::stoul(input->getStringValueForAttribute("local_output"));
+            hoistedValues.emplace(inputID, inputs.at(localOutputs[output]));
+        }
+    }
+    return hoistedValues;
+}
+
 }  // namespace fuse::backend
 
 #endif /* FUSE_MOTIONBACKEND_H */
@@ -30,6 +30,7 @@
 #include <vector>
 
 #include "BaseVisitor.h"
+#include "LivenessAnalysis.h"
 #include "ModuleWrapper.h"
 
 namespace fuse::backend {
@@ -51,9 +52,13 @@ class PlaintextInterpreter {
     void evaluate(const core::CircuitReadOnly& circuit, std::unordered_map<Identifier, value_type>& inputMappings);
 
    private:
+    // all outputs of nodes with more than one output (e.g. calls), the environment only holds their first output
+    using MultipleOutputs = std::unordered_map<Identifier, std::vector<value_type>>;
+
     void evaluate(const core::CircuitReadOnly& circuit, std::unordered_map<Identifier, value_type>& environment, const core::ModuleReadOnly& parentModule);
     void evaluate(const core::NodeReadOnly& node, std::unordered_map<Identifier, value_type>& environment);
-    void evaluate(const core::NodeReadOnly& node, std::unordered_map<Identifier, value_type>& environment, const core::ModuleReadOnly& parentModule);
+    void evaluate(const core::NodeReadOnly& node, std::unordered_map<Identifier, value_type>& environment, MultipleOutputs& multipleOutputs,
+                  const core::ModuleReadOnly& parentModule);
 };
 
 /*
@@ -64,7 +69,15 @@ class PlaintextInterpreter {
 
 template <typename value_type>
 void PlaintextInterpreter<value_type>::evaluate(const core::CircuitReadOnly& circuit, std::unordered_map<Identifier, value_type>& inputMappings) {
-    circuit.topologicalTraversal([=, this, &inputMappings](core::NodeReadOnly& node) { this->evaluate(node, inputMappings); });
+    // values are erased after their last use, so only the inputs and outputs remain in the environment
+    auto liveness = passes::analyzeLiveness(circuit, true);
+    size_t position = 0;
+    circuit.topologicalTraversal([&, this](core::NodeReadOnly& node) {
+        this->evaluate(node, inputMappings);
+        for (auto id : liveness.getValuesFreedAfter(position++)) {
+            inputMappings.erase(id);
+        }
+    });
 }
 
 template <typename value_type>
@@ -86,8 +99,14 @@ void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node,
         }
     }
 
-    // compute node output -> start with first input value, accumulate if needed
-    assert(!inputArgs.empty());
+    // constants have no inputs, all other nodes start with their first input value and accumulate if needed
+    if (node.getOperation() == op::Constant) {
+        environment[node.getNodeID()] = node.getConstantFlexbuffer().As<value_type>();
+        return;
+    }
+    if (inputArgs.empty()) {
+        throw missing_value_error("missing value for Node without inputs: " + std::to_string(node.getNodeID()) + "\n");
+    }
     value_type eval = inputArgs.at(0);
     auto it = inputArgs.begin() + 1;
 
@@ -97,11 +116,6 @@ void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node,
         case op::Output:
             break;
 
-        case op::Constant: {
-            eval = node.getConstantFlexbuffer().As<value_type>();
-            break;
-        }
-
         case op::Not: {
             assert(inputArgs.size() == 1);
             eval = !eval;
@@ -210,16 +224,26 @@ void PlaintextInterpreter<value_type>::evaluate(const core::ModuleReadOnly& modu
     // visit entry circuit with reference to this module
     // so that calls to subcircuits can be resolved
     auto entryCircuit = module.getEntryCircuit();
-    evaluate(entryCircuit, inputMappings, module);
+    evaluate(*entryCircuit, inputMappings, module);
 }
 
 template <typename value_type>
 void PlaintextInterpreter<value_type>::evaluate(const core::CircuitReadOnly& circuit, std::unordered_map<Identifier, value_type>& environment, const core::ModuleReadOnly& parentModule) {
-    circuit.topologicalTraversal([=, this, &environment](core::NodeReadOnly& node) { this->evaluate(node, environment, parentModule); });
+    MultipleOutputs multipleOutputs;
+    auto liveness = passes::analyzeLiveness(circuit, true);
+    size_t position = 0;
+    circuit.topologicalTraversal([&, this](core::NodeReadOnly& node) {
+        this->evaluate(node, environment, multipleOutputs, parentModule);
+        for (auto id : liveness.getValuesFreedAfter(position++)) {
+            environment.erase(id);
+            multipleOutputs.erase(id);
+        }
+    });
 }
 
 template <typename value_type>
-void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node, std::unordered_map<Identifier, value_type>& environment, const core::ModuleReadOnly& parentModule) {
+void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node, std::unordered_map<Identifier, value_type>& environment, MultipleOutputs& multipleOutputs,
+                                                const core::ModuleReadOnly& parentModule) {
     using op = core::ir::PrimitiveOperation;
 
     // if node has already been computed, return
@@ -227,29 +251,74 @@ void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node,
         return;
     }
 
-    // get input values for this node
+    // get input values for this node, inputs with an offset > 0 refer to one of multiple outputs
     std::vector<value_type> inputArgs;
-    value_type eval = inputArgs.at(0);
-    auto it = inputArgs.begin() + 1;
-    for (auto id : node.getInputNodeIDs()) {
-        if (environment.contains(id)) {
+    auto inputIDs = node.getInputNodeIDs();
+    auto inputOffsets = node.getInputOffsets();
+    for (size_t i = 0; i < inputIDs.size(); ++i) {
+        auto id = inputIDs[i];
+        size_t offset = inputOffsets.empty() ? 0 : inputOffsets[i];
+        if (offset == 0 && environment.contains(id)) {
             inputArgs.push_back(environment[id]);
+        } else if (multipleOutputs.contains(id) && offset < multipleOutputs[id].size()) {
+            inputArgs.push_back(multipleOutputs[id][offset]);
         } else {
-            throw missing_value_error("missing input value for Node: " + std::to_string(id) + "\n");
+            throw missing_value_error("missing input value for Node: " + std::to_string(id) + " at offset " + std::to_string(offset) + "\n");
+        }
+    }
+
+    // constants have no inputs, all other nodes start with their first input value and accumulate if needed
+    if (node.getOperation() == op::Constant) {
+        environment[node.getNodeID()] = node.getConstantFlexbuffer().As<value_type>();
+        return;
+    }
+
+    if (node.getOperation() == op::CallSubcircuit) {
+        auto subcircuit = parentModule.getCircuitWithName(node.getSubCircuitName());
+        const size_t numberOfInputs = subcircuit->getNumberOfInputs();
+        // SIMD calls (see vectorizeCalls) contain the inputs of several calls in order
+        if (numberOfInputs == 0 ? !inputArgs.empty() : inputArgs.size() % numberOfInputs != 0) {
+            throw unsupported_operation_error("Call to " + node.getSubCircuitName() + " with " + std::to_string(inputArgs.size()) +
+                                              " inputs is neither a call nor a SIMD call of a subcircuit with " + std::to_string(numberOfInputs) + " inputs");
+        }
+        const size_t numberOfCalls = numberOfInputs == 0 ? 1 : inputArgs.size() / numberOfInputs;
+
+        // evaluate the subcircuit once per call, the outputs of the j-th call start at j * (subcircuit outputs)
+        std::vector<value_type> outputs;
+        for (size_t call = 0; call < numberOfCalls; ++call) {
+            std::unordered_map<Identifier, value_type> subcircuitEnvironment;
+            auto subcircuitInputIDs = subcircuit->getInputNodeIDs();
+            for (size_t in = 0; in < numberOfInputs; ++in) {
+                subcircuitEnvironment[subcircuitInputIDs[in]] = inputArgs.at(call * numberOfInputs + in);
+            }
+            evaluate(*subcircuit, subcircuitEnvironment, parentModule);
+            for (auto outputID : subcircuit->getOutputNodeIDs()) {
+                outputs.push_back(subcircuitEnvironment.at(outputID));
+            }
+        }
+        if (outputs.empty()) {
+            throw missing_value_error("Call to " + node.getSubCircuitName() + " has no outputs\n");
+        }
+        environment[node.getNodeID()] = outputs.front();
+        if (outputs.size() > 1) {
+            multipleOutputs[node.getNodeID()] = std::move(outputs);
         }
+        return;
+    }
+
+    if (inputArgs.empty()) {
+        throw missing_value_error("missing value for Node without inputs: " + std::to_string(node.getNodeID()) + "\n");
     }
+    value_type eval = inputArgs.at(0);
+    auto it = inputArgs.begin() + 1;
 
     // perform computation depending on operation
     switch (node.getOperation()) {
         case op::Input:
         case op::Output:
+        case op::SelectOffset:  // the input value already is the selected output
             break;
 
-        case op::Constant: {
-            eval = node.getConstantFlexbuffer().As<value_type>();
-            break;
-        }
-
         case op::Not: {
             assert(inputArgs.size() == 1);
             eval = !eval;
@@ -334,27 +403,6 @@ void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node,
             break;
         }
 
-        case op::CallSubcircuit: {
-            // prepare environment for call to subcircuit
-            std::unordered_map<Identifier, value_type> subcircuitInputs;
-            auto subcircuit = parentModule.getCircuitWithName(node.getSubCircuitName());
-
-            // we need exact amount of input values for the subcircuit
-            assert(inputArgs.size() == subcircuit->getNumberOfInputs());
-            size_t in;
-            for (auto inputNode : subcircuit->getInputNodeIDs()) {
-                subcircuitInputs[inputNode] = inputArgs.at(in++);
-            }
-
-            // evaluate subcircuit with the same inputs that the node itself received
-            evaluate(subcircuit, subcircuitInputs, parentModule);
-
-            // after evaluation, get circuit output and save them in this environment as well
-            // to do this: translate subcircuit output ID to node output ID
-            assert(subcircuit->getNumberOfOutputs() == 1);
-            eval = subcircuitInputs.at(subcircuit->getOutputNodeIDs()[0]);
-            break;
-        }
         case op::Loop:
         case op::Split:
         case op::Merge:
@@ -362,6 +410,9 @@ void PlaintextInterpreter<value_type>::evaluate(const core::NodeReadOnly& node,
             throw unsupported_operation_error("Node contains unsupported operation: " +
                                               std::string(core::ir::EnumNamePrimitiveOperation(node.getOperation())));
     }
+
+    // output is then saved in the mapping for other nodes to use this as their input
+    environment[node.getNodeID()] = eval;
 }
 
 }  // namespace fuse::backend
@@ -734,6 +734,31 @@ void CircuitBuilder::addCallToSubcircuitNode(Identifier nodeID,
     addNode(nodeID, {/* input datatypes */}, inputNodeIdentifiers, inputOffsets, ir::PrimitiveOperation::CallSubcircuit, "", subcircuitName, {/* payload */}, 1, {/* output types */}, nodeAnnotations);
 }
 
+namespace {
+std::string getLoopAnnotations(size_t numberOfIterations, const std::string &nodeAnnotations) {
+    auto iterations = "iterations:" + std::to_string(numberOfIterations);
+    return nodeAnnotations.empty() ? iterations : iterations + "," + nodeAnnotations;
+}
+}  // namespace
+
+Identifier CircuitBuilder::addLoopNode(const std::vector<Identifier> &inputNodeIdentifiers,
+                                       const std::vector<unsigned int> &inputOffsets,
+                                       const std::string &bodyName,
+                                       size_t numberOfIterations,
+                                       unsigned int numberOfCarriedValues,
+                                       const std::string &nodeAnnotations) {
+    return addNode({/* input datatypes */}, inputNodeIdentifiers, inputOffsets, ir::PrimitiveOperation::Loop, "", bodyName, {/* payload */}, numberOfCarriedValues, {/* output types */}, getLoopAnnotations(numberOfIterations, nodeAnnotations));
+}
+void CircuitBuilder::addLoopNode(Identifier nodeID,
+                                 const std::vector<Identifier> &inputNodeIdentifiers,
+                                 const std::vector<unsigned int> &inputOffsets,
+                                 const std::string &bodyName,
+                                 size_t numberOfIterations,
+                                 unsigned int numberOfCarriedValues,
+                                 const std::string &nodeAnnotations) {
+    addNode(nodeID, {/* input datatypes */}, inputNodeIdentifiers, inputOffsets, ir::PrimitiveOperation::Loop, "", bodyName, {/* payload */}, numberOfCarriedValues, {/* output types */}, getLoopAnnotations(numberOfIterations, nodeAnnotations));
+}
+
 void CircuitBuilder::finish() {
     if (!finished_) {
         // prepare inputs for circuit flatbuffer
@@ -253,6 +253,23 @@ class CircuitBuilder {
                                  const std::vector<unsigned int> &inputOffsets,
                                  const std::string &subcircuitName,
                                  const std::string &nodeAnnotations = "");
+    /*
+    Loops: the inputs are the initial carried values, the per-iteration values of every iteration
+    (given as node annotation "per_iteration_inputs:k") and the loop-invariant values, see node.fbs
+     */
+    Identifier addLoopNode(const std::vector<Identifier> &inputNodeIdentifiers,
+                           const std::vector<unsigned int> &inputOffsets,
+                           const std::string &bodyName,
+                           size_t numberOfIterations,
+                           unsigned int numberOfCarriedValues,
+                           const std::string &nodeAnnotations = "");
+    void addLoopNode(Identifier nodeID,
+                     const std::vector<Identifier> &inputNodeIdentifiers,
+                     const std::vector<unsigned int> &inputOffsets,
+                     const std::string &bodyName,
+                     size_t numberOfIterations,
+                     unsigned int numberOfCarriedValues,
+                     const std::string &nodeAnnotations = "");
 
     void finishAndWriteToFile(const std::string &pathToSaveBuffer);
     void finish();
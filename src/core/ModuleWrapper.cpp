@@ -22,12 +22,14 @@
 
 #include "ModuleWrapper.h"
 
+#include <algorithm>
 #include <iostream>
 #include <list>
 #include <regex>
 
 #include "DOTBackend.h"
 #include "NodeSuccessorsAnalysis.h"
+#include "ParallelFor.h"
 #include "datatype_generated.h"
 
 #include "NodeSuccessorsAnalysis.h"
@@ -38,6 +40,28 @@
 
 namespace fuse::core {
 
+namespace {
+// annotations are comma-separated "key:value" pairs, so keys are only matched at the start of a pair
+std::regex attributeRegex(const std::string& attribute, const std::string& valuePattern = "\\w*") {
+    return std::regex("(^|,)\\s*" + attribute + "\\s*:\\s*(" + valuePattern + ")");
+}
+
+std::string getAnnotationValue(const std::string& annotations, const std::string& attribute, const std::string& valuePattern = "\\w*") {
+    std::smatch match;
+    std::regex_search(annotations, match, attributeRegex(attribute, valuePattern));
+    return match.str(2);
+}
+
+void setAnnotationValue(std::string& annotations, const std::string& attribute, const std::string& value) {
+    auto regex = attributeRegex(attribute);
+    if (std::regex_search(annotations, regex)) {
+        annotations = std::regex_replace(annotations, regex, "$1" + attribute + ":" + value, std::regex_constants::format_first_only);
+    } else {
+        annotations += (annotations.empty() ? "" : ",") + attribute + ":" + value;
+    }
+}
+}  // namespace
+
 /*
  ****************************************** DataTypeBufferWrapper Member Functions ******************************************
  */
@@ -58,11 +82,7 @@ std::string DataTypeBufferWrapper::getDataTypeAnnotations() const {
 }
 
 std::string DataTypeBufferWrapper::getStringValueForAttribute(const std::string& attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getDataTypeAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getDataTypeAnnotations(), attribute);
 }
 
 std::span<const int64_t>
@@ -85,11 +105,7 @@ ir::SecurityLevel DataTypeObjectWrapper::getSecurityLevel() const { return data_
 std::string DataTypeObjectWrapper::getSecurityLevelName() const { return core::ir::EnumNameSecurityLevel(data_type_object_->security_level); }
 std::string DataTypeObjectWrapper::getDataTypeAnnotations() const { return data_type_object_->data_type_annotations; }
 std::string DataTypeObjectWrapper::getStringValueForAttribute(const std::string& attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getDataTypeAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getDataTypeAnnotations(), attribute);
 }
 std::span<const int64_t> DataTypeObjectWrapper::getShape() const { return {data_type_object_->shape.data(), data_type_object_->shape.size()}; }
 
@@ -97,8 +113,7 @@ void DataTypeObjectWrapper::setPrimitiveType(ir::PrimitiveType primitiveType) {
 void DataTypeObjectWrapper::setSecurityLevel(ir::SecurityLevel securityLevel) { data_type_object_->security_level = securityLevel; }
 void DataTypeObjectWrapper::setDataTypeAnnotations(const std::string& annotations) { data_type_object_->data_type_annotations = annotations; }
 void DataTypeObjectWrapper::setStringValueForAttribute(const std::string& attribute, const std::string& value) {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::regex_replace(data_type_object_->data_type_annotations, attribute_regex, value);
+    setAnnotationValue(data_type_object_->data_type_annotations, attribute, value);
 }
 
 void DataTypeObjectWrapper::setShape(std::span<const int64_t> shape) { data_type_object_->shape.assign(shape.begin(), shape.end()); }
@@ -187,11 +202,7 @@ std::string NodeBufferWrapper::getNodeAnnotations() const {
 }
 
 std::string NodeBufferWrapper::getStringValueForAttribute(std::string attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getNodeAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getNodeAnnotations(), attribute);
 }
 
 std::span<const uint64_t> NodeBufferWrapper::getInputNodeIDs() const {
@@ -399,11 +410,7 @@ std::string NodeObjectWrapper::getCustomOperationName() const { return node_obje
 std::string NodeObjectWrapper::getSubCircuitName() const { return node_object_->subcircuit_name; }
 std::string NodeObjectWrapper::getNodeAnnotations() const { return node_object_->node_annotations; }
 std::string NodeObjectWrapper::getStringValueForAttribute(std::string attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getNodeAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getNodeAnnotations(), attribute);
 }
 
 std::span<const uint64_t> NodeObjectWrapper::getInputNodeIDs() const {
@@ -530,10 +537,41 @@ void NodeObjectWrapper::setCustomOperationName(const std::string& customOperatio
 void NodeObjectWrapper::setSubCircuitName(const std::string& subcircuitName) { node_object_->subcircuit_name = subcircuitName; }
 void NodeObjectWrapper::setNodeAnnotations(const std::string& nodeAnnotations) { node_object_->node_annotations = nodeAnnotations; }
 void NodeObjectWrapper::setStringValueForAttribute(const std::string& attribute, const std::string& value) {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::regex_replace(node_object_->node_annotations, attribute_regex, value);
+    setAnnotationValue(node_object_->node_annotations, attribute, value);
 }
 
+namespace {
+// removes the IDs and, if there is one data type per ID, their data types
+void removeInterfaceNodes(std::vector<uint64_t>& ids, std::vector<std::unique_ptr<ir::DataTypeTableT>>& types, const std::unordered_set<uint64_t>& toRemove) {
+    const bool removeTypes = types.size() == ids.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (toRemove.contains(ids[i])) {
+            continue;
+        }
+        ids[kept] = ids[i];
+        if (removeTypes) {
+            types[kept] = std::move(types[i]);
+        }
+        ++kept;
+    }
+    ids.resize(kept);
+    if (removeTypes) {
+        types.resize(kept);
+    }
+}
+
+std::unique_ptr<ir::DataTypeTableT> copyDataType(const DataTypeReadOnly& dataType) {
+    auto copy = std::make_unique<ir::DataTypeTableT>();
+    copy->primitive_type = dataType.getPrimitiveType();
+    copy->security_level = dataType.getSecurityLevel();
+    auto shape = dataType.getShape();
+    copy->shape.assign(shape.begin(), shape.end());
+    copy->data_type_annotations = dataType.getDataTypeAnnotations();
+    return copy;
+}
+}  // namespace
+
 void NodeObjectWrapper::setConstantType(ir::PrimitiveType primitiveType, std::span<const int64_t> shape) {
     node_object_->input_datatypes.clear();
     node_object_->output_datatypes.clear();
@@ -544,10 +582,39 @@ void NodeObjectWrapper::setConstantType(ir::PrimitiveType primitiveType, std::sp
     node_object_->output_datatypes.push_back(std::move(dt));
 }
 
+void NodeObjectWrapper::setInterfaceDataType(const DataTypeReadOnly& dataType) {
+    node_object_->input_datatypes.clear();
+    node_object_->output_datatypes.clear();
+    node_object_->input_datatypes.push_back(copyDataType(dataType));
+    node_object_->output_datatypes.push_back(copyDataType(dataType));
+}
+
+void NodeObjectWrapper::setInputDataTypes(const DataTypeReadOnly& dataType) {
+    node_object_->input_datatypes.clear();
+    for (size_t i = 0; i < node_object_->input_identifiers.size(); ++i) {
+        node_object_->input_datatypes.push_back(copyDataType(dataType));
+    }
+}
+
+void NodeObjectWrapper::setInputDataTypes(const std::vector<const DataTypeReadOnly*>& dataTypes) {
+    node_object_->input_datatypes.clear();
+    for (const auto* dataType : dataTypes) {
+        node_object_->input_datatypes.push_back(copyDataType(*dataType));
+    }
+}
+
+void NodeObjectWrapper::setOutputDataTypes(const DataTypeReadOnly& dataType) {
+    node_object_->output_datatypes.clear();
+    for (uint32_t i = 0; i < node_object_->num_of_outputs; ++i) {
+        node_object_->output_datatypes.push_back(copyDataType(dataType));
+    }
+}
+
 void NodeObjectWrapper::setInputNodeIDs(std::span<uint64_t> inputNodeIDs) { node_object_->input_identifiers.assign(inputNodeIDs.begin(), inputNodeIDs.end()); }
 void NodeObjectWrapper::setInputOffsets(std::span<uint32_t> inputOffsets) { node_object_->input_offsets.assign(inputOffsets.begin(), inputOffsets.end()); }
 void NodeObjectWrapper::setNumberOfOutputs(uint32_t numberOfOutputs) { node_object_->num_of_outputs = numberOfOutputs; }
 void NodeObjectWrapper::setPayload(const std::vector<uint8_t>& finishedFlexbuffer) { node_object_->payload = finishedFlexbuffer; }
+std::span<const uint8_t> NodeObjectWrapper::getPayload() const { return {node_object_->payload.data(), node_object_->payload.size()}; }
 void NodeObjectWrapper::setPayload(bool boolValue) {
     flexbuffers::Builder fbb;
     fbb.Bool(boolValue);
@@ -690,11 +757,7 @@ std::string CircuitBufferWrapper::getName() const { return circuit_flatbuffer_->
 std::string CircuitBufferWrapper::getCircuitAnnotations() const { return circuit_flatbuffer_->circuit_annotations()->str(); }
 
 std::string CircuitBufferWrapper::getStringValueForAttribute(const std::string& attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getCircuitAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getCircuitAnnotations(), attribute);
 }
 
 std::span<const uint64_t> CircuitBufferWrapper::getInputNodeIDs() const { return {circuit_flatbuffer_->inputs()->data(), circuit_flatbuffer_->inputs()->size()}; }
@@ -723,6 +786,11 @@ size_t CircuitBufferWrapper::getNumberOfOutputs() const { return circuit_flatbuf
 CircuitBufferWrapper::Node CircuitBufferWrapper::getNodeWithID(uint64_t nodeID) const {
     // TODO this is not working when the vector is not sorted
     // return NodeBufferWrapper(circuit_flatbuffer_->nodes()->LookupByKey(nodeID));
+    // densely numbered circuits store node i at position i
+    auto nodes = circuit_flatbuffer_->nodes();
+    if (nodeID < nodes->size() && nodes->Get(nodeID)->id() == nodeID) {
+        return std::make_unique<NodeBufferWrapper>(nodes->Get(nodeID));
+    }
     for (auto it = circuit_flatbuffer_->nodes()->begin(), end = circuit_flatbuffer_->nodes()->end(); it != end; ++it) {
         if (nodeID == (*it)->id()) {
             return std::make_unique<NodeBufferWrapper>(*it);
@@ -742,11 +810,7 @@ std::string CircuitObjectWrapper::getName() const { return circuit_object_->name
 std::string CircuitObjectWrapper::getCircuitAnnotations() const { return circuit_object_->circuit_annotations; }
 
 std::string CircuitObjectWrapper::getStringValueForAttribute(const std::string& attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getCircuitAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getCircuitAnnotations(), attribute);
 }
 
 std::span<const uint64_t> CircuitObjectWrapper::getInputNodeIDs() const { return {circuit_object_->inputs.data(), circuit_object_->inputs.size()}; }
@@ -774,6 +838,10 @@ std::vector<CircuitObjectWrapper::DataType> CircuitObjectWrapper::getOutputDataT
 size_t CircuitObjectWrapper::getNumberOfOutputs() const { return circuit_object_->outputs.size(); }
 
 CircuitObjectWrapper::Node CircuitObjectWrapper::getNodeWithID(uint64_t nodeID) const {
+    // densely numbered circuits store node i at position i
+    if (nodeID < circuit_object_->nodes.size() && circuit_object_->nodes[nodeID]->id == nodeID) {
+        return std::make_unique<NodeObjectWrapper>(circuit_object_->nodes[nodeID].get());
+    }
     for (auto& node : circuit_object_->nodes) {
         if (node->id == nodeID) {
             return std::make_unique<NodeObjectWrapper>(node.get());
@@ -789,8 +857,7 @@ void CircuitObjectWrapper::setName(const std::string& name) { circuit_object_->n
 void CircuitObjectWrapper::setCircuitAnnotations(const std::string& annotations) { circuit_object_->circuit_annotations = annotations; }
 
 void CircuitObjectWrapper::setStringValueForAttribute(const std::string& attribute, const std::string& value) {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::regex_replace(circuit_object_->circuit_annotations, attribute_regex, value);
+    setAnnotationValue(circuit_object_->circuit_annotations, attribute, value);
 }
 
 CircuitObjectWrapper::MutableDataType CircuitObjectWrapper::getInputDataTypeAt(size_t inputNumber) {
@@ -811,6 +878,15 @@ std::vector<CircuitObjectWrapper::MutableDataType> CircuitObjectWrapper::getInpu
 
 void CircuitObjectWrapper::setInputNodeIDs(std::span<uint64_t> inputNodeIDs) { circuit_object_->inputs.assign(inputNodeIDs.begin(), inputNodeIDs.end()); }
 
+void CircuitObjectWrapper::removeInputs(const std::unordered_set<uint64_t>& inputNodeIDs) {
+    removeInterfaceNodes(circuit_object_->inputs, circuit_object_->input_datatypes, inputNodeIDs);
+}
+
+void CircuitObjectWrapper::addInput(uint64_t inputNodeID, const DataTypeReadOnly& dataType) {
+    circuit_object_->inputs.push_back(inputNodeID);
+    circuit_object_->input_datatypes.push_back(copyDataType(dataType));
+}
+
 CircuitObjectWrapper::MutableDataType CircuitObjectWrapper::getOutputDataTypeAt(size_t inputNumber) {
     if (inputNumber < getNumberOfOutputs()) {
         return DataTypeObjectWrapper(circuit_object_->output_datatypes.at(inputNumber).get());
@@ -829,7 +905,19 @@ std::vector<CircuitObjectWrapper::MutableDataType> CircuitObjectWrapper::getOutp
 
 void CircuitObjectWrapper::setOutputNodeIDs(std::span<uint64_t> outputNodeIDs) { circuit_object_->outputs.assign(outputNodeIDs.begin(), outputNodeIDs.end()); }
 
+void CircuitObjectWrapper::removeOutputs(const std::unordered_set<uint64_t>& outputNodeIDs) {
+    removeInterfaceNodes(circuit_object_->outputs, circuit_object_->output_datatypes, outputNodeIDs);
+}
+
+void CircuitObjectWrapper::addOutput(uint64_t outputNodeID, const DataTypeReadOnly& dataType) {
+    circuit_object_->outputs.push_back(outputNodeID);
+    circuit_object_->output_datatypes.push_back(copyDataType(dataType));
+}
+
 CircuitObjectWrapper::MutableNode CircuitObjectWrapper::getNodeWithID(uint64_t nodeID) {
+    if (nodeID < circuit_object_->nodes.size() && circuit_object_->nodes[nodeID]->id == nodeID) {
+        return NodeObjectWrapper(circuit_object_->nodes[nodeID].get());
+    }
     for (auto& node : circuit_object_->nodes) {
         if (node->id == nodeID) {
             return NodeObjectWrapper(node.get());
@@ -866,6 +954,13 @@ CircuitObjectWrapper::MutableNode CircuitObjectWrapper::addNode(long position) {
     return NodeObjectWrapper(newIt->get());
 }
 
+CircuitObjectWrapper::MutableNode CircuitObjectWrapper::addNodeWithID(uint64_t nodeID) {
+    auto temp = std::make_unique<core::ir::NodeTableT>();
+    temp->id = nodeID;
+    circuit_object_->nodes.push_back(std::move(temp));
+    return NodeObjectWrapper(circuit_object_->nodes.back().get());
+}
+
 /**
  * @brief restores the topological order of the nodes for the circuit in a iterative fashion
  *
@@ -926,6 +1021,73 @@ void CircuitObjectWrapper::iterativelyRestoreTopologicalOrder(uint64_t nodeID, s
     }
 }
 
+void CircuitObjectWrapper::restoreTopologicalOrder() {
+    auto& nodes = circuit_object_->nodes;
+    std::unordered_map<uint64_t, size_t> positions;
+    for (size_t pos = 0; pos < nodes.size(); ++pos) {
+        positions[nodes[pos]->id] = pos;
+    }
+
+    std::vector<std::unique_ptr<core::ir::NodeTableT>> orderedNodes;
+    orderedNodes.reserve(nodes.size());
+    std::vector<bool> visited(nodes.size(), false);
+    // depth-first post-order: each stack entry holds a node position and the next input to look at
+    std::vector<std::pair<size_t, size_t>> stack;
+    for (size_t start = 0; start < nodes.size(); ++start) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = true;
+        stack.emplace_back(start, 0);
+        while (!stack.empty()) {
+            auto [pos, nextInput] = stack.back();
+            const auto& inputs = nodes[pos]->input_identifiers;
+            if (nextInput < inputs.size()) {
+                ++stack.back().second;
+                auto inputPos = positions.find(inputs[nextInput]);
+                if (inputPos != positions.end() && !visited[inputPos->second]) {
+                    visited[inputPos->second] = true;
+                    stack.emplace_back(inputPos->second, 0);
+                }
+                continue;
+            }
+            orderedNodes.push_back(std::move(nodes[pos]));
+            stack.pop_back();
+        }
+    }
+    nodes = std::move(orderedNodes);
+}
+
+void CircuitObjectWrapper::reorderNodes(std::span<const uint64_t> nodeIDs) {
+    auto& nodes = circuit_object_->nodes;
+    std::unordered_map<uint64_t, size_t> positions;
+    for (size_t pos = 0; pos < nodes.size(); ++pos) {
+        positions[nodes[pos]->id] = pos;
+    }
+    // validate the order before moving any node
+    std::vector<size_t> newPositions;
+    newPositions.reserve(nodeIDs.size());
+    std::vector<bool> placed(nodes.size(), false);
+    for (auto id : nodeIDs) {
+        auto pos = positions.find(id);
+        if (pos == positions.end() || placed[pos->second]) {
+            throw std::logic_error("Invalid order for circuit " + circuit_object_->name + " at node " + std::to_string(id));
+        }
+        placed[pos->second] = true;
+        newPositions.push_back(pos->second);
+    }
+    if (newPositions.size() != nodes.size()) {
+        throw std::logic_error("Order for circuit " + circuit_object_->name + " does not contain every node");
+    }
+
+    std::vector<std::unique_ptr<core::ir::NodeTableT>> orderedNodes;
+    orderedNodes.reserve(nodes.size());
+    for (auto pos : newPositions) {
+        orderedNodes.push_back(std::move(nodes[pos]));
+    }
+    nodes = std::move(orderedNodes);
+}
+
 /*
  * nodesToReplace: all the nodes that are to be deleted for the one call node
  */
@@ -1105,6 +1267,163 @@ void CircuitObjectWrapper::replaceNodesBySIMDNode(std::span<uint64_t> nodesToSim
     iterativelyRestoreTopologicalOrder(simdNodeID, nodeSuccessors);
 }
 
+std::vector<uint64_t> CircuitObjectWrapper::replaceNodesBySIMDNodes(const std::vector<std::vector<uint64_t>>& nodeGroups) {
+    using Identifier = uint64_t;
+    using Offset = uint32_t;
+    auto& nodes = circuit_object_->nodes;
+    std::unordered_map<Identifier, size_t> positions;
+    Identifier nextID = 0;
+    for (size_t pos = 0; pos < nodes.size(); ++pos) {
+        positions[nodes[pos]->id] = pos;
+        nextID = std::max(nextID, nodes[pos]->id + 1);
+    }
+
+    // build all SIMD nodes and map each replaced node to the first of its outputs inside the SIMD node
+    std::unordered_map<Identifier, std::pair<Identifier, Offset>> replacements;
+    std::unordered_map<size_t, std::unique_ptr<core::ir::NodeTableT>> simdNodeAtPosition;
+    std::vector<Identifier> simdNodeIDs;
+    for (const auto& group : nodeGroups) {
+        if (group.empty()) {
+            continue;
+        }
+        auto simdNodeObj = std::make_unique<core::ir::NodeTableT>();
+        simdNodeObj->id = nextID++;
+        simdNodeObj->operation = nodes.at(positions.at(group[0]))->operation;
+        simdNodeObj->subcircuit_name = nodes.at(positions.at(group[0]))->subcircuit_name;
+        size_t firstPosition = nodes.size();
+        Offset offset = 0;
+        for (auto nodeID : group) {
+            size_t pos = positions.at(nodeID);
+            const auto& node = nodes[pos];
+            simdNodeObj->input_identifiers.insert(simdNodeObj->input_identifiers.end(), node->input_identifiers.begin(), node->input_identifiers.end());
+            if (node->input_offsets.empty()) {
+                simdNodeObj->input_offsets.insert(simdNodeObj->input_offsets.end(), node->input_identifiers.size(), 0);
+            } else {
+                simdNodeObj->input_offsets.insert(simdNodeObj->input_offsets.end(), node->input_offsets.begin(), node->input_offsets.end());
+            }
+            replacements[node->id] = {simdNodeObj->id, offset};
+            offset += std::max<uint32_t>(node->num_of_outputs, 1);
+            firstPosition = std::min(firstPosition, pos);
+        }
+        simdNodeObj->num_of_outputs = offset;
+        simdNodeIDs.push_back(simdNodeObj->id);
+        simdNodeAtPosition[firstPosition] = std::move(simdNodeObj);
+    }
+
+    // rebuild the node vector once: each SIMD node takes the place of the first node of its group
+    std::vector<std::unique_ptr<core::ir::NodeTableT>> newNodes;
+    newNodes.reserve(nodes.size() - replacements.size() + simdNodeIDs.size());
+    for (size_t pos = 0; pos < nodes.size(); ++pos) {
+        auto simdNode = simdNodeAtPosition.find(pos);
+        if (simdNode != simdNodeAtPosition.end()) {
+            newNodes.push_back(std::move(simdNode->second));
+        }
+        if (!replacements.contains(nodes[pos]->id)) {
+            newNodes.push_back(std::move(nodes[pos]));
+        }
+    }
+    nodes = std::move(newNodes);
+
+    // for all nodes that referred to a simdified node: set input ID + Offset
+    for (auto& node : nodes) {
+        for (size_t input = 0; input < node->input_identifiers.size(); ++input) {
+            auto replacement = replacements.find(node->input_identifiers[input]);
+            if (replacement == replacements.end()) {
+                continue;
+            }
+            if (node->input_offsets.empty()) {
+                node->input_offsets.assign(node->input_identifiers.size(), 0);
+            }
+            node->input_identifiers[input] = replacement->second.first;
+            node->input_offsets[input] += replacement->second.second;
+        }
+    }
+
+    // a SIMD node placed at the first node of its group may precede inputs of other group members
+    restoreTopologicalOrder();
+    return simdNodeIDs;
+}
+
+void CircuitObjectWrapper::inlineCalls(const std::unordered_map<uint64_t, CircuitObjectWrapper>& callsToInline) {
+    using Identifier = uint64_t;
+    using Offset = uint32_t;
+    using Value = std::pair<Identifier, Offset>;
+    auto& nodes = circuit_object_->nodes;
+    Identifier nextID = 0;
+    for (const auto& node : nodes) {
+        nextID = std::max(nextID, node->id + 1);
+    }
+
+    // the values computed by the inlined calls, i.e. callID -> (node, offset) for every output of the call
+    std::unordered_map<Identifier, std::vector<Value>> callResults;
+    auto remapInputs = [](core::ir::NodeTableT& node, auto&& getValue) {
+        std::vector<Offset> offsets(node.input_identifiers.size(), 0);
+        bool usesOffsets = false;
+        for (size_t input = 0; input < node.input_identifiers.size(); ++input) {
+            auto [id, offset] = getValue(node.input_identifiers[input], node.input_offsets.empty() ? 0 : node.input_offsets[input]);
+            node.input_identifiers[input] = id;
+            offsets[input] = offset;
+            usesOffsets |= offset != 0;
+        }
+        node.input_offsets = usesOffsets ? std::move(offsets) : std::vector<Offset>{};
+    };
+    auto getCallerValue = [&](Identifier id, Offset offset) -> Value {
+        auto result = callResults.find(id);
+        return result == callResults.end() ? Value{id, offset} : result->second.at(offset);
+    };
+
+    // rebuild the node vector once: every inlined call is replaced by a copy of the callee's nodes at its position
+    std::vector<std::unique_ptr<core::ir::NodeTableT>> newNodes;
+    newNodes.reserve(nodes.size());
+    for (auto& node : nodes) {
+        remapInputs(*node, getCallerValue);
+        auto call = callsToInline.find(node->id);
+        if (call == callsToInline.end()) {
+            newNodes.push_back(std::move(node));
+            continue;
+        }
+
+        const auto& callee = *call->second.circuit_object_;
+        if (callee.inputs.size() != node->input_identifiers.size()) {
+            throw std::logic_error("Call to " + callee.name + " does not provide an input for every circuit input");
+        }
+        std::unordered_map<Identifier, Value> calleeValues;
+        for (size_t input = 0; input < callee.inputs.size(); ++input) {
+            calleeValues[callee.inputs[input]] = {node->input_identifiers[input], node->input_offsets.empty() ? 0 : node->input_offsets[input]};
+        }
+        // offsets into a callee input are relative to the value passed by the caller
+        auto getCalleeValue = [&](Identifier id, Offset offset) -> Value {
+            auto value = calleeValues.find(id);
+            if (value == calleeValues.end()) {
+                throw std::logic_error("Node " + std::to_string(id) + " is not defined before its use in " + callee.name);
+            }
+            return {value->second.first, value->second.second + offset};
+        };
+
+        std::unordered_map<Identifier, size_t> outputIndex;
+        for (size_t output = 0; output < callee.outputs.size(); ++output) {
+            outputIndex[callee.outputs[output]] = output;
+        }
+        auto& results = callResults[node->id];
+        results.resize(callee.outputs.size());
+        for (const auto& calleeNode : callee.nodes) {
+            if (calleeNode->operation == ir::PrimitiveOperation::Input) {
+                continue;
+            }
+            if (calleeNode->operation == ir::PrimitiveOperation::Output) {
+                results.at(outputIndex.at(calleeNode->id)) = getCalleeValue(calleeNode->input_identifiers.at(0), calleeNode->input_offsets.empty() ? 0 : calleeNode->input_offsets.at(0));
+                continue;
+            }
+            auto copy = std::make_unique<core::ir::NodeTableT>(*calleeNode);
+            copy->id = nextID++;
+            remapInputs(*copy, getCalleeValue);
+            calleeValues[calleeNode->id] = {copy->id, 0};
+            newNodes.push_back(std::move(copy));
+        }
+    }
+    nodes = std::move(newNodes);
+}
+
 void CircuitObjectWrapper::removeNode(uint64_t nodeToDelete) {
     std::erase_if(circuit_object_->nodes, [=](std::unique_ptr<fuse::core::ir::NodeTableT>& node) { return node->id == nodeToDelete; });
 }
@@ -1125,11 +1444,7 @@ std::string ModuleBufferWrapper::getModuleAnnotations() const {
 }
 
 std::string ModuleBufferWrapper::getStringValueForAttribute(std::string attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\d*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getModuleAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getModuleAnnotations(), attribute, "\\d*");
 }
 
 std::string ModuleBufferWrapper::getEntryCircuitName() const {
@@ -1171,14 +1486,11 @@ std::string ModuleObjectWrapper::getModuleAnnotations() const {
 }
 
 std::string ModuleObjectWrapper::getStringValueForAttribute(std::string attribute) const {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::smatch match;
-    auto annotation_string = getModuleAnnotations();
-    std::regex_search(annotation_string, match, attribute_regex);
-    return match.str();
+    return getAnnotationValue(getModuleAnnotations(), attribute);
 }
 
 ModuleObjectWrapper::Circuit ModuleObjectWrapper::getCircuitWithName(const std::string& name) const {
+    std::lock_guard lock(*circuits_mutex_);
     for (auto& it : unpacked_circuits_) {
         if (it->name == name) {
             return std::make_unique<CircuitObjectWrapper>(it.get());
@@ -1206,14 +1518,15 @@ void ModuleObjectWrapper::setModuleAnnotations(const std::string& annotations) {
 }
 
 void ModuleObjectWrapper::setStringValueForAttribute(const std::string& attribute, const std::string& value) {
-    std::regex attribute_regex(attribute + "\\s*:\\s*(\\w*)\\s*,?");
-    std::regex_replace(module_object_->module_annotations, attribute_regex, value);
+    setAnnotationValue(module_object_->module_annotations, attribute, value);
 }
 
 ModuleObjectWrapper::MutableCircuit ModuleObjectWrapper::getCircuitWithName(const std::string& name) {
+    std::lock_guard lock(*circuits_mutex_);
     // Look if the circuit needs to be unpacked first
-    for (auto& it : module_object_->circuits) {
-        const ir::CircuitTable* circuitBuffer = ir::GetCircuitTable(it->circuit_buffer.data());
+    auto& buffers = module_object_->circuits;
+    for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+        const ir::CircuitTable* circuitBuffer = ir::GetCircuitTable((*it)->circuit_buffer.data());
         if (circuitBuffer->name()->str() == name) {
             // unpack and save circuit first
             std::unique_ptr<ir::CircuitTableT> ptr;
@@ -1221,7 +1534,8 @@ ModuleObjectWrapper::MutableCircuit ModuleObjectWrapper::getCircuitWithName(cons
             ptr.reset(circuitBuffer->UnPack());
             unpacked_circuits_.push_back(std::move(ptr));
             // then remove the old flatbuffer data from the module, as the circuit has been unpacked anyways
-            std::erase_if(module_object_->circuits, [&, name](auto const& buffer) { return ir::GetCircuitTable(buffer->circuit_buffer.data())->name()->str() == name; });
+            buffers.erase(it);
+            break;
         }
     }
     // Then return a wrapper to the unpacked circuit
@@ -1237,7 +1551,38 @@ ModuleObjectWrapper::MutableCircuit ModuleObjectWrapper::getEntryCircuit() {
     return getCircuitWithName(module_object_->entry_point);
 }
 
+void ModuleObjectWrapper::unpackAllCircuits(size_t numberOfThreads) {
+    std::lock_guard lock(*circuits_mutex_);
+    auto& buffers = module_object_->circuits;
+    std::vector<std::unique_ptr<ir::CircuitTableT>> unpacked(buffers.size());
+    // every circuit is a separate nested flatbuffer, so they can be unpacked independently
+    util::parallelFor(
+        buffers.size(), [&](size_t i) { unpacked[i].reset(ir::GetCircuitTable(buffers[i]->circuit_buffer.data())->UnPack()); }, numberOfThreads);
+    std::move(unpacked.begin(), unpacked.end(), std::back_inserter(unpacked_circuits_));
+    buffers.clear();
+}
+
+ModuleObjectWrapper::MutableCircuit ModuleObjectWrapper::copyCircuit(const std::string& name, const std::string& copyName) {
+    auto names = getAllCircuitNames();
+    if (std::find(names.begin(), names.end(), copyName) != names.end()) {
+        throw std::logic_error("Module already contains a circuit with the name: " + copyName);
+    }
+    // make sure the original is unpacked
+    getCircuitWithName(name);
+    std::lock_guard lock(*circuits_mutex_);
+    auto original = std::find_if(unpacked_circuits_.begin(), unpacked_circuits_.end(), [&](const auto& circuit) { return circuit->name == name; });
+    // round trip through a flatbuffer to copy all nested tables
+    flatbuffers::FlatBufferBuilder fbb;
+    fbb.Finish(ir::CircuitTable::Pack(fbb, original->get()));
+    std::unique_ptr<ir::CircuitTableT> copy;
+    copy.reset(ir::GetCircuitTable(fbb.GetBufferPointer())->UnPack());
+    copy->name = copyName;
+    unpacked_circuits_.push_back(std::move(copy));
+    return CircuitObjectWrapper(unpacked_circuits_.back().get());
+}
+
 std::vector<std::string> ModuleObjectWrapper::getAllCircuitNames() const {
+    std::lock_guard lock(*circuits_mutex_);
     std::vector<std::string> result;
     // first write all of the unpacked circuits' names
     for (auto& circ : unpacked_circuits_) {
@@ -1252,6 +1597,7 @@ std::vector<std::string> ModuleObjectWrapper::getAllCircuitNames() const {
 }
 
 void ModuleObjectWrapper::removeCircuit(const std::string& name) {
+    std::lock_guard lock(*circuits_mutex_);
     // either erase from the vector that contains the flatbuffer binaries
     std::erase_if(module_object_->circuits, [&, name](auto const& buffer) { return ir::GetCircuitTable(buffer->circuit_buffer.data())->name()->str() == name; });
     // or erase from the vector that contains the unpacked circuits
@@ -24,6 +24,8 @@
 
 #include <cstddef>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <unordered_set>
 
@@ -486,8 +488,18 @@ public:
 
   void setConstantType(ir::PrimitiveType primitiveType,
                        std::span<const int64_t> shape = {});
+  /// sets the type as the only input and output data type, like the builder does for input and output nodes
+  void setInterfaceDataType(const DataTypeReadOnly &dataType);
+  /// sets the type as the data type of every input
+  void setInputDataTypes(const DataTypeReadOnly &dataType);
+  /// sets one data type per input, the types are copied
+  void setInputDataTypes(const std::vector<const DataTypeReadOnly *> &dataTypes);
+  /// sets the type as the data type of every output
+  void setOutputDataTypes(const DataTypeReadOnly &dataType);
 
   void setPayload(const std::vector<uint8_t> &finishedFlexbuffer);
+  /// returns the finished flexbuffer of the constant, e.g. to copy it into another node
+  std::span<const uint8_t> getPayload() const;
 
   void setPayload(bool boolValue);
   void setPayload(uint64_t unsignedValue);
@@ -800,11 +812,22 @@ private:
     MutableDataType getInputDataTypeAt(size_t inputNumber);
     std::vector<MutableDataType> getInputDataTypes();
     void setInputNodeIDs(std::span<uint64_t> inputNodeIDs);
+    /**
+     * @brief Removes the given nodes from the circuit's inputs together with their input data types.
+     * The nodes themselves stay inside the circuit.
+     */
+    void removeInputs(const std::unordered_set<uint64_t>& inputNodeIDs);
+    /// appends the node to the circuit's inputs together with a copy of its data type
+    void addInput(uint64_t inputNodeID, const DataTypeReadOnly& dataType);
 
     MutableDataType getOutputDataTypeAt(size_t inputNumber);
     std::vector<MutableDataType> getOutputDataTypes();
 
     void setOutputNodeIDs(std::span<uint64_t> outputNodeIDs);
+    /// counterpart of removeInputs for the circuit's outputs
+    void removeOutputs(const std::unordered_set<uint64_t>& outputNodeIDs);
+    /// appends the node to the circuit's outputs together with a copy of its data type
+    void addOutput(uint64_t outputNodeID, const DataTypeReadOnly& dataType);
     MutableNode getNodeWithID(uint64_t nodeID);
 
     /*
@@ -826,6 +849,14 @@ private:
      * @return MutableNode a mutable wrapper to the newly added node for further mutation.
      */
     MutableNode addNode(long position);
+    /**
+     * @brief Adds a node with the given ID at the back of the circuit without searching for the next available ID.
+     * The caller has to make sure that the ID is not used by any other node of the circuit.
+     *
+     * @param nodeID ID of the node to add.
+     * @return MutableNode a mutable wrapper to the newly added node for further mutation.
+     */
+    MutableNode addNodeWithID(uint64_t nodeID);
     uint64_t replaceNodesBySubcircuit(CircuitReadOnly& subcircuit,
                                   // nodees that need to be deleted afterwards
                                   std::span<uint64_t> nodesToReplace,
@@ -836,7 +867,34 @@ private:
                                   // maps subcircuit output to one of the nodes to replace
                                   std::unordered_map<uint64_t, uint64_t> subcircuitOutputToCircuitNode);
     void replaceNodesBySIMDNode(std::span<uint64_t> nodesToSimdify);
+    /**
+     * @brief Replaces every group of nodes by one SIMD node in a single sweep over the circuit.
+     * The outputs of the SIMD node are the outputs of the group's nodes in order, e.g. for calls with several outputs.
+     * Users of the replaced nodes (including the new SIMD nodes) read from the respective SIMD output afterwards.
+     * Nodes inside a group must not depend on each other and the groups must not depend on each other cyclically.
+     *
+     * @return the IDs of the SIMD nodes in the order of the groups
+     */
+    std::vector<uint64_t> replaceNodesBySIMDNodes(const std::vector<std::vector<uint64_t>>& nodeGroups);
+    /**
+     * @brief Replaces every given call node by a copy of the called circuit's nodes in a single sweep over the circuit.
+     * Users of the call's o-th output read the value of the callee's o-th output node afterwards.
+     *
+     * @param callsToInline maps the ID of each call node to inline to the called circuit
+     */
+    void inlineCalls(const std::unordered_map<uint64_t, CircuitObjectWrapper>& callsToInline);
     void iterativelyRestoreTopologicalOrder(uint64_t nodeID, std::unordered_map<uint64_t, std::unordered_set<uint64_t>> nodeSuccessors);
+    /**
+     * @brief Reorders all nodes s.t. every node is placed after its inputs.
+     * Nodes that already are in topological order keep their relative order.
+     */
+    void restoreTopologicalOrder();
+    /**
+     * @brief Places the nodes in the given order, which has to contain every node of the circuit exactly once.
+     *
+     * @throws std::logic_error if the order does not contain every node exactly once
+     */
+    void reorderNodes(std::span<const uint64_t> nodeIDs);
 
     void removeNode(uint64_t nodeToDelete);
     void removeNodes(const std::unordered_set<uint64_t>& nodesToDelete);
@@ -1005,6 +1063,8 @@ class ModuleObjectWrapper : public VisitableWriteable, public ModuleReadOnly {
 private:
   ir::ModuleTableT *module_object_;
   std::vector<std::unique_ptr<ir::CircuitTableT>> unpacked_circuits_;
+  // guards the circuit buffers and unpacked circuits, so circuits can be requested from several threads
+  std::unique_ptr<std::mutex> circuits_mutex_ = std::make_unique<std::mutex>();
 
 public:
   explicit ModuleObjectWrapper(ir::ModuleTableT *module_object)
@@ -1029,6 +1089,19 @@ public:
   MutableCircuit getCircuitWithName(const std::string &name);
   MutableCircuit getEntryCircuit();
 
+  /**
+   * @brief Unpacks all circuits that are still serialized, using up to numberOfThreads threads (all hardware threads if 0).
+   * Afterwards, getCircuitWithName only looks up the unpacked circuit, so passes can request circuits concurrently.
+   */
+  void unpackAllCircuits(size_t numberOfThreads = 0);
+
+  /**
+   * @brief Adds a deep copy of the circuit with the given name to the module under the new name.
+   *
+   * @throws std::logic_error if the module already contains a circuit with the new name
+   */
+  MutableCircuit copyCircuit(const std::string &name, const std::string &copyName);
+
   virtual void accept(ReadOnlyVisitor &visitor) const override {
     visitor.visit(*this);
   }
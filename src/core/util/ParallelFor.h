@@ -0,0 +1,45 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_PARALLELFOR_H
+#define FUSE_PARALLELFOR_H
+
+#include <cstddef>
+#include <functional>
+
+namespace fuse::core::util {
+
+/**
+ * @brief Returns the given number of threads or the number of hardware threads if it is 0.
+ */
+size_t getNumberOfThreads(size_t numberOfThreads);
+
+/**
+ * @brief Calls func(i) for every i in [0, n) on up to numberOfThreads threads including the calling one,
+ * using all hardware threads if numberOfThreads is 0. Indices are handed out one at a time, so calls of different cost balance out.
+ * If calls throw, the exception of the smallest index is rethrown after all threads have finished.
+ */
+void parallelFor(size_t n, const std::function<void(size_t)>& func, size_t numberOfThreads = 0);
+
+}  // namespace fuse::core::util
+
+#endif /* FUSE_PARALLELFOR_H */
@@ -0,0 +1,393 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "BitWidthNarrowing.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "CostEstimation.h"
+#include "OperandWidths.h"
+#include "ProtocolAssignment.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using Offset = uint32_t;
+using op = core::ir::PrimitiveOperation;
+using pt = core::ir::PrimitiveType;
+
+bool isUnsignedType(pt type) {
+    return type == pt::Bool || type == pt::UInt8 || type == pt::UInt16 || type == pt::UInt32 || type == pt::UInt64;
+}
+
+uint64_t getMaxValue(pt type) {
+    const auto width = getPrimitiveTypeBitWidth(type);
+    return !isUnsignedType(type) || width >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{1} << width) - 1;
+}
+
+pt getUnsignedType(size_t bitWidth) {
+    if (bitWidth <= 8) {
+        return pt::UInt8;
+    } else if (bitWidth <= 16) {
+        return pt::UInt16;
+    } else if (bitWidth <= 32) {
+        return pt::UInt32;
+    }
+    return pt::UInt64;
+}
+
+// bounds that exceed the type mean that the value may wrap around
+uint64_t addBounds(uint64_t a, uint64_t b, uint64_t limit) { return a > limit - std::min(b, limit) ? limit : a + b; }
+
+uint64_t multiplyBounds(uint64_t a, uint64_t b, uint64_t limit) { return a != 0 && b > limit / a ? limit : a * b; }
+
+bool isRingOperation(op operation) {
+    return operation == op::Add || operation == op::Sub || operation == op::Mul || operation == op::Neg || operation == op::Square;
+}
+
+bool isExactOperation(const core::NodeReadOnly& node) {
+    return node.hasComparisonOperator() || node.getOperation() == op::Div || node.getOperation() == op::Mux;
+}
+
+// Mux selects between its second and third input, the condition keeps its width
+size_t getFirstOperand(const core::NodeReadOnly& node) { return node.getOperation() == op::Mux ? 1 : 0; }
+
+core::ir::DataTypeTableT makeUnsignedType(size_t bitWidth, core::ir::SecurityLevel securityLevel) {
+    core::ir::DataTypeTableT type;
+    type.primitive_type = getUnsignedType(bitWidth);
+    type.security_level = securityLevel;
+    return type;
+}
+
+// a use of a value with another width than the value is computed with
+struct Conversion {
+    Identifier user;
+    size_t input;
+    Identifier value;
+    size_t fromWidth;
+    size_t toWidth;
+};
+
+std::vector<Conversion> findConversions(core::CircuitObjectWrapper& circuit, const std::unordered_map<Identifier, ValueRange>& ranges,
+                                        const std::unordered_map<Identifier, size_t>& narrowedWidths) {
+    std::vector<Conversion> conversions;
+    for (auto node : circuit) {
+        auto narrowed = narrowedWidths.find(node.getNodeID());
+        auto inputs = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        const size_t firstOperand = narrowed != narrowedWidths.end() ? getFirstOperand(node) : 0;
+        for (size_t i = firstOperand; i < inputs.size(); ++i) {
+            const bool isFirstOutput = offsets.empty() || offsets[i] == 0;
+            const auto& range = ranges.at(inputs[i]);
+            if (!isFirstOutput || !isUnsignedType(range.type) || range.type == pt::Bool) {
+                continue;
+            }
+            const size_t declaredWidth = getPrimitiveTypeBitWidth(range.type);
+            auto producer = narrowedWidths.find(inputs[i]);
+            const size_t fromWidth = producer != narrowedWidths.end() ? producer->second : declaredWidth;
+            const size_t toWidth = narrowed != narrowedWidths.end() ? narrowed->second : declaredWidth;
+            if (fromWidth != toWidth) {
+                conversions.push_back({node.getNodeID(), i, inputs[i], fromWidth, toWidth});
+            }
+        }
+    }
+    return conversions;
+}
+
+MpcProtocol getCheapestProtocol(const ProtocolCostModel& costModel, const core::NodeReadOnly& node, size_t bitWidth) {
+    auto cheapest = MpcProtocol::BooleanGmw;
+    double cost = std::numeric_limits<double>::infinity();
+    for (auto protocol : {MpcProtocol::ArithmeticGmw, MpcProtocol::BooleanGmw, MpcProtocol::Bmr}) {
+        if (costModel.getOperationCost(node, protocol, bitWidth) < cost) {
+            cost = costModel.getOperationCost(node, protocol, bitWidth);
+            cheapest = protocol;
+        }
+    }
+    return cheapest;
+}
+
+double getCheapestOperationCost(const ProtocolCostModel& costModel, const core::NodeReadOnly& node, size_t bitWidth) {
+    return costModel.getOperationCost(node, getCheapestProtocol(costModel, node, bitWidth), bitWidth);
+}
+
+/*
+ * Changing the width of an arithmetic share needs its bits, i.e. a conversion to Boolean GMW and back.
+ * Boolean shares are truncated and extended locally.
+ */
+double getWidthConversionCost(const ProtocolCostModel& costModel, size_t fromWidth, size_t toWidth) {
+    return costModel.getConversionCost(MpcProtocol::ArithmeticGmw, MpcProtocol::BooleanGmw, fromWidth) +
+           costModel.getConversionCost(MpcProtocol::BooleanGmw, MpcProtocol::ArithmeticGmw, toWidth);
+}
+
+Identifier findRoot(std::unordered_map<Identifier, Identifier>& parents, Identifier id) {
+    while (parents.at(id) != id) {
+        id = parents[id] = parents.at(parents.at(id));
+    }
+    return id;
+}
+
+}  // namespace
+
+std::unordered_map<uint64_t, ValueRange> analyzeValueRanges(const core::CircuitReadOnly& circuit) {
+    std::unordered_map<Identifier, ValueRange> ranges;
+    circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+        auto inputs = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        auto getOperandRange = [&](size_t i) {
+            const auto& producerRange = ranges.at(inputs[i]);
+            if (offsets.empty() || offsets[i] == 0) {
+                return producerRange;
+            }
+            // further outputs of Split are bits, nothing is known about the other outputs of multi-output nodes
+            if (circuit.getNodeWithID(inputs[i])->isSplitNode()) {
+                return ValueRange{pt::Bool, 1};
+            }
+            return ValueRange{producerRange.type, getMaxValue(producerRange.type)};
+        };
+
+        ValueRange range;
+        auto outputTypes = node.getOutputDataTypes();
+        if (node.isSplitNode() || node.hasComparisonOperator()) {
+            range = {pt::Bool, 1};
+        } else if (node.isConstantNode()) {
+            auto constantType = node.getConstantType();
+            range.type = constantType->getPrimitiveType();
+            range.maxValue = getMaxValue(range.type);
+            if (constantType->getShape().empty() && isUnsignedType(range.type)) {
+                range.maxValue = node.getConstantFlexbuffer().AsUInt64();
+            }
+        } else if (node.isInputNode()) {
+            range.type = outputTypes.empty() ? pt::Bool : outputTypes[0]->getPrimitiveType();
+            range.maxValue = getMaxValue(range.type);
+            if (auto maxValue = node.getStringValueForAttribute("max_value"); !maxValue.empty() && isUnsignedType(range.type)) {
+                range.maxValue = std::min<uint64_t>(range.maxValue, std::stoull(maxValue));
+            }
+        } else if (node.isMergeNode()) {
+            range.type = getUnsignedType(inputs.size());
+            // the value is bounded by its highest bit that is not constant zero
+            size_t bits = inputs.size();
+            while (bits > 0) {
+                auto bit = circuit.getNodeWithID(inputs[bits - 1]);
+                if (!bit->isConstantNode() || bit->getConstantFlexbuffer().AsUInt64() != 0) {
+                    break;
+                }
+                --bits;
+            }
+            range.maxValue = bits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{1} << bits) - 1;
+        } else if (node.getNumberOfInputs() > getFirstOperand(node) && !node.isSubcircuitNode() && !node.isLoopNode()) {
+            const auto first = getOperandRange(getFirstOperand(node));
+            range.type = first.type;
+            const auto limit = getMaxValue(range.type);
+            switch (node.getOperation()) {
+                case op::Add:
+                    range.maxValue = first.maxValue;
+                    for (size_t i = 1; i < inputs.size(); ++i) {
+                        range.maxValue = addBounds(range.maxValue, getOperandRange(i).maxValue, limit);
+                    }
+                    break;
+                case op::Mul:
+                    range.maxValue = first.maxValue;
+                    for (size_t i = 1; i < inputs.size(); ++i) {
+                        range.maxValue = multiplyBounds(range.maxValue, getOperandRange(i).maxValue, limit);
+                    }
+                    break;
+                case op::Square:
+                    range.maxValue = multiplyBounds(first.maxValue, first.maxValue, limit);
+                    break;
+                case op::Div:
+                    range.maxValue = first.maxValue;
+                    break;
+                case op::Mux:
+                    range.maxValue = inputs.size() == 3 ? std::max(first.maxValue, getOperandRange(2).maxValue) : limit;
+                    break;
+                case op::Custom:
+                    range.maxValue = node.getCustomOperationName() == kConvertOperationName ? first.maxValue : limit;
+                    break;
+                default:
+                    // Boolean gates on bits stay bits
+                    range.maxValue = range.type == pt::Bool ? 1 : limit;
+                    break;
+            }
+        }
+        // explicit output types take precedence, e.g. when a frontend annotates the result of an operation
+        if (!outputTypes.empty() && !node.isSplitNode() && !node.isConstantNode()) {
+            range.type = outputTypes[0]->getPrimitiveType();
+            range.maxValue = std::min(range.maxValue, getMaxValue(range.type));
+        }
+        if (!isUnsignedType(range.type)) {
+            range.maxValue = std::numeric_limits<uint64_t>::max();
+        }
+        ranges.emplace(node.getNodeID(), range);
+    });
+    return ranges;
+}
+
+size_t narrowBitWidths(core::CircuitObjectWrapper& circuit, const ProtocolCostModel& costModel) {
+    const auto ranges = analyzeValueRanges(circuit);
+
+    // width with which each narrowed node computes and the cost it saves
+    std::unordered_map<Identifier, size_t> narrowedWidths;
+    std::unordered_map<Identifier, double> savings;
+    for (auto node : circuit) {
+        if (node.getNumberOfOutputs() != 1 || (!isRingOperation(node.getOperation()) && !isExactOperation(node)) ||
+            node.getNumberOfInputs() <= getFirstOperand(node)) {
+            continue;
+        }
+        auto inputs = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        const auto operandType = ranges.at(inputs[getFirstOperand(node)]).type;
+        const size_t declaredWidth = getPrimitiveTypeBitWidth(operandType);
+        if (!isUnsignedType(operandType) || operandType == pt::Bool || declaredWidth <= 8) {
+            continue;
+        }
+        size_t neededBits = 0;
+        bool hasKnownOperands = true;
+        for (size_t i = getFirstOperand(node); i < inputs.size(); ++i) {
+            // the ranges only cover the first output of each node
+            hasKnownOperands &= offsets.empty() || offsets[i] == 0;
+            neededBits = std::max<size_t>(neededBits, std::bit_width(ranges.at(inputs[i]).maxValue));
+        }
+        if (isRingOperation(node.getOperation())) {
+            neededBits = std::bit_width(ranges.at(node.getNodeID()).maxValue);
+        } else if (!hasKnownOperands) {
+            continue;
+        }
+        const size_t width = getPrimitiveTypeBitWidth(getUnsignedType(std::max<size_t>(neededBits, 1)));
+        if (width < declaredWidth) {
+            narrowedWidths.emplace(node.getNodeID(), width);
+            const double saving = getCheapestOperationCost(costModel, node, declaredWidth) - getCheapestOperationCost(costModel, node, width);
+            savings.emplace(node.getNodeID(), std::isfinite(saving) ? saving : 0.0);
+        }
+    }
+
+    /*
+     * Narrowed nodes that use each other form regions, the conversions of a region only depend on the region itself.
+     * A region is kept if its savings exceed the cost of the conversions at its boundary, so a single narrowed multiplication
+     * between wide values does not pay more for conversions than it saves. The protocols are not known yet: extensions are
+     * always charged, truncations only if the narrowed user is cheapest in arithmetic GMW, as other users need the bits anyway.
+     */
+    std::unordered_map<Identifier, Identifier> regions;
+    for (const auto& [id, width] : narrowedWidths) {
+        regions.emplace(id, id);
+    }
+    for (auto node : circuit) {
+        if (!regions.contains(node.getNodeID())) {
+            continue;
+        }
+        for (auto input : node.getInputNodeIDs()) {
+            if (regions.contains(input)) {
+                regions[findRoot(regions, input)] = findRoot(regions, node.getNodeID());
+            }
+        }
+    }
+    std::unordered_map<Identifier, double> benefits;
+    for (const auto& [id, saving] : savings) {
+        benefits[findRoot(regions, id)] += saving;
+    }
+    std::set<std::pair<Identifier, size_t>> chargedConversions;
+    for (const auto& conversion : findConversions(circuit, ranges, narrowedWidths)) {
+        if (conversion.fromWidth > conversion.toWidth &&
+            getCheapestProtocol(costModel, circuit.getNodeWithID(conversion.user), conversion.toWidth) != MpcProtocol::ArithmeticGmw) {
+            continue;
+        }
+        if (!chargedConversions.emplace(conversion.value, conversion.toWidth).second) {
+            continue;
+        }
+        const auto region = findRoot(regions, regions.contains(conversion.user) ? conversion.user : conversion.value);
+        benefits[region] -= getWidthConversionCost(costModel, conversion.fromWidth, conversion.toWidth);
+    }
+    std::erase_if(narrowedWidths, [&](const auto& entry) { return benefits.at(findRoot(regions, entry.first)) <= 0.0; });
+    if (narrowedWidths.empty()) {
+        return 0;
+    }
+
+    // find the uses with another width than the value is computed with, before nodes are added to the circuit
+    const auto conversions = findConversions(circuit, ranges, narrowedWidths);
+
+    // every value is converted at most once per width
+    std::map<std::pair<Identifier, size_t>, Identifier> convertedValues;
+    for (const auto& conversion : conversions) {
+        auto user = circuit.getNodeWithID(conversion.user);
+        const auto value = user.getInputNodeIDs()[conversion.input];
+        auto [converted, inserted] = convertedValues.try_emplace({value, conversion.toWidth}, 0);
+        if (inserted) {
+            auto producer = circuit.getNodeWithID(value);
+            auto toType = makeUnsignedType(conversion.toWidth, core::ir::SecurityLevel::Secure);
+            auto newNode = circuit.addNode();
+            if (producer.isConstantNode() && ranges.at(value).maxValue <= getMaxValue(toType.primitive_type)) {
+                newNode.setPrimitiveOperation(op::Constant);
+                newNode.setNumberOfOutputs(1);
+                newNode.setConstantType(toType.primitive_type);
+                newNode.setPayload(ranges.at(value).maxValue);
+            } else {
+                std::vector<Identifier> inputIDs{value};
+                std::vector<Offset> inputOffsets{0};
+                auto fromType = makeUnsignedType(conversion.fromWidth, core::ir::SecurityLevel::Secure);
+                newNode.setPrimitiveOperation(op::Custom);
+                newNode.setCustomOperationName(kConvertOperationName);
+                newNode.setInputNodeIDs(inputIDs);
+                newNode.setInputOffsets(inputOffsets);
+                newNode.setNumberOfOutputs(1);
+                newNode.setInputDataTypes(core::DataTypeObjectWrapper(&fromType));
+                newNode.setOutputDataTypes(core::DataTypeObjectWrapper(&toType));
+            }
+            converted->second = newNode.getNodeID();
+        }
+        user = circuit.getNodeWithID(conversion.user);
+        std::vector<Identifier> inputIDs(user.getInputNodeIDs().begin(), user.getInputNodeIDs().end());
+        std::vector<Offset> inputOffsets(inputIDs.size(), 0);
+        auto offsets = user.getInputOffsets();
+        std::copy(offsets.begin(), offsets.end(), inputOffsets.begin());
+        inputIDs[conversion.input] = converted->second;
+        inputOffsets[conversion.input] = 0;
+        user.setInputNodeIDs(inputIDs);
+        user.setInputOffsets(inputOffsets);
+    }
+
+    for (const auto& [id, width] : narrowedWidths) {
+        auto node = circuit.getNodeWithID(id);
+        auto type = makeUnsignedType(width, core::ir::SecurityLevel::Secure);
+        core::DataTypeObjectWrapper typeWrapper(&type);
+        if (node.getOperation() != op::Mux) {
+            node.setInputDataTypes(typeWrapper);
+        }
+        if (!node.hasComparisonOperator()) {
+            node.setOutputDataTypes(typeWrapper);
+        }
+    }
+    // conversions have been added at the end of the circuit
+    circuit.restoreTopologicalOrder();
+    return narrowedWidths.size();
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_BITWIDTHNARROWING_H
+#define FUSE_BITWIDTHNARROWING_H
+
+#include <unordered_map>
+
+#include "ModuleWrapper.h"
+#include "ProtocolAssignment.h"
+
+namespace fuse::passes {
+
+/// name of the custom operation that converts an unsigned value from the width of its input data type into the width of its output data type
+constexpr auto kConvertOperationName = "Convert";
+
+/**
+ * @brief The type of a node's first output and an upper bound for its value, interpreted as unsigned integer.
+ * If the value may wrap around, the bound is the maximum value of the type.
+ */
+struct ValueRange {
+    core::ir::PrimitiveType type = core::ir::PrimitiveType::Bool;
+    uint64_t maxValue = 1;
+};
+
+/**
+ * @brief Computes the value range of every node in the circuit.
+ *
+ * Bounds come from constants, comparisons and Split (single bits), Merge (the highest bit that is not constant zero,
+ * assuming the first input is the least significant bit) and inputs annotated with "max_value:<n>".
+ * They are propagated through Add, Mul, Square, Div and Mux, other operations may produce any value of their type.
+ */
+std::unordered_map<uint64_t, ValueRange> analyzeValueRanges(const core::CircuitReadOnly& circuit);
+
+/**
+ * @brief Evaluates unsigned arithmetic nodes with the smallest width of 8, 16, 32 or 64 bits that is exact according to the value ranges.
+ *
+ * Add, Sub, Mul, Neg and Square are computed modulo 2^n, so they are narrowed if their result fits into n bits.
+ * Comparisons, Div and Mux are narrowed if their operands fit into n bits.
+ * Narrowed nodes get explicit data types and "Convert" nodes (see kConvertOperationName) are inserted where a value
+ * is used with another width than it is computed with, constants are replaced by narrowed constants instead.
+ * Boolean shares change their width locally, but arithmetic shares need a conversion to Boolean shares and back. Narrowed nodes
+ * that use each other are therefore only narrowed together, and only if the operations they save in their cheapest protocol
+ * outweigh the conversions at their boundary according to the cost model.
+ *
+ * @return the number of narrowed nodes
+ */
+size_t narrowBitWidths(core::CircuitObjectWrapper& circuit, const ProtocolCostModel& costModel = {});
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_BITWIDTHNARROWING_H */
@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CallVectorization.h"
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "DepthAnalysis.h"
+
+namespace fuse::passes {
+
+class CallVectorizer {
+   public:
+    CallVectorizer(core::ModuleObjectWrapper& module, size_t minCalls, size_t maxWidth) : module_(module), minCalls_(std::max<size_t>(minCalls, 2)), maxWidth_(maxWidth) {}
+
+    /**
+     * @brief Vectorizes the circuit after all of its callees, s.t. the callee information is final when it is used.
+     */
+    size_t visit(const std::string& name) {
+        if (!visited_.insert(name).second) {
+            return 0;
+        }
+        size_t numberOfSimdCalls = 0;
+        std::unordered_set<std::string> calleeNames;
+        const auto& readOnlyModule = static_cast<const core::ModuleObjectWrapper&>(module_);
+        readOnlyModule.getCircuitWithName(name)->topologicalTraversal([&](const core::NodeReadOnly& node) {
+            if (node.isSubcircuitNode()) {
+                calleeNames.insert(node.getSubCircuitName());
+            }
+        });
+        for (const auto& calleeName : calleeNames) {
+            numberOfSimdCalls += visit(calleeName);
+        }
+        auto circuit = module_.getCircuitWithName(name);
+        return numberOfSimdCalls + visit(circuit);
+    }
+
+   private:
+    size_t visit(core::CircuitObjectWrapper& circuit) {
+        auto callDepths = getNodeInstructionDepths(circuit, core::ir::PrimitiveOperation::CallSubcircuit);
+
+        // calls to the same callee on the same call depth can not depend on each other
+        std::map<std::pair<uint64_t, std::string>, std::vector<uint64_t>> candidates;
+        for (auto node : circuit) {
+            if (!node.isSubcircuitNode() || !callDepths.contains(node.getNodeID())) {
+                continue;
+            }
+            const auto& callee = getCalleeInfo(node.getSubCircuitName());
+            if (callee.simdCompatible && node.getNumberOfInputs() == callee.numberOfInputs) {
+                candidates[{callDepths.at(node.getNodeID()), node.getSubCircuitName()}].push_back(node.getNodeID());
+            }
+        }
+
+        std::vector<std::vector<uint64_t>> groups;
+        for (auto& [key, calls] : candidates) {
+            size_t width = maxWidth_ == 0 ? calls.size() : maxWidth_;
+            for (size_t begin = 0; begin < calls.size(); begin += width) {
+                size_t end = std::min(begin + width, calls.size());
+                if (end - begin >= minCalls_) {
+                    groups.emplace_back(calls.begin() + begin, calls.begin() + end);
+                }
+            }
+        }
+        if (groups.empty()) {
+            return 0;
+        }
+
+        // make the number of outputs explicit, s.t. the outputs of each call get their own offsets in the SIMD call
+        std::unordered_set<uint64_t> groupedCalls;
+        for (const auto& group : groups) {
+            groupedCalls.insert(group.begin(), group.end());
+        }
+        for (auto node : circuit) {
+            if (groupedCalls.contains(node.getNodeID())) {
+                node.setNumberOfOutputs(getCalleeInfo(node.getSubCircuitName()).numberOfOutputs);
+            }
+        }
+        circuit.replaceNodesBySIMDNodes(groups);
+        return groups.size();
+    }
+
+    struct CalleeInfo {
+        size_t numberOfInputs = 0;
+        size_t numberOfOutputs = 0;
+        bool simdCompatible = false;
+    };
+
+    static bool isScalarNode(const core::NodeReadOnly& node) {
+        using op = core::ir::PrimitiveOperation;
+        switch (node.getOperation()) {
+            case op::Not:
+            case op::Neg:
+            case op::Square:
+            case op::Output:
+            case op::Split:
+            case op::SelectOffset:
+                return node.getNumberOfInputs() == 1;
+            case op::And:
+            case op::Xor:
+            case op::Or:
+            case op::Nand:
+            case op::Nor:
+            case op::Xnor:
+            case op::Gt:
+            case op::Ge:
+            case op::Lt:
+            case op::Le:
+            case op::Eq:
+            case op::Add:
+            case op::Mul:
+            case op::Div:
+            case op::Sub:
+                return node.getNumberOfInputs() == 2;
+            case op::Mux:
+                return node.getNumberOfInputs() == 3;
+            case op::Input:
+            case op::Merge:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    const CalleeInfo& getCalleeInfo(const std::string& name) {
+        if (auto it = callees_.find(name); it != callees_.end()) {
+            return it->second;
+        }
+        // recursive calls are not SIMD compatible until proven otherwise
+        callees_[name] = CalleeInfo{};
+        const auto& readOnlyModule = static_cast<const core::ModuleObjectWrapper&>(module_);
+        auto callee = readOnlyModule.getCircuitWithName(name);
+        CalleeInfo info;
+        info.numberOfInputs = callee->getNumberOfInputs();
+        info.numberOfOutputs = callee->getNumberOfOutputs();
+        info.simdCompatible = true;
+        callee->topologicalTraversal([&](const core::NodeReadOnly& node) {
+            if (!info.simdCompatible) {
+                return;
+            }
+            if (node.isSubcircuitNode()) {
+                const auto& nestedCallee = getCalleeInfo(node.getSubCircuitName());
+                info.simdCompatible = nestedCallee.simdCompatible && node.getNumberOfInputs() == nestedCallee.numberOfInputs;
+            } else {
+                info.simdCompatible = isScalarNode(node);
+            }
+        });
+        callees_[name] = info;
+        return callees_[name];
+    }
+
+    core::ModuleObjectWrapper& module_;
+    const size_t minCalls_;
+    const size_t maxWidth_;
+    std::unordered_map<std::string, CalleeInfo> callees_;
+    std::unordered_set<std::string> visited_;
+};
+
+size_t vectorizeCalls(core::ModuleObjectWrapper& module, size_t minCalls, size_t maxWidth) {
+    CallVectorizer vectorizer(module, minCalls, maxWidth);
+    size_t numberOfSimdCalls = 0;
+    for (auto name : module.getAllCircuitNames()) {
+        numberOfSimdCalls += vectorizer.visit(name);
+    }
+    return numberOfSimdCalls;
+}
+
+}  // namespace fuse::passes
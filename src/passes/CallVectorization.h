@@ -0,0 +1,49 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_CALLVECTORIZATION_H
+#define FUSE_CALLVECTORIZATION_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Merges independent calls to the same subcircuit into one SIMD call node.
+ *
+ * Calls are independent if they have the same depth w.r.t. CallSubcircuit nodes.
+ * A SIMD call with k calls has the inputs of all calls in order (k times the number of callee inputs)
+ * and k times the number of callee outputs, where the outputs of the j-th call start at offset j * (callee outputs).
+ * Backends can thus evaluate the callee only once on SIMD values.
+ * Only callees that can be evaluated on SIMD values are considered,
+ * i.e. callees (and their callees) without constants and without SIMD nodes.
+ *
+ * @param module the module whose circuits are vectorized
+ * @param minCalls minimal number of calls per SIMD call
+ * @param maxWidth maximal number of calls per SIMD call, 0 means unlimited
+ * @return the number of SIMD call nodes that were created
+ */
+size_t vectorizeCalls(core::ModuleObjectWrapper& module, size_t minCalls = 2, size_t maxWidth = 0);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_CALLVECTORIZATION_H */
@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CircuitDeduplication.h"
+
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+namespace fuse::passes {
+
+namespace {
+
+void appendDataType(std::stringstream& out, const core::DataTypeReadOnly& dataType) {
+    out << static_cast<int>(dataType.getPrimitiveType()) << ":" << static_cast<int>(dataType.getSecurityLevel()) << "[";
+    for (auto dim : dataType.getShape()) {
+        out << dim << ",";
+    }
+    out << "]" << dataType.getDataTypeAnnotations() << ";";
+}
+
+}  // namespace
+
+std::string getCanonicalStructure(const core::CircuitReadOnly& circuit) {
+    std::unordered_map<uint64_t, size_t> positions;
+    std::stringstream out;
+    out << circuit.getCircuitAnnotations() << "\n";
+    circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+        positions[node.getNodeID()] = positions.size();
+        out << static_cast<int>(node.getOperation()) << "(";
+        auto inputs = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            // inputs that are not part of the circuit cannot be renamed consistently
+            auto it = positions.find(inputs[i]);
+            out << (it == positions.end() ? "?" + std::to_string(inputs[i]) : std::to_string(it->second));
+            out << ":" << (node.usesInputOffsets() ? offsets[i] : 0) << ",";
+        }
+        out << ")" << node.getNumberOfOutputs() << "{";
+        for (const auto& dataType : node.getOutputDataTypes()) {
+            appendDataType(out, *dataType);
+        }
+        out << "}";
+        if (node.isNodeWithCustomOp()) {
+            out << "custom=" << node.getCustomOperationName();
+        }
+        if (node.isSubcircuitNode() || node.isLoopNode()) {
+            out << "call=" << node.getSubCircuitName();
+        }
+        if (node.isConstantNode()) {
+            out << "const=";
+            appendDataType(out, *node.getConstantType());
+            out << node.getConstantFlexbuffer().ToString();
+        }
+        out << "@" << node.getNodeAnnotations() << "\n";
+    });
+
+    out << "in:";
+    for (auto input : circuit.getInputNodeIDs()) {
+        out << positions.at(input) << ",";
+    }
+    out << "\nout:";
+    for (auto output : circuit.getOutputNodeIDs()) {
+        out << positions.at(output) << ",";
+    }
+    return out.str();
+}
+
+uint64_t computeStructuralHash(const core::CircuitReadOnly& circuit) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : getCanonicalStructure(circuit)) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+size_t deduplicateCircuits(core::ModuleObjectWrapper& module) {
+    const auto entryCircuitName = module.getEntryCircuitName();
+    size_t numberOfRemovedCircuits = 0;
+
+    while (true) {
+        auto circuitNames = module.getAllCircuitNames();
+        std::sort(circuitNames.begin(), circuitNames.end());
+
+        // 1. group circuits by their canonical structure, the first name of each group is kept
+        std::unordered_map<std::string, std::string> representatives;
+        std::unordered_map<std::string, std::string> replacements;
+        for (const auto& name : circuitNames) {
+            auto canonical = getCanonicalStructure(*std::as_const(module).getCircuitWithName(name));
+            auto [it, inserted] = representatives.try_emplace(std::move(canonical), name);
+            if (inserted) {
+                continue;
+            }
+            if (name == entryCircuitName) {
+                replacements[it->second] = name;
+                it->second = name;
+            } else {
+                replacements[name] = it->second;
+            }
+        }
+        if (replacements.empty()) {
+            break;
+        }
+        // an earlier copy may have been redirected to a circuit that was replaced by the entry circuit afterwards
+        for (auto& [removed, kept] : replacements) {
+            while (replacements.contains(kept)) {
+                kept = replacements.at(kept);
+            }
+        }
+
+        // 2. redirect all calls to the removed copies, circuits are only unpacked if they contain such a call
+        for (const auto& name : circuitNames) {
+            if (replacements.contains(name)) {
+                continue;
+            }
+            bool callsRemovedCircuit = false;
+            std::as_const(module).getCircuitWithName(name)->topologicalTraversal([&](const core::NodeReadOnly& node) {
+                callsRemovedCircuit |= (node.isSubcircuitNode() || node.isLoopNode()) && replacements.contains(node.getSubCircuitName());
+            });
+            if (!callsRemovedCircuit) {
+                continue;
+            }
+            auto circuit = module.getCircuitWithName(name);
+            for (auto node : circuit) {
+                if ((node.isSubcircuitNode() || node.isLoopNode()) && replacements.contains(node.getSubCircuitName())) {
+                    node.setSubCircuitName(replacements.at(node.getSubCircuitName()));
+                }
+            }
+        }
+
+        // 3. remove the copies, callers may have become identical so repeat
+        for (const auto& [removed, kept] : replacements) {
+            module.removeCircuit(removed);
+            ++numberOfRemovedCircuits;
+        }
+    }
+    return numberOfRemovedCircuits;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_CIRCUITDEDUPLICATION_H
+#define FUSE_CIRCUITDEDUPLICATION_H
+
+#include <string>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Computes the canonical structure of the circuit: all nodes in topological order with their operations, data types,
+ * payloads, annotations and called subcircuits, where node IDs are replaced by their position in the topological order.
+ * The circuit name is not part of the canonical structure, so two circuits with equal canonical structure compute the same function.
+ *
+ * @param circuit the circuit to canonicalize
+ * @return std::string the canonical structure, invariant to renaming of node IDs
+ */
+std::string getCanonicalStructure(const core::CircuitReadOnly& circuit);
+
+/**
+ * @brief Structural hash of the circuit, i.e. a 64 bit FNV-1a hash of its canonical structure.
+ */
+uint64_t computeStructuralHash(const core::CircuitReadOnly& circuit);
+
+/**
+ * @brief Merges structurally identical circuits of the module and rewrites all calls to the removed copies.
+ * The entry circuit or otherwise the copy with the lexicographically smallest name is kept.
+ * Merging is repeated until no more circuits become identical after rewriting their calls.
+ *
+ * @param module the module to deduplicate
+ * @return the number of removed circuits
+ */
+size_t deduplicateCircuits(core::ModuleObjectWrapper& module);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_CIRCUITDEDUPLICATION_H */
@@ -26,6 +26,7 @@
 #include <numeric>
 #include <unordered_set>
 
+#include "ParallelPasses.h"
 #include "PrimitiveOperationPolicies.hpp"
 #include "PrimitiveTypeTraits.hpp"
 
@@ -700,12 +701,9 @@ void foldConstantNodes(core::CircuitObjectWrapper& circuit) {
     folder.visit(circuit);
 }
 
-void foldConstantNodes(core::ModuleObjectWrapper& module) {
-    auto circuitNames = module.getAllCircuitNames();
-    for (auto name : circuitNames) {
-        auto circuit = module.getCircuitWithName(name);
-        foldConstantNodes(circuit);
-    }
+void foldConstantNodes(core::ModuleObjectWrapper& module, size_t numberOfThreads) {
+    runOnAllCircuits(
+        module, [](core::CircuitObjectWrapper& circuit) { foldConstantNodes(circuit); }, numberOfThreads);
 }
 
 }  // namespace fuse::passes
@@ -32,10 +32,12 @@ namespace fuse::passes {
  *
  * It runs a dead code elimination first, then performs constant folding,
  * and runs dead code elimination again to clean the circuit after having replaced nodes with other nodes.
+ * Circuits are folded independently of each other, so they are processed concurrently.
  *
  * @param module mutable module where the constant folding is performed
+ * @param numberOfThreads maximal number of circuits that are folded at once, all hardware threads if 0
  */
-void foldConstantNodes(core::ModuleObjectWrapper& module);
+void foldConstantNodes(core::ModuleObjectWrapper& module, size_t numberOfThreads = 0);
 
 void foldConstantNodes(core::CircuitObjectWrapper& circuit);
 
@@ -0,0 +1,330 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CostEstimation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "LoopUnrolling.h"
+#include "OperandWidths.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using op = core::ir::PrimitiveOperation;
+
+bool isAndGate(op operation) {
+    return operation == op::And || operation == op::Or || operation == op::Nand || operation == op::Nor;
+}
+
+bool isNonlinear(op operation) {
+    return isAndGate(operation) || operation == op::Mul || operation == op::Square || operation == op::Mux;
+}
+
+class CostEstimator {
+   public:
+    CostEstimator(const std::vector<MpcCostTable>& costTables, const core::ModuleReadOnly* module) : costTables_(costTables), module_(module) {}
+
+    CostEstimate estimate(const core::CircuitReadOnly& circuit) {
+        auto result = summarize(circuit);
+        for (size_t i = 0; i < costTables_.size(); ++i) {
+            result.protocols[i].rounds += costTables_[i].fixedRounds;
+        }
+        return result;
+    }
+
+   private:
+    struct Callee {
+        CostEstimate summary;
+        size_t numberOfInputs;
+    };
+
+    // the summary of a circuit contains the longest paths as depth and rounds, without the fixed rounds of the protocols
+    const Callee& summarizeCallee(const std::string& name) {
+        if (auto it = callees_.find(name); it != callees_.end()) {
+            return it->second;
+        }
+        if (!module_) {
+            throw std::logic_error("Cannot expand call to " + name + " without the module");
+        }
+        if (!activeCallees_.insert(name).second) {
+            throw std::logic_error("Cannot expand recursive call to " + name);
+        }
+        auto circuit = module_->getCircuitWithName(name);
+        Callee callee{summarize(*circuit), circuit->getNumberOfInputs()};
+        activeCallees_.erase(name);
+        return callees_.emplace(name, std::move(callee)).first->second;
+    }
+
+    CostEstimate summarize(const core::CircuitReadOnly& circuit) {
+        CostEstimate summary;
+        summary.circuitName = circuit.getName();
+        for (const auto& table : costTables_) {
+            summary.protocols.push_back({.protocol = table.protocol});
+        }
+
+        // longest path to every node: multiplicative depth followed by the rounds in every protocol
+        std::unordered_map<uint64_t, std::vector<double>> pathLengths;
+        circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+            std::vector<double> path(1 + costTables_.size(), 0.0);
+            for (auto input : node.getInputNodeIDs()) {
+                auto it = pathLengths.find(input);
+                if (it != pathLengths.end()) {
+                    for (size_t i = 0; i < path.size(); ++i) {
+                        path[i] = std::max(path[i], it->second[i]);
+                    }
+                }
+            }
+
+            if (node.isSubcircuitNode() || node.isLoopNode()) {
+                const auto& callee = summarizeCallee(node.getSubCircuitName());
+                // SIMD calls evaluate the callee once on all lanes, loops once per iteration one after another
+                const size_t lanes = node.isSubcircuitNode() && callee.numberOfInputs > 0 ? std::max<size_t>(node.getNumberOfInputs() / callee.numberOfInputs, 1) : 1;
+                const size_t iterations = node.isLoopNode() ? getNumberOfIterations(node) : 1;
+                addCallee(summary, callee.summary, lanes, iterations);
+                path[0] += iterations * callee.summary.multiplicativeDepth;
+                for (size_t i = 0; i < costTables_.size(); ++i) {
+                    path[i + 1] += iterations * callee.summary.protocols[i].rounds;
+                }
+            } else {
+                const auto operation = node.getOperation();
+                const double lanes = static_cast<double>(getNumberOfLanes(node));
+                const size_t width = getOperandBitWidth(node);
+                summary.numberOfNodes += lanes;
+                summary.operationCounts[core::ir::EnumNamePrimitiveOperation(operation)] += lanes;
+                summary.simdWidths[getNumberOfLanes(node)] += 1.0;
+                if (isAndGate(operation)) {
+                    summary.numberOfAndGates += lanes * static_cast<double>(width);
+                }
+                if (operation == op::Mul || operation == op::Square) {
+                    summary.numberOfMultiplications += lanes;
+                }
+                if (isNonlinear(operation)) {
+                    path[0] += 1.0;
+                }
+                for (size_t i = 0; i < costTables_.size(); ++i) {
+                    const auto& table = costTables_[i];
+                    if (table.unsupportedOperations.contains(operation)) {
+                        summary.protocols[i].unsupportedOperations += lanes;
+                    } else if (auto cost = table.operations.find(operation); cost != table.operations.end()) {
+                        summary.protocols[i].bytes += lanes * cost->second.getBytes(width);
+                        path[i + 1] += cost->second.getRounds(width);
+                    }
+                }
+            }
+
+            summary.multiplicativeDepth = std::max(summary.multiplicativeDepth, path[0]);
+            for (size_t i = 0; i < costTables_.size(); ++i) {
+                summary.protocols[i].rounds = std::max(summary.protocols[i].rounds, path[i + 1]);
+            }
+            pathLengths[node.getNodeID()] = std::move(path);
+        });
+        return summary;
+    }
+
+    static void addCallee(CostEstimate& summary, const CostEstimate& callee, size_t lanes, size_t iterations) {
+        const double factor = static_cast<double>(lanes * iterations);
+        summary.numberOfNodes += factor * callee.numberOfNodes;
+        summary.numberOfAndGates += factor * callee.numberOfAndGates;
+        summary.numberOfMultiplications += factor * callee.numberOfMultiplications;
+        for (const auto& [operation, count] : callee.operationCounts) {
+            summary.operationCounts[operation] += factor * count;
+        }
+        for (const auto& [width, count] : callee.simdWidths) {
+            summary.simdWidths[width * lanes] += iterations * count;
+        }
+        for (size_t i = 0; i < summary.protocols.size(); ++i) {
+            summary.protocols[i].bytes += factor * callee.protocols[i].bytes;
+            summary.protocols[i].unsupportedOperations += factor * callee.protocols[i].unsupportedOperations;
+        }
+    }
+
+    const std::vector<MpcCostTable>& costTables_;
+    const core::ModuleReadOnly* module_;
+    std::unordered_map<std::string, Callee> callees_;
+    std::unordered_set<std::string> activeCallees_;
+};
+
+std::string escapeJSON(const std::string& value) {
+    std::stringstream escaped;
+    for (char c : value) {
+        switch (c) {
+            case '"':
+                escaped << "\\\"";
+                break;
+            case '\\':
+                escaped << "\\\\";
+                break;
+            case '\n':
+                escaped << "\\n";
+                break;
+            case '\t':
+                escaped << "\\t";
+                break;
+            case '\r':
+                escaped << "\\r";
+                break;
+            default:
+                // the remaining control characters are not allowed in JSON strings
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                } else {
+                    escaped << c;
+                }
+        }
+    }
+    return escaped.str();
+}
+
+}  // namespace
+
+double OperationCost::getBytes(size_t bitWidth) const {
+    const double w = static_cast<double>(bitWidth);
+    return bytesPerBit * w + bytesPerBitSquared * w * w;
+}
+
+double OperationCost::getRounds(size_t bitWidth) const {
+    const double w = static_cast<double>(bitWidth);
+    return rounds + roundsPerLogBit * std::ceil(std::log2(std::max(w, 1.0))) + roundsPerBit * w + roundsPerBitSquared * w * w;
+}
+
+MpcCostTable MpcCostTable::booleanGMW() {
+    MpcCostTable table;
+    table.protocol = "BooleanGmw";
+    // every AND gate opens two masked bits
+    const OperationCost andGate{.bytesPerBit = 0.25, .rounds = 1.0};
+    for (auto operation : {op::And, op::Or, op::Nand, op::Nor, op::Mux}) {
+        table.operations[operation] = andGate;
+    }
+    for (auto operation : {op::Add, op::Sub, op::Neg}) {
+        table.operations[operation] = {.bytesPerBit = 0.25, .roundsPerBit = 1.0};
+    }
+    for (auto operation : {op::Mul, op::Square}) {
+        table.operations[operation] = {.bytesPerBitSquared = 0.25, .roundsPerBit = 2.0};
+    }
+    for (auto operation : {op::Gt, op::Ge, op::Lt, op::Le, op::Eq}) {
+        table.operations[operation] = {.bytesPerBit = 0.25, .rounds = 1.0, .roundsPerLogBit = 1.0};
+    }
+    table.operations[op::Div] = {.bytesPerBitSquared = 0.5, .roundsPerBitSquared = 1.0};
+    return table;
+}
+
+MpcCostTable MpcCostTable::BMR() {
+    MpcCostTable table;
+    table.protocol = "Bmr";
+    table.fixedRounds = 2.0;
+    // every AND gate costs a garbled table of four rows with one key per party
+    const double garbledTable = 4.0 * (2.0 * 128.0 + 1.0) / 8.0;
+    for (auto operation : {op::And, op::Or, op::Nand, op::Nor, op::Mux, op::Add, op::Sub, op::Neg, op::Gt, op::Ge, op::Lt, op::Le, op::Eq}) {
+        table.operations[operation] = {.bytesPerBit = garbledTable};
+    }
+    for (auto operation : {op::Mul, op::Square}) {
+        table.operations[operation] = {.bytesPerBitSquared = garbledTable};
+    }
+    table.operations[op::Div] = {.bytesPerBitSquared = 2.0 * garbledTable};
+    return table;
+}
+
+MpcCostTable MpcCostTable::arithmeticGMW() {
+    MpcCostTable table;
+    table.protocol = "ArithmeticGmw";
+    // every multiplication opens two masked ring elements
+    for (auto operation : {op::Mul, op::Square}) {
+        table.operations[operation] = {.bytesPerBit = 0.25, .rounds = 1.0};
+    }
+    table.unsupportedOperations = {op::And, op::Xor, op::Not, op::Or, op::Nand, op::Nor, op::Xnor, op::Gt, op::Ge, op::Lt, op::Le, op::Eq,
+                                   op::Div, op::Split, op::Merge, op::Mux};
+    return table;
+}
+
+size_t getNumberOfLanes(const core::NodeReadOnly& node) {
+    switch (node.getOperation()) {
+        case op::Split:
+        case op::Custom:
+        case op::Input:
+        case op::Output:
+        case op::Constant:
+            return 1;
+        default:
+            return std::max<size_t>(node.getNumberOfOutputs(), 1);
+    }
+}
+
+std::vector<MpcCostTable> getDefaultCostTables() {
+    return {MpcCostTable::booleanGMW(), MpcCostTable::BMR(), MpcCostTable::arithmeticGMW()};
+}
+
+CostEstimate estimateCost(const core::ModuleReadOnly& module, const std::vector<MpcCostTable>& costTables) {
+    CostEstimator estimator(costTables, &module);
+    auto entryCircuit = module.getEntryCircuit();
+    return estimator.estimate(*entryCircuit);
+}
+
+CostEstimate estimateCost(const core::CircuitReadOnly& circuit, const std::vector<MpcCostTable>& costTables) {
+    CostEstimator estimator(costTables, nullptr);
+    return estimator.estimate(circuit);
+}
+
+std::string toJSON(const CostEstimate& estimate) {
+    std::ostringstream json;
+    json << std::setprecision(15);
+    json << "{\n";
+    json << "  \"circuit\": \"" << escapeJSON(estimate.circuitName) << "\",\n";
+    json << "  \"nodes\": " << estimate.numberOfNodes << ",\n";
+    json << "  \"andGates\": " << estimate.numberOfAndGates << ",\n";
+    json << "  \"multiplications\": " << estimate.numberOfMultiplications << ",\n";
+    json << "  \"multiplicativeDepth\": " << estimate.multiplicativeDepth << ",\n";
+
+    json << "  \"operations\": {";
+    bool first = true;
+    for (const auto& [operation, count] : estimate.operationCounts) {
+        json << (first ? "" : ",") << "\n    \"" << escapeJSON(operation) << "\": " << count;
+        first = false;
+    }
+    json << (first ? "" : "\n  ") << "},\n";
+
+    json << "  \"simdWidths\": {";
+    first = true;
+    for (const auto& [width, count] : estimate.simdWidths) {
+        json << (first ? "" : ",") << "\n    \"" << width << "\": " << count;
+        first = false;
+    }
+    json << (first ? "" : "\n  ") << "},\n";
+
+    json << "  \"protocols\": [";
+    first = true;
+    for (const auto& protocol : estimate.protocols) {
+        json << (first ? "" : ",") << "\n    {\"protocol\": \"" << escapeJSON(protocol.protocol) << "\", \"bytes\": " << protocol.bytes
+             << ", \"rounds\": " << protocol.rounds << ", \"unsupportedOperations\": " << protocol.unsupportedOperations << "}";
+        first = false;
+    }
+    json << (first ? "" : "\n  ") << "]\n";
+    json << "}\n";
+    return json.str();
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_COSTESTIMATION_H
+#define FUSE_COSTESTIMATION_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Cost of one lane of an operation on w-bit operands in an MPC protocol.
+ * Bytes are the bytes sent per party, both bytes and rounds are polynomials in w (rounds may also grow with log2(w)).
+ */
+struct OperationCost {
+    double bytesPerBit = 0.0;
+    double bytesPerBitSquared = 0.0;
+    double rounds = 0.0;
+    double roundsPerLogBit = 0.0;
+    double roundsPerBit = 0.0;
+    double roundsPerBitSquared = 0.0;
+
+    double getBytes(size_t bitWidth) const;
+    double getRounds(size_t bitWidth) const;
+};
+
+/**
+ * @brief Costs of all operations in one MPC protocol. Operations without an entry are local and free.
+ * The default tables are rough estimates for two parties and a security parameter of 128 bits that can be calibrated for a concrete setup.
+ */
+struct MpcCostTable {
+    std::string protocol;
+    // rounds that are needed independently of the circuit, e.g. for the constant-round evaluation in BMR
+    double fixedRounds = 0.0;
+    std::unordered_map<core::ir::PrimitiveOperation, OperationCost> operations;
+    std::unordered_set<core::ir::PrimitiveOperation> unsupportedOperations;
+
+    /**
+     * @brief Boolean GMW: one round per layer of AND gates, each AND gate opens two masked bits.
+     */
+    static MpcCostTable booleanGMW();
+
+    /**
+     * @brief BMR: a constant number of rounds, but each AND gate costs a garbled table.
+     */
+    static MpcCostTable BMR();
+
+    /**
+     * @brief Arithmetic GMW: additions are free, each multiplication opens two masked ring elements.
+     * Boolean operations and comparisons are not supported.
+     */
+    static MpcCostTable arithmeticGMW();
+};
+
+std::vector<MpcCostTable> getDefaultCostTables();
+
+/**
+ * @brief Returns the number of operations the node performs, i.e. the number of outputs for SIMD nodes and 1 otherwise.
+ */
+size_t getNumberOfLanes(const core::NodeReadOnly& node);
+
+struct ProtocolCostEstimate {
+    std::string protocol;
+    double bytes = 0.0;
+    double rounds = 0.0;
+    // number of operations the protocol cannot evaluate, the estimate is only meaningful if this is 0
+    double unsupportedOperations = 0.0;
+};
+
+/**
+ * @brief Static cost estimate of a circuit with all calls expanded.
+ * Counts are numbers of operations, i.e. a SIMD node of width k or a call with k SIMD lanes counts k times.
+ */
+struct CostEstimate {
+    std::string circuitName;
+    double numberOfNodes = 0.0;
+    double numberOfAndGates = 0.0;
+    double numberOfMultiplications = 0.0;
+    // number of AND (or OR, NAND, NOR) gates, multiplications and multiplexers on the longest path
+    double multiplicativeDepth = 0.0;
+    // number of operations by operation name
+    std::map<std::string, double> operationCounts;
+    // number of nodes by SIMD width
+    std::map<size_t, double> simdWidths;
+    std::vector<ProtocolCostEstimate> protocols;
+};
+
+/**
+ * @brief Estimates the cost of the entry circuit of the module in every protocol without running it.
+ *
+ * Calls are expanded by analyzing every called circuit once and scaling its counts by the number of calls,
+ * the inlined circuit is never materialized. A call contributes the longest path of the callee to the depth and rounds,
+ * regardless of which of its inputs are late. Loop bodies are counted once per iteration.
+ *
+ * @throws std::logic_error for recursive calls or loops without a number of iterations
+ */
+CostEstimate estimateCost(const core::ModuleReadOnly& module, const std::vector<MpcCostTable>& costTables = getDefaultCostTables());
+
+/**
+ * @brief Estimates the cost of a circuit without calls.
+ *
+ * @throws std::logic_error if the circuit contains calls or loops
+ */
+CostEstimate estimateCost(const core::CircuitReadOnly& circuit, const std::vector<MpcCostTable>& costTables = getDefaultCostTables());
+
+/**
+ * @brief Serializes the estimate as JSON object.
+ */
+std::string toJSON(const CostEstimate& estimate);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_COSTESTIMATION_H */
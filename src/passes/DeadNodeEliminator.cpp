@@ -22,16 +22,20 @@
 
 #include "DeadNodeEliminator.h"
 
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#include "ParallelFor.h"
 
 namespace fuse::passes {
 class DeadNodeEliminator {
     using Identifier = uint64_t;
 
    public:
-    void visit(core::ModuleObjectWrapper& module, bool removeUnusedCircuits = false);
+    void visit(core::ModuleObjectWrapper& module, bool removeUnusedCircuits = false, size_t numberOfThreads = 0);
     void visit(core::CircuitObjectWrapper& circuit);
 
    private:
@@ -43,13 +47,32 @@ class DeadNodeEliminator {
 /*
 DeadNodeEliminator Member Functions
  */
-void DeadNodeEliminator::visit(core::ModuleObjectWrapper& module, bool removeUnusedCircuits) {
-    auto entryCircuit = module.getEntryCircuit();
-    workingSet.push(entryCircuit.getName());
-    while (!workingSet.empty()) {
-        auto currentCircuit = module.getCircuitWithName(workingSet.front());
-        workingSet.pop();
-        visit(currentCircuit);
+void DeadNodeEliminator::visit(core::ModuleObjectWrapper& module, bool removeUnusedCircuits, size_t numberOfThreads) {
+    module.unpackAllCircuits(numberOfThreads);
+    // circuits are processed level by level starting at the entry circuit:
+    // the circuits called by the live nodes of one level form the next level and are processed concurrently
+    std::vector<std::string> level{module.getEntryCircuitName()};
+    liveCircuits.insert(level.front());
+    std::mutex calledCircuitsMutex;
+    while (!level.empty()) {
+        std::vector<std::string> calledCircuits;
+        core::util::parallelFor(
+            level.size(), [&](size_t i) {
+                DeadNodeEliminator eliminator;
+                auto circuit = module.getCircuitWithName(level[i]);
+                eliminator.visit(circuit);
+                std::lock_guard lock(calledCircuitsMutex);
+                for (; !eliminator.workingSet.empty(); eliminator.workingSet.pop()) {
+                    calledCircuits.push_back(eliminator.workingSet.front());
+                }
+            },
+            numberOfThreads);
+        level.clear();
+        for (auto& name : calledCircuits) {
+            if (liveCircuits.insert(name).second) {
+                level.push_back(std::move(name));
+            }
+        }
     }
     auto circuitNames = module.getAllCircuitNames();
     if (removeUnusedCircuits) {
@@ -81,13 +104,15 @@ void DeadNodeEliminator::visit(core::CircuitObjectWrapper& circuit) {
 }
 
 void DeadNodeEliminator::visit(core::NodeObjectWrapper& node, std::unordered_set<Identifier>& liveNodes, core::CircuitObjectWrapper& parentCircuit) {
-    if (node.getOperation() == core::ir::PrimitiveOperation::CallSubcircuit) {
+    if (node.isSubcircuitNode() || node.isLoopNode()) {
         workingSet.push(node.getSubCircuitName());
     }
     for (auto inputNodeID : node.getInputNodeIDs()) {
-        liveNodes.insert(inputNodeID);
-        auto inputNode = parentCircuit.getNodeWithID(inputNodeID);
-        visit(inputNode, liveNodes, parentCircuit);
+        // nodes that are already live have been visited before
+        if (liveNodes.insert(inputNodeID).second) {
+            auto inputNode = parentCircuit.getNodeWithID(inputNodeID);
+            visit(inputNode, liveNodes, parentCircuit);
+        }
     }
 }
 
@@ -95,9 +120,9 @@ void DeadNodeEliminator::visit(core::NodeObjectWrapper& node, std::unordered_set
 Function Definitions from Header File: Setup DeadNodeEliminator and call visit
  */
 
-void eliminateDeadNodes(core::ModuleObjectWrapper& module, bool removeUnusedCircuits) {
+void eliminateDeadNodes(core::ModuleObjectWrapper& module, bool removeUnusedCircuits, size_t numberOfThreads) {
     DeadNodeEliminator eliminator;
-    eliminator.visit(module, removeUnusedCircuits);
+    eliminator.visit(module, removeUnusedCircuits, numberOfThreads);
 }
 
 void eliminateDeadNodes(core::CircuitObjectWrapper& circuit) {
@@ -35,8 +35,9 @@ namespace fuse::passes {
  *
  * @param module mutable module where all the circuits' dead nodes are removed
  * @param removeUnusedCircuits removes circuits which are not called to compute any of the entry point's outputs.
+ * @param numberOfThreads maximal number of circuits that are processed concurrently, all hardware threads if 0
  */
-void eliminateDeadNodes(core::ModuleObjectWrapper& module, bool removeUnusedCircuits = false);
+void eliminateDeadNodes(core::ModuleObjectWrapper& module, bool removeUnusedCircuits = false, size_t numberOfThreads = 0);
 
 void eliminateDeadNodes(core::CircuitObjectWrapper& circuit);
 
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "DenseNodeNumbering.h"
+
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace fuse::passes {
+
+void renumberNodesDensely(core::CircuitObjectWrapper& circuit) {
+    using Identifier = uint64_t;
+    circuit.restoreTopologicalOrder();
+
+    std::unordered_map<Identifier, Identifier> newIDs;
+    newIDs.reserve(circuit.getNumberOfNodes());
+    for (auto node : circuit) {
+        newIDs.emplace(node.getNodeID(), newIDs.size());
+    }
+    auto renumber = [&](std::span<const Identifier> ids) {
+        std::vector<Identifier> renumbered;
+        renumbered.reserve(ids.size());
+        for (auto id : ids) {
+            auto newID = newIDs.find(id);
+            if (newID == newIDs.end()) {
+                throw std::logic_error("Node " + std::to_string(id) + " is not part of circuit " + circuit.getName());
+            }
+            renumbered.push_back(newID->second);
+        }
+        return renumbered;
+    };
+
+    for (auto node : circuit) {
+        auto inputs = renumber(node.getInputNodeIDs());
+        node.setInputNodeIDs(inputs);
+        node.setNodeID(newIDs.at(node.getNodeID()));
+    }
+    auto inputs = renumber(circuit.getInputNodeIDs());
+    circuit.setInputNodeIDs(inputs);
+    auto outputs = renumber(circuit.getOutputNodeIDs());
+    circuit.setOutputNodeIDs(outputs);
+    circuit.setStringValueForAttribute(kDenseNodeIDsAttribute, "true");
+}
+
+void renumberNodesDensely(core::ModuleObjectWrapper& module) {
+    for (const auto& name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        renumberNodesDensely(circuit);
+    }
+}
+
+bool hasDenseNodeIDs(const core::CircuitReadOnly& circuit) {
+    if (circuit.getStringValueForAttribute(kDenseNodeIDsAttribute) != "true") {
+        return false;
+    }
+    uint64_t expectedID = 0;
+    bool dense = true;
+    circuit.topologicalTraversal([&](core::NodeReadOnly& node) { dense = dense && node.getNodeID() == expectedID++; });
+    return dense;
+}
+
+}  // namespace fuse::passes
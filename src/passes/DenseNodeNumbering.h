@@ -0,0 +1,61 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_DENSENODENUMBERING_H
+#define FUSE_DENSENODENUMBERING_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Circuit attribute that marks circuits whose n nodes have the IDs 0..n-1 in topological order.
+ */
+constexpr char kDenseNodeIDsAttribute[] = "dense_ids";
+
+/**
+ * @brief Renumbers the nodes of the circuit to 0..n-1 in topological order and marks the circuit as densely numbered.
+ *
+ * The nodes are sorted topologically first, so the ID of every node is its position inside the circuit
+ * and larger than the IDs of its inputs. Inputs of nodes as well as the circuit's inputs and outputs are rewritten accordingly,
+ * input offsets refer to the outputs of the input nodes and stay the same.
+ *
+ * @throws std::logic_error if a node uses a node that is not part of the circuit
+ */
+void renumberNodesDensely(core::CircuitObjectWrapper& circuit);
+
+/**
+ * @brief Renumbers the nodes of every circuit of the module densely, see renumberNodesDensely(core::CircuitObjectWrapper&).
+ */
+void renumberNodesDensely(core::ModuleObjectWrapper& module);
+
+/**
+ * @brief Returns whether the circuit is marked as densely numbered and node i has the ID i for every position i,
+ * i.e. whether values of the nodes can be stored in arrays indexed by node ID.
+ *
+ * Passes that add or remove nodes do not maintain the numbering, so the mark alone is not trusted.
+ */
+bool hasDenseNodeIDs(const core::CircuitReadOnly& circuit);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_DENSENODENUMBERING_H */
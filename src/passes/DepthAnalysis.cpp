@@ -22,14 +22,50 @@
 
 #include "DepthAnalysis.h"
 #include "NodeSuccessorsAnalysis.h"
+#include <algorithm>
 #include <queue>
 namespace fuse::passes {
 
+namespace {
+
+// index the inputs and operations of all nodes once instead of searching every visited node in the circuit
+struct NodeIndex {
+    std::unordered_map<uint64_t, std::vector<uint64_t>> inputs;
+    std::unordered_map<uint64_t, core::ir::PrimitiveOperation> operations;
+
+    explicit NodeIndex(const core::CircuitReadOnly& circuit) {
+        circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+            auto nodeInputs = node.getInputNodeIDs();
+            inputs[node.getNodeID()].assign(nodeInputs.begin(), nodeInputs.end());
+            operations[node.getNodeID()] = node.getOperation();
+        });
+    }
+};
+
+// sorts the node indices into layers by their level, keeping the topological order inside each layer
+void buildLayers(const std::vector<uint32_t>& levels, size_t numberOfLevels, std::vector<size_t>& offsets, std::vector<size_t>& layerNodes) {
+    offsets.assign(numberOfLevels + 1, 0);
+    for (auto level : levels) {
+        ++offsets[level + 1];
+    }
+    for (size_t level = 0; level < numberOfLevels; ++level) {
+        offsets[level + 1] += offsets[level];
+    }
+    layerNodes.resize(levels.size());
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t index = 0; index < levels.size(); ++index) {
+        layerNodes[next[levels[index]]++] = index;
+    }
+}
+
+}  // namespace
+
 std::unordered_map<uint64_t, uint64_t> getNodeDepths(const core::CircuitReadOnly& circuit){
     std::unordered_map<uint64_t, uint64_t> depth;
 
     // apply node successor analysis
     std::unordered_map<uint64_t, std::unordered_set<uint64_t>> nodeSuccessors = fuse::passes::getNodeSuccessors(circuit);  
+    NodeIndex nodeIndex(circuit);
 
     // bfs
     std::queue<uint64_t> bfs_queue;
@@ -48,9 +84,8 @@ std::unordered_map<uint64_t, uint64_t> getNodeDepths(const core::CircuitReadOnly
 
         // calculate depth 
         uint64_t max_depth = 0;
-        auto cur_n = circuit.getNodeWithID(cur_node);
         bool skip = false;
-        for(auto pred: (*cur_n).getInputNodeIDs()){
+        for(auto pred: nodeIndex.inputs[cur_node]){
             
             // skip if not all preds set (will be called later)
             if (!depth.contains(pred)){
@@ -84,6 +119,7 @@ std::unordered_map<uint64_t, uint64_t> getNodeInstructionDepths(const core::Circ
 
     // apply node successor analysis
     std::unordered_map<uint64_t, std::unordered_set<uint64_t>> nodeSuccessors = fuse::passes::getNodeSuccessors(circuit);  
+    NodeIndex nodeIndex(circuit);
 
     // bfs
     std::queue<uint64_t> bfs_queue;
@@ -102,9 +138,8 @@ std::unordered_map<uint64_t, uint64_t> getNodeInstructionDepths(const core::Circ
 
         // calculate depth 
         uint64_t max_depth = 0;
-        auto cur_n = circuit.getNodeWithID(cur_node);
         bool skip = false;
-        for(auto pred: (*cur_n).getInputNodeIDs()){
+        for(auto pred: nodeIndex.inputs[cur_node]){
             
             // skip if not all preds set (will be called later)
             if (!depth.contains(pred)){
@@ -119,7 +154,7 @@ std::unordered_map<uint64_t, uint64_t> getNodeInstructionDepths(const core::Circ
             continue;
         }
 
-        if ((*cur_n).getOperation() == operationType){
+        if (nodeIndex.operations[cur_node] == operationType){
             depth[cur_node] = max_depth + 1;
         } else {
             depth[cur_node] = max_depth;
@@ -137,4 +172,54 @@ std::unordered_map<uint64_t, uint64_t> getNodeInstructionDepths(const core::Circ
     return depth;
 }
 
+LevelSchedule computeLevelSchedule(const core::CircuitReadOnly& circuit, std::optional<core::ir::PrimitiveOperation> countedOperation) {
+    LevelSchedule schedule;
+    std::unordered_map<uint64_t, size_t> indices;
+    // inputs of the nodes as indices, the inputs of node i are inputs[inputOffsets[i]] until inputs[inputOffsets[i + 1]]
+    std::vector<size_t> inputOffsets{0};
+    std::vector<size_t> inputs;
+    std::vector<bool> isCounted;
+
+    // forward sweep: ASAP levels
+    uint32_t maxLevel = 0;
+    circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+        const size_t index = schedule.nodeIDs.size();
+        indices[node.getNodeID()] = index;
+        schedule.nodeIDs.push_back(node.getNodeID());
+
+        bool counted = countedOperation ? node.getOperation() == *countedOperation : node.getNumberOfInputs() > 0;
+        isCounted.push_back(counted);
+        uint32_t level = 0;
+        for (auto inputID : node.getInputNodeIDs()) {
+            auto input = indices.find(inputID);
+            if (input != indices.end()) {
+                inputs.push_back(input->second);
+                level = std::max(level, schedule.asapLevels[input->second]);
+            }
+        }
+        inputOffsets.push_back(inputs.size());
+        level += counted ? 1 : 0;
+        schedule.asapLevels.push_back(level);
+        maxLevel = std::max(maxLevel, level);
+    });
+    const size_t numberOfNodes = schedule.nodeIDs.size();
+    if (numberOfNodes == 0) {
+        return schedule;
+    }
+    const size_t numberOfLevels = static_cast<size_t>(maxLevel) + 1;
+
+    // backward sweep: every node is placed right below its earliest user, nodes without users on the last level
+    schedule.alapLevels.assign(numberOfNodes, maxLevel);
+    for (size_t index = numberOfNodes; index-- > 0;) {
+        uint32_t latestInputLevel = schedule.alapLevels[index] - (isCounted[index] ? 1 : 0);
+        for (size_t i = inputOffsets[index]; i < inputOffsets[index + 1]; ++i) {
+            schedule.alapLevels[inputs[i]] = std::min(schedule.alapLevels[inputs[i]], latestInputLevel);
+        }
+    }
+
+    buildLayers(schedule.asapLevels, numberOfLevels, schedule.asapLayerOffsets, schedule.asapLayerNodes);
+    buildLayers(schedule.alapLevels, numberOfLevels, schedule.alapLayerOffsets, schedule.alapLayerNodes);
+    return schedule;
+}
+
 }  // namespace fuse::passes
@@ -23,7 +23,10 @@
 #ifndef FUSE_DEPTHANALYSIS_H
 #define FUSE_DEPTHANALYSIS_H
 
+#include <optional>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 #include "ModuleWrapper.h"
 
@@ -33,6 +36,43 @@ std::unordered_map<uint64_t, uint64_t> getNodeDepths(const core::CircuitReadOnly
 
 std::unordered_map<uint64_t, uint64_t> getNodeInstructionDepths(const core::CircuitReadOnly& circuit, core::ir::PrimitiveOperation operationType);
 
+/**
+ * @brief Nodes of a circuit grouped into levels s.t. every node is on a higher level than its inputs,
+ * once as soon as possible (ASAP) and once as late as possible (ALAP) without increasing the number of levels.
+ * Nodes are referred to by their index in nodeIDs, layers list their nodes in topological order.
+ */
+struct LevelSchedule {
+    // node IDs in topological order
+    std::vector<uint64_t> nodeIDs;
+    std::vector<uint32_t> asapLevels;
+    std::vector<uint32_t> alapLevels;
+    // the nodes on ASAP level l are asapLayerNodes[asapLayerOffsets[l]] until asapLayerNodes[asapLayerOffsets[l + 1]]
+    std::vector<size_t> asapLayerOffsets;
+    std::vector<size_t> asapLayerNodes;
+    // the same for the ALAP levels
+    std::vector<size_t> alapLayerOffsets;
+    std::vector<size_t> alapLayerNodes;
+
+    size_t getNumberOfLevels() const { return asapLayerOffsets.empty() ? 0 : asapLayerOffsets.size() - 1; }
+    std::span<const size_t> getASAPLayer(size_t level) const {
+        return {asapLayerNodes.data() + asapLayerOffsets.at(level), asapLayerNodes.data() + asapLayerOffsets.at(level + 1)};
+    }
+    std::span<const size_t> getALAPLayer(size_t level) const {
+        return {alapLayerNodes.data() + alapLayerOffsets.at(level), alapLayerNodes.data() + alapLayerOffsets.at(level + 1)};
+    }
+    // number of levels the node at the given index can be moved up without increasing the number of levels
+    uint32_t getSlack(size_t index) const { return alapLevels.at(index) - asapLevels.at(index); }
+};
+
+/**
+ * @brief Computes the ASAP and ALAP levels of all nodes with one forward and one backward sweep over the circuit.
+ * Nodes without inputs, e.g. inputs and constants, are on ASAP level 0.
+ *
+ * @param countedOperation if set, only nodes with this operation are placed one level above their inputs,
+ * all other nodes are on the level of their latest input (like getNodeInstructionDepths), otherwise every node with inputs is
+ */
+LevelSchedule computeLevelSchedule(const core::CircuitReadOnly& circuit, std::optional<core::ir::PrimitiveOperation> countedOperation = std::nullopt);
+
 }  // namespace fuse::passes
 
 #endif /* FUSE_DEPTHANALYSIS_H */
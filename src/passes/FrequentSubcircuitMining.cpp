@@ -0,0 +1,404 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "FrequentSubcircuitMining.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ModuleBuilder.h"
+#include "NodeSuccessorsAnalysis.h"
+
+namespace fuse::passes {
+
+namespace {
+
+bool shouldStop(const FrequentSubcircuitOptions& options) {
+    return options.stopToken.stop_requested() || std::chrono::steady_clock::now() >= options.deadline;
+}
+
+bool isMinableNode(const core::NodeReadOnly& node) {
+    using op = core::ir::PrimitiveOperation;
+    switch (node.getOperation()) {
+        case op::Input:
+        case op::Output:
+        case op::Constant:
+        case op::CallSubcircuit:
+        case op::Loop:
+        case op::Custom:
+        case op::Split:
+        case op::Merge:
+        case op::SelectOffset:
+            return false;
+        default:
+            break;
+    }
+    if (node.getNumberOfOutputs() > 1) {
+        return false;
+    }
+    // calls can only forward whole nodes as inputs
+    if (node.usesInputOffsets()) {
+        auto offsets = node.getInputOffsets();
+        return std::all_of(offsets.begin(), offsets.end(), [](uint32_t offset) { return offset == 0; });
+    }
+    return true;
+}
+
+/**
+ * @brief Compressed sparse row representation of the data flow of a circuit, nodes are referred to by their position.
+ */
+struct CircuitGraph {
+    static constexpr size_t kExternal = std::numeric_limits<size_t>::max();
+
+    std::vector<uint64_t> ids;
+    std::vector<core::ir::PrimitiveOperation> operations;
+    std::vector<bool> minable;
+    // the inputs of the node at position p are inputs[inputBegin[p]] to inputs[inputBegin[p + 1] - 1]
+    std::vector<size_t> inputBegin;
+    std::vector<size_t> inputs;
+
+    explicit CircuitGraph(const core::CircuitReadOnly& circuit) {
+        std::vector<uint64_t> inputIDs;
+        circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+            ids.push_back(node.getNodeID());
+            operations.push_back(node.getOperation());
+            minable.push_back(isMinableNode(node));
+            inputBegin.push_back(inputIDs.size());
+            auto nodeInputs = node.getInputNodeIDs();
+            inputIDs.insert(inputIDs.end(), nodeInputs.begin(), nodeInputs.end());
+        });
+        inputBegin.push_back(inputIDs.size());
+
+        std::unordered_map<uint64_t, size_t> positions;
+        for (size_t pos = 0; pos < ids.size(); ++pos) {
+            positions[ids[pos]] = pos;
+        }
+        inputs.reserve(inputIDs.size());
+        for (auto inputID : inputIDs) {
+            auto it = positions.find(inputID);
+            inputs.push_back(it == positions.end() ? kExternal : it->second);
+        }
+    }
+
+    size_t size() const { return ids.size(); }
+
+    /**
+     * @brief Grows the cone of the root breadth-first along the minable inputs and calls visit for every cone of at least minSize nodes.
+     */
+    template <typename Visitor>
+    void growCone(size_t root, size_t minSize, size_t maxSize, Visitor&& visit) const {
+        std::vector<size_t> cone = {root};
+        if (cone.size() >= minSize) {
+            visit(cone);
+        }
+        for (size_t next = 0; next < cone.size() && cone.size() < maxSize; ++next) {
+            for (size_t in = inputBegin[cone[next]]; in < inputBegin[cone[next] + 1] && cone.size() < maxSize; ++in) {
+                size_t input = inputs[in];
+                if (input == kExternal || !minable[input] || std::find(cone.begin(), cone.end(), input) != cone.end()) {
+                    continue;
+                }
+                cone.push_back(input);
+                if (cone.size() >= minSize) {
+                    visit(cone);
+                }
+            }
+        }
+    }
+
+    std::string getSignature(const std::vector<size_t>& cone) const {
+        std::string signature;
+        for (auto pos : cone) {
+            signature += std::to_string(static_cast<int>(operations[pos])) + "(";
+            for (size_t in = inputBegin[pos]; in < inputBegin[pos + 1]; ++in) {
+                auto it = std::find(cone.begin(), cone.end(), inputs[in]);
+                signature += it == cone.end() ? "x" : "c" + std::to_string(std::distance(cone.begin(), it));
+                signature += in + 1 < inputBegin[pos + 1] ? "," : "";
+            }
+            signature += ");";
+        }
+        return signature;
+    }
+};
+
+/*
+ * Searches for a path that leaves the embedding and enters it again. Nodes after the last member in topological order cannot
+ * lead back into the embedding, except through the calls of embeddings replaced before: a call uses the inputs and feeds the users
+ * of all of its former members, so the bound is extended over every replaced embedding it overlaps with. Calls are placed
+ * at the position of their first former member.
+ */
+bool isLegalEmbedding(const std::vector<uint64_t>& embedding, std::unordered_map<uint64_t, std::unordered_set<uint64_t>>& successors,
+                      const std::unordered_map<uint64_t, size_t>& positions, const std::map<size_t, size_t>& replacedIntervals) {
+    std::unordered_set<uint64_t> members(embedding.begin(), embedding.end());
+    size_t bound = 0;
+    for (auto member : embedding) {
+        bound = std::max(bound, positions.at(member));
+    }
+    for (auto interval = replacedIntervals.begin(); interval != replacedIntervals.end() && interval->first <= bound; ++interval) {
+        bound = std::max(bound, interval->second);
+    }
+    std::vector<uint64_t> stack;
+    std::unordered_set<uint64_t> visited;
+    auto visit = [&](uint64_t node) {
+        if (positions.at(node) <= bound && visited.insert(node).second) {
+            stack.push_back(node);
+        }
+    };
+    for (auto member : embedding) {
+        for (auto successor : successors[member]) {
+            if (!members.contains(successor)) {
+                visit(successor);
+            }
+        }
+    }
+    // the call would depend on its own output if a path leaves the embedding and enters it again
+    while (!stack.empty()) {
+        auto current = stack.back();
+        stack.pop_back();
+        for (auto successor : successors[current]) {
+            if (members.contains(successor)) {
+                return false;
+            }
+            visit(successor);
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+FrequentSubcircuitMiningResult mineFrequentSubcircuits(const core::CircuitReadOnly& circuit, const FrequentSubcircuitOptions& options) {
+    FrequentSubcircuitMiningResult result;
+    CircuitGraph graph(circuit);
+    const size_t minSize = std::max<size_t>(options.minPatternSize, 2);
+    const size_t maxSize = std::max(options.maxPatternSize, minSize);
+
+    // 1. collect all cones by their signature, an embedding is stored as its root and size
+    std::unordered_map<std::string, std::vector<std::pair<size_t, size_t>>> conesBySignature;
+    for (size_t root = 0; root < graph.size(); ++root) {
+        if (root % 64 == 0 && shouldStop(options)) {
+            result.completed = false;
+            break;
+        }
+        if (!graph.minable[root]) {
+            continue;
+        }
+        graph.growCone(root, minSize, maxSize, [&](const std::vector<size_t>& cone) {
+            conesBySignature[graph.getSignature(cone)].emplace_back(root, cone.size());
+        });
+    }
+
+    // 2. count non-overlapping embeddings of every pattern
+    auto getEmbedding = [&](size_t root, size_t size) {
+        std::vector<size_t> embedding;
+        graph.growCone(root, size, size, [&](const std::vector<size_t>& cone) { embedding = cone; });
+        return embedding;
+    };
+    std::vector<std::pair<std::string, std::vector<std::vector<size_t>>>> candidates;
+    for (const auto& [signature, cones] : conesBySignature) {
+        if (cones.size() < options.frequencyThreshold) {
+            continue;
+        }
+        std::unordered_set<size_t> used;
+        std::vector<std::vector<size_t>> embeddings;
+        for (auto [root, size] : cones) {
+            auto embedding = getEmbedding(root, size);
+            if (std::none_of(embedding.begin(), embedding.end(), [&](size_t pos) { return used.contains(pos); })) {
+                used.insert(embedding.begin(), embedding.end());
+                embeddings.push_back(std::move(embedding));
+            }
+        }
+        if (embeddings.size() >= options.frequencyThreshold) {
+            candidates.emplace_back(signature, std::move(embeddings));
+        }
+    }
+
+    // 3. prefer patterns that save the most nodes and keep the patterns disjoint
+    auto savedNodes = [](const std::vector<std::vector<size_t>>& embeddings) { return (embeddings[0].size() - 1) * embeddings.size(); };
+    std::sort(candidates.begin(), candidates.end(), [&](const auto& lhs, const auto& rhs) {
+        auto lhsSaved = savedNodes(lhs.second);
+        auto rhsSaved = savedNodes(rhs.second);
+        return lhsSaved != rhsSaved ? lhsSaved > rhsSaved : lhs.first < rhs.first;
+    });
+    std::vector<bool> used(graph.size(), false);
+    for (auto& [signature, embeddings] : candidates) {
+        FrequentSubcircuit pattern;
+        pattern.signature = signature;
+        pattern.numberOfNodes = embeddings[0].size();
+        std::vector<const std::vector<size_t>*> accepted;
+        for (const auto& embedding : embeddings) {
+            if (std::any_of(embedding.begin(), embedding.end(), [&](size_t pos) { return used[pos]; })) {
+                continue;
+            }
+            std::vector<uint64_t> nodeIDs;
+            for (auto pos : embedding) {
+                nodeIDs.push_back(graph.ids[pos]);
+            }
+            pattern.embeddings.push_back(std::move(nodeIDs));
+            accepted.push_back(&embedding);
+        }
+        if (pattern.embeddings.size() >= options.frequencyThreshold) {
+            for (const auto* embedding : accepted) {
+                for (auto pos : *embedding) {
+                    used[pos] = true;
+                }
+            }
+            result.patterns.push_back(std::move(pattern));
+        }
+    }
+    return result;
+}
+
+FrequentSubcircuitReplacementResult replaceFrequentSubcircuitsInMemory(core::CircuitContext& circuitContext, const FrequentSubcircuitOptions& options) {
+    FrequentSubcircuitReplacementResult result;
+    auto circuit = circuitContext.getMutableCircuitWrapper();
+    auto mined = mineFrequentSubcircuits(circuit, options);
+    result.completed = mined.completed;
+
+    frontend::ModuleBuilder moduleBuilder;
+    auto successors = getNodeSuccessors(circuit);
+    std::unordered_map<uint64_t, size_t> positions;
+    std::unordered_map<uint64_t, core::NodeObjectWrapper> nodes;
+    for (auto node : circuit) {
+        positions[node.getNodeID()] = positions.size();
+        nodes.emplace(node.getNodeID(), node);
+    }
+    // first and last position of the former members of every call
+    std::map<size_t, size_t> replacedIntervals;
+
+    const size_t numberOfPatterns = std::min(options.maxPatterns, mined.patterns.size());
+    for (size_t patternIndex = 0; patternIndex < numberOfPatterns && result.completed; ++patternIndex) {
+        const auto& pattern = mined.patterns[patternIndex];
+        const auto& first = pattern.embeddings.front();
+        const size_t k = first.size();
+
+        // create the pattern nodes in topological order, every external input gets its own subcircuit input
+        std::vector<size_t> creationOrder(k);
+        std::iota(creationOrder.begin(), creationOrder.end(), 0);
+        std::sort(creationOrder.begin(), creationOrder.end(), [&](size_t lhs, size_t rhs) { return positions.at(first[lhs]) < positions.at(first[rhs]); });
+
+        frontend::CircuitBuilder circuitBuilder(std::to_string(first[0]));
+        auto dummyType = circuitBuilder.addDataType(core::ir::PrimitiveType::Bool, core::ir::SecurityLevel::Plaintext);
+        std::vector<uint64_t> created(k);
+        std::vector<uint64_t> subcircuitInputs;
+        for (auto index : creationOrder) {
+            const auto& node = nodes.at(first[index]);
+            std::vector<uint64_t> inputs;
+            for (auto inputID : node.getInputNodeIDs()) {
+                auto member = std::find(first.begin(), first.end(), inputID);
+                if (member != first.end()) {
+                    inputs.push_back(created[std::distance(first.begin(), member)]);
+                } else {
+                    subcircuitInputs.push_back(circuitBuilder.addInputNode({dummyType}));
+                    inputs.push_back(subcircuitInputs.back());
+                }
+            }
+            created[index] = circuitBuilder.addNode(node.getOperation(), inputs);
+        }
+        std::vector<uint64_t> subcircuitOutputs;
+        for (size_t index = 0; index < k; ++index) {
+            subcircuitOutputs.push_back(circuitBuilder.addOutputNode({dummyType}, {created[index]}));
+        }
+        circuitBuilder.finish();
+        core::CircuitContext subcircuit(circuitBuilder);
+        auto subcircuitReadOnly = subcircuit.getReadOnlyCircuit();
+
+        FrequentSubcircuit replaced;
+        replaced.signature = pattern.signature;
+        replaced.numberOfNodes = k;
+        for (auto embedding : pattern.embeddings) {
+            if (shouldStop(options)) {
+                result.completed = false;
+                break;
+            }
+            if (!isLegalEmbedding(embedding, successors, positions, replacedIntervals)) {
+                continue;
+            }
+            std::unordered_set<uint64_t> members(embedding.begin(), embedding.end());
+
+            // map inputs and outputs of the subcircuit to the nodes of this embedding
+            std::unordered_map<uint64_t, uint64_t> inputMapping;
+            std::unordered_set<uint64_t> externalInputs;
+            size_t inputCounter = 0;
+            for (auto index : creationOrder) {
+                for (auto inputID : nodes.at(embedding[index]).getInputNodeIDs()) {
+                    if (!members.contains(inputID)) {
+                        inputMapping[subcircuitInputs[inputCounter++]] = inputID;
+                        externalInputs.insert(inputID);
+                    }
+                }
+            }
+            std::unordered_map<uint64_t, std::vector<uint64_t>> outputMapping;
+            std::unordered_map<uint64_t, uint64_t> replacedNodeMapping;
+            std::unordered_set<uint64_t> users;
+            for (size_t index = 0; index < k; ++index) {
+                replacedNodeMapping[subcircuitOutputs[index]] = embedding[index];
+                for (auto successor : successors[embedding[index]]) {
+                    if (!members.contains(successor)) {
+                        outputMapping[subcircuitOutputs[index]].push_back(successor);
+                        users.insert(successor);
+                    }
+                }
+            }
+
+            uint64_t callID = circuit.replaceNodesBySubcircuit(*subcircuitReadOnly, embedding, inputMapping, outputMapping, replacedNodeMapping);
+
+            // keep the successors up to date for the legality checks of the following embeddings
+            for (auto inputID : externalInputs) {
+                for (auto member : embedding) {
+                    successors[inputID].erase(member);
+                }
+                successors[inputID].insert(callID);
+            }
+            for (auto member : embedding) {
+                successors.erase(member);
+                nodes.erase(member);
+            }
+            successors[callID] = std::move(users);
+            size_t firstMember = positions.at(embedding.front());
+            size_t lastMember = firstMember;
+            for (auto member : embedding) {
+                firstMember = std::min(firstMember, positions.at(member));
+                lastMember = std::max(lastMember, positions.at(member));
+            }
+            replacedIntervals.emplace(firstMember, lastMember);
+            positions[callID] = firstMember;
+            replaced.embeddings.push_back(std::move(embedding));
+        }
+
+        if (!replaced.embeddings.empty()) {
+            moduleBuilder.addSerializedCircuit(subcircuit.getBufferPointer(), subcircuit.getBufferSize());
+            result.replacedPatterns.push_back(std::move(replaced));
+        }
+    }
+
+    circuitContext.packCircuit();
+    moduleBuilder.addSerializedCircuit(circuitContext.getBufferPointer(), circuitContext.getBufferSize());
+    moduleBuilder.setEntryCircuitName(circuitContext.getReadOnlyCircuit()->getName());
+    result.module = core::ModuleContext(moduleBuilder);
+    return result;
+}
+
+}  // namespace fuse::passes
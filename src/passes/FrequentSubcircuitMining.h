@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_FREQUENTSUBCIRCUITMINING_H
+#define FUSE_FREQUENTSUBCIRCUITMINING_H
+
+#include <chrono>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+struct FrequentSubcircuitOptions {
+    // minimal number of non-overlapping embeddings of a pattern
+    size_t frequencyThreshold = 3;
+    // minimal and maximal number of nodes inside a pattern
+    size_t minPatternSize = 2;
+    size_t maxPatternSize = 6;
+    // number of patterns that are replaced, the patterns that save the most nodes are chosen first
+    size_t maxPatterns = 1;
+    // mining and replacement stop cooperatively at the deadline or if a stop is requested
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    std::stop_token stopToken;
+};
+
+struct FrequentSubcircuit {
+    // canonical description of the pattern: for each pattern node its operation and its inputs,
+    // which are either other pattern nodes (by their index) or external inputs
+    std::string signature;
+    size_t numberOfNodes = 0;
+    // non-overlapping embeddings, each with the circuit's node IDs in the order of the pattern nodes
+    std::vector<std::vector<uint64_t>> embeddings;
+};
+
+struct FrequentSubcircuitMiningResult {
+    std::vector<FrequentSubcircuit> patterns;
+    // false if mining stopped early because of the deadline or a stop request
+    bool completed = true;
+};
+
+struct FrequentSubcircuitReplacementResult {
+    core::ModuleContext module;
+    // the embeddings that were actually replaced by calls
+    std::vector<FrequentSubcircuit> replacedPatterns;
+    bool completed = true;
+};
+
+/**
+ * @brief Mines frequent subcircuits in process, without intermediate files or child processes.
+ *
+ * Patterns are connected parts of the fan-in cone of a root node, grown breadth-first along the inputs of the root.
+ * Inputs, outputs, constants, calls and nodes that read specific outputs of other nodes are not part of patterns.
+ * Only local state is used, so the function can be called concurrently for different circuits.
+ *
+ * @return the patterns sorted by the number of nodes they save, with at least options.frequencyThreshold embeddings each
+ */
+FrequentSubcircuitMiningResult mineFrequentSubcircuits(const core::CircuitReadOnly& circuit, const FrequentSubcircuitOptions& options = {});
+
+/**
+ * @brief Replaces the embeddings of the mined patterns by calls to a new subcircuit per pattern.
+ * Embeddings that would make a call depend on its own outputs are skipped.
+ *
+ * @return a module with the modified circuit as entry circuit and the pattern subcircuits
+ */
+FrequentSubcircuitReplacementResult replaceFrequentSubcircuitsInMemory(core::CircuitContext& circuitContext, const FrequentSubcircuitOptions& options = {});
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_FREQUENTSUBCIRCUITMINING_H */
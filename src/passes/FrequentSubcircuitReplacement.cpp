@@ -252,43 +252,48 @@ fuse::core::ModuleContext replaceFrequentSubcircuits(core::CircuitContext &circu
 
     // 4. apply Glasgow Subgraph Solver for each frequent pattern and replace
 
-    // read frequent subgraphs one by one
+    // translate all frequent subgraphs to Glasgow patterns
     std::ifstream inf(output_filename + "_opt", std::ios::in);
     std::string cur_line;
-    int pattern_ctr = 1;
-    std::set<uint64_t> already_replaced;
-
+    std::vector<std::string> pattern_files;
     while (std::getline(inf, cur_line)) {
-
-        // read Distgraph Pattern and translate
         if (cur_line.empty()) {
             break;
         }
-        std::string pattern_file = output_dir + "pattern" + std::to_string(ctr) + ".csv";
+        std::string pattern_file = output_dir + "pattern" + std::to_string(ctr) + "_" + std::to_string(pattern_files.size()) + ".csv";
         std::ofstream of(pattern_file, std::ios::trunc);
         of << fuse::backend::translateDistgraphToGlasgow(cur_line);
         of.flush();
         of.close();
+        pattern_files.push_back(pattern_file);
+    }
 
-        // apply Glasgow Solver for pattern
-        boost::multiprecision::cpp_int count_glasgow = fuse::backend::glasglowSubgraphFinding(output_dir, ctr, glasgow_graph, pattern_file);
+    // search the embeddings of all patterns in parallel, the replacement below stays sequential in pattern order
+    std::vector<boost::multiprecision::cpp_int> counts_glasgow = fuse::backend::glasgowParallelSubgraphFinding(output_dir, ctr, glasgow_graph, pattern_files);
+
+    int pattern_ctr = 1;
+    std::set<uint64_t> already_replaced;
+
+    for (size_t pattern_index = 0; pattern_index < pattern_files.size(); ++pattern_index) {
+        boost::multiprecision::cpp_int count_glasgow = counts_glasgow[pattern_index];
 
         // apply node successor analysis and get node depths
         std::unordered_map<uint64_t, std::unordered_set<uint64_t>> nodeSuccessors = fuse::passes::getNodeSuccessors(circuit);
         std::unordered_map<uint64_t, uint64_t> nodeDepth = fuse::passes::getNodeDepths(circuit);
 
         // create subgraph 
-        output_filename = output_dir + "mappings" + std::to_string(ctr);
+        output_filename = output_dir + "mappings" + std::to_string(ctr) + "_" + std::to_string(pattern_index);
         std::map<uint64_t, std::vector<uint64_t>> subgraph_input;
         std::map<uint64_t, fuse::frontend::Identifier> subgraph_output;
         std::map<uint64_t, bool> is_input;
         std::vector<uint64_t> first_embedding = find_first_valid_embedding(already_replaced, output_filename, nodeSuccessors, nodeDepth);
 
-        // optimization: no applicable embedding 
+        // no applicable embedding left, later patterns may still have some as their embeddings were already searched
         if (first_embedding.empty()){
             // update report
-            report << "Not a single valid embedding for pattern " << pattern_ctr << "/" << count_patterns << std::endl << std::endl;;
-            break;
+            report << "Not a single valid embedding for pattern " << pattern_ctr << "/" << count_patterns << std::endl << std::endl;
+            pattern_ctr++;
+            continue;
         }
 
         core::CircuitContext subcircuit = create_circuit_to_call(circuit, first_embedding, nodeSuccessors, subgraph_input, subgraph_output);
@@ -308,7 +313,7 @@ fuse::core::ModuleContext replaceFrequentSubcircuits(core::CircuitContext &circu
         report << "Filtered embeddings " << count_embeddings << "/" << count_glasgow << std::endl;
 
         // read filtered output
-        output_filename = output_dir + "mappings" + std::to_string(ctr) + "_opt";
+        output_filename = output_dir + "mappings" + std::to_string(ctr) + "_" + std::to_string(pattern_index) + "_opt";
         std::ifstream inf_mapping(output_filename, std::ios::in);
 
         std::string cur_mapping;
@@ -31,7 +31,7 @@
 
 namespace fuse::passes {
 
-void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::PrimitiveOperation operationType, int minGates, int maxDistance, bool multi) {
+void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::PrimitiveOperation operationType, int minGates, int maxDistance, bool multi, bool batched) {
     // prepare tmp folder
     namespace fs = std::filesystem;
     const std::string output_dir = "../../tmp/";
@@ -68,13 +68,16 @@ void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::Primit
 
     // remove all but the gates of the specific type
     std::map<uint64_t, std::vector<uint64_t>> depthToNode;
-    for (auto nodePair : instructionDepth) {
-        auto curNode = circuit.getNodeWithID(nodePair.first);
-        if (curNode.getOperation() == operationType) {
-            depthToNode[nodePair.second].push_back(nodePair.first);
+    for (auto curNode : circuit) {
+        auto nodeDepth = instructionDepth.find(curNode.getNodeID());
+        if (curNode.getOperation() == operationType && nodeDepth != instructionDepth.end()) {
+            depthToNode[nodeDepth->second].push_back(curNode.getNodeID());
         }
     }
 
+    // in batched mode, all groups are collected first and replaced in a single sweep
+    std::vector<std::vector<uint64_t>> simdGroups;
+
     int ctr = 1;
     for (auto depthPair : depthToNode) {
         int size = depthPair.second.size();
@@ -108,7 +111,11 @@ void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::Primit
 
             int new_size = final_vec.size();
             if (new_size >= minGates) {
-                circuit.replaceNodesBySIMDNode(final_vec);
+                if (batched) {
+                    simdGroups.push_back(std::move(final_vec));
+                } else {
+                    circuit.replaceNodesBySIMDNode(final_vec);
+                }
                 // std::string deb = fuse::backend::generateDotCodeFrom(circuit);
                 replaced_calls++;
                 replaced = replaced + new_size;
@@ -117,6 +124,9 @@ void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::Primit
         }
     }
 
+    if (batched && !simdGroups.empty()) {
+        circuit.replaceNodesBySIMDNodes(simdGroups);
+    }
 
     report << "\n"
            << "Circuit size after vec: " << circuit.getNumberOfNodes() << std::endl;
@@ -125,7 +135,7 @@ void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::Primit
            << std::endl;
 }
 
-void vectorizeAllInstructions(core::CircuitObjectWrapper& circuit, int minGates, int maxDistance) {
+void vectorizeAllInstructions(core::CircuitObjectWrapper& circuit, int minGates, int maxDistance, bool batched) {
     // prepare tmp folder
     namespace fs = std::filesystem;
     const std::string output_dir = "../../tmp/";
@@ -138,7 +148,7 @@ void vectorizeAllInstructions(core::CircuitObjectWrapper& circuit, int minGates,
     for (auto instructionType = static_cast<int>(core::ir::PrimitiveOperation::MIN); instructionType != static_cast<int>(core::ir::PrimitiveOperation::MAX); instructionType++) {
         auto cur_type = static_cast<core::ir::PrimitiveOperation>(instructionType);
         if (cur_type != core::ir::PrimitiveOperation::Input && cur_type != core::ir::PrimitiveOperation::Output) {
-            vectorizeInstructions(circuit, cur_type, minGates, maxDistance, true);
+            vectorizeInstructions(circuit, cur_type, minGates, maxDistance, true, batched);
         }
     }
 }
@@ -27,9 +27,15 @@
 
 namespace fuse::passes {
 
-void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::PrimitiveOperation operationType, int minGates = 2, int maxDistance = 100, bool multi=false);
+/**
+ * @brief Replaces nodes of the given operation that are on the same instruction depth by SIMD nodes.
+ *
+ * @param batched if true, all groups are selected first and replaced in a single rewrite of the circuit
+ * instead of rewriting the whole circuit once per group, which is much faster for large circuits.
+ */
+void vectorizeInstructions(core::CircuitObjectWrapper& circuit, core::ir::PrimitiveOperation operationType, int minGates = 2, int maxDistance = 100, bool multi=false, bool batched=false);
 
-void vectorizeAllInstructions(core::CircuitObjectWrapper& circuit, int minGates = 2, int maxDistance = 100);
+void vectorizeAllInstructions(core::CircuitObjectWrapper& circuit, int minGates = 2, int maxDistance = 100, bool batched=false);
 
 }  // namespace fuse::passes
 
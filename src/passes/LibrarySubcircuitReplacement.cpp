@@ -0,0 +1,624 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LibrarySubcircuitReplacement.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "ParallelPasses.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using Offset = uint32_t;
+using Value = std::pair<Identifier, Offset>;
+using op = core::ir::PrimitiveOperation;
+
+constexpr size_t kUnmatched = std::numeric_limits<size_t>::max();
+
+bool isCommutative(op operation) {
+    switch (operation) {
+        case op::And:
+        case op::Xor:
+        case op::Or:
+        case op::Nand:
+        case op::Nor:
+        case op::Xnor:
+        case op::Add:
+        case op::Mul:
+        case op::Eq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// everything besides the operation that two nodes have to agree on
+std::string getLabel(const core::NodeReadOnly& node) {
+    if (node.isNodeWithCustomOp()) {
+        return node.getCustomOperationName();
+    }
+    if (node.isSubcircuitNode() || node.isLoopNode()) {
+        return node.getSubCircuitName();
+    }
+    if (node.isConstantNode()) {
+        return core::ir::EnumNamePrimitiveType(node.getConstantType()->getPrimitiveType()) + std::string(":") + node.getConstantFlexbuffer().ToString();
+    }
+    return "";
+}
+
+// the type of a value, pattern and target values have to agree on it
+struct ValueType {
+    core::ir::PrimitiveType primitiveType;
+    std::vector<int64_t> shape;
+    core::ir::SecurityLevel securityLevel;
+
+    bool operator==(const ValueType& other) const = default;
+};
+
+ValueType toValueType(const core::DataTypeReadOnly& dataType) {
+    auto shape = dataType.getShape();
+    return {dataType.getPrimitiveType(), {shape.begin(), shape.end()}, dataType.getSecurityLevel()};
+}
+
+/*
+ * Compressed adjacency of a circuit in topological order: the inputs of the node at index i
+ * are inputs[inputOffsets[i]] up to inputs[inputOffsets[i + 1]], its distinct users are stored likewise.
+ * The graph is a copy, so it stays valid when the circuit is unpacked or modified afterwards.
+ */
+struct CircuitGraph {
+    std::vector<Identifier> nodeIDs;
+    std::vector<op> operations;
+    std::vector<std::string> labels;
+    std::vector<uint32_t> numberOfOutputs;
+    // the type of every output of a node, if it is declared or can be inferred from its first input
+    std::vector<std::vector<std::optional<ValueType>>> valueTypes;
+    std::vector<size_t> inputOffsets{0};
+    std::vector<std::pair<size_t, Offset>> inputs;
+    std::vector<size_t> userOffsets{0};
+    std::vector<size_t> users;
+    // indices of the input and output nodes in the order of the circuit's interface
+    std::vector<size_t> inputNodes;
+    std::vector<size_t> outputNodes;
+
+    explicit CircuitGraph(const core::CircuitReadOnly& circuit) {
+        std::unordered_map<Identifier, size_t> indices;
+        std::vector<std::vector<size_t>> userLists;
+        circuit.topologicalTraversal([&](core::NodeReadOnly& node) {
+            const size_t index = nodeIDs.size();
+            indices.emplace(node.getNodeID(), index);
+            nodeIDs.push_back(node.getNodeID());
+            operations.push_back(node.getOperation());
+            labels.push_back(getLabel(node));
+            numberOfOutputs.push_back(node.getNumberOfOutputs());
+            userLists.emplace_back();
+            auto ids = node.getInputNodeIDs();
+            auto offsets = node.getInputOffsets();
+            valueTypes.push_back(inferValueTypes(node, ids.empty() ? std::nullopt : getValueType(indices.at(ids[0]), node.usesInputOffsets() ? offsets[0] : 0)));
+            for (size_t i = 0; i < ids.size(); ++i) {
+                const size_t input = indices.at(ids[i]);
+                inputs.emplace_back(input, node.usesInputOffsets() ? offsets[i] : 0);
+                if (userLists[input].empty() || userLists[input].back() != index) {
+                    userLists[input].push_back(index);
+                }
+            }
+            inputOffsets.push_back(inputs.size());
+        });
+        for (const auto& list : userLists) {
+            users.insert(users.end(), list.begin(), list.end());
+            userOffsets.push_back(users.size());
+        }
+        for (auto input : circuit.getInputNodeIDs()) {
+            inputNodes.push_back(indices.at(input));
+        }
+        for (auto output : circuit.getOutputNodeIDs()) {
+            outputNodes.push_back(indices.at(output));
+        }
+    }
+
+    size_t size() const { return nodeIDs.size(); }
+
+    std::optional<ValueType> getValueType(size_t index, Offset offset) const {
+        return offset < valueTypes[index].size() ? valueTypes[index][offset] : std::nullopt;
+    }
+
+    std::span<const std::pair<size_t, Offset>> getInputs(size_t index) const {
+        return {inputs.data() + inputOffsets[index], inputs.data() + inputOffsets[index + 1]};
+    }
+
+    std::span<const size_t> getUsers(size_t index) const { return {users.data() + userOffsets[index], users.data() + userOffsets[index + 1]}; }
+
+    bool isInterfaceNode(size_t index) const { return operations[index] == op::Input || operations[index] == op::Output; }
+
+    bool matches(size_t index, const CircuitGraph& other, size_t otherIndex) const {
+        return operations[index] == other.operations[otherIndex] && labels[index] == other.labels[otherIndex] &&
+               numberOfOutputs[index] == other.numberOfOutputs[otherIndex] && valueTypes[index] == other.valueTypes[otherIndex] &&
+               getInputs(index).size() == other.getInputs(otherIndex).size();
+    }
+
+   private:
+    // gates without declared types compute values of the type of their first input, comparisons compute Booleans of that shape
+    static std::vector<std::optional<ValueType>> inferValueTypes(const core::NodeReadOnly& node, std::optional<ValueType> firstInputType) {
+        std::vector<std::optional<ValueType>> types;
+        for (const auto& dataType : node.getOutputDataTypes()) {
+            types.push_back(toValueType(*dataType));
+        }
+        if (!types.empty() || node.getOperation() == op::Split || node.getNumberOfOutputs() > 1) {
+            return types;
+        }
+        if (firstInputType && node.hasComparisonOperator()) {
+            firstInputType->primitiveType = core::ir::PrimitiveType::Bool;
+        }
+        types.push_back(firstInputType);
+        return types;
+    }
+};
+
+/*
+ * Backtracking subgraph matcher: pattern nodes are matched one after another in an order where every node is adjacent
+ * to an already matched one, so its candidates are read from the adjacency of the target instead of trying all nodes.
+ */
+class SubcircuitMatcher {
+   public:
+    SubcircuitMatcher(const CircuitGraph& pattern, const CircuitGraph& target) : pattern_(pattern), target_(target) {
+        patternInputs_ = pattern_.inputNodes;
+        isExported_.assign(pattern_.size(), false);
+        for (auto output : pattern_.outputNodes) {
+            const auto& value = pattern_.getInputs(output).front();
+            patternOutputs_.push_back(value);
+            isExported_[value.first] = true;
+        }
+        computeMatchingOrder();
+        matched_.assign(pattern_.size(), kUnmatched);
+        swapped_.assign(pattern_.size(), false);
+        bindings_.assign(pattern_.size(), std::nullopt);
+        isImage_.assign(target_.size(), false);
+        coveredBy_.assign(target_.size(), kUnmatched);
+    }
+
+    std::vector<Embedding> findAll() {
+        std::vector<Embedding> embeddings;
+        if (order_.empty()) {
+            return embeddings;
+        }
+        const size_t anchor = order_.front();
+        for (size_t candidate = 0; candidate < target_.size(); ++candidate) {
+            if (tryAll(anchor, candidate, 1)) {
+                embeddings.push_back(recordEmbedding());
+            }
+        }
+        return embeddings;
+    }
+
+   private:
+    const CircuitGraph& pattern_;
+    const CircuitGraph& target_;
+    std::vector<size_t> patternInputs_;
+    std::vector<std::pair<size_t, Offset>> patternOutputs_;
+    std::vector<bool> isExported_;
+    std::vector<size_t> order_;
+
+    std::vector<size_t> matched_;
+    std::vector<bool> swapped_;
+    std::vector<std::optional<std::pair<size_t, Offset>>> bindings_;
+    std::vector<bool> isImage_;
+    // the embedding found earlier that covers a target node, and the target nodes bound to the inputs of every embedding
+    std::vector<size_t> coveredBy_;
+    std::vector<std::vector<size_t>> embeddingInputs_;
+
+    bool isMatched(size_t patternNode) const { return !pattern_.isInterfaceNode(patternNode) && matched_[patternNode] != kUnmatched; }
+
+    // starts with the last node of the pattern, which typically computes an output, and prefers nodes read by matched nodes
+    void computeMatchingOrder() {
+        std::vector<size_t> internal;
+        for (size_t index = 0; index < pattern_.size(); ++index) {
+            if (!pattern_.isInterfaceNode(index)) {
+                internal.push_back(index);
+            }
+        }
+        if (internal.empty()) {
+            return;
+        }
+        std::vector<bool> isOrdered(pattern_.size(), false);
+        std::vector<bool> isBound(pattern_.size(), false);
+        auto append = [&](size_t index) {
+            order_.push_back(index);
+            isOrdered[index] = true;
+            for (const auto& [input, offset] : pattern_.getInputs(index)) {
+                isBound[input] = true;
+            }
+        };
+        append(internal.back());
+        while (order_.size() < internal.size()) {
+            size_t best = kUnmatched;
+            int bestRank = 4;
+            for (auto index : internal) {
+                if (isOrdered[index]) {
+                    continue;
+                }
+                int rank = 3;
+                for (auto user : pattern_.getUsers(index)) {
+                    rank = isOrdered[user] ? 0 : rank;
+                }
+                for (const auto& [input, offset] : pattern_.getInputs(index)) {
+                    if (isOrdered[input]) {
+                        rank = std::min(rank, 1);
+                    } else if (isBound[input]) {
+                        rank = std::min(rank, 2);
+                    }
+                }
+                if (rank < bestRank) {
+                    best = index;
+                    bestRank = rank;
+                }
+            }
+            append(best);
+        }
+    }
+
+    std::vector<size_t> getCandidates(size_t patternNode) const {
+        std::vector<size_t> candidates;
+        for (auto user : pattern_.getUsers(patternNode)) {
+            if (!isMatched(user)) {
+                continue;
+            }
+            auto patternInputs = pattern_.getInputs(user);
+            auto targetInputs = target_.getInputs(matched_[user]);
+            for (size_t i = 0; i < patternInputs.size(); ++i) {
+                if (patternInputs[i].first == patternNode) {
+                    candidates.push_back(targetInputs[swapped_[user] ? 1 - i : i].first);
+                }
+            }
+            return candidates;
+        }
+        for (const auto& [input, offset] : pattern_.getInputs(patternNode)) {
+            if (isMatched(input)) {
+                auto users = target_.getUsers(matched_[input]);
+                return {users.begin(), users.end()};
+            }
+        }
+        for (const auto& [input, offset] : pattern_.getInputs(patternNode)) {
+            if (bindings_[input]) {
+                auto users = target_.getUsers(bindings_[input]->first);
+                return {users.begin(), users.end()};
+            }
+        }
+        candidates.resize(target_.size());
+        for (size_t index = 0; index < candidates.size(); ++index) {
+            candidates[index] = index;
+        }
+        return candidates;
+    }
+
+    bool tryMatch(size_t patternNode, size_t targetNode, bool swap, std::vector<size_t>& newBindings) {
+        auto patternInputs = pattern_.getInputs(patternNode);
+        auto targetInputs = target_.getInputs(targetNode);
+        auto fail = [&]() {
+            for (auto input : newBindings) {
+                bindings_[input].reset();
+            }
+            newBindings.clear();
+            return false;
+        };
+        for (size_t i = 0; i < patternInputs.size(); ++i) {
+            const auto& [input, offset] = patternInputs[i];
+            const auto& value = targetInputs[swap ? 1 - i : i];
+            if (pattern_.operations[input] == op::Input) {
+                if (!bindings_[input]) {
+                    // inputs without a declared type accept values of any type
+                    auto inputType = pattern_.getValueType(input, offset);
+                    if (inputType && inputType != target_.getValueType(value.first, value.second)) {
+                        return fail();
+                    }
+                    bindings_[input] = value;
+                    newBindings.push_back(input);
+                } else if (*bindings_[input] != value) {
+                    return fail();
+                }
+            } else if (isMatched(input) && (matched_[input] != value.first || offset != value.second)) {
+                return fail();
+            }
+        }
+        // matched users have to read the target node wherever they read the pattern node
+        for (auto user : pattern_.getUsers(patternNode)) {
+            if (!isMatched(user)) {
+                continue;
+            }
+            auto userInputs = pattern_.getInputs(user);
+            auto targetUserInputs = target_.getInputs(matched_[user]);
+            for (size_t i = 0; i < userInputs.size(); ++i) {
+                const auto& value = targetUserInputs[swapped_[user] ? 1 - i : i];
+                if (userInputs[i].first == patternNode && (value.first != targetNode || value.second != userInputs[i].second)) {
+                    return fail();
+                }
+            }
+        }
+        matched_[patternNode] = targetNode;
+        swapped_[patternNode] = swap;
+        isImage_[targetNode] = true;
+        return true;
+    }
+
+    void undo(size_t patternNode, std::vector<size_t>& newBindings) {
+        isImage_[matched_[patternNode]] = false;
+        matched_[patternNode] = kUnmatched;
+        for (auto input : newBindings) {
+            bindings_[input].reset();
+        }
+        newBindings.clear();
+    }
+
+    // tries to match the pattern node to the target node and all remaining pattern nodes afterwards
+    bool tryAll(size_t patternNode, size_t targetNode, size_t nextStep) {
+        if (coveredBy_[targetNode] != kUnmatched || isImage_[targetNode] || !pattern_.matches(patternNode, target_, targetNode)) {
+            return false;
+        }
+        const bool commutative = isCommutative(pattern_.operations[patternNode]) && pattern_.getInputs(patternNode).size() == 2;
+        for (bool swap : {false, true}) {
+            if (swap && !commutative) {
+                break;
+            }
+            std::vector<size_t> newBindings;
+            if (!tryMatch(patternNode, targetNode, swap, newBindings)) {
+                continue;
+            }
+            if (match(nextStep)) {
+                return true;
+            }
+            undo(patternNode, newBindings);
+        }
+        return false;
+    }
+
+    bool match(size_t step) {
+        if (step == order_.size()) {
+            return isReplaceable();
+        }
+        const size_t patternNode = order_[step];
+        for (auto candidate : getCandidates(patternNode)) {
+            if (tryAll(patternNode, candidate, step + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // every input is bound, only the outputs of the pattern are used outside of the embedding, and no input depends on the embedding
+    bool isReplaceable() const {
+        for (auto input : patternInputs_) {
+            if (!bindings_[input]) {
+                return false;
+            }
+        }
+        if (dependsOnImage()) {
+            return false;
+        }
+        for (auto patternNode : order_) {
+            if (isExported_[patternNode]) {
+                continue;
+            }
+            for (auto user : target_.getUsers(matched_[patternNode])) {
+                if (!isImage_[user]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Searches backwards from the bound inputs for a path that leaves and re-enters the embedding, which would turn the call into a cycle.
+     * Embeddings found earlier are replaced by a single call as well, so their outputs depend on all of their inputs.
+     */
+    bool dependsOnImage() const {
+        size_t firstImageNode = target_.size();
+        for (auto patternNode : order_) {
+            firstImageNode = std::min(firstImageNode, matched_[patternNode]);
+        }
+        std::vector<bool> isVisited(target_.size(), false);
+        std::vector<bool> isExpanded(embeddingInputs_.size(), false);
+        std::vector<size_t> stack;
+        for (auto input : patternInputs_) {
+            stack.push_back(bindings_[input]->first);
+        }
+        while (!stack.empty()) {
+            const size_t node = stack.back();
+            stack.pop_back();
+            if (isVisited[node]) {
+                continue;
+            }
+            isVisited[node] = true;
+            if (isImage_[node]) {
+                return true;
+            }
+            if (const size_t embedding = coveredBy_[node]; embedding != kUnmatched) {
+                if (!isExpanded[embedding]) {
+                    isExpanded[embedding] = true;
+                    stack.insert(stack.end(), embeddingInputs_[embedding].begin(), embeddingInputs_[embedding].end());
+                }
+            } else if (node < firstImageNode) {
+                // nodes before the embedding in topological order cannot depend on it
+                continue;
+            }
+            for (const auto& [input, offset] : target_.getInputs(node)) {
+                stack.push_back(input);
+            }
+        }
+        return false;
+    }
+
+    Embedding recordEmbedding() {
+        Embedding embedding;
+        auto toValue = [&](const std::pair<size_t, Offset>& value) { return Value{target_.nodeIDs[value.first], value.second}; };
+        for (auto patternNode : order_) {
+            embedding.nodes.emplace(pattern_.nodeIDs[patternNode], target_.nodeIDs[matched_[patternNode]]);
+        }
+        for (auto input : patternInputs_) {
+            embedding.inputs.push_back(toValue(*bindings_[input]));
+        }
+        for (const auto& [node, offset] : patternOutputs_) {
+            embedding.outputs.push_back(pattern_.operations[node] == op::Input ? toValue(*bindings_[node]) : Value{target_.nodeIDs[matched_[node]], offset});
+        }
+        embeddingInputs_.emplace_back();
+        for (auto input : patternInputs_) {
+            embeddingInputs_.back().push_back(bindings_[input]->first);
+        }
+        for (auto patternNode : order_) {
+            coveredBy_[matched_[patternNode]] = embeddingInputs_.size() - 1;
+            isImage_[matched_[patternNode]] = false;
+            matched_[patternNode] = kUnmatched;
+        }
+        std::fill(bindings_.begin(), bindings_.end(), std::nullopt);
+        return embedding;
+    }
+};
+
+std::vector<Embedding> findEmbeddings(const CircuitGraph& pattern, const core::CircuitReadOnly& target) {
+    const CircuitGraph targetGraph(target);
+    return SubcircuitMatcher(pattern, targetGraph).findAll();
+}
+
+void replaceEmbeddings(core::CircuitObjectWrapper& circuit, const std::vector<Embedding>& embeddings, const std::string& implementation,
+                       std::unordered_map<uint64_t, core::CircuitObjectWrapper>* callsToInline, core::ModuleObjectWrapper& module) {
+    std::map<Value, Value> replacements;
+    std::unordered_set<Identifier> replacedNodes;
+    std::vector<Identifier> callIDs;
+    for (const auto& embedding : embeddings) {
+        auto call = circuit.addNode();
+        call.setPrimitiveOperation(op::CallSubcircuit);
+        call.setSubCircuitName(implementation);
+        call.setNumberOfOutputs(embedding.outputs.size());
+        callIDs.push_back(call.getNodeID());
+        std::unordered_set<Identifier> image;
+        for (const auto& [patternNode, targetNode] : embedding.nodes) {
+            image.insert(targetNode);
+        }
+        for (size_t output = 0; output < embedding.outputs.size(); ++output) {
+            // outputs that pass an input through keep being read from the input
+            if (image.contains(embedding.outputs[output].first)) {
+                replacements.emplace(embedding.outputs[output], Value{call.getNodeID(), output});
+            }
+        }
+        replacedNodes.insert(image.begin(), image.end());
+        if (callsToInline != nullptr) {
+            callsToInline->emplace(call.getNodeID(), module.getCircuitWithName(implementation));
+        }
+    }
+
+    auto replace = [&](const Value& value) {
+        auto replacement = replacements.find(value);
+        return replacement == replacements.end() ? value : replacement->second;
+    };
+    // inputs of an embedding may be computed by another one
+    for (size_t i = 0; i < embeddings.size(); ++i) {
+        std::vector<Identifier> ids;
+        std::vector<Offset> offsets;
+        for (const auto& input : embeddings[i].inputs) {
+            auto value = replace(input);
+            ids.push_back(value.first);
+            offsets.push_back(value.second);
+        }
+        auto call = circuit.getNodeWithID(callIDs[i]);
+        call.setInputNodeIDs(ids);
+        call.setInputOffsets(offsets);
+    }
+    for (auto node : circuit) {
+        if (replacedNodes.contains(node.getNodeID()) || std::find(callIDs.begin(), callIDs.end(), node.getNodeID()) != callIDs.end()) {
+            continue;
+        }
+        auto ids = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        std::vector<Identifier> newIDs(ids.begin(), ids.end());
+        std::vector<Offset> newOffsets(ids.size(), 0);
+        bool replaced = false;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            auto value = replace({ids[i], offsets.empty() ? 0 : offsets[i]});
+            replaced |= value.first != ids[i];
+            newIDs[i] = value.first;
+            newOffsets[i] = value.second;
+        }
+        if (replaced) {
+            node.setInputNodeIDs(newIDs);
+            node.setInputOffsets(newOffsets);
+        }
+    }
+    circuit.removeNodes(replacedNodes);
+    // the calls have been added at the end
+    circuit.restoreTopologicalOrder();
+}
+
+}  // namespace
+
+std::vector<Embedding> findEmbeddings(const core::CircuitReadOnly& pattern, const core::CircuitReadOnly& target) {
+    const CircuitGraph patternGraph(pattern);
+    return findEmbeddings(patternGraph, target);
+}
+
+size_t replaceLibrarySubcircuit(core::ModuleObjectWrapper& module, const core::CircuitReadOnly& pattern, const std::string& implementation,
+                                bool inlineImplementation, size_t numberOfThreads) {
+    auto names = module.getAllCircuitNames();
+    if (std::find(names.begin(), names.end(), implementation) == names.end()) {
+        throw std::logic_error("Library implementation not found in module: " + implementation);
+    }
+    {
+        auto circuit = std::as_const(module).getCircuitWithName(implementation);
+        if (circuit->getNumberOfInputs() != pattern.getNumberOfInputs() || circuit->getNumberOfOutputs() != pattern.getNumberOfOutputs()) {
+            throw std::logic_error("Library implementation " + implementation + " does not have the interface of pattern " + pattern.getName());
+        }
+    }
+
+    // the pattern may be a packed circuit of the module, which is invalidated when runOnAllCircuits unpacks the module
+    const CircuitGraph patternGraph(pattern);
+    const auto patternName = pattern.getName();
+    std::atomic<size_t> numberOfReplacements = 0;
+    runOnAllCircuits(
+        module,
+        [&](core::CircuitObjectWrapper& circuit) {
+            const auto name = circuit.getName();
+            if (name == implementation || name == patternName) {
+                return;
+            }
+            auto embeddings = findEmbeddings(patternGraph, circuit);
+            if (embeddings.empty()) {
+                return;
+            }
+            std::unordered_map<uint64_t, core::CircuitObjectWrapper> callsToInline;
+            replaceEmbeddings(circuit, embeddings, implementation, inlineImplementation ? &callsToInline : nullptr, module);
+            if (inlineImplementation) {
+                circuit.inlineCalls(callsToInline);
+            }
+            numberOfReplacements += embeddings.size();
+        },
+        numberOfThreads);
+    return numberOfReplacements;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_LIBRARYSUBCIRCUITREPLACEMENT_H
+#define FUSE_LIBRARYSUBCIRCUITREPLACEMENT_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief An occurrence of a pattern circuit in a target circuit.
+ */
+struct Embedding {
+    /// the target node for every node of the pattern that is neither an input nor an output
+    std::unordered_map<uint64_t, uint64_t> nodes;
+    /// the target value (node ID and output offset) bound to every input of the pattern, in the order of the pattern's inputs
+    std::vector<std::pair<uint64_t, uint32_t>> inputs;
+    /// the target value computed for every output of the pattern, in the order of the pattern's outputs
+    std::vector<std::pair<uint64_t, uint32_t>> outputs;
+};
+
+/**
+ * @brief Finds non-overlapping embeddings of the pattern in the target circuit.
+ *
+ * A target node matches a pattern node if both have the same operation (custom operation, callee or constant value),
+ * the same number and types of outputs and corresponding inputs; the operands of commutative binary operations may be swapped.
+ * Output types that are not declared are inferred from the first input, so a pattern for 8-bit values does not match 32-bit gates.
+ * Pattern inputs may be bound to arbitrary target values of their declared type. Values computed inside an embedding may only be used
+ * outside of it if the pattern outputs them, so the embedding can be replaced as a whole.
+ * Embeddings are searched greedily in the order of the target circuit.
+ */
+std::vector<Embedding> findEmbeddings(const core::CircuitReadOnly& pattern, const core::CircuitReadOnly& target);
+
+/**
+ * @brief Replaces every embedding of the pattern (see findEmbeddings) in all circuits of the module by a call to the
+ * implementation, e.g. to substitute hand-optimized adders, comparators or S-boxes for the textbook versions emitted by frontends.
+ * If inlineImplementation is set, the calls are inlined afterwards, so the module contains copies of the implementation instead.
+ * The pattern may belong to another module; if it is part of this module, it is left unchanged like the implementation.
+ * Circuits are processed on up to numberOfThreads threads at once (all hardware threads if 0).
+ *
+ * @throws std::logic_error if the module contains no circuit with the name of the implementation
+ * or if the implementation has a different number of inputs or outputs than the pattern
+ * @return the number of replaced embeddings
+ */
+size_t replaceLibrarySubcircuit(core::ModuleObjectWrapper& module, const core::CircuitReadOnly& pattern, const std::string& implementation,
+                                bool inlineImplementation = false, size_t numberOfThreads = 0);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_LIBRARYSUBCIRCUITREPLACEMENT_H */
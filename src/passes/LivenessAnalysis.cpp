@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LivenessAnalysis.h"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+
+#include "DenseNodeNumbering.h"
+
+namespace fuse::passes {
+
+LivenessInfo analyzeLiveness(const core::CircuitReadOnly& circuit, bool keepInputValues) {
+    LivenessInfo liveness;
+    // the position of a node in a densely numbered circuit is its ID
+    const bool dense = hasDenseNodeIDs(circuit);
+    std::unordered_map<uint64_t, size_t> position;
+    auto findPosition = [&](uint64_t id) -> std::optional<size_t> {
+        if (dense) {
+            return id < liveness.evaluationOrder.size() ? std::optional<size_t>(id) : std::nullopt;
+        }
+        auto it = position.find(id);
+        return it != position.end() ? std::optional<size_t>(it->second) : std::nullopt;
+    };
+    circuit.topologicalTraversal([&](core::NodeReadOnly& node) {
+        const size_t current = liveness.evaluationOrder.size();
+        if (!dense) {
+            position[node.getNodeID()] = current;
+        }
+
+        if (node.isOutputNode() || (keepInputValues && node.isInputNode())) {
+            liveness.lastUse.push_back(LivenessInfo::kLiveOut);
+        } else {
+            liveness.lastUse.push_back(current);
+        }
+        for (auto input : node.getInputNodeIDs()) {
+            auto inputPosition = findPosition(input);
+            if (inputPosition && liveness.lastUse[*inputPosition] != LivenessInfo::kLiveOut) {
+                liveness.lastUse[*inputPosition] = std::max(liveness.lastUse[*inputPosition], current);
+            }
+        }
+        liveness.evaluationOrder.push_back(node.getNodeID());
+    });
+    const size_t numberOfNodes = liveness.evaluationOrder.size();
+
+    // bucket the values by their last use
+    liveness.freedOffsets.assign(numberOfNodes + 1, 0);
+    for (auto last : liveness.lastUse) {
+        if (last != LivenessInfo::kLiveOut) {
+            ++liveness.freedOffsets[last + 1];
+        }
+    }
+    for (size_t i = 0; i < numberOfNodes; ++i) {
+        liveness.freedOffsets[i + 1] += liveness.freedOffsets[i];
+    }
+    liveness.freedValues.resize(liveness.freedOffsets[numberOfNodes]);
+    std::vector<size_t> next(liveness.freedOffsets.begin(), liveness.freedOffsets.end() - 1);
+    for (size_t p = 0; p < numberOfNodes; ++p) {
+        if (liveness.lastUse[p] != LivenessInfo::kLiveOut) {
+            liveness.freedValues[next[liveness.lastUse[p]]++] = liveness.evaluationOrder[p];
+        }
+    }
+
+    size_t live = 0;
+    for (size_t p = 0; p < numberOfNodes; ++p) {
+        ++live;
+        liveness.maxLiveValues = std::max(liveness.maxLiveValues, live);
+        live -= liveness.freedOffsets[p + 1] - liveness.freedOffsets[p];
+    }
+    return liveness;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_LIVENESSANALYSIS_H
+#define FUSE_LIVENESSANALYSIS_H
+
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Last uses of the node values of a circuit w.r.t. the order of topologicalTraversal, indexed by the position of the nodes in this order.
+ *
+ * The value of a node comprises all of its outputs, so a node is used by every node that reads one of its offsets.
+ * Call and loop nodes use their inputs at their own position, the values inside the callee are analyzed with the callee.
+ */
+struct LivenessInfo {
+    static constexpr size_t kLiveOut = std::numeric_limits<size_t>::max();
+
+    // node IDs in evaluation order
+    std::vector<uint64_t> evaluationOrder;
+    // position of the last node that reads the value of the node at the given position (the node itself if there is none),
+    // kLiveOut for values that are needed after the evaluation
+    std::vector<size_t> lastUse;
+    // the values that are dead after evaluating the node at position i are freedValues[freedOffsets[i]] until freedValues[freedOffsets[i + 1]]
+    std::vector<size_t> freedOffsets;
+    std::vector<uint64_t> freedValues;
+    // maximum number of values that are live at the same time, i.e. the size of the live frontier
+    size_t maxLiveValues = 0;
+
+    /**
+     * @brief Returns the IDs of the nodes whose values can be freed after the node at the given position was evaluated.
+     */
+    std::span<const uint64_t> getValuesFreedAfter(size_t position) const {
+        return {freedValues.data() + freedOffsets.at(position), freedValues.data() + freedOffsets.at(position + 1)};
+    }
+};
+
+/**
+ * @brief Computes the last use of every node value in the circuit.
+ * The values of output nodes are live-out, so evaluators that free the values after their last use only keep the outputs.
+ *
+ * @param keepInputValues if true, the values of input nodes are live-out as well, e.g. if the inputs are owned by the caller
+ */
+LivenessInfo analyzeLiveness(const core::CircuitReadOnly& circuit, bool keepInputValues = false);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_LIVENESSANALYSIS_H */
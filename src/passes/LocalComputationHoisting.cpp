@@ -0,0 +1,302 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LocalComputationHoisting.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using Offset = uint32_t;
+using Value = std::pair<Identifier, Offset>;
+using op = core::ir::PrimitiveOperation;
+
+std::string getOwnerName(const Ownership& ownership) {
+    return ownership.kind == Ownership::Kind::Public ? kPublicOwner : ownership.party;
+}
+
+// the position of every input node in the circuit's inputs, looked up once per node
+std::unordered_map<Identifier, size_t> getInputPositions(const core::CircuitReadOnly& circuit) {
+    auto inputIDs = circuit.getInputNodeIDs();
+    std::unordered_map<Identifier, size_t> positions;
+    for (size_t i = 0; i < inputIDs.size(); ++i) {
+        positions.emplace(inputIDs[i], i);
+    }
+    return positions;
+}
+
+// the type of the first output of every node, nodes without type information inherit the type of their first input
+std::unordered_map<Identifier, core::ir::DataTypeTableT> inferValueTypes(core::CircuitObjectWrapper& circuit) {
+    std::unordered_map<Identifier, core::ir::DataTypeTableT> types;
+    auto inputTypes = std::as_const(circuit).getInputDataTypes();
+    const auto inputPositions = getInputPositions(circuit);
+    const bool hasInputTypes = inputTypes.size() == inputPositions.size();
+    for (auto node : circuit) {
+        core::ir::DataTypeTableT type;
+        type.primitive_type = core::ir::PrimitiveType::Bool;
+        type.security_level = core::ir::SecurityLevel::Secure;
+        auto setFrom = [&](const core::DataTypeReadOnly& dataType) {
+            type.primitive_type = dataType.getPrimitiveType();
+            type.security_level = dataType.getSecurityLevel();
+            auto shape = dataType.getShape();
+            type.shape.assign(shape.begin(), shape.end());
+        };
+        auto outputTypes = std::as_const(node).getOutputDataTypes();
+        auto inputPosition = inputPositions.find(node.getNodeID());
+        if (!outputTypes.empty() && node.getOperation() != op::Split) {
+            setFrom(*outputTypes[0]);
+        } else if (node.isInputNode() && inputPosition != inputPositions.end() && hasInputTypes) {
+            setFrom(*inputTypes[inputPosition->second]);
+        } else if (!node.hasComparisonOperator() && node.getOperation() != op::Split && node.getNumberOfInputs() > 0) {
+            type = types.at(node.getInputNodeIDs()[0]);
+        }
+        types.emplace(node.getNodeID(), std::move(type));
+    }
+    return types;
+}
+
+core::ir::DataTypeTableT getValueType(core::CircuitObjectWrapper& circuit, const std::unordered_map<Identifier, core::ir::DataTypeTableT>& types, const Value& value) {
+    auto node = circuit.getNodeWithID(value.first);
+    auto outputTypes = std::as_const(node).getOutputDataTypes();
+    if (value.second > 0 && value.second < outputTypes.size()) {
+        core::ir::DataTypeTableT type;
+        type.primitive_type = outputTypes[value.second]->getPrimitiveType();
+        type.security_level = outputTypes[value.second]->getSecurityLevel();
+        auto shape = outputTypes[value.second]->getShape();
+        type.shape.assign(shape.begin(), shape.end());
+        return type;
+    }
+    return types.at(value.first);
+}
+
+// the local circuit computes the values of the frontier from the owner's inputs
+void extractLocalCircuit(core::CircuitObjectWrapper& local,
+                         const std::string& owner,
+                         const std::vector<Value>& frontier,
+                         std::vector<core::ir::DataTypeTableT> frontierTypes) {
+    std::unordered_set<Identifier> keep;
+    std::vector<Identifier> stack;
+    for (const auto& value : frontier) {
+        stack.push_back(value.first);
+    }
+    while (!stack.empty()) {
+        auto id = stack.back();
+        stack.pop_back();
+        if (keep.insert(id).second) {
+            auto inputs = local.getNodeWithID(id).getInputNodeIDs();
+            stack.insert(stack.end(), inputs.begin(), inputs.end());
+        }
+    }
+
+    std::unordered_set<Identifier> unusedInputs;
+    for (auto input : local.getInputNodeIDs()) {
+        if (!keep.contains(input)) {
+            unusedInputs.insert(input);
+        }
+    }
+    local.removeInputs(unusedInputs);
+    auto outputs = local.getOutputNodeIDs();
+    local.removeOutputs({outputs.begin(), outputs.end()});
+
+    for (size_t i = 0; i < frontier.size(); ++i) {
+        std::vector<Identifier> inputIDs{frontier[i].first};
+        std::vector<Offset> inputOffsets{frontier[i].second};
+        // the local circuit is evaluated in cleartext
+        frontierTypes[i].security_level = core::ir::SecurityLevel::Plaintext;
+        core::DataTypeObjectWrapper type(&frontierTypes[i]);
+        auto output = local.addNode();
+        output.setPrimitiveOperation(op::Output);
+        output.setInputNodeIDs(inputIDs);
+        output.setInputOffsets(inputOffsets);
+        output.setNumberOfOutputs(1);
+        output.setInterfaceDataType(type);
+        local.addOutput(output.getNodeID(), type);
+        keep.insert(output.getNodeID());
+    }
+    local.removeNodesNotContainedIn(keep);
+    local.setStringValueForAttribute("local_owner", owner);
+}
+
+}  // namespace
+
+Ownership Ownership::join(const Ownership& a, const Ownership& b) {
+    if (a.kind == Kind::Public) {
+        return b;
+    }
+    if (b.kind == Kind::Public || a == b) {
+        return a;
+    }
+    return {Kind::Secure, ""};
+}
+
+std::unordered_map<uint64_t, Ownership> analyzeOwnership(const core::CircuitReadOnly& circuit) {
+    std::unordered_map<Identifier, Ownership> ownership;
+    auto inputTypes = circuit.getInputDataTypes();
+    const auto inputPositions = getInputPositions(circuit);
+    circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+        Ownership result;
+        if (node.isInputNode()) {
+            const auto owner = node.getStringValueForAttribute("owner");
+            if (owner == kPublicOwner) {
+                result = {Ownership::Kind::Public, ""};
+            } else if (!owner.empty()) {
+                result = {Ownership::Kind::Party, owner};
+            } else {
+                // plaintext inputs are known to every party
+                auto outputTypes = node.getOutputDataTypes();
+                auto position = inputPositions.find(node.getNodeID());
+                bool isSecure = true;
+                if (!outputTypes.empty()) {
+                    isSecure = outputTypes[0]->isSecureType();
+                } else if (position != inputPositions.end() && inputTypes.size() == inputPositions.size()) {
+                    isSecure = inputTypes[position->second]->isSecureType();
+                }
+                result = {isSecure ? Ownership::Kind::Secure : Ownership::Kind::Public, ""};
+            }
+        } else if (node.isConstantNode()) {
+            result = {Ownership::Kind::Public, ""};
+        } else if (node.isSubcircuitNode() || node.isLoopNode() || node.isNodeWithCustomOp() || node.getNumberOfInputs() == 0) {
+            result = {Ownership::Kind::Secure, ""};
+        } else {
+            for (auto input : node.getInputNodeIDs()) {
+                result = Ownership::join(result, ownership.at(input));
+            }
+        }
+        ownership.emplace(node.getNodeID(), std::move(result));
+    });
+    return ownership;
+}
+
+size_t hoistLocalComputations(core::ModuleObjectWrapper& module) {
+    auto circuit = module.getEntryCircuit();
+    const auto circuitName = circuit.getName();
+    const auto ownership = analyzeOwnership(circuit);
+
+    std::unordered_set<Identifier> localNodes;
+    for (auto node : circuit) {
+        if (!node.isInputNode() && !node.isOutputNode() && !node.isConstantNode() && ownership.at(node.getNodeID()).kind != Ownership::Kind::Secure) {
+            localNodes.insert(node.getNodeID());
+        }
+    }
+    if (localNodes.empty()) {
+        return 0;
+    }
+
+    // values of local nodes that are used by the secure part, grouped by owner
+    std::map<std::string, std::vector<Value>> frontiers;
+    std::set<Value> frontierValues;
+    for (auto node : circuit) {
+        // local nodes compute their inputs themselves, parties also compute the public values they need
+        if (localNodes.contains(node.getNodeID())) {
+            continue;
+        }
+        auto inputs = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            Value value{inputs[i], offsets.empty() ? 0 : offsets[i]};
+            if (localNodes.contains(value.first) && frontierValues.insert(value).second) {
+                frontiers[getOwnerName(ownership.at(value.first))].push_back(value);
+            }
+        }
+    }
+
+    // extract the local circuits before the entry circuit is changed
+    const auto types = inferValueTypes(circuit);
+    std::map<Value, Identifier> replacements;
+    for (const auto& [owner, frontier] : frontiers) {
+        const std::string localName = circuitName + "_local_" + owner;
+        std::vector<core::ir::DataTypeTableT> frontierTypes;
+        for (const auto& value : frontier) {
+            frontierTypes.push_back(getValueType(circuit, types, value));
+        }
+        auto local = module.copyCircuit(circuitName, localName);
+        extractLocalCircuit(local, owner, frontier, frontierTypes);
+
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            frontierTypes[i].security_level = owner == kPublicOwner ? core::ir::SecurityLevel::Plaintext : core::ir::SecurityLevel::Secure;
+            core::DataTypeObjectWrapper type(&frontierTypes[i]);
+            auto input = circuit.addNode();
+            input.setPrimitiveOperation(op::Input);
+            input.setNumberOfOutputs(1);
+            input.setInterfaceDataType(type);
+            input.setStringValueForAttribute("owner", owner);
+            input.setStringValueForAttribute("local_circuit", localName);
+            input.setStringValueForAttribute("local_output", std::to_string(i));
+            circuit.addInput(input.getNodeID(), type);
+            replacements.emplace(frontier[i], input.getNodeID());
+        }
+    }
+
+    // the secure part reads the hoisted values from the new inputs
+    std::unordered_set<Identifier> usedNodes;
+    std::unordered_set<Identifier> usedLocally;
+    for (auto node : circuit) {
+        if (localNodes.contains(node.getNodeID())) {
+            auto inputs = node.getInputNodeIDs();
+            usedLocally.insert(inputs.begin(), inputs.end());
+            continue;
+        }
+        auto ids = node.getInputNodeIDs();
+        auto offsets = node.getInputOffsets();
+        std::vector<Identifier> newIDs(ids.begin(), ids.end());
+        std::vector<Offset> newOffsets(ids.size(), 0);
+        bool replaced = false;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            newOffsets[i] = offsets.empty() ? 0 : offsets[i];
+            if (auto replacement = replacements.find({ids[i], newOffsets[i]}); replacement != replacements.end()) {
+                newIDs[i] = replacement->second;
+                newOffsets[i] = 0;
+                replaced = true;
+            }
+        }
+        if (replaced) {
+            node.setInputNodeIDs(newIDs);
+            node.setInputOffsets(newOffsets);
+        }
+        usedNodes.insert(newIDs.begin(), newIDs.end());
+    }
+
+    // inputs of the parties that are only used locally are no longer needed by the secure part
+    std::unordered_set<Identifier> removedInputs;
+    for (auto input : circuit.getInputNodeIDs()) {
+        if (usedLocally.contains(input) && !usedNodes.contains(input)) {
+            removedInputs.insert(input);
+        }
+    }
+    circuit.removeInputs(removedInputs);
+    auto nodesToRemove = localNodes;
+    nodesToRemove.insert(removedInputs.begin(), removedInputs.end());
+    circuit.removeNodes(nodesToRemove);
+    // the new inputs have been added at the end
+    circuit.restoreTopologicalOrder();
+    return localNodes.size();
+}
+
+}  // namespace fuse::passes
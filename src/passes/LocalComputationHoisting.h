@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_LOCALCOMPUTATIONHOISTING_H
+#define FUSE_LOCALCOMPUTATIONHOISTING_H
+
+#include <string>
+#include <unordered_map>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/// owner annotation of inputs that are known to all parties, single parties are annotated like "owner:1"
+constexpr auto kPublicOwner = "public";
+
+/**
+ * @brief Describes who is able to compute a value without secure computation.
+ */
+struct Ownership {
+    enum class Kind {
+        // constants and plaintext inputs: every party can compute it
+        Public,
+        // depends on the inputs of a single party only
+        Party,
+        // needs secure computation
+        Secure
+    };
+    Kind kind = Kind::Public;
+    // owner annotation of the party's inputs, only for Kind::Party
+    std::string party;
+
+    bool operator==(const Ownership& other) const = default;
+
+    /// the ownership of a node that depends on values with both ownerships
+    static Ownership join(const Ownership& a, const Ownership& b);
+};
+
+/**
+ * @brief Computes the ownership of every node of the circuit.
+ * Input nodes are owned by the party of their "owner" annotation, inputs without it are public if their type is plaintext and secure otherwise.
+ * Other nodes depend on their inputs, except for calls, loops and custom operations which are treated as secure.
+ */
+std::unordered_map<uint64_t, Ownership> analyzeOwnership(const core::CircuitReadOnly& circuit);
+
+/**
+ * @brief Moves the computations of the entry circuit that do not need secure computation into local circuits.
+ *
+ * For every party (and for public values) whose values are used by secure nodes or outputs after some local computation, the circuit
+ * "<entry>_local_<owner>" is added to the module. It takes the party's inputs (with the same IDs) and outputs the values used by the secure part.
+ * In the entry circuit, these values are replaced by new inputs at the end of the circuit's inputs, annotated with the owner,
+ * the local circuit and the output of the local circuit that provides them (attributes "owner", "local_circuit" and "local_output").
+ * Inputs that only feed local computations are removed from the entry circuit.
+ *
+ * @return the number of computations that have been moved out of the entry circuit
+ */
+size_t hoistLocalComputations(core::ModuleObjectWrapper& module);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_LOCALCOMPUTATIONHOISTING_H */
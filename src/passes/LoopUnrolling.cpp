@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "LoopUnrolling.h"
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using Offset = uint32_t;
+using Value = std::pair<Identifier, Offset>;
+
+struct LoopInfo {
+    Identifier nodeID;
+    std::string body;
+    size_t iterations;
+    size_t numberOfCarriedValues;
+    size_t numberOfPerIterationInputs;
+    std::vector<Value> inputs;
+};
+
+std::vector<Value> getInputValues(const core::NodeReadOnly& node) {
+    auto ids = node.getInputNodeIDs();
+    auto offsets = node.getInputOffsets();
+    std::vector<Value> values;
+    values.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        values.emplace_back(ids[i], offsets.empty() ? 0 : offsets[i]);
+    }
+    return values;
+}
+
+void setInputValues(core::NodeObjectWrapper& node, const std::vector<Value>& values) {
+    std::vector<Identifier> ids;
+    std::vector<Offset> offsets;
+    ids.reserve(values.size());
+    offsets.reserve(values.size());
+    for (const auto& [id, offset] : values) {
+        ids.push_back(id);
+        offsets.push_back(offset);
+    }
+    node.setInputNodeIDs(ids);
+    node.setInputOffsets(offsets);
+}
+
+std::optional<size_t> getCountAttribute(const core::NodeReadOnly& loopNode, const std::string& attribute) {
+    auto count = loopNode.getStringValueForAttribute(attribute);
+    if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+        return std::nullopt;
+    }
+    return std::stoull(count);
+}
+
+}  // namespace
+
+size_t getNumberOfIterations(const core::NodeReadOnly& loopNode) {
+    auto iterations = getCountAttribute(loopNode, kLoopIterationsAttribute);
+    if (!iterations) {
+        throw std::logic_error("Loop node " + std::to_string(loopNode.getNodeID()) + " has no valid number of iterations");
+    }
+    return *iterations;
+}
+
+size_t getNumberOfPerIterationInputs(const core::NodeReadOnly& loopNode) {
+    if (loopNode.getStringValueForAttribute(kLoopPerIterationInputsAttribute).empty()) {
+        return 0;
+    }
+    auto perIterationInputs = getCountAttribute(loopNode, kLoopPerIterationInputsAttribute);
+    if (!perIterationInputs) {
+        throw std::logic_error("Loop node " + std::to_string(loopNode.getNodeID()) + " has no valid number of per-iteration inputs");
+    }
+    return *perIterationInputs;
+}
+
+size_t unrollLoops(core::ModuleObjectWrapper& module) {
+    size_t numberOfUnrolledLoops = 0;
+    for (const auto& name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        std::vector<LoopInfo> loops;
+        for (auto node : circuit) {
+            if (!node.isLoopNode()) {
+                continue;
+            }
+            auto body = std::as_const(module).getCircuitWithName(node.getSubCircuitName());
+            const size_t carried = body->getNumberOfOutputs();
+            const size_t iterations = getNumberOfIterations(node);
+            const size_t perIteration = getNumberOfPerIterationInputs(node);
+            // the body's per-iteration inputs receive one value per iteration from the loop
+            if (carried + perIteration > body->getNumberOfInputs() ||
+                node.getNumberOfInputs() + perIteration != body->getNumberOfInputs() + iterations * perIteration) {
+                throw std::logic_error("Inputs of loop node " + std::to_string(node.getNodeID()) + " do not match loop body " + body->getName());
+            }
+            loops.push_back({node.getNodeID(), body->getName(), iterations, carried, perIteration, getInputValues(node)});
+        }
+        if (loops.empty()) {
+            continue;
+        }
+
+        // final carried values of every loop, loops are visited in topological order so their inputs are already resolved
+        std::unordered_map<Identifier, std::vector<Value>> loopResults;
+        auto resolve = [&](const Value& value) {
+            auto result = loopResults.find(value.first);
+            return result == loopResults.end() ? value : result->second.at(value.second);
+        };
+        std::unordered_set<Identifier> loopNodeIDs;
+        for (auto& loop : loops) {
+            for (auto& input : loop.inputs) {
+                input = resolve(input);
+            }
+            std::vector<Value> carried(loop.inputs.begin(), loop.inputs.begin() + loop.numberOfCarriedValues);
+            const auto perIterationInputs = loop.inputs.begin() + loop.numberOfCarriedValues;
+            const auto invariantInputs = perIterationInputs + loop.iterations * loop.numberOfPerIterationInputs;
+            for (size_t iteration = 0; iteration < loop.iterations; ++iteration) {
+                auto call = circuit.addNode();
+                call.setPrimitiveOperation(core::ir::PrimitiveOperation::CallSubcircuit);
+                call.setSubCircuitName(loop.body);
+                call.setNumberOfOutputs(loop.numberOfCarriedValues);
+                std::vector<Value> callInputs = carried;
+                const auto roundInputs = perIterationInputs + iteration * loop.numberOfPerIterationInputs;
+                callInputs.insert(callInputs.end(), roundInputs, roundInputs + loop.numberOfPerIterationInputs);
+                callInputs.insert(callInputs.end(), invariantInputs, loop.inputs.end());
+                setInputValues(call, callInputs);
+                for (size_t i = 0; i < carried.size(); ++i) {
+                    carried[i] = {call.getNodeID(), static_cast<Offset>(i)};
+                }
+            }
+            loopResults.emplace(loop.nodeID, std::move(carried));
+            loopNodeIDs.insert(loop.nodeID);
+        }
+
+        for (auto node : circuit) {
+            if (loopNodeIDs.contains(node.getNodeID())) {
+                continue;
+            }
+            auto inputs = getInputValues(node);
+            bool usesLoop = false;
+            for (auto& input : inputs) {
+                usesLoop |= loopNodeIDs.contains(input.first);
+                input = resolve(input);
+            }
+            if (usesLoop) {
+                setInputValues(node, inputs);
+            }
+        }
+        circuit.removeNodes(loopNodeIDs);
+        circuit.restoreTopologicalOrder();
+        numberOfUnrolledLoops += loops.size();
+    }
+    return numberOfUnrolledLoops;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_LOOPUNROLLING_H
+#define FUSE_LOOPUNROLLING_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Node attribute that holds the number of iterations of a loop node.
+ */
+constexpr char kLoopIterationsAttribute[] = "iterations";
+
+/**
+ * @brief Node attribute that holds the number of per-iteration inputs of the loop body, e.g. round keys.
+ */
+constexpr char kLoopPerIterationInputsAttribute[] = "per_iteration_inputs";
+
+/**
+ * @brief Returns the number of iterations of the loop node, see node.fbs for the semantics of loops.
+ *
+ * @throws std::logic_error if the node has no valid iterations attribute
+ */
+size_t getNumberOfIterations(const core::NodeReadOnly& loopNode);
+
+/**
+ * @brief Returns the number of body inputs that receive a different value in every iteration of the loop node,
+ * 0 if the node has no per-iteration inputs attribute.
+ *
+ * @throws std::logic_error if the attribute is not a number
+ */
+size_t getNumberOfPerIterationInputs(const core::NodeReadOnly& loopNode);
+
+/**
+ * @brief Replaces every loop node inside the module by a chain of calls to the loop body, one call per iteration.
+ *
+ * The first call receives the initial carried values, every further call the carried outputs of the previous call.
+ * Each call also receives the per-iteration values of its iteration and the loop-invariant inputs. Users of the loop read the outputs of the last call afterwards,
+ * or the initial carried values for loops without iterations. Run inlineSubcircuits afterwards to flatten the bodies.
+ *
+ * @return the number of unrolled loops
+ * @throws std::logic_error if a loop's inputs do not match the signature of its body
+ */
+size_t unrollLoops(core::ModuleObjectWrapper& module);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_LOOPUNROLLING_H */
@@ -0,0 +1,259 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MemoryAwareScheduling.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DepthAnalysis.h"
+#include "LivenessAnalysis.h"
+#include "ParallelPasses.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using op = core::ir::PrimitiveOperation;
+
+class PeakMemoryScheduler {
+   public:
+    explicit PeakMemoryScheduler(const core::CircuitObjectWrapper& circuit) : levels_(computeLevelSchedule(circuit, op::And)) {
+        const size_t numberOfNodes = levels_.nodeIDs.size();
+        std::unordered_map<Identifier, size_t> indices;
+        for (size_t index = 0; index < numberOfNodes; ++index) {
+            indices.emplace(levels_.nodeIDs[index], index);
+        }
+        inputs_.resize(numberOfNodes);
+        users_.resize(numberOfNodes);
+        isCircuitInput_.assign(numberOfNodes, false);
+        isLiveOut_.assign(numberOfNodes, false);
+        isCounted_.assign(numberOfNodes, false);
+        size_t index = 0;
+        for (auto node : circuit) {
+            auto ids = node.getInputNodeIDs();
+            for (auto id : ids) {
+                auto input = indices.find(id);
+                // the value of a node comprises all of its outputs, so every input node is counted once
+                if (input != indices.end() && std::find(inputs_[index].begin(), inputs_[index].end(), input->second) == inputs_[index].end()) {
+                    inputs_[index].push_back(input->second);
+                    users_[input->second].push_back(index);
+                }
+            }
+            isLiveOut_[index] = node.isOutputNode();
+            isCounted_[index] = node.getOperation() == op::And;
+            ++index;
+        }
+        for (auto id : circuit.getInputNodeIDs()) {
+            if (auto input = indices.find(id); input != indices.end()) {
+                isCircuitInput_[input->second] = true;
+            }
+        }
+    }
+
+    std::vector<Identifier> computeOrder() {
+        const size_t numberOfNodes = levels_.nodeIDs.size();
+        const size_t numberOfLevels = levels_.getNumberOfLevels();
+        scheduled_.assign(numberOfNodes, false);
+        readyLevels_.assign(numberOfNodes, 0);
+        remainingUsers_.resize(numberOfNodes);
+        missingInputs_.assign(numberOfNodes, 0);
+        deltas_.assign(numberOfNodes, 0);
+        deferred_.assign(numberOfLevels + 1, {});
+        waiting_.assign(numberOfLevels + 1, {});
+        order_.clear();
+        order_.reserve(numberOfNodes);
+
+        for (size_t index = 0; index < numberOfNodes; ++index) {
+            remainingUsers_[index] = users_[index].size();
+            for (auto input : inputs_[index]) {
+                missingInputs_[index] += isScheduledOnDemand(input) ? 0 : 1;
+            }
+        }
+        for (size_t index = 0; index < numberOfNodes; ++index) {
+            deltas_[index] = computeDelta(index);
+        }
+
+        // inputs are available from the start, unused nodes without inputs are placed with them
+        currentLevel_ = 0;
+        for (size_t index = 0; index < numberOfNodes; ++index) {
+            if (isCircuitInput_[index] || (inputs_[index].empty() && users_[index].empty())) {
+                schedule(index);
+            }
+        }
+        for (size_t index = 0; index < numberOfNodes; ++index) {
+            if (!scheduled_[index] && !isScheduledOnDemand(index) && missingInputs_[index] == 0) {
+                makeReady(index);
+            }
+        }
+
+        for (currentLevel_ = 0; currentLevel_ < numberOfLevels; ++currentLevel_) {
+            for (auto index : deferred_[currentLevel_]) {
+                makeCandidate(index);
+            }
+            // nodes on their ALAP level must be scheduled now
+            for (auto index : waiting_[currentLevel_]) {
+                if (!scheduled_[index]) {
+                    candidates_.emplace(deltas_[index], index);
+                }
+            }
+            while (!candidates_.empty()) {
+                auto [delta, index] = candidates_.top();
+                candidates_.pop();
+                // skip outdated entries
+                if (scheduled_[index] || delta != deltas_[index]) {
+                    continue;
+                }
+                schedule(index);
+            }
+        }
+
+        std::vector<Identifier> order;
+        order.reserve(order_.size());
+        for (auto index : order_) {
+            order.push_back(levels_.nodeIDs[index]);
+        }
+        return order;
+    }
+
+   private:
+    // nodes without inputs that are not inputs of the circuit, e.g. constants, are placed right before their first user
+    bool isScheduledOnDemand(size_t index) const { return inputs_[index].empty() && !isCircuitInput_[index] && !users_[index].empty(); }
+
+    // change of the number of live values when scheduling the node now
+    long computeDelta(size_t index) const {
+        long delta = users_[index].empty() && !isLiveOut_[index] ? 0 : 1;
+        for (auto input : inputs_[index]) {
+            if (remainingUsers_[input] == 1 && !isLiveOut_[input]) {
+                --delta;
+            }
+        }
+        return delta;
+    }
+
+    void makeReady(size_t index) {
+        if (readyLevels_[index] > currentLevel_) {
+            deferred_[readyLevels_[index]].push_back(index);
+        } else {
+            makeCandidate(index);
+        }
+    }
+
+    // the node is ready: schedule it now if it frees values or has reached its ALAP level, otherwise wait for its ALAP level
+    void makeCandidate(size_t index) {
+        if (deltas_[index] <= 0 || levels_.alapLevels[index] <= currentLevel_) {
+            candidates_.emplace(deltas_[index], index);
+        } else {
+            waiting_[levels_.alapLevels[index]].push_back(index);
+        }
+    }
+
+    bool isReady(size_t index) const { return missingInputs_[index] == 0 && readyLevels_[index] <= currentLevel_; }
+
+    void schedule(size_t index) {
+        for (auto input : inputs_[index]) {
+            if (isScheduledOnDemand(input) && !scheduled_[input]) {
+                scheduled_[input] = true;
+                order_.push_back(input);
+            }
+        }
+        scheduled_[index] = true;
+        order_.push_back(index);
+
+        for (auto input : inputs_[index]) {
+            if (--remainingUsers_[input] != 1 || isLiveOut_[input]) {
+                continue;
+            }
+            // the remaining user now frees the input
+            for (auto user : users_[input]) {
+                if (!scheduled_[user]) {
+                    // entries with the old delta are outdated, so eligible nodes are queued again
+                    --deltas_[user];
+                    if (isReady(user) && (deltas_[user] <= 0 || levels_.alapLevels[user] <= currentLevel_)) {
+                        candidates_.emplace(deltas_[user], user);
+                    }
+                }
+            }
+        }
+        for (auto user : users_[index]) {
+            readyLevels_[user] = std::max<uint32_t>(readyLevels_[user], currentLevel_ + (isCounted_[user] ? 1 : 0));
+            if (--missingInputs_[user] == 0) {
+                makeReady(user);
+            }
+        }
+    }
+
+    LevelSchedule levels_;
+    std::vector<std::vector<size_t>> inputs_;
+    std::vector<std::vector<size_t>> users_;
+    std::vector<bool> isCircuitInput_;
+    std::vector<bool> isLiveOut_;
+    std::vector<bool> isCounted_;
+
+    uint32_t currentLevel_ = 0;
+    std::vector<bool> scheduled_;
+    std::vector<uint32_t> readyLevels_;
+    std::vector<size_t> remainingUsers_;
+    std::vector<size_t> missingInputs_;
+    std::vector<long> deltas_;
+    // ready nodes by the level from which on they may be scheduled, and by their ALAP level
+    std::vector<std::vector<size_t>> deferred_;
+    std::vector<std::vector<size_t>> waiting_;
+    // nodes that are scheduled on the current level, the ones that free the most values first
+    std::priority_queue<std::pair<long, size_t>, std::vector<std::pair<long, size_t>>, std::greater<>> candidates_;
+    std::vector<size_t> order_;
+};
+
+}  // namespace
+
+size_t scheduleForPeakMemory(core::CircuitObjectWrapper& circuit) {
+    const size_t before = analyzeLiveness(circuit).maxLiveValues;
+    std::vector<Identifier> originalOrder;
+    for (auto node : circuit) {
+        originalOrder.push_back(node.getNodeID());
+    }
+
+    auto order = PeakMemoryScheduler(circuit).computeOrder();
+    if (order.size() != originalOrder.size()) {
+        // only happens for circuits that are not in topological order
+        return before;
+    }
+    circuit.reorderNodes(order);
+    const size_t after = analyzeLiveness(circuit).maxLiveValues;
+    if (after >= before) {
+        circuit.reorderNodes(originalOrder);
+        return before;
+    }
+    return after;
+}
+
+void scheduleForPeakMemory(core::ModuleObjectWrapper& module, size_t numberOfThreads) {
+    runOnAllCircuits(
+        module, [](core::CircuitObjectWrapper& circuit) { scheduleForPeakMemory(circuit); }, numberOfThreads);
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_MEMORYAWARESCHEDULING_H
+#define FUSE_MEMORYAWARESCHEDULING_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Reorders the nodes of the circuit to reduce the maximum number of values that are live at once during evaluation
+ * (see LivenessInfo::maxLiveValues), e.g. for frontends that evaluate wide fronts of the circuit early.
+ *
+ * Every node is assigned a level between its ASAP and ALAP level w.r.t. AND gates (see computeLevelSchedule), so the order
+ * is sorted by AND depth and evaluators that process the circuit round by round need no additional rounds.
+ * Within these bounds, nodes are scheduled greedily: nodes that free more values than they create come first,
+ * all other nodes are delayed up to their ALAP level. Inputs stay at the front and constants are placed right before their first use.
+ * If the new order does not reduce the maximum number of live values, the circuit is left unchanged.
+ *
+ * @return the maximum number of live values of the resulting order
+ */
+size_t scheduleForPeakMemory(core::CircuitObjectWrapper& circuit);
+
+/**
+ * @brief Schedules all circuits of the module, see scheduleForPeakMemory(core::CircuitObjectWrapper&),
+ * on up to numberOfThreads circuits at once (all hardware threads if 0).
+ */
+void scheduleForPeakMemory(core::ModuleObjectWrapper& module, size_t numberOfThreads = 0);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_MEMORYAWARESCHEDULING_H */
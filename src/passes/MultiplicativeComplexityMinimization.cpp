@@ -0,0 +1,559 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "MultiplicativeComplexityMinimization.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "DeadNodeEliminator.h"
+#include "NodeSuccessorsAnalysis.h"
+#include "PeepholeRewriter.h"
+
+namespace fuse::passes {
+
+namespace {
+
+bool isNonlinearOperation(core::ir::PrimitiveOperation operation) {
+    using op = core::ir::PrimitiveOperation;
+    return operation == op::And || operation == op::Or || operation == op::Nand || operation == op::Nor;
+}
+
+/*
+ * Affine functions over the cut leaves x1, x2, x3 are encoded as bit masks:
+ * bit 0 adds the constant 1, bits 1 to 3 add the leaves x1 to x3.
+ * Truth tables of functions with up to three inputs are stored in a single byte.
+ */
+constexpr std::array<uint8_t, 3> kLeafTruthTables = {0xAA, 0xCC, 0xF0};
+constexpr size_t kMaxCutSize = 3;
+constexpr size_t kMaxCutsPerNode = 8;
+
+uint8_t evaluateAffine(uint8_t mask) {
+    uint8_t result = (mask & 1) ? 0xFF : 0x00;
+    for (size_t leaf = 0; leaf < kMaxCutSize; ++leaf) {
+        if (mask & (1 << (leaf + 1))) {
+            result ^= kLeafTruthTables[leaf];
+        }
+    }
+    return result;
+}
+
+/*
+ * Multiplicative complexity optimal implementation of a 3-input function with t = L1 AND L2:
+ *   0 ANDs: f = L0
+ *   1 AND:  f = L0 XOR t
+ *   2 ANDs: f = L0 XOR (gamma * t) XOR ((L3 XOR alpha * t) AND (L4 XOR beta * t))
+ * Every Boolean function with three inputs has a multiplicative complexity of at most 2.
+ */
+struct MCImplementation {
+    uint8_t numberOfAnds = 0;
+    uint8_t l0 = 0, l1 = 0, l2 = 0, l3 = 0, l4 = 0;
+    bool alpha = false, beta = false, gamma = false;
+};
+
+std::array<MCImplementation, 256> computeMCOptimalImplementations() {
+    std::array<MCImplementation, 256> table;
+    std::array<bool, 256> found{};
+    size_t numberFound = 0;
+    auto store = [&](uint8_t truthTable, const MCImplementation& implementation) {
+        if (!found[truthTable]) {
+            found[truthTable] = true;
+            table[truthTable] = implementation;
+            ++numberFound;
+        }
+    };
+
+    // prefer implementations with fewer ANDs, then implementations that use fewer leaves,
+    // s.t. the implementation of a function never refers to a leaf it does not depend on
+    for (uint8_t ands = 0; ands <= 2; ++ands) {
+        for (uint8_t leaves = 1; leaves <= kMaxCutSize; ++leaves) {
+            const uint8_t numberOfMasks = 1 << (leaves + 1);
+            for (uint8_t l0 = 0; l0 < numberOfMasks; ++l0) {
+                uint8_t f0 = evaluateAffine(l0);
+                if (ands == 0) {
+                    store(f0, {0, l0});
+                    continue;
+                }
+                // AND inputs that are constant never lead to an optimal implementation
+                for (uint8_t l1 = 2; l1 < numberOfMasks; ++l1) {
+                    for (uint8_t l2 = l1; l2 < numberOfMasks; ++l2) {
+                        uint8_t t = evaluateAffine(l1) & evaluateAffine(l2);
+                        if (ands == 1) {
+                            store(f0 ^ t, {1, l0, l1, l2});
+                            continue;
+                        }
+                        for (uint8_t l3 = 0; l3 < numberOfMasks; ++l3) {
+                            for (uint8_t l4 = l3; l4 < numberOfMasks; ++l4) {
+                                for (uint8_t flags = 0; flags < 8; ++flags) {
+                                    bool alpha = flags & 1, beta = flags & 2, gamma = flags & 4;
+                                    uint8_t u = (evaluateAffine(l3) ^ (alpha ? t : 0)) & (evaluateAffine(l4) ^ (beta ? t : 0));
+                                    store(f0 ^ (gamma ? t : 0) ^ u, {2, l0, l1, l2, l3, l4, alpha, beta, gamma});
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            if (numberFound == table.size()) {
+                return table;
+            }
+        }
+    }
+    return table;
+}
+
+const std::array<MCImplementation, 256>& getMCOptimalImplementations() {
+    static const auto implementations = computeMCOptimalImplementations();
+    return implementations;
+}
+
+}  // namespace
+
+/*
+ * MultiplicativeComplexityMinimizer: cut-based resynthesis of Boolean gates
+ */
+
+class MultiplicativeComplexityMinimizer {
+    using Identifier = uint64_t;
+    using Cut = std::vector<NodeOutput>;
+
+   public:
+    void visit(core::CircuitObjectWrapper& circuit);
+
+   private:
+    NodeOutput getInput(const core::NodeReadOnly& node, size_t inputNumber) const;
+    bool isBooleanSignal(NodeOutput signal) const;
+    bool isGateSignal(NodeOutput signal) const;
+    void computeCuts(const core::NodeObjectWrapper& node);
+    bool collectCone(Identifier nodeID, const Cut& cut, std::vector<Identifier>& cone, std::unordered_set<Identifier>& visited) const;
+    uint8_t computeTruthTable(const std::vector<Identifier>& cone, const Cut& cut) const;
+    size_t countRemovableNonlinearGates(const std::vector<Identifier>& cone) const;
+    void resynthesize(core::CircuitObjectWrapper& circuit, Identifier rootID, const Cut& cut, const MCImplementation& implementation);
+
+    NodeOutput addGate(core::CircuitObjectWrapper& circuit, core::ir::PrimitiveOperation operation, const std::vector<NodeOutput>& inputs);
+    NodeOutput addBooleanConstant(core::CircuitObjectWrapper& circuit, bool value);
+    NodeOutput addAffine(core::CircuitObjectWrapper& circuit, uint8_t mask, const Cut& cut, std::optional<NodeOutput> additionalTerm);
+    void setInputs(core::NodeObjectWrapper& node, core::ir::PrimitiveOperation operation, const std::vector<NodeOutput>& inputs);
+
+    std::unordered_map<Identifier, core::NodeObjectWrapper> nodes_;
+    std::unordered_map<Identifier, std::unordered_set<Identifier>> successors_;
+    std::unordered_set<Identifier> booleanGates_;
+    std::unordered_map<Identifier, std::vector<Cut>> cuts_;
+    std::vector<std::pair<Identifier, NodeOutput>> forwardedNodes_;
+    Identifier nextID_ = 0;
+};
+
+NodeOutput MultiplicativeComplexityMinimizer::getInput(const core::NodeReadOnly& node, size_t inputNumber) const {
+    Identifier inputID = node.getInputNodeIDs()[inputNumber];
+    uint32_t inputOffset = node.usesInputOffsets() ? node.getInputOffsets()[inputNumber] : 0;
+    return {inputID, inputOffset};
+}
+
+bool MultiplicativeComplexityMinimizer::isGateSignal(NodeOutput signal) const {
+    return signal.offset == 0 && booleanGates_.contains(signal.nodeID);
+}
+
+bool MultiplicativeComplexityMinimizer::isBooleanSignal(NodeOutput signal) const {
+    if (isGateSignal(signal)) {
+        return true;
+    }
+    auto it = nodes_.find(signal.nodeID);
+    if (it == nodes_.end()) {
+        return false;
+    }
+    const core::NodeReadOnly& node = it->second;
+    auto outputTypes = node.getOutputDataTypes();
+    if (outputTypes.size() > signal.offset) {
+        return outputTypes[signal.offset]->getPrimitiveType() == core::ir::PrimitiveType::Bool;
+    } else if (outputTypes.size() == 1) {
+        return outputTypes[0]->getPrimitiveType() == core::ir::PrimitiveType::Bool;
+    }
+    // gates without type annotations, e.g. from Bristol circuits, are Boolean
+    return true;
+}
+
+void MultiplicativeComplexityMinimizer::computeCuts(const core::NodeObjectWrapper& node) {
+    auto cutsOf = [&](NodeOutput signal) -> std::vector<Cut> {
+        if (isGateSignal(signal)) {
+            return cuts_.at(signal.nodeID);
+        }
+        return {{signal}};
+    };
+
+    std::vector<Cut> cuts = cutsOf(getInput(node, 0));
+    if (node.getNumberOfInputs() == 2) {
+        std::vector<Cut> mergedCuts;
+        for (const auto& first : cuts) {
+            for (const auto& second : cutsOf(getInput(node, 1))) {
+                Cut merged;
+                std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(merged));
+                if (merged.size() <= kMaxCutSize) {
+                    mergedCuts.push_back(std::move(merged));
+                }
+            }
+        }
+        cuts = std::move(mergedCuts);
+    }
+
+    // keep the smallest cuts, the trivial cut of the node itself always comes first
+    std::sort(cuts.begin(), cuts.end(), [](const Cut& a, const Cut& b) { return a.size() < b.size() || (a.size() == b.size() && a < b); });
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+    if (cuts.size() > kMaxCutsPerNode - 1) {
+        cuts.resize(kMaxCutsPerNode - 1);
+    }
+    cuts.insert(cuts.begin(), Cut{{node.getNodeID(), 0}});
+    cuts_[node.getNodeID()] = std::move(cuts);
+}
+
+bool MultiplicativeComplexityMinimizer::collectCone(Identifier nodeID, const Cut& cut, std::vector<Identifier>& cone, std::unordered_set<Identifier>& visited) const {
+    if (!visited.insert(nodeID).second) {
+        return true;
+    }
+    const auto& node = nodes_.at(nodeID);
+    for (size_t input = 0; input < node.getNumberOfInputs(); ++input) {
+        auto signal = getInput(node, input);
+        if (std::binary_search(cut.begin(), cut.end(), signal)) {
+            continue;
+        }
+        if (!isGateSignal(signal) || !collectCone(signal.nodeID, cut, cone, visited)) {
+            return false;
+        }
+    }
+    // post-order: every gate is placed after the gates it depends on
+    cone.push_back(nodeID);
+    return true;
+}
+
+uint8_t MultiplicativeComplexityMinimizer::computeTruthTable(const std::vector<Identifier>& cone, const Cut& cut) const {
+    using op = core::ir::PrimitiveOperation;
+    std::unordered_map<Identifier, uint8_t> truthTables;
+    auto truthTableOf = [&](NodeOutput signal) -> uint8_t {
+        auto leaf = std::lower_bound(cut.begin(), cut.end(), signal);
+        if (leaf != cut.end() && *leaf == signal) {
+            return kLeafTruthTables[leaf - cut.begin()];
+        }
+        return truthTables.at(signal.nodeID);
+    };
+
+    uint8_t result = 0;
+    for (auto nodeID : cone) {
+        const auto& node = nodes_.at(nodeID);
+        uint8_t a = truthTableOf(getInput(node, 0));
+        uint8_t b = node.getNumberOfInputs() == 2 ? truthTableOf(getInput(node, 1)) : 0;
+        switch (node.getOperation()) {
+            case op::And:
+                result = a & b;
+                break;
+            case op::Or:
+                result = a | b;
+                break;
+            case op::Nand:
+                result = ~(a & b);
+                break;
+            case op::Nor:
+                result = ~(a | b);
+                break;
+            case op::Xor:
+                result = a ^ b;
+                break;
+            case op::Xnor:
+                result = ~(a ^ b);
+                break;
+            case op::Not:
+                result = ~a;
+                break;
+            default:
+                throw std::logic_error("unexpected operation in Boolean cone: " + node.getOperationName());
+        }
+        truthTables[nodeID] = result;
+    }
+    return result;
+}
+
+size_t MultiplicativeComplexityMinimizer::countRemovableNonlinearGates(const std::vector<Identifier>& cone) const {
+    // a gate of the cone is removed if all of its successors are removed: start at the root (last element)
+    std::unordered_set<Identifier> removable = {cone.back()};
+    size_t numberOfNonlinearGates = isNonlinearOperation(nodes_.at(cone.back()).getOperation()) ? 1 : 0;
+    for (auto it = cone.rbegin() + 1; it != cone.rend(); ++it) {
+        auto successors = successors_.find(*it);
+        bool onlyUsedInside = successors == successors_.end() ||
+                              std::all_of(successors->second.begin(), successors->second.end(), [&](Identifier succ) { return removable.contains(succ); });
+        if (onlyUsedInside) {
+            removable.insert(*it);
+            if (isNonlinearOperation(nodes_.at(*it).getOperation())) {
+                ++numberOfNonlinearGates;
+            }
+        }
+    }
+    return numberOfNonlinearGates;
+}
+
+NodeOutput MultiplicativeComplexityMinimizer::addGate(core::CircuitObjectWrapper& circuit, core::ir::PrimitiveOperation operation, const std::vector<NodeOutput>& inputs) {
+    Identifier nodeID = nextID_++;
+    auto node = circuit.addNodeWithID(nodeID);
+    nodes_.emplace(nodeID, node);
+    setInputs(node, operation, inputs);
+    booleanGates_.insert(nodeID);
+    return {nodeID, 0};
+}
+
+NodeOutput MultiplicativeComplexityMinimizer::addBooleanConstant(core::CircuitObjectWrapper& circuit, bool value) {
+    Identifier nodeID = nextID_++;
+    auto node = circuit.addNodeWithID(nodeID);
+    node.setPrimitiveOperation(core::ir::PrimitiveOperation::Constant);
+    node.setPayload(value);
+    node.setConstantType(core::ir::PrimitiveType::Bool);
+    nodes_.emplace(nodeID, node);
+    return {nodeID, 0};
+}
+
+NodeOutput MultiplicativeComplexityMinimizer::addAffine(core::CircuitObjectWrapper& circuit, uint8_t mask, const Cut& cut, std::optional<NodeOutput> additionalTerm) {
+    using op = core::ir::PrimitiveOperation;
+    std::vector<NodeOutput> terms;
+    for (size_t leaf = 0; leaf < cut.size(); ++leaf) {
+        if (mask & (1 << (leaf + 1))) {
+            terms.push_back(cut[leaf]);
+        }
+    }
+    if (additionalTerm) {
+        terms.push_back(*additionalTerm);
+    }
+    bool negate = mask & 1;
+    if (terms.empty()) {
+        return addBooleanConstant(circuit, negate);
+    }
+    NodeOutput result = terms[0];
+    for (size_t term = 1; term < terms.size(); ++term) {
+        result = addGate(circuit, op::Xor, {result, terms[term]});
+    }
+    return negate ? addGate(circuit, op::Not, {result}) : result;
+}
+
+void MultiplicativeComplexityMinimizer::setInputs(core::NodeObjectWrapper& node, core::ir::PrimitiveOperation operation, const std::vector<NodeOutput>& inputs) {
+    Identifier nodeID = node.getNodeID();
+    for (auto input : node.getInputNodeIDs()) {
+        if (successors_.contains(input)) {
+            successors_[input].erase(nodeID);
+        }
+    }
+    std::vector<Identifier> inputIDs;
+    std::vector<uint32_t> inputOffsets;
+    for (auto input : inputs) {
+        inputIDs.push_back(input.nodeID);
+        inputOffsets.push_back(input.offset);
+        successors_[input.nodeID].insert(nodeID);
+    }
+    node.setPrimitiveOperation(operation);
+    node.setInputNodeIDs(inputIDs);
+    node.setInputOffsets(inputOffsets);
+}
+
+void MultiplicativeComplexityMinimizer::resynthesize(core::CircuitObjectWrapper& circuit, Identifier rootID, const Cut& cut, const MCImplementation& implementation) {
+    using op = core::ir::PrimitiveOperation;
+    const Identifier firstNewID = nextID_;
+
+    // top level XOR terms of the implementation
+    std::vector<NodeOutput> terms;
+    for (size_t leaf = 0; leaf < cut.size(); ++leaf) {
+        if (implementation.l0 & (1 << (leaf + 1))) {
+            terms.push_back(cut[leaf]);
+        }
+    }
+    bool negate = implementation.l0 & 1;
+    if (implementation.numberOfAnds > 0) {
+        auto t = addGate(circuit, op::And, {addAffine(circuit, implementation.l1, cut, std::nullopt), addAffine(circuit, implementation.l2, cut, std::nullopt)});
+        if (implementation.numberOfAnds == 1 || implementation.gamma) {
+            terms.push_back(t);
+        }
+        if (implementation.numberOfAnds == 2) {
+            auto left = addAffine(circuit, implementation.l3, cut, implementation.alpha ? std::optional<NodeOutput>(t) : std::nullopt);
+            auto right = addAffine(circuit, implementation.l4, cut, implementation.beta ? std::optional<NodeOutput>(t) : std::nullopt);
+            terms.push_back(addGate(circuit, op::And, {left, right}));
+        }
+    }
+
+    // the root keeps its identifier, s.t. its users do not need to be changed
+    auto root = nodes_.at(rootID);
+    if (terms.empty()) {
+        setInputs(root, op::Constant, {});
+        root.setPayload(negate);
+        root.setConstantType(core::ir::PrimitiveType::Bool);
+        booleanGates_.erase(rootID);
+        cuts_.erase(rootID);
+        return;
+    }
+    if (terms.size() == 1 && !negate) {
+        if (terms[0].nodeID >= firstNewID && booleanGates_.contains(terms[0].nodeID)) {
+            // move the newly created gate into the root, the new gate remains unused
+            const auto& gate = nodes_.at(terms[0].nodeID);
+            std::vector<NodeOutput> inputs;
+            for (size_t input = 0; input < gate.getNumberOfInputs(); ++input) {
+                inputs.push_back(getInput(gate, input));
+            }
+            setInputs(root, gate.getOperation(), inputs);
+        } else {
+            // the root computes one of the leaves: forward its users after the resynthesis
+            forwardedNodes_.emplace_back(rootID, terms[0]);
+            return;
+        }
+    } else if (terms.size() == 1) {
+        setInputs(root, op::Not, {terms[0]});
+    } else {
+        NodeOutput accumulated = terms[0];
+        for (size_t term = 1; term + 1 < terms.size(); ++term) {
+            accumulated = addGate(circuit, op::Xor, {accumulated, terms[term]});
+        }
+        setInputs(root, negate ? op::Xnor : op::Xor, {accumulated, terms.back()});
+    }
+    cuts_[rootID] = {Cut{{rootID, 0}}, cut};
+}
+
+void MultiplicativeComplexityMinimizer::visit(core::CircuitObjectWrapper& circuit) {
+    using op = core::ir::PrimitiveOperation;
+    const auto& implementations = getMCOptimalImplementations();
+
+    successors_ = getNodeSuccessors(circuit);
+    nextID_ = circuit.getNextID();
+    std::vector<Identifier> topologicalOrder;
+    for (auto node : circuit) {
+        nodes_.emplace(node.getNodeID(), node);
+        topologicalOrder.push_back(node.getNodeID());
+    }
+
+    for (auto nodeID : topologicalOrder) {
+        const auto& node = nodes_.at(nodeID);
+        auto operation = node.getOperation();
+        bool isBinaryGate = operation == op::And || operation == op::Or || operation == op::Nand || operation == op::Nor ||
+                            operation == op::Xor || operation == op::Xnor;
+        bool isGate = (isBinaryGate && node.getNumberOfInputs() == 2) || (operation == op::Not && node.getNumberOfInputs() == 1);
+        if (!isGate || node.getNumberOfOutputs() != 1 || !isBooleanSignal({nodeID, 0})) {
+            continue;
+        }
+        bool hasBooleanInputs = true;
+        for (size_t input = 0; input < node.getNumberOfInputs(); ++input) {
+            hasBooleanInputs = hasBooleanInputs && isBooleanSignal(getInput(node, input));
+        }
+        if (!hasBooleanInputs) {
+            continue;
+        }
+        booleanGates_.insert(nodeID);
+        computeCuts(node);
+
+        // find the cut whose resynthesis removes the most non-linear gates
+        long bestGain = 0;
+        const Cut* bestCut = nullptr;
+        std::vector<Identifier> cone;
+        std::unordered_set<Identifier> visited;
+        for (const auto& cut : cuts_.at(nodeID)) {
+            if (cut.size() == 1 && cut[0].nodeID == nodeID) {
+                continue;
+            }
+            cone.clear();
+            visited.clear();
+            if (!collectCone(nodeID, cut, cone, visited)) {
+                continue;
+            }
+            auto truthTable = computeTruthTable(cone, cut);
+            long gain = static_cast<long>(countRemovableNonlinearGates(cone)) - implementations[truthTable].numberOfAnds;
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestCut = &cut;
+            }
+        }
+        if (bestCut != nullptr) {
+            Cut cut = *bestCut;
+            cone.clear();
+            visited.clear();
+            collectCone(nodeID, cut, cone, visited);
+            resynthesize(circuit, nodeID, cut, implementations[computeTruthTable(cone, cut)]);
+        }
+    }
+
+    // new gates have been appended at the end of the circuit
+    circuit.restoreTopologicalOrder();
+
+    RewriteContext context(circuit);
+    for (auto [nodeID, replacement] : forwardedNodes_) {
+        context.replaceAllUsesWith(nodeID, replacement);
+    }
+
+    // share non-linear gates that compute the same operation on the same inputs
+    std::map<std::tuple<op, NodeOutput, NodeOutput>, Identifier> nonlinearGates;
+    for (auto node : circuit) {
+        if (!isNonlinearOperation(node.getOperation()) || node.getNumberOfInputs() != 2 || node.getNumberOfOutputs() != 1) {
+            continue;
+        }
+        auto first = context.getInput(node, 0);
+        auto second = context.getInput(node, 1);
+        if (second < first) {
+            std::swap(first, second);
+        }
+        auto [it, inserted] = nonlinearGates.try_emplace({node.getOperation(), first, second}, node.getNodeID());
+        if (!inserted) {
+            context.replaceAllUsesWith(node.getNodeID(), NodeOutput{it->second, 0});
+        }
+    }
+
+    applyPeepholeRewrites(circuit);
+    eliminateDeadNodes(circuit);
+}
+
+/*
+Function Definitions from Header File
+ */
+
+size_t countNonlinearGates(const core::CircuitReadOnly& circuit) {
+    size_t numberOfNonlinearGates = 0;
+    circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+        if (isNonlinearOperation(node.getOperation())) {
+            numberOfNonlinearGates += node.getNumberOfOutputs();
+        }
+    });
+    return numberOfNonlinearGates;
+}
+
+MultiplicativeComplexityReport minimizeMultiplicativeComplexity(core::CircuitObjectWrapper& circuit) {
+    MultiplicativeComplexityReport report;
+    eliminateDeadNodes(circuit);
+    report.nonlinearGatesBefore = countNonlinearGates(circuit);
+    MultiplicativeComplexityMinimizer minimizer;
+    minimizer.visit(circuit);
+    report.nonlinearGatesAfter = countNonlinearGates(circuit);
+    return report;
+}
+
+MultiplicativeComplexityReport minimizeMultiplicativeComplexity(core::ModuleObjectWrapper& module) {
+    MultiplicativeComplexityReport report;
+    for (auto name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        auto circuitReport = minimizeMultiplicativeComplexity(circuit);
+        report.nonlinearGatesBefore += circuitReport.nonlinearGatesBefore;
+        report.nonlinearGatesAfter += circuitReport.nonlinearGatesAfter;
+    }
+    return report;
+}
+
+}  // namespace fuse::passes
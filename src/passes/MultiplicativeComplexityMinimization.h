@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_MULTIPLICATIVECOMPLEXITYMINIMIZATION_H
+#define FUSE_MULTIPLICATIVECOMPLEXITYMINIMIZATION_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Number of non-linear (And, Or, Nand, Nor) gates before and after the minimization.
+ */
+struct MultiplicativeComplexityReport {
+    size_t nonlinearGatesBefore = 0;
+    size_t nonlinearGatesAfter = 0;
+};
+
+/**
+ * @brief Counts the non-linear gates of the circuit, i.e. And, Or, Nand and Nor gates.
+ * SIMD nodes are counted once for every output.
+ */
+size_t countNonlinearGates(const core::CircuitReadOnly& circuit);
+
+/**
+ * @brief Reduces the number of non-linear gates in the Boolean parts of the circuit.
+ *
+ * As XOR gates are (almost) free in GMW and garbling schemes, every 3-input cut of a Boolean gate
+ * is resynthesized with a precomputed multiplicative complexity optimal XOR-AND implementation
+ * if this removes non-linear gates. Afterwards, identical non-linear gates are shared
+ * and the result is cleaned up by the peephole rewriter and the dead node elimination.
+ *
+ * @param circuit mutable circuit where the optimization is performed
+ * @return MultiplicativeComplexityReport the number of non-linear gates before and after the optimization
+ */
+MultiplicativeComplexityReport minimizeMultiplicativeComplexity(core::CircuitObjectWrapper& circuit);
+
+/**
+ * @brief Reduces the number of non-linear gates in every circuit inside the module.
+ */
+MultiplicativeComplexityReport minimizeMultiplicativeComplexity(core::ModuleObjectWrapper& module);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_MULTIPLICATIVECOMPLEXITYMINIMIZATION_H */
@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "OperandWidths.h"
+
+namespace fuse::passes {
+
+using op = core::ir::PrimitiveOperation;
+
+bool isBooleanGate(op operation) {
+    switch (operation) {
+        case op::And:
+        case op::Xor:
+        case op::Not:
+        case op::Or:
+        case op::Nand:
+        case op::Nor:
+        case op::Xnor:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t getPrimitiveTypeBitWidth(core::ir::PrimitiveType type) {
+    using pt = core::ir::PrimitiveType;
+    switch (type) {
+        case pt::Bool:
+            return 1;
+        case pt::Int8:
+        case pt::UInt8:
+            return 8;
+        case pt::Int16:
+        case pt::UInt16:
+            return 16;
+        case pt::Int64:
+        case pt::UInt64:
+        case pt::Double:
+            return 64;
+        default:
+            return 32;
+    }
+}
+
+size_t getOperandBitWidth(const core::NodeReadOnly& node) {
+    auto inputTypes = node.getInputDataTypes();
+    if (!inputTypes.empty() && inputTypes[0]->isPrimitiveType()) {
+        return getPrimitiveTypeBitWidth(inputTypes[0]->getPrimitiveType());
+    }
+    auto outputTypes = node.getOutputDataTypes();
+    if (node.getOperation() != op::Split && !outputTypes.empty() && outputTypes[0]->isPrimitiveType()) {
+        return getPrimitiveTypeBitWidth(outputTypes[0]->getPrimitiveType());
+    }
+    return isBooleanGate(node.getOperation()) || node.getOperation() == op::Merge ? 1 : 32;
+}
+
+}  // namespace fuse::passes
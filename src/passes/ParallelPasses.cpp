@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ParallelPasses.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "ParallelFor.h"
+
+namespace fuse::passes {
+
+namespace {
+
+void runOnCircuits(core::ModuleObjectWrapper& module, const std::vector<std::string>& names, const CircuitPass& pass, size_t numberOfThreads) {
+    core::util::parallelFor(
+        names.size(), [&](size_t i) {
+            auto circuit = module.getCircuitWithName(names[i]);
+            pass(circuit);
+        },
+        numberOfThreads);
+}
+
+}  // namespace
+
+void runOnAllCircuits(core::ModuleObjectWrapper& module, const CircuitPass& pass, size_t numberOfThreads) {
+    module.unpackAllCircuits(numberOfThreads);
+    runOnCircuits(module, module.getAllCircuitNames(), pass, numberOfThreads);
+}
+
+std::vector<std::vector<std::string>> getCallGraphLevels(const core::ModuleReadOnly& module) {
+    auto names = module.getAllCircuitNames();
+    const std::unordered_set<std::string> circuitNames(names.begin(), names.end());
+    std::unordered_map<std::string, std::unordered_set<std::string>> callees;
+    std::unordered_map<std::string, std::vector<std::string>> callers;
+    for (const auto& name : names) {
+        auto& circuitCallees = callees[name];
+        module.getCircuitWithName(name)->topologicalTraversal([&](core::NodeReadOnly& node) {
+            if ((node.isSubcircuitNode() || node.isLoopNode()) && circuitNames.contains(node.getSubCircuitName())) {
+                circuitCallees.insert(node.getSubCircuitName());
+            }
+        });
+        for (const auto& callee : circuitCallees) {
+            callers[callee].push_back(name);
+        }
+    }
+
+    // Kahn's algorithm on the reversed call graph, one level per round
+    std::unordered_map<std::string, size_t> remainingCallees;
+    std::vector<std::string> level;
+    for (const auto& name : names) {
+        remainingCallees[name] = callees[name].size();
+        if (callees[name].empty()) {
+            level.push_back(name);
+        }
+    }
+    std::vector<std::vector<std::string>> levels;
+    size_t numberOfPlacedCircuits = 0;
+    while (!level.empty()) {
+        std::vector<std::string> nextLevel;
+        for (const auto& callee : level) {
+            for (const auto& caller : callers[callee]) {
+                if (--remainingCallees[caller] == 0) {
+                    nextLevel.push_back(caller);
+                }
+            }
+        }
+        numberOfPlacedCircuits += level.size();
+        levels.push_back(std::move(level));
+        level = std::move(nextLevel);
+    }
+
+    // circuits on or depending on a call cycle
+    if (numberOfPlacedCircuits < names.size()) {
+        std::vector<std::string> remaining;
+        for (const auto& name : names) {
+            if (remainingCallees[name] > 0) {
+                remaining.push_back(name);
+            }
+        }
+        levels.push_back(std::move(remaining));
+    }
+    return levels;
+}
+
+void runInCallGraphOrder(core::ModuleObjectWrapper& module, const CircuitPass& pass, size_t numberOfThreads) {
+    module.unpackAllCircuits(numberOfThreads);
+    for (const auto& level : getCallGraphLevels(module)) {
+        runOnCircuits(module, level, pass, numberOfThreads);
+    }
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_PARALLELPASSES_H
+#define FUSE_PARALLELPASSES_H
+
+#include <functional>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+using CircuitPass = std::function<void(core::CircuitObjectWrapper&)>;
+
+/**
+ * @brief Runs an intra-circuit pass on every circuit of the module, on up to numberOfThreads circuits at once
+ * (all hardware threads if 0). All circuits are unpacked up front.
+ *
+ * The pass must only modify the circuit it is given, it may read other circuits of the module only if they are not modified concurrently.
+ */
+void runOnAllCircuits(core::ModuleObjectWrapper& module, const CircuitPass& pass, size_t numberOfThreads = 0);
+
+/**
+ * @brief Groups the circuits of the module into levels s.t. every circuit is in a later level than all circuits it calls
+ * or uses as loop body. Circuits that call each other recursively are put into one level after all others.
+ */
+std::vector<std::vector<std::string>> getCallGraphLevels(const core::ModuleReadOnly& module);
+
+/**
+ * @brief Runs a pass on every circuit of the module after it ran on all circuits called by the circuit,
+ * e.g. for passes that use the already optimized callees to decide about their calls.
+ * The circuits of one level of the call graph (see getCallGraphLevels) are processed concurrently.
+ */
+void runInCallGraphOrder(core::ModuleObjectWrapper& module, const CircuitPass& pass, size_t numberOfThreads = 0);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_PARALLELPASSES_H */
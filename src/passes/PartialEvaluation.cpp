@@ -0,0 +1,287 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "PartialEvaluation.h"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+
+#include "ConstantFolder.h"
+#include "DeadNodeEliminator.h"
+#include "PeepholeRewriter.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using Offset = uint32_t;
+using op = core::ir::PrimitiveOperation;
+
+template <typename T>
+PublicValue makePublicValue(core::ir::PrimitiveType type, std::vector<int64_t> shape, const T& value) {
+    // reuse the encoding of constant nodes
+    core::ir::NodeTableT node;
+    core::NodeObjectWrapper(&node).setPayload(value);
+    return {type, std::move(shape), std::move(node.payload)};
+}
+
+void turnIntoConstant(core::NodeObjectWrapper& node, const PublicValue& value) {
+    std::vector<Identifier> noInputs;
+    std::vector<Offset> noOffsets;
+    node.setPrimitiveOperation(op::Constant);
+    node.setInputNodeIDs(noInputs);
+    node.setInputOffsets(noOffsets);
+    node.setNumberOfOutputs(1);
+    node.setConstantType(value.type, value.shape);
+    node.setPayload(value.payload);
+}
+
+PublicValue getPublicValue(core::NodeObjectWrapper& constantNode) {
+    auto type = constantNode.getConstantType();
+    auto shape = type.getShape();
+    auto payload = constantNode.getPayload();
+    return {type.getPrimitiveType(), {shape.begin(), shape.end()}, {payload.begin(), payload.end()}};
+}
+
+// substitutes the known inputs and folds the circuit, without looking into calls
+void substituteInputs(core::CircuitObjectWrapper& circuit, const PublicInputs& knownInputs) {
+    auto inputs = circuit.getInputNodeIDs();
+    const std::unordered_set<Identifier> inputIDs(inputs.begin(), inputs.end());
+    std::unordered_set<Identifier> substituted;
+    for (const auto& [id, value] : knownInputs) {
+        if (!inputIDs.contains(id)) {
+            throw std::logic_error("Node " + std::to_string(id) + " is not an input of circuit " + circuit.getName());
+        }
+        auto node = circuit.getNodeWithID(id);
+        turnIntoConstant(node, value);
+        substituted.insert(id);
+    }
+    circuit.removeInputs(substituted);
+}
+
+// applies constant folding and peephole rewrites until neither changes the circuit anymore
+void simplify(core::CircuitObjectWrapper& circuit) {
+    do {
+        foldConstantNodes(circuit);
+    } while (applyPeepholeRewrites(circuit) > 0);
+    eliminateDeadNodes(circuit);
+}
+
+class PartialEvaluator {
+   public:
+    explicit PartialEvaluator(core::ModuleObjectWrapper& module) : module_(module) {}
+
+    void specialize(core::CircuitObjectWrapper& circuit, const PublicInputs& knownInputs) {
+        substituteInputs(circuit, knownInputs);
+        do {
+            simplify(circuit);
+        } while (specializeCalls(circuit));
+    }
+
+    size_t getNumberOfSpecializedCircuits() const { return specializations_.size(); }
+
+   private:
+    // the callee and its constant arguments by input position
+    using SpecializationKey = std::pair<std::string, std::map<size_t, std::tuple<core::ir::PrimitiveType, std::vector<int64_t>, std::vector<uint8_t>>>>;
+
+    struct Specialization {
+        std::string name;
+        // constant value of every output of the specialized callee, if it is constant
+        std::vector<std::optional<PublicValue>> constantOutputs;
+    };
+
+    // redirects calls with constant arguments to specialized callees, returns true if the circuit changed
+    bool specializeCalls(core::CircuitObjectWrapper& circuit) {
+        activeCircuits_.insert(circuit.getName());
+        bool changed = false;
+        std::unordered_map<Identifier, std::vector<std::optional<PublicValue>>> constantCallResults;
+        for (auto node : circuit) {
+            if (!node.isSubcircuitNode() || activeCircuits_.contains(node.getSubCircuitName())) {
+                continue;
+            }
+            auto callee = std::as_const(module_).getCircuitWithName(node.getSubCircuitName());
+            auto inputs = node.getInputNodeIDs();
+            auto offsets = node.getInputOffsets();
+            // SIMD calls pass several sets of inputs
+            if (inputs.size() != callee->getNumberOfInputs()) {
+                continue;
+            }
+
+            SpecializationKey key{node.getSubCircuitName(), {}};
+            PublicInputs calleeInputs;
+            std::vector<Identifier> remainingInputs;
+            std::vector<Offset> remainingOffsets;
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                auto input = circuit.getNodeWithID(inputs[i]);
+                const Offset offset = offsets.empty() ? 0 : offsets[i];
+                if (input.isConstantNode() && offset == 0) {
+                    auto value = getPublicValue(input);
+                    key.second.emplace(i, std::make_tuple(value.type, value.shape, value.payload));
+                    calleeInputs.emplace(callee->getInputNodeIDs()[i], std::move(value));
+                } else {
+                    remainingInputs.push_back(inputs[i]);
+                    remainingOffsets.push_back(offset);
+                }
+            }
+            if (calleeInputs.empty()) {
+                continue;
+            }
+
+            const auto& specialization = getSpecialization(key, calleeInputs);
+            const auto& outputs = specialization.constantOutputs;
+            if (remainingInputs.empty()) {
+                // a call without arguments is folded into its results, it becomes dead once they are forwarded
+                if (!std::all_of(outputs.begin(), outputs.end(), [](const auto& output) { return output.has_value(); })) {
+                    continue;
+                }
+            } else {
+                node.setSubCircuitName(specialization.name);
+                node.setInputNodeIDs(remainingInputs);
+                node.setInputOffsets(remainingOffsets);
+            }
+            if (std::any_of(outputs.begin(), outputs.end(), [](const auto& output) { return output.has_value(); })) {
+                constantCallResults.emplace(node.getNodeID(), outputs);
+            }
+            changed = true;
+        }
+        activeCircuits_.erase(circuit.getName());
+
+        if (!constantCallResults.empty()) {
+            forwardConstantResults(circuit, constantCallResults);
+        }
+        return changed;
+    }
+
+    const Specialization& getSpecialization(const SpecializationKey& key, const PublicInputs& calleeInputs) {
+        if (auto it = specializations_.find(key); it != specializations_.end()) {
+            return it->second;
+        }
+        const auto& calleeName = key.first;
+        std::string name;
+        auto names = module_.getAllCircuitNames();
+        const std::unordered_set<std::string> existingNames(names.begin(), names.end());
+        do {
+            name = calleeName + "_specialized_" + std::to_string(nextSpecializationNumber_++);
+        } while (existingNames.contains(name));
+
+        auto copy = module_.copyCircuit(calleeName, name);
+        // the copy must not be specialized within itself when the callee is recursive
+        activeCircuits_.insert(calleeName);
+        specialize(copy, calleeInputs);
+        activeCircuits_.erase(calleeName);
+
+        Specialization specialization{name, {}};
+        for (auto outputID : copy.getOutputNodeIDs()) {
+            auto output = copy.getNodeWithID(outputID);
+            std::optional<PublicValue> constant;
+            if (output.getNumberOfInputs() == 1 && (output.getInputOffsets().empty() || output.getInputOffsets()[0] == 0)) {
+                auto producer = copy.getNodeWithID(output.getInputNodeIDs()[0]);
+                if (producer.isConstantNode()) {
+                    constant = getPublicValue(producer);
+                }
+            }
+            specialization.constantOutputs.push_back(std::move(constant));
+        }
+        return specializations_.emplace(key, std::move(specialization)).first->second;
+    }
+
+    // replaces uses of constant call outputs by new constant nodes in the caller
+    static void forwardConstantResults(core::CircuitObjectWrapper& circuit,
+                                       const std::unordered_map<Identifier, std::vector<std::optional<PublicValue>>>& constantCallResults) {
+        // add the constants before rewiring, adding nodes invalidates iterators over the circuit
+        std::map<std::pair<Identifier, Offset>, Identifier> constantNodes;
+        for (const auto& [call, results] : constantCallResults) {
+            for (Offset offset = 0; offset < results.size(); ++offset) {
+                if (results[offset]) {
+                    auto constant = circuit.addNode();
+                    turnIntoConstant(constant, *results[offset]);
+                    constantNodes.emplace(std::make_pair(call, offset), constant.getNodeID());
+                }
+            }
+        }
+
+        for (auto node : circuit) {
+            auto ids = node.getInputNodeIDs();
+            auto offsets = node.getInputOffsets();
+            std::vector<Identifier> newIDs(ids.begin(), ids.end());
+            std::vector<Offset> newOffsets(ids.size(), 0);
+            bool usesConstantResult = false;
+            for (size_t i = 0; i < ids.size(); ++i) {
+                newOffsets[i] = offsets.empty() ? 0 : offsets[i];
+                if (auto constant = constantNodes.find({ids[i], newOffsets[i]}); constant != constantNodes.end()) {
+                    newIDs[i] = constant->second;
+                    newOffsets[i] = 0;
+                    usesConstantResult = true;
+                }
+            }
+            if (usesConstantResult) {
+                node.setInputNodeIDs(newIDs);
+                node.setInputOffsets(newOffsets);
+            }
+        }
+        // the new constants have been added at the end
+        circuit.restoreTopologicalOrder();
+    }
+
+    core::ModuleObjectWrapper& module_;
+    std::map<SpecializationKey, Specialization> specializations_;
+    std::unordered_set<std::string> activeCircuits_;
+    size_t nextSpecializationNumber_ = 0;
+};
+
+}  // namespace
+
+PublicValue PublicValue::fromBool(bool value) { return makePublicValue(core::ir::PrimitiveType::Bool, {}, value); }
+
+PublicValue PublicValue::fromUnsigned(core::ir::PrimitiveType type, uint64_t value) { return makePublicValue(type, {}, value); }
+
+PublicValue PublicValue::fromSigned(core::ir::PrimitiveType type, int64_t value) { return makePublicValue(type, {}, value); }
+
+PublicValue PublicValue::fromBoolVector(const std::vector<bool>& values) {
+    return makePublicValue(core::ir::PrimitiveType::Bool, {static_cast<int64_t>(values.size())}, values);
+}
+
+PublicValue PublicValue::fromUnsignedVector(core::ir::PrimitiveType type, const std::vector<uint64_t>& values) {
+    return makePublicValue(type, {static_cast<int64_t>(values.size())}, values);
+}
+
+size_t evaluatePartially(core::CircuitObjectWrapper& circuit, const PublicInputs& knownInputs) {
+    const size_t numberOfNodes = circuit.getNumberOfNodes();
+    substituteInputs(circuit, knownInputs);
+    simplify(circuit);
+    return numberOfNodes - circuit.getNumberOfNodes();
+}
+
+size_t evaluatePartially(core::ModuleObjectWrapper& module, const PublicInputs& knownInputs) {
+    PartialEvaluator evaluator(module);
+    auto entryCircuit = module.getEntryCircuit();
+    evaluator.specialize(entryCircuit, knownInputs);
+    return evaluator.getNumberOfSpecializedCircuits();
+}
+
+}  // namespace fuse::passes
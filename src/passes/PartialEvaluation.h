@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_PARTIALEVALUATION_H
+#define FUSE_PARTIALEVALUATION_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief A value that is known at compile time, stored like the payload of constant nodes.
+ */
+struct PublicValue {
+    core::ir::PrimitiveType type;
+    // empty for scalars
+    std::vector<int64_t> shape;
+    // finished flexbuffer
+    std::vector<uint8_t> payload;
+
+    static PublicValue fromBool(bool value);
+    static PublicValue fromUnsigned(core::ir::PrimitiveType type, uint64_t value);
+    static PublicValue fromSigned(core::ir::PrimitiveType type, int64_t value);
+    static PublicValue fromBoolVector(const std::vector<bool>& values);
+    static PublicValue fromUnsignedVector(core::ir::PrimitiveType type, const std::vector<uint64_t>& values);
+};
+
+/**
+ * @brief Maps the IDs of input nodes to their known values.
+ */
+using PublicInputs = std::unordered_map<uint64_t, PublicValue>;
+
+/**
+ * @brief Specializes the circuit for the known inputs: the inputs become constant nodes and are removed from the circuit's inputs,
+ * then constant folding and the peephole rewrites are applied until nothing changes anymore and dead nodes are removed.
+ *
+ * @return the number of nodes that have been removed from the circuit
+ * @throws std::logic_error if one of the IDs is not an input of the circuit
+ */
+size_t evaluatePartially(core::CircuitObjectWrapper& circuit, const PublicInputs& knownInputs);
+
+/**
+ * @brief Specializes the entry circuit of the module for the known inputs like evaluatePartially(core::CircuitObjectWrapper&, const PublicInputs&),
+ * and propagates constants across calls.
+ *
+ * Calls with constant arguments are redirected to a copy of the callee that is specialized for these arguments and no longer receives them,
+ * one copy per callee and distinct constant arguments. Outputs of specialized callees that turn out constant are substituted in the caller,
+ * which may enable further folding there. Calls whose arguments are all constant are replaced by their results if these are constant,
+ * and are kept as they are otherwise, so no call without arguments is created. SIMD and recursive calls are not specialized.
+ * Callees that are no longer called can be removed with eliminateDeadNodes(module, true).
+ *
+ * @return the number of specialized circuits that have been added to the module
+ */
+size_t evaluatePartially(core::ModuleObjectWrapper& module, const PublicInputs& knownInputs);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_PARTIALEVALUATION_H */
@@ -0,0 +1,510 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "PeepholeRewriter.h"
+
+#include <deque>
+
+#include "DeadNodeEliminator.h"
+#include "NodeSuccessorsAnalysis.h"
+
+namespace fuse::passes {
+
+/*
+RewriteContext Member Functions
+ */
+
+RewriteContext::RewriteContext(core::CircuitObjectWrapper& circuit) : successors_(getNodeSuccessors(circuit)) {
+    for (auto node : circuit) {
+        nodes_.emplace(node.getNodeID(), node);
+    }
+}
+
+core::NodeObjectWrapper RewriteContext::getNode(Identifier nodeID) const {
+    auto it = nodes_.find(nodeID);
+    if (it == nodes_.end()) {
+        throw std::logic_error("Node could not be found with ID: " + std::to_string(nodeID));
+    }
+    return it->second;
+}
+
+NodeOutput RewriteContext::getInput(const core::NodeReadOnly& node, size_t inputNumber) const {
+    Identifier inputID = node.getInputNodeIDs()[inputNumber];
+    Offset inputOffset = node.usesInputOffsets() ? node.getInputOffsets()[inputNumber] : 0;
+    return {inputID, inputOffset};
+}
+
+std::optional<flexbuffers::Reference> RewriteContext::getConstantInput(const core::NodeReadOnly& node, size_t inputNumber) const {
+    auto input = getInput(node, inputNumber);
+    auto inputNode = getNode(input.nodeID);
+    if (!inputNode.isConstantNode()) {
+        return std::nullopt;
+    }
+    auto constant = inputNode.getConstantFlexbuffer();
+    if (constant.IsAnyVector()) {
+        auto vector = constant.AsVector();
+        if (input.offset >= vector.size()) {
+            return std::nullopt;
+        }
+        return vector[input.offset];
+    }
+    return constant;
+}
+
+bool RewriteContext::hasIdenticalInputs(const core::NodeReadOnly& node, size_t firstInput, size_t secondInput) const {
+    auto first = getInput(node, firstInput);
+    auto second = getInput(node, secondInput);
+    return first.nodeID == second.nodeID && first.offset == second.offset;
+}
+
+void RewriteContext::replaceAllUsesWith(Identifier nodeID, const std::vector<NodeOutput>& replacement) {
+    auto successorIt = successors_.find(nodeID);
+    if (successorIt == successors_.end()) {
+        return;
+    }
+    auto users = std::move(successorIt->second);
+    successors_.erase(successorIt);
+
+    for (auto userID : users) {
+        auto user = getNode(userID);
+        auto userInputs = user.getInputNodeIDs();
+        std::vector<Identifier> inputIDs(userInputs.begin(), userInputs.end());
+        std::vector<Offset> inputOffsets;
+        if (user.usesInputOffsets()) {
+            auto userOffsets = user.getInputOffsets();
+            inputOffsets.assign(userOffsets.begin(), userOffsets.end());
+        } else {
+            inputOffsets.assign(inputIDs.size(), 0);
+        }
+
+        bool changed = false;
+        for (size_t input = 0; input < inputIDs.size(); ++input) {
+            if (inputIDs[input] == nodeID) {
+                const auto& newInput = replacement.at(inputOffsets[input]);
+                inputIDs[input] = newInput.nodeID;
+                inputOffsets[input] = newInput.offset;
+                successors_[newInput.nodeID].insert(userID);
+                changed = true;
+            }
+        }
+        if (changed) {
+            user.setInputNodeIDs(inputIDs);
+            user.setInputOffsets(inputOffsets);
+            changedNodes_.push_back(userID);
+        }
+    }
+}
+
+void RewriteContext::replaceAllUsesWith(Identifier nodeID, NodeOutput replacement) {
+    replaceAllUsesWith(nodeID, std::vector<NodeOutput>{replacement});
+}
+
+void RewriteContext::replaceByZeroConstant(core::NodeObjectWrapper& node, core::ir::PrimitiveType primitiveType) {
+    using pt = core::ir::PrimitiveType;
+    Identifier nodeID = node.getNodeID();
+    for (auto input : node.getInputNodeIDs()) {
+        successors_[input].erase(nodeID);
+    }
+
+    node.setInputNodeIDs({});
+    node.setInputOffsets({});
+    node.setPrimitiveOperation(core::ir::PrimitiveOperation::Constant);
+    switch (primitiveType) {
+        case pt::Bool:
+            node.setPayload(false);
+            break;
+        case pt::Int8:
+        case pt::Int16:
+        case pt::Int32:
+        case pt::Int64:
+            node.setPayload(int64_t{0});
+            break;
+        case pt::UInt8:
+        case pt::UInt16:
+        case pt::UInt32:
+        case pt::UInt64:
+            node.setPayload(uint64_t{0});
+            break;
+        case pt::Float:
+            node.setPayload(0.0f);
+            break;
+        case pt::Double:
+            node.setPayload(0.0);
+            break;
+        default:
+            std::string dtName = core::ir::EnumNamePrimitiveType(primitiveType);
+            throw std::logic_error("unexpected datatype for constant: " + dtName);
+    }
+    node.setConstantType(primitiveType);
+
+    // the node itself and all of its users may now be simplified further
+    changedNodes_.push_back(nodeID);
+    if (successors_.contains(nodeID)) {
+        changedNodes_.insert(changedNodes_.end(), successors_[nodeID].begin(), successors_[nodeID].end());
+    }
+}
+
+std::optional<core::ir::PrimitiveType> RewriteContext::getOutputPrimitiveType(const core::NodeReadOnly& node) const {
+    auto outputTypes = node.getOutputDataTypes();
+    if (!outputTypes.empty()) {
+        return outputTypes[0]->getPrimitiveType();
+    }
+    if (node.getNumberOfInputs() == 0) {
+        return std::nullopt;
+    }
+    auto input = getInput(node, 0);
+    const auto inputNode = getNode(input.nodeID);
+    auto inputTypes = static_cast<const core::NodeReadOnly&>(inputNode).getOutputDataTypes();
+    if (inputTypes.size() > input.offset) {
+        return inputTypes[input.offset]->getPrimitiveType();
+    } else if (inputTypes.size() == 1) {
+        // nodes with several outputs of the same type only annotate it once, e.g. Split
+        return inputTypes[0]->getPrimitiveType();
+    }
+    return std::nullopt;
+}
+
+std::vector<RewriteContext::Identifier> RewriteContext::takeChangedNodes() {
+    std::vector<Identifier> result;
+    result.swap(changedNodes_);
+    return result;
+}
+
+/*
+Built-in Rewrite Rules
+ */
+
+namespace {
+
+bool isZero(const flexbuffers::Reference& value) {
+    if (value.IsBool()) {
+        return !value.AsBool();
+    } else if (value.IsInt()) {
+        return value.AsInt64() == 0;
+    } else if (value.IsUInt()) {
+        return value.AsUInt64() == 0;
+    } else if (value.IsFloat()) {
+        return value.AsDouble() == 0.0;
+    }
+    return false;
+}
+
+bool isOne(const flexbuffers::Reference& value) {
+    if (value.IsBool()) {
+        return value.AsBool();
+    } else if (value.IsInt()) {
+        return value.AsInt64() == 1;
+    } else if (value.IsUInt()) {
+        return value.AsUInt64() == 1;
+    } else if (value.IsFloat()) {
+        return value.AsDouble() == 1.0;
+    }
+    return false;
+}
+
+// x AND true / x OR true are only identities for single bits, not for bitwise operations on integers
+bool isBooleanTrue(const flexbuffers::Reference& value, const core::NodeReadOnly& node, const RewriteContext& context) {
+    if (value.IsBool()) {
+        return value.AsBool();
+    }
+    return isOne(value) && context.getOutputPrimitiveType(node) == core::ir::PrimitiveType::Bool;
+}
+
+bool isScalarBinaryNode(const core::NodeReadOnly& node) {
+    return node.getNumberOfInputs() == 2 && node.getNumberOfOutputs() == 1;
+}
+
+bool isScalarUnaryNode(const core::NodeReadOnly& node) {
+    return node.getNumberOfInputs() == 1 && node.getNumberOfOutputs() == 1;
+}
+
+/**
+ * @brief Forwards the node to one of its inputs if the other input is a constant satisfying the predicate.
+ *
+ * @param forwardToConstant forward to the constant input instead of the other input, e.g. for x AND 0 = 0
+ * @param commutative also check the first input for the constant
+ */
+bool forwardOnConstantInput(core::NodeObjectWrapper& node, RewriteContext& context,
+                            std::function<bool(const flexbuffers::Reference&)> predicate,
+                            bool forwardToConstant, bool commutative = true) {
+    if (!isScalarBinaryNode(node)) {
+        return false;
+    }
+    for (size_t constantInput : {size_t{1}, size_t{0}}) {
+        if (constantInput == 0 && !commutative) {
+            break;
+        }
+        auto constant = context.getConstantInput(node, constantInput);
+        if (constant && predicate(*constant)) {
+            size_t forwardedInput = forwardToConstant ? constantInput : 1 - constantInput;
+            context.replaceAllUsesWith(node.getNodeID(), context.getInput(node, forwardedInput));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool forwardOnIdenticalInputs(core::NodeObjectWrapper& node, RewriteContext& context) {
+    if (!isScalarBinaryNode(node) || !context.hasIdenticalInputs(node, 0, 1)) {
+        return false;
+    }
+    context.replaceAllUsesWith(node.getNodeID(), context.getInput(node, 0));
+    return true;
+}
+
+bool zeroOnIdenticalInputs(core::NodeObjectWrapper& node, RewriteContext& context, std::optional<core::ir::PrimitiveType> defaultType) {
+    if (!isScalarBinaryNode(node) || !context.hasIdenticalInputs(node, 0, 1)) {
+        return false;
+    }
+    auto primitiveType = context.getOutputPrimitiveType(node);
+    if (!primitiveType) {
+        primitiveType = defaultType;
+    }
+    if (!primitiveType) {
+        return false;
+    }
+    context.replaceByZeroConstant(node, *primitiveType);
+    return true;
+}
+
+}  // namespace
+
+std::vector<RewriteRule> getDefaultRewriteRules() {
+    using op = core::ir::PrimitiveOperation;
+    using Reference = flexbuffers::Reference;
+    std::vector<RewriteRule> rules;
+
+    // Boolean identities
+    rules.push_back({"and-zero", op::And, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isZero, true);
+                     }});
+    rules.push_back({"and-true", op::And, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(
+                             node, context, [&](const Reference& value) { return isBooleanTrue(value, node, context); }, false);
+                     }});
+    rules.push_back({"and-idempotent", op::And, forwardOnIdenticalInputs});
+    rules.push_back({"or-zero", op::Or, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isZero, false);
+                     }});
+    rules.push_back({"or-true", op::Or, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(
+                             node, context, [&](const Reference& value) { return isBooleanTrue(value, node, context); }, true);
+                     }});
+    rules.push_back({"or-idempotent", op::Or, forwardOnIdenticalInputs});
+    rules.push_back({"xor-zero", op::Xor, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isZero, false);
+                     }});
+    rules.push_back({"xor-self", op::Xor, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         // Bristol circuits do not annotate their gates: XOR without any type information is Boolean
+                         return zeroOnIdenticalInputs(node, context, core::ir::PrimitiveType::Bool);
+                     }});
+    rules.push_back({"not-not", op::Not, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         if (!isScalarUnaryNode(node)) {
+                             return false;
+                         }
+                         auto inputNode = context.getNode(context.getInput(node, 0).nodeID);
+                         if (inputNode.getOperation() != op::Not || !isScalarUnaryNode(inputNode)) {
+                             return false;
+                         }
+                         context.replaceAllUsesWith(node.getNodeID(), context.getInput(inputNode, 0));
+                         return true;
+                     }});
+
+    // Mux(cond, a, b) = cond ? a : b
+    rules.push_back({"mux-identical-branches", op::Mux, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         if (node.getNumberOfInputs() != 3 || node.getNumberOfOutputs() != 1 || !context.hasIdenticalInputs(node, 1, 2)) {
+                             return false;
+                         }
+                         context.replaceAllUsesWith(node.getNodeID(), context.getInput(node, 1));
+                         return true;
+                     }});
+    rules.push_back({"mux-constant-condition", op::Mux, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         if (node.getNumberOfInputs() != 3 || node.getNumberOfOutputs() != 1) {
+                             return false;
+                         }
+                         auto condition = context.getConstantInput(node, 0);
+                         if (!condition || !(isZero(*condition) || isOne(*condition))) {
+                             return false;
+                         }
+                         context.replaceAllUsesWith(node.getNodeID(), context.getInput(node, isZero(*condition) ? 2 : 1));
+                         return true;
+                     }});
+
+    // arithmetic identities
+    rules.push_back({"add-zero", op::Add, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isZero, false);
+                     }});
+    rules.push_back({"sub-zero", op::Sub, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isZero, false, false);
+                     }});
+    rules.push_back({"sub-self", op::Sub, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return zeroOnIdenticalInputs(node, context, std::nullopt);
+                     }});
+    rules.push_back({"mul-zero", op::Mul, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         // x * 0 is not necessarily 0 for floating point values (NaN, infinity)
+                         return forwardOnConstantInput(
+                             node, context, [](const Reference& value) { return !value.IsFloat() && isZero(value); }, true);
+                     }});
+    rules.push_back({"mul-one", op::Mul, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isOne, false);
+                     }});
+    rules.push_back({"div-one", op::Div, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         return forwardOnConstantInput(node, context, isOne, false, false);
+                     }});
+
+    // SelectOffset, Split and Merge chains
+    rules.push_back({"select-offset", op::SelectOffset, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         if (!isScalarUnaryNode(node)) {
+                             return false;
+                         }
+                         context.replaceAllUsesWith(node.getNodeID(), context.getInput(node, 0));
+                         return true;
+                     }});
+    rules.push_back({"split-of-merge", op::Split, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         // Split(Merge(b_0, ..., b_n-1)) at offset i = b_i
+                         if (node.getNumberOfInputs() != 1) {
+                             return false;
+                         }
+                         auto mergeNode = context.getNode(context.getInput(node, 0).nodeID);
+                         if (mergeNode.getOperation() != op::Merge || mergeNode.getNumberOfInputs() != node.getNumberOfOutputs()) {
+                             return false;
+                         }
+                         std::vector<NodeOutput> bits;
+                         for (size_t bit = 0; bit < mergeNode.getNumberOfInputs(); ++bit) {
+                             bits.push_back(context.getInput(mergeNode, bit));
+                         }
+                         context.replaceAllUsesWith(node.getNodeID(), bits);
+                         return true;
+                     }});
+    rules.push_back({"merge-of-split", op::Merge, [](core::NodeObjectWrapper& node, RewriteContext& context) {
+                         // Merge(Split(x)[0], ..., Split(x)[n-1]) = x
+                         if (node.getNumberOfInputs() == 0 || node.getNumberOfOutputs() != 1) {
+                             return false;
+                         }
+                         auto splitID = context.getInput(node, 0).nodeID;
+                         auto splitNode = context.getNode(splitID);
+                         if (splitNode.getOperation() != op::Split || splitNode.getNumberOfInputs() != 1 ||
+                             splitNode.getNumberOfOutputs() != node.getNumberOfInputs()) {
+                             return false;
+                         }
+                         for (size_t bit = 0; bit < node.getNumberOfInputs(); ++bit) {
+                             auto input = context.getInput(node, bit);
+                             if (input.nodeID != splitID || input.offset != bit) {
+                                 return false;
+                             }
+                         }
+                         auto value = context.getInput(splitNode, 0);
+                         // only forward if the merged value has the same type as the value that was split
+                         auto mergedType = context.getOutputPrimitiveType(node);
+                         auto splitType = context.getOutputPrimitiveType(context.getNode(value.nodeID));
+                         if (mergedType && splitType && *mergedType != *splitType) {
+                             return false;
+                         }
+                         context.replaceAllUsesWith(node.getNodeID(), value);
+                         return true;
+                     }});
+
+    return rules;
+}
+
+/*
+PeepholeRewriter: applies the rules with a worklist until a fixpoint is reached
+ */
+
+class PeepholeRewriter {
+    using Identifier = uint64_t;
+
+   public:
+    explicit PeepholeRewriter(const std::vector<RewriteRule>& rules);
+    size_t visit(core::CircuitObjectWrapper& circuit);
+
+   private:
+    std::unordered_map<core::ir::PrimitiveOperation, std::vector<const RewriteRule*>> rulesByOperation_;
+};
+
+PeepholeRewriter::PeepholeRewriter(const std::vector<RewriteRule>& rules) {
+    for (const auto& rule : rules) {
+        rulesByOperation_[rule.operation].push_back(&rule);
+    }
+}
+
+size_t PeepholeRewriter::visit(core::CircuitObjectWrapper& circuit) {
+    RewriteContext context(circuit);
+    std::deque<Identifier> worklist;
+    std::unordered_set<Identifier> queued;
+    for (auto node : circuit) {
+        worklist.push_back(node.getNodeID());
+        queued.insert(node.getNodeID());
+    }
+
+    size_t numberOfRewrites = 0;
+    while (!worklist.empty()) {
+        Identifier nodeID = worklist.front();
+        worklist.pop_front();
+        queued.erase(nodeID);
+
+        auto node = context.getNode(nodeID);
+        auto rules = rulesByOperation_.find(node.getOperation());
+        if (rules == rulesByOperation_.end()) {
+            continue;
+        }
+        for (const auto* rule : rules->second) {
+            if (rule->rewrite(node, context)) {
+                ++numberOfRewrites;
+                break;
+            }
+        }
+        // revisit all nodes whose inputs have changed by the rewrite
+        for (auto changedNode : context.takeChangedNodes()) {
+            if (queued.insert(changedNode).second) {
+                worklist.push_back(changedNode);
+            }
+        }
+    }
+
+    // forwarded nodes are not used anymore
+    if (numberOfRewrites > 0) {
+        eliminateDeadNodes(circuit);
+    }
+    return numberOfRewrites;
+}
+
+/*
+Function Definitions from Header File: Setup PeepholeRewriter and call visit
+ */
+
+size_t applyPeepholeRewrites(core::CircuitObjectWrapper& circuit, const std::vector<RewriteRule>& rules) {
+    PeepholeRewriter rewriter(rules);
+    return rewriter.visit(circuit);
+}
+
+size_t applyPeepholeRewrites(core::ModuleObjectWrapper& module, const std::vector<RewriteRule>& rules) {
+    PeepholeRewriter rewriter(rules);
+    size_t numberOfRewrites = 0;
+    for (auto name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        numberOfRewrites += rewriter.visit(circuit);
+    }
+    return numberOfRewrites;
+}
+
+}  // namespace fuse::passes
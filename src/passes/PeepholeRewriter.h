@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_PEEPHOLEREWRITER_H
+#define FUSE_PEEPHOLEREWRITER_H
+
+#include <compare>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Refers to one output of a node: the node's identifier and the output's offset.
+ */
+struct NodeOutput {
+    uint64_t nodeID;
+    uint32_t offset = 0;
+
+    auto operator<=>(const NodeOutput&) const = default;
+};
+
+/**
+ * @brief Gives rewrite rules access to the circuit they are applied on.
+ *
+ * The context keeps an index from identifiers to nodes and the successors of every node,
+ * so that rules can query their inputs and forward their uses in constant time.
+ * All changes performed through the context are recorded, so that the rewriter can revisit affected nodes.
+ */
+class RewriteContext {
+    using Identifier = uint64_t;
+    using Offset = uint32_t;
+
+   public:
+    explicit RewriteContext(core::CircuitObjectWrapper& circuit);
+
+    core::NodeObjectWrapper getNode(Identifier nodeID) const;
+
+    /// returns the node and offset the given input of the node refers to
+    NodeOutput getInput(const core::NodeReadOnly& node, size_t inputNumber) const;
+
+    /// returns the constant value of the given input if the input is produced by a constant node
+    std::optional<flexbuffers::Reference> getConstantInput(const core::NodeReadOnly& node, size_t inputNumber) const;
+
+    /// true if both inputs of the node refer to the same output of the same node
+    bool hasIdenticalInputs(const core::NodeReadOnly& node, size_t firstInput, size_t secondInput) const;
+
+    /**
+     * @brief Replaces every use of the node's outputs: uses of output i are redirected to replacement[i].
+     * Afterwards, the node is not used anymore and can be removed by a dead node elimination.
+     */
+    void replaceAllUsesWith(Identifier nodeID, const std::vector<NodeOutput>& replacement);
+    void replaceAllUsesWith(Identifier nodeID, NodeOutput replacement);
+
+    /// turns the node into a constant node with the value zero of the given type
+    void replaceByZeroConstant(core::NodeObjectWrapper& node, core::ir::PrimitiveType primitiveType);
+
+    /// returns the primitive type of the node's output, falling back to the type of its first input, or std::nullopt if neither is annotated
+    std::optional<core::ir::PrimitiveType> getOutputPrimitiveType(const core::NodeReadOnly& node) const;
+
+    /// returns and clears the identifiers of all nodes that have been changed since the last call
+    std::vector<Identifier> takeChangedNodes();
+
+   private:
+    std::unordered_map<Identifier, core::NodeObjectWrapper> nodes_;
+    std::unordered_map<Identifier, std::unordered_set<Identifier>> successors_;
+    std::vector<Identifier> changedNodes_;
+};
+
+/**
+ * @brief A rewrite rule that is tried on every node with the given operation.
+ *
+ * The rewrite function returns true if it changed the circuit.
+ * It must only use the context to forward uses to nodes that precede the node,
+ * so that the topological order of the circuit is preserved.
+ */
+struct RewriteRule {
+    std::string name;
+    core::ir::PrimitiveOperation operation;
+    std::function<bool(core::NodeObjectWrapper& node, RewriteContext& context)> rewrite;
+};
+
+/**
+ * @brief Returns the built-in Boolean and arithmetic identities, e.g. x AND 0 = 0, x XOR x = 0, NOT NOT x = x,
+ * Mux(c, a, a) = a, x + 0 = x, x * 1 = x, and the forwarding of SelectOffset, Split and Merge chains.
+ */
+std::vector<RewriteRule> getDefaultRewriteRules();
+
+/**
+ * @brief Applies the rewrite rules on the circuit until no rule can be applied anymore.
+ *
+ * Uses a worklist that initially contains all nodes and afterwards only the nodes affected by a rewrite,
+ * and eliminates the nodes that became dead afterwards.
+ *
+ * @param circuit mutable circuit where the rewrites are performed
+ * @param rules rules to apply, the built-in identities if not specified
+ * @return size_t the number of rewrites that have been applied
+ */
+size_t applyPeepholeRewrites(core::CircuitObjectWrapper& circuit, const std::vector<RewriteRule>& rules = getDefaultRewriteRules());
+
+/**
+ * @brief Applies the rewrite rules on every circuit inside the module.
+ */
+size_t applyPeepholeRewrites(core::ModuleObjectWrapper& module, const std::vector<RewriteRule>& rules = getDefaultRewriteRules());
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_PEEPHOLEREWRITER_H */
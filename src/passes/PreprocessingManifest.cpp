@@ -0,0 +1,310 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "PreprocessingManifest.h"
+
+#include <array>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "CostEstimation.h"
+#include "LoopUnrolling.h"
+#include "OperandWidths.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using op = core::ir::PrimitiveOperation;
+using Identifier = uint64_t;
+using Offset = uint32_t;
+
+// key length of the garbled circuits in BMR
+constexpr size_t kBmrKeyLength = 128;
+
+constexpr std::array<PreprocessingResource, 5> kResources{PreprocessingResource::BooleanTriple, PreprocessingResource::ArithmeticTriple,
+                                                          PreprocessingResource::SquarePair, PreprocessingResource::SharedBit,
+                                                          PreprocessingResource::ObliviousTransfer};
+
+// number of AND gates of the Boolean circuit that evaluates the operation on w-bit operands
+uint64_t getNumberOfAndGates(op operation, uint64_t w) {
+    switch (operation) {
+        case op::And:
+        case op::Or:
+        case op::Nand:
+        case op::Nor:
+        case op::Mux:
+        case op::Gt:
+        case op::Ge:
+        case op::Lt:
+        case op::Le:
+            return w;
+        case op::Add:
+        case op::Sub:
+        case op::Neg:
+        case op::Eq:
+            return w > 0 ? w - 1 : 0;
+        case op::Mul:
+        case op::Square:
+            return w * w;
+        case op::Div:
+            return 2 * w * w;
+        default:
+            return 0;
+    }
+}
+
+// constants can be combined with any protocol, calls, loops and custom operations are not evaluated in a single protocol
+bool hasProtocol(const core::NodeReadOnly& node) {
+    switch (node.getOperation()) {
+        case op::Constant:
+        case op::CallSubcircuit:
+        case op::Loop:
+        case op::Custom:
+            return false;
+        default:
+            return true;
+    }
+}
+
+size_t getOutputBitWidth(const core::NodeReadOnly& node) {
+    auto outputTypes = node.getOutputDataTypes();
+    if (!outputTypes.empty() && outputTypes[0]->isPrimitiveType()) {
+        return getPrimitiveTypeBitWidth(outputTypes[0]->getPrimitiveType());
+    }
+    switch (node.getOperation()) {
+        case op::Split:
+        case op::Gt:
+        case op::Ge:
+        case op::Lt:
+        case op::Le:
+        case op::Eq:
+            return 1;
+        case op::Merge:
+            return node.getNumberOfInputs();
+        default:
+            return getOperandBitWidth(node);
+    }
+}
+
+MpcProtocol getNodeProtocol(const core::NodeReadOnly& node, MpcProtocol defaultProtocol) {
+    auto name = node.getStringValueForAttribute(kProtocolAttribute);
+    if (name.empty()) {
+        return defaultProtocol;
+    }
+    auto protocol = getProtocolFromName(name);
+    if (!protocol) {
+        throw std::logic_error("Unknown protocol " + name + " at node " + std::to_string(node.getNodeID()));
+    }
+    return *protocol;
+}
+
+void addAndGates(PreprocessingManifest& manifest, MpcProtocol protocol, size_t simdWidth, uint64_t numberOfAndGates) {
+    if (numberOfAndGates == 0) {
+        return;
+    }
+    if (protocol == MpcProtocol::BooleanGmw) {
+        manifest.add(PreprocessingResource::BooleanTriple, 1, simdWidth, numberOfAndGates);
+    } else if (protocol == MpcProtocol::Bmr) {
+        manifest.add(PreprocessingResource::ObliviousTransfer, kBmrKeyLength, simdWidth, numberOfAndGates);
+    }
+}
+
+class ManifestBuilder {
+   public:
+    ManifestBuilder(const core::ModuleReadOnly* module, MpcProtocol defaultProtocol) : module_(module), defaultProtocol_(defaultProtocol) {}
+
+    PreprocessingManifest build(const core::CircuitReadOnly& circuit) {
+        PreprocessingManifest manifest;
+        struct Producer {
+            MpcProtocol protocol;
+            size_t bitWidth;
+        };
+        std::unordered_map<Identifier, Producer> producers;
+        std::set<std::tuple<Identifier, Offset, MpcProtocol>> convertedValues;
+
+        circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+            if (node.isSubcircuitNode() || node.isLoopNode()) {
+                const auto& callee = getCalleeManifest(node.getSubCircuitName());
+                // SIMD calls evaluate the callee once on all lanes
+                size_t lanes = 1;
+                if (node.isSubcircuitNode() && callee.numberOfInputs > 0) {
+                    lanes = std::max<size_t>(node.getNumberOfInputs() / callee.numberOfInputs, 1);
+                }
+                const size_t iterations = node.isLoopNode() ? getNumberOfIterations(node) : 1;
+                for (const auto& [demand, count] : callee.manifest.demands) {
+                    manifest.add(demand.resource, demand.bitWidth, demand.simdWidth * lanes, iterations * count);
+                }
+                return;
+            }
+            if (!hasProtocol(node)) {
+                return;
+            }
+
+            const auto protocol = getNodeProtocol(node, defaultProtocol_);
+            auto inputs = node.getInputNodeIDs();
+            auto offsets = node.getInputOffsets();
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                auto producer = producers.find(inputs[i]);
+                if (producer == producers.end() || producer->second.protocol == protocol) {
+                    continue;
+                }
+                if (!convertedValues.emplace(inputs[i], offsets.empty() ? 0 : offsets[i], protocol).second) {
+                    continue;
+                }
+                addConversion(manifest, producer->second.protocol, protocol, producer->second.bitWidth);
+            }
+
+            const size_t bitWidth = getOperandBitWidth(node);
+            const size_t lanes = getNumberOfLanes(node);
+            if (protocol == MpcProtocol::ArithmeticGmw) {
+                if (node.getOperation() == op::Mul) {
+                    manifest.add(PreprocessingResource::ArithmeticTriple, bitWidth, lanes, 1);
+                } else if (node.getOperation() == op::Square) {
+                    manifest.add(PreprocessingResource::SquarePair, bitWidth, lanes, 1);
+                }
+            } else {
+                addAndGates(manifest, protocol, lanes, getNumberOfAndGates(node.getOperation(), bitWidth));
+            }
+            producers[node.getNodeID()] = {protocol, getOutputBitWidth(node)};
+        });
+        return manifest;
+    }
+
+   private:
+    struct Callee {
+        PreprocessingManifest manifest;
+        size_t numberOfInputs;
+    };
+
+    const Callee& getCalleeManifest(const std::string& name) {
+        if (auto it = callees_.find(name); it != callees_.end()) {
+            return it->second;
+        }
+        if (!module_) {
+            throw std::logic_error("Cannot expand call to " + name + " without the module");
+        }
+        if (!activeCallees_.insert(name).second) {
+            throw std::logic_error("Cannot expand recursive call to " + name);
+        }
+        auto circuit = module_->getCircuitWithName(name);
+        Callee callee{build(*circuit), circuit->getNumberOfInputs()};
+        activeCallees_.erase(name);
+        return callees_.emplace(name, std::move(callee)).first->second;
+    }
+
+    static void addConversion(PreprocessingManifest& manifest, MpcProtocol from, MpcProtocol to, size_t bitWidth) {
+        if (to == MpcProtocol::ArithmeticGmw) {
+            // one shared bit per bit of the Boolean value
+            manifest.add(PreprocessingResource::SharedBit, bitWidth, 1, bitWidth);
+        } else if (from == MpcProtocol::ArithmeticGmw) {
+            // the Boolean sharings of the parties' arithmetic shares are added
+            addAndGates(manifest, to, 1, getNumberOfAndGates(op::Add, bitWidth));
+        }
+        // conversions between Boolean GMW and BMR need no preprocessing
+    }
+
+    const core::ModuleReadOnly* module_;
+    MpcProtocol defaultProtocol_;
+    std::unordered_map<std::string, Callee> callees_;
+    std::unordered_set<std::string> activeCallees_;
+};
+
+}  // namespace
+
+std::string getResourceName(PreprocessingResource resource) {
+    switch (resource) {
+        case PreprocessingResource::BooleanTriple:
+            return "BooleanTriple";
+        case PreprocessingResource::ArithmeticTriple:
+            return "ArithmeticTriple";
+        case PreprocessingResource::SquarePair:
+            return "SquarePair";
+        case PreprocessingResource::SharedBit:
+            return "SharedBit";
+        case PreprocessingResource::ObliviousTransfer:
+            return "ObliviousTransfer";
+    }
+    throw std::logic_error("Unknown preprocessing resource");
+}
+
+void PreprocessingManifest::add(PreprocessingResource resource, size_t bitWidth, size_t simdWidth, uint64_t count) {
+    if (count > 0) {
+        demands[{resource, bitWidth, simdWidth}] += count;
+    }
+}
+
+std::map<size_t, uint64_t> PreprocessingManifest::getTotals(PreprocessingResource resource) const {
+    std::map<size_t, uint64_t> totals;
+    for (const auto& [demand, count] : demands) {
+        if (demand.resource == resource) {
+            totals[demand.bitWidth] += count * demand.simdWidth;
+        }
+    }
+    return totals;
+}
+
+PreprocessingManifest computePreprocessingManifest(const core::ModuleReadOnly& module, MpcProtocol defaultProtocol) {
+    ManifestBuilder builder(&module, defaultProtocol);
+    auto entryCircuit = module.getEntryCircuit();
+    return builder.build(*entryCircuit);
+}
+
+PreprocessingManifest computePreprocessingManifest(const core::CircuitReadOnly& circuit, MpcProtocol defaultProtocol) {
+    ManifestBuilder builder(nullptr, defaultProtocol);
+    return builder.build(circuit);
+}
+
+std::string toJSON(const PreprocessingManifest& manifest) {
+    std::ostringstream json;
+    json << "{\n  \"demands\": [";
+    bool first = true;
+    for (const auto& [demand, count] : manifest.demands) {
+        json << (first ? "" : ",") << "\n    {\"resource\": \"" << getResourceName(demand.resource) << "\", \"bitWidth\": " << demand.bitWidth
+             << ", \"simdWidth\": " << demand.simdWidth << ", \"count\": " << count << "}";
+        first = false;
+    }
+    json << (first ? "" : "\n  ") << "],\n  \"totals\": {";
+    first = true;
+    for (auto resource : kResources) {
+        auto totals = manifest.getTotals(resource);
+        if (totals.empty()) {
+            continue;
+        }
+        json << (first ? "" : ",") << "\n    \"" << getResourceName(resource) << "\": {";
+        bool firstWidth = true;
+        for (const auto& [bitWidth, count] : totals) {
+            json << (firstWidth ? "" : ", ") << "\"" << bitWidth << "\": " << count;
+            firstWidth = false;
+        }
+        json << "}";
+        first = false;
+    }
+    json << (first ? "" : "\n  ") << "}\n}\n";
+    return json.str();
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_PREPROCESSINGMANIFEST_H
+#define FUSE_PREPROCESSINGMANIFEST_H
+
+#include <compare>
+#include <map>
+#include <string>
+
+#include "ModuleWrapper.h"
+#include "ProtocolAssignment.h"
+
+namespace fuse::passes {
+
+enum class PreprocessingResource { BooleanTriple,
+                                   ArithmeticTriple,
+                                   SquarePair,
+                                   SharedBit,
+                                   ObliviousTransfer };
+
+std::string getResourceName(PreprocessingResource resource);
+
+/**
+ * @brief Correlated randomness that the offline phase has to generate before a circuit can be evaluated.
+ */
+struct PreprocessingManifest {
+    struct Demand {
+        PreprocessingResource resource;
+        size_t bitWidth;
+        // a resource with SIMD width k is consumed by a SIMD operation on k values at once
+        size_t simdWidth;
+
+        auto operator<=>(const Demand&) const = default;
+    };
+
+    std::map<Demand, uint64_t> demands;
+
+    void add(PreprocessingResource resource, size_t bitWidth, size_t simdWidth, uint64_t count);
+
+    /**
+     * @brief Returns the number of values of the resource per bit width over all SIMD widths,
+     * i.e. the number of values to request from the respective provider of the offline phase.
+     */
+    std::map<size_t, uint64_t> getTotals(PreprocessingResource resource) const;
+};
+
+/**
+ * @brief Computes the preprocessing demand of the entry circuit of the module, counting every call and the lanes of SIMD nodes and calls.
+ *
+ * Nodes are evaluated in the protocol of their protocol annotation (see assignProtocols) or in the default protocol otherwise.
+ * Boolean GMW needs one binary triple per AND gate (also for the AND gates of adders, multipliers and comparators of words,
+ * counted for ripple-carry and schoolbook constructions), BMR one OT of a 128-bit key per AND gate,
+ * arithmetic GMW one triple per multiplication and one square pair per squaring of the respective bit width.
+ * Every value is converted at most once per protocol: Boolean to arithmetic sharing needs one shared bit per bit,
+ * arithmetic to Boolean sharing the AND gates of an adder. Loop bodies are counted once per iteration.
+ *
+ * @throws std::logic_error for recursive calls, loops without a number of iterations or unknown protocol annotations
+ */
+PreprocessingManifest computePreprocessingManifest(const core::ModuleReadOnly& module, MpcProtocol defaultProtocol = MpcProtocol::BooleanGmw);
+
+/**
+ * @brief Computes the preprocessing demand of a circuit without calls.
+ *
+ * @throws std::logic_error if the circuit contains calls or loops
+ */
+PreprocessingManifest computePreprocessingManifest(const core::CircuitReadOnly& circuit, MpcProtocol defaultProtocol = MpcProtocol::BooleanGmw);
+
+/**
+ * @brief Serializes the manifest as JSON object with one entry per demand and the totals per resource and bit width.
+ */
+std::string toJSON(const PreprocessingManifest& manifest);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_PREPROCESSINGMANIFEST_H */
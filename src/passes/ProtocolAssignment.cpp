@@ -0,0 +1,418 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ProtocolAssignment.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "OperandWidths.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using op = core::ir::PrimitiveOperation;
+using Identifier = uint64_t;
+using Offset = uint32_t;
+
+constexpr double kUnsupported = std::numeric_limits<double>::infinity();
+constexpr std::array<MpcProtocol, kNumberOfMpcProtocols> kProtocols{MpcProtocol::ArithmeticGmw, MpcProtocol::BooleanGmw, MpcProtocol::Bmr};
+
+// constants are combined with shares of any protocol, calls, loops and custom operations are assigned in their own circuits
+bool isAssignable(const core::NodeReadOnly& node) {
+    switch (node.getOperation()) {
+        case op::Constant:
+        case op::CallSubcircuit:
+        case op::Loop:
+        case op::Custom:
+            return false;
+        default:
+            return true;
+    }
+}
+
+size_t getOutputWidth(const core::NodeReadOnly& node, size_t operandWidth) {
+    auto outputTypes = node.getOutputDataTypes();
+    if (!outputTypes.empty() && outputTypes[0]->isPrimitiveType()) {
+        return getPrimitiveTypeBitWidth(outputTypes[0]->getPrimitiveType());
+    }
+    switch (node.getOperation()) {
+        case op::Split:
+        case op::Gt:
+        case op::Ge:
+        case op::Lt:
+        case op::Le:
+        case op::Eq:
+            return 1;
+        case op::Merge:
+            return node.getNumberOfInputs();
+        default:
+            return operandWidth;
+    }
+}
+
+size_t protocolIndex(MpcProtocol protocol) { return static_cast<size_t>(protocol); }
+
+class ProtocolAssigner {
+   public:
+    ProtocolAssigner(const core::CircuitReadOnly& circuit, const ProtocolCostModel& costModel) : circuit_(circuit), costModel_(costModel) {}
+
+    ProtocolAssignment run(size_t maxRefinementRounds) {
+        buildGraph();
+        estimateConeCosts();
+        chooseProtocols();
+        for (size_t round = 0; round < maxRefinementRounds; ++round) {
+            if (!refine()) {
+                break;
+            }
+        }
+
+        ProtocolAssignment assignment;
+        for (const auto& node : nodes_) {
+            assignment.nodeProtocols[node.id] = node.protocol;
+            assignment.totalCost += node.cost[protocolIndex(node.protocol)];
+        }
+        for (const auto& value : values_) {
+            auto producerProtocol = nodes_[value.producer].protocol;
+            for (auto protocol : kProtocols) {
+                if (protocol != producerProtocol && value.usersPerProtocol[protocolIndex(protocol)] > 0) {
+                    assignment.conversionCost += costModel_.getConversionCost(producerProtocol, protocol, value.width);
+                    ++assignment.numberOfConversions;
+                }
+            }
+        }
+        assignment.totalCost += assignment.conversionCost;
+        return assignment;
+    }
+
+   private:
+    struct NodeInfo {
+        Identifier id;
+        std::array<double, kNumberOfMpcProtocols> cost;
+        // estimated cost of the input cone if the node is evaluated in the protocol
+        std::array<double, kNumberOfMpcProtocols> coneCost;
+        std::vector<size_t> inputValues;
+        std::vector<size_t> outputValues;
+        MpcProtocol protocol = MpcProtocol::BooleanGmw;
+    };
+
+    // an output of an assigned node that is read by assigned nodes
+    struct Value {
+        size_t producer;
+        size_t width;
+        // one entry per input edge, i.e. a node that reads the value twice is listed twice
+        std::vector<size_t> users;
+        std::array<size_t, kNumberOfMpcProtocols> usersPerProtocol{};
+    };
+
+    void buildGraph() {
+        std::unordered_map<Identifier, size_t> nodeIndex;
+        std::unordered_map<Identifier, size_t> outputWidths;
+        std::map<std::pair<Identifier, Offset>, size_t> valueIndex;
+        circuit_.topologicalTraversal([&](core::NodeReadOnly& node) {
+            if (!isAssignable(node)) {
+                return;
+            }
+            const size_t nodeIdx = nodes_.size();
+            NodeInfo info{.id = node.getNodeID()};
+            const size_t operandWidth = getOperandBitWidth(node);
+            bool supported = false;
+            for (auto protocol : kProtocols) {
+                info.cost[protocolIndex(protocol)] = costModel_.getOperationCost(node, protocol, operandWidth);
+                supported = supported || info.cost[protocolIndex(protocol)] != kUnsupported;
+            }
+            if (!supported) {
+                throw std::logic_error("No protocol supports node " + std::to_string(info.id) + " with operation " +
+                                       core::ir::EnumNamePrimitiveOperation(node.getOperation()));
+            }
+
+            auto inputs = node.getInputNodeIDs();
+            auto offsets = node.getInputOffsets();
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                auto producer = nodeIndex.find(inputs[i]);
+                if (producer == nodeIndex.end()) {
+                    continue;
+                }
+                std::pair<Identifier, Offset> key{inputs[i], offsets.empty() ? 0 : offsets[i]};
+                auto [it, inserted] = valueIndex.try_emplace(key, values_.size());
+                if (inserted) {
+                    values_.push_back(Value{.producer = producer->second, .width = outputWidths.at(inputs[i])});
+                    nodes_[producer->second].outputValues.push_back(it->second);
+                }
+                values_[it->second].users.push_back(nodeIdx);
+                info.inputValues.push_back(it->second);
+            }
+
+            nodeIndex[info.id] = nodeIdx;
+            outputWidths[info.id] = getOutputWidth(node, operandWidth);
+            nodes_.push_back(std::move(info));
+        });
+    }
+
+    // forward pass: the cone cost of a value is shared among its users s.t. reconvergent paths are not counted several times
+    void estimateConeCosts() {
+        for (auto& node : nodes_) {
+            for (auto protocol : kProtocols) {
+                double coneCost = node.cost[protocolIndex(protocol)];
+                for (auto v : node.inputValues) {
+                    const auto& value = values_[v];
+                    const auto& producer = nodes_[value.producer];
+                    double best = kUnsupported;
+                    for (auto from : kProtocols) {
+                        best = std::min(best, producer.coneCost[protocolIndex(from)] + costModel_.getConversionCost(from, protocol, value.width));
+                    }
+                    coneCost += best / value.users.size();
+                }
+                node.coneCost[protocolIndex(protocol)] = coneCost;
+            }
+        }
+    }
+
+    // sum of the conversions of the value if its producer is evaluated in the given protocol
+    double getConversionCost(const Value& value, MpcProtocol producerProtocol) const {
+        double cost = 0.0;
+        for (auto protocol : kProtocols) {
+            if (protocol != producerProtocol && value.usersPerProtocol[protocolIndex(protocol)] > 0) {
+                cost += costModel_.getConversionCost(producerProtocol, protocol, value.width);
+            }
+        }
+        return cost;
+    }
+
+    // backward pass: all users of a node are assigned before the node itself
+    void chooseProtocols() {
+        for (size_t n = nodes_.size(); n-- > 0;) {
+            auto& node = nodes_[n];
+            double bestCost = kUnsupported;
+            for (auto protocol : kProtocols) {
+                double cost = node.coneCost[protocolIndex(protocol)];
+                for (auto v : node.outputValues) {
+                    cost += getConversionCost(values_[v], protocol);
+                }
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    node.protocol = protocol;
+                }
+            }
+            for (auto v : node.inputValues) {
+                ++values_[v].usersPerProtocol[protocolIndex(node.protocol)];
+            }
+        }
+    }
+
+    // local search: moves single nodes into the protocol that minimizes the total cost, returns whether a node was moved
+    bool refine() {
+        bool changed = false;
+        for (auto& node : nodes_) {
+            auto uniqueInputs = node.inputValues;
+            std::sort(uniqueInputs.begin(), uniqueInputs.end());
+            uniqueInputs.erase(std::unique(uniqueInputs.begin(), uniqueInputs.end()), uniqueInputs.end());
+
+            for (auto v : node.inputValues) {
+                --values_[v].usersPerProtocol[protocolIndex(node.protocol)];
+            }
+            auto localCost = [&](MpcProtocol protocol) {
+                if (node.cost[protocolIndex(protocol)] == kUnsupported) {
+                    return kUnsupported;
+                }
+                for (auto v : node.inputValues) {
+                    ++values_[v].usersPerProtocol[protocolIndex(protocol)];
+                }
+                double cost = node.cost[protocolIndex(protocol)];
+                for (auto v : node.outputValues) {
+                    cost += getConversionCost(values_[v], protocol);
+                }
+                for (auto v : uniqueInputs) {
+                    cost += getConversionCost(values_[v], nodes_[values_[v].producer].protocol);
+                }
+                for (auto v : node.inputValues) {
+                    --values_[v].usersPerProtocol[protocolIndex(protocol)];
+                }
+                return cost;
+            };
+
+            // the current protocol wins ties s.t. the search terminates
+            auto best = node.protocol;
+            double bestCost = localCost(best);
+            for (auto protocol : kProtocols) {
+                double cost = localCost(protocol);
+                if (cost < bestCost - 1e-9) {
+                    bestCost = cost;
+                    best = protocol;
+                }
+            }
+            changed = changed || best != node.protocol;
+            node.protocol = best;
+            for (auto v : node.inputValues) {
+                ++values_[v].usersPerProtocol[protocolIndex(node.protocol)];
+            }
+        }
+        return changed;
+    }
+
+    const core::CircuitReadOnly& circuit_;
+    const ProtocolCostModel& costModel_;
+    // in topological order
+    std::vector<NodeInfo> nodes_;
+    std::vector<Value> values_;
+};
+
+}  // namespace
+
+std::string getProtocolName(MpcProtocol protocol) {
+    switch (protocol) {
+        case MpcProtocol::ArithmeticGmw:
+            return "ArithmeticGmw";
+        case MpcProtocol::BooleanGmw:
+            return "BooleanGmw";
+        case MpcProtocol::Bmr:
+            return "Bmr";
+    }
+    throw std::logic_error("Unknown MPC protocol");
+}
+
+std::optional<MpcProtocol> getProtocolFromName(const std::string& name) {
+    for (auto protocol : kProtocols) {
+        if (getProtocolName(protocol) == name) {
+            return protocol;
+        }
+    }
+    return std::nullopt;
+}
+
+double ProtocolCostModel::getOperationCost(const core::NodeReadOnly& node, MpcProtocol protocol, size_t bitWidth) const {
+    const bool arithmetic = protocol == MpcProtocol::ArithmeticGmw;
+    const double width = static_cast<double>(bitWidth);
+    const double logWidth = std::ceil(std::log2(std::max(width, 1.0)));
+    // SIMD nodes evaluate one operation per output in the same rounds
+    const double lanes = node.getOperation() == op::Split ? 1.0 : static_cast<double>(std::max<size_t>(node.getNumberOfOutputs(), 1));
+    double andGates = 0.0;
+    double rounds = 0.0;
+    switch (node.getOperation()) {
+        case op::Input:
+        case op::Output:
+        case op::SelectOffset:
+            return 0.0;
+        case op::Xor:
+        case op::Not:
+        case op::Xnor:
+        case op::Split:
+        case op::Merge:
+            return arithmetic ? kUnsupported : 0.0;
+        case op::And:
+        case op::Or:
+        case op::Nand:
+        case op::Nor:
+        case op::Mux:
+            if (arithmetic) {
+                return kUnsupported;
+            }
+            andGates = width;
+            rounds = 1.0;
+            break;
+        case op::Eq:
+        case op::Gt:
+        case op::Ge:
+        case op::Lt:
+        case op::Le:
+            if (arithmetic) {
+                return kUnsupported;
+            }
+            andGates = width;
+            rounds = logWidth + 1.0;
+            break;
+        case op::Add:
+        case op::Sub:
+        case op::Neg:
+            if (arithmetic) {
+                return 0.0;
+            }
+            andGates = width;
+            rounds = width;
+            break;
+        case op::Mul:
+        case op::Square:
+            if (arithmetic) {
+                return lanes * arithmeticMultiplicationCostPerBit * width + roundCost;
+            }
+            andGates = width * width;
+            rounds = width;
+            break;
+        case op::Div:
+            if (arithmetic) {
+                return kUnsupported;
+            }
+            andGates = 2.0 * width * width;
+            rounds = width * width;
+            break;
+        default:
+            return 0.0;
+    }
+    if (protocol == MpcProtocol::Bmr) {
+        // constant number of rounds for the whole circuit
+        return lanes * andGates * bmrAndCost;
+    }
+    return lanes * andGates * booleanGmwAndCost + rounds * roundCost;
+}
+
+double ProtocolCostModel::getConversionCost(MpcProtocol from, MpcProtocol to, size_t bitWidth) const {
+    if (from == to) {
+        return 0.0;
+    }
+    return conversionCostPerBit[protocolIndex(from)][protocolIndex(to)] * static_cast<double>(bitWidth) + conversionRounds[protocolIndex(from)][protocolIndex(to)] * roundCost;
+}
+
+ProtocolAssignment assignProtocols(const core::CircuitReadOnly& circuit, const ProtocolCostModel& costModel, size_t maxRefinementRounds) {
+    ProtocolAssigner assigner(circuit, costModel);
+    return assigner.run(maxRefinementRounds);
+}
+
+void annotateProtocols(core::CircuitObjectWrapper& circuit, const ProtocolAssignment& assignment) {
+    for (auto node : circuit) {
+        auto it = assignment.nodeProtocols.find(node.getNodeID());
+        if (it != assignment.nodeProtocols.end()) {
+            node.setStringValueForAttribute(kProtocolAttribute, getProtocolName(it->second));
+        }
+    }
+}
+
+ProtocolAssignment assignAndAnnotateProtocols(core::CircuitObjectWrapper& circuit, const ProtocolCostModel& costModel) {
+    auto assignment = assignProtocols(circuit, costModel);
+    annotateProtocols(circuit, assignment);
+    return assignment;
+}
+
+double assignAndAnnotateProtocols(core::ModuleObjectWrapper& module, const ProtocolCostModel& costModel) {
+    double totalCost = 0.0;
+    for (const auto& name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        totalCost += assignAndAnnotateProtocols(circuit, costModel).totalCost;
+    }
+    return totalCost;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_PROTOCOLASSIGNMENT_H
+#define FUSE_PROTOCOLASSIGNMENT_H
+
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+enum class MpcProtocol { ArithmeticGmw,
+                         BooleanGmw,
+                         Bmr };
+
+constexpr size_t kNumberOfMpcProtocols = 3;
+
+// name of the node attribute that holds the assigned protocol, e.g. "protocol:BooleanGmw"
+constexpr char kProtocolAttribute[] = "protocol";
+
+std::string getProtocolName(MpcProtocol protocol);
+std::optional<MpcProtocol> getProtocolFromName(const std::string& name);
+
+/**
+ * @brief Cost model for mixed-protocol evaluation.
+ *
+ * The cost of a node in a protocol is the number of AND gates (Boolean protocols) or multiplications (arithmetic GMW)
+ * of the operation times their cost, plus its number of communication rounds times the round cost.
+ * Rounds are charged per node, so chains of interactive operations are penalized even though independent nodes could share rounds.
+ * Conversions cost a per-bit amount plus a number of rounds for each pair of protocols.
+ * The default values are relative costs in the spirit of ABY and HyCC and can be calibrated for a concrete setup,
+ * derived classes can replace the estimates altogether.
+ */
+struct ProtocolCostModel {
+    virtual ~ProtocolCostModel() = default;
+
+    // cost of one communication round in units of one AND gate in Boolean GMW
+    double roundCost = 20.0;
+    double booleanGmwAndCost = 1.0;
+    double bmrAndCost = 4.0;
+    // cost of one multiplication in arithmetic GMW per bit of the ring
+    double arithmeticMultiplicationCostPerBit = 1.0;
+    // indexed by [from][to] with the numeric values of MpcProtocol
+    std::array<std::array<double, kNumberOfMpcProtocols>, kNumberOfMpcProtocols> conversionCostPerBit{{
+        {0.0, 2.0, 4.0},  // A2B, A2Y
+        {1.0, 0.0, 4.0},  // B2A, B2Y
+        {1.0, 0.0, 0.0},  // Y2A, Y2B
+    }};
+    std::array<std::array<double, kNumberOfMpcProtocols>, kNumberOfMpcProtocols> conversionRounds{{
+        {0.0, 4.0, 2.0},
+        {1.0, 0.0, 1.0},
+        {2.0, 1.0, 0.0},
+    }};
+
+    /**
+     * @brief Returns the cost of evaluating the node in the protocol or infinity if the protocol does not support the operation.
+     *
+     * @param bitWidth width of the operands of the node
+     */
+    virtual double getOperationCost(const core::NodeReadOnly& node, MpcProtocol protocol, size_t bitWidth) const;
+
+    /**
+     * @brief Returns the cost of converting a value of bitWidth bits from one protocol into another.
+     */
+    virtual double getConversionCost(MpcProtocol from, MpcProtocol to, size_t bitWidth) const;
+};
+
+struct ProtocolAssignment {
+    std::unordered_map<uint64_t, MpcProtocol> nodeProtocols;
+    // estimated cost of all operations and conversions
+    double totalCost = 0.0;
+    double conversionCost = 0.0;
+    // number of values that are converted, every value is converted at most once per target protocol
+    size_t numberOfConversions = 0;
+};
+
+/**
+ * @brief Assigns an MPC protocol to every node of the circuit s.t. the estimated cost of operations and conversions is low.
+ *
+ * Constants, calls, loops and custom operations are not assigned a protocol and are not part of the cost:
+ * constant shares can be combined with shares of any protocol and the bodies of calls and loops are assigned separately.
+ * The assignment is computed in three steps:
+ * a forward pass estimates for each node and protocol the cost of the node's input cone
+ * (the cost of a shared input is distributed among its users), a backward pass chooses the protocols
+ * from the outputs to the inputs given the already chosen protocols of the users, and a local search
+ * changes the protocols of single nodes as long as this reduces the total cost.
+ *
+ * @param maxRefinementRounds maximum number of rounds of the local search
+ * @throws std::logic_error if a node is not supported by any protocol
+ */
+ProtocolAssignment assignProtocols(const core::CircuitReadOnly& circuit, const ProtocolCostModel& costModel = {}, size_t maxRefinementRounds = 8);
+
+/**
+ * @brief Writes the assigned protocols into the node annotations, using the attribute kProtocolAttribute.
+ * Backends convert the inputs of annotated nodes into the assigned protocol before evaluating the node.
+ */
+void annotateProtocols(core::CircuitObjectWrapper& circuit, const ProtocolAssignment& assignment);
+
+/**
+ * @brief Assigns protocols to the nodes of the circuit and annotates them.
+ *
+ * @return the assignment that was annotated
+ */
+ProtocolAssignment assignAndAnnotateProtocols(core::CircuitObjectWrapper& circuit, const ProtocolCostModel& costModel = {});
+
+/**
+ * @brief Assigns and annotates protocols in every circuit inside the module.
+ *
+ * @return the sum of the estimated costs of all circuits
+ */
+double assignAndAnnotateProtocols(core::ModuleObjectWrapper& module, const ProtocolCostModel& costModel = {});
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_PROTOCOLASSIGNMENT_H */
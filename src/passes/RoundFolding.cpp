@@ -0,0 +1,228 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "RoundFolding.h"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "LoopUnrolling.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using Identifier = uint64_t;
+using Offset = uint32_t;
+using Value = std::pair<Identifier, Offset>;
+
+struct CallInfo {
+    std::string callee;
+    size_t numberOfCarriedValues;
+    std::vector<Value> inputs;
+};
+
+std::vector<Value> getInputValues(const core::NodeReadOnly& node) {
+    auto ids = node.getInputNodeIDs();
+    auto offsets = node.getInputOffsets();
+    std::vector<Value> values;
+    values.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        values.emplace_back(ids[i], offsets.empty() ? 0 : offsets[i]);
+    }
+    return values;
+}
+
+// whether the call continues the chain of the previous call to the same round function
+bool continuesChain(Identifier previousID, const CallInfo& previous, const CallInfo& call) {
+    const size_t carried = call.numberOfCarriedValues;
+    if (call.callee != previous.callee || carried == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < carried; ++i) {
+        if (call.inputs[i] != Value{previousID, static_cast<Offset>(i)}) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * The number of inputs after the carried values that differ between the calls of the chain, e.g. round keys,
+ * or nothing if other inputs follow them, which the body would have to be reordered for.
+ */
+std::optional<size_t> countPerIterationInputs(const std::vector<const CallInfo*>& chain) {
+    const auto& first = *chain.front();
+    size_t numberOfPerIterationInputs = 0;
+    for (size_t i = first.numberOfCarriedValues; i < first.inputs.size(); ++i) {
+        const bool isInvariant = std::all_of(chain.begin(), chain.end(), [&](const CallInfo* call) { return call->inputs[i] == first.inputs[i]; });
+        if (isInvariant) {
+            continue;
+        }
+        if (i != first.numberOfCarriedValues + numberOfPerIterationInputs) {
+            return std::nullopt;
+        }
+        ++numberOfPerIterationInputs;
+    }
+    return numberOfPerIterationInputs;
+}
+
+void setInputValues(core::NodeObjectWrapper& node, const std::vector<Value>& values) {
+    std::vector<Identifier> ids;
+    std::vector<Offset> offsets;
+    ids.reserve(values.size());
+    offsets.reserve(values.size());
+    for (const auto& [id, offset] : values) {
+        ids.push_back(id);
+        offsets.push_back(offset);
+    }
+    node.setInputNodeIDs(ids);
+    node.setInputOffsets(offsets);
+}
+
+size_t foldRounds(core::ModuleObjectWrapper& module, core::CircuitObjectWrapper& circuit, size_t minIterations) {
+    std::unordered_map<std::string, std::pair<size_t, size_t>> signatures;
+    std::unordered_map<Identifier, CallInfo> calls;
+    std::unordered_map<Identifier, std::vector<Identifier>> users;
+    std::vector<Identifier> callOrder;
+    for (auto node : circuit) {
+        auto inputIDs = node.getInputNodeIDs();
+        for (auto input : std::unordered_set<Identifier>(inputIDs.begin(), inputIDs.end())) {
+            users[input].push_back(node.getNodeID());
+        }
+        if (!node.isSubcircuitNode()) {
+            continue;
+        }
+        auto name = node.getSubCircuitName();
+        auto signature = signatures.find(name);
+        if (signature == signatures.end()) {
+            auto callee = std::as_const(module).getCircuitWithName(name);
+            signature = signatures.emplace(name, std::make_pair(callee->getNumberOfInputs(), callee->getNumberOfOutputs())).first;
+        }
+        const auto [numberOfInputs, numberOfOutputs] = signature->second;
+        // SIMD calls and round functions with extra outputs cannot be chained
+        if (node.getNumberOfInputs() != numberOfInputs || numberOfOutputs > numberOfInputs) {
+            continue;
+        }
+        calls.emplace(node.getNodeID(), CallInfo{name, numberOfOutputs, getInputValues(node)});
+        callOrder.push_back(node.getNodeID());
+    }
+
+    // the next call of every call inside a chain
+    std::unordered_map<Identifier, Identifier> next;
+    std::unordered_set<Identifier> hasPrevious;
+    for (auto id : callOrder) {
+        auto callUsers = users.find(id);
+        if (callUsers == users.end() || callUsers->second.size() != 1) {
+            continue;
+        }
+        auto successor = calls.find(callUsers->second[0]);
+        if (successor != calls.end() && continuesChain(id, calls.at(id), successor->second)) {
+            next[id] = successor->first;
+            hasPrevious.insert(successor->first);
+        }
+    }
+
+    size_t numberOfLoops = 0;
+    std::unordered_set<Identifier> foldedCalls;
+    std::unordered_map<Identifier, Identifier> replacedBy;
+    for (auto first : callOrder) {
+        if (hasPrevious.contains(first) || !next.contains(first)) {
+            continue;
+        }
+        std::vector<Identifier> chain{first};
+        for (auto it = next.find(first); it != next.end(); it = next.find(it->second)) {
+            chain.push_back(it->second);
+        }
+        if (chain.size() < minIterations) {
+            continue;
+        }
+        std::vector<const CallInfo*> chainCalls;
+        for (auto id : chain) {
+            chainCalls.push_back(&calls.at(id));
+        }
+        auto perIteration = countPerIterationInputs(chainCalls);
+        if (!perIteration) {
+            continue;
+        }
+
+        // the carried values of the first call, the per-iteration values of every call and the loop-invariant values
+        const auto& firstCall = *chainCalls.front();
+        const auto perIterationInputs = firstCall.inputs.begin() + firstCall.numberOfCarriedValues;
+        std::vector<Value> loopInputs(firstCall.inputs.begin(), perIterationInputs);
+        for (const auto* call : chainCalls) {
+            const auto roundInputs = call->inputs.begin() + call->numberOfCarriedValues;
+            loopInputs.insert(loopInputs.end(), roundInputs, roundInputs + *perIteration);
+        }
+        loopInputs.insert(loopInputs.end(), perIterationInputs + *perIteration, firstCall.inputs.end());
+
+        auto loop = circuit.getNodeWithID(first);
+        loop.setPrimitiveOperation(core::ir::PrimitiveOperation::Loop);
+        loop.setNumberOfOutputs(firstCall.numberOfCarriedValues);
+        loop.setStringValueForAttribute(kLoopIterationsAttribute, std::to_string(chain.size()));
+        if (*perIteration > 0) {
+            loop.setStringValueForAttribute(kLoopPerIterationInputsAttribute, std::to_string(*perIteration));
+        }
+        setInputValues(loop, loopInputs);
+        foldedCalls.insert(chain.begin() + 1, chain.end());
+        replacedBy[chain.back()] = first;
+        ++numberOfLoops;
+    }
+    if (numberOfLoops == 0) {
+        return 0;
+    }
+
+    for (auto node : circuit) {
+        auto ids = node.getInputNodeIDs();
+        if (foldedCalls.contains(node.getNodeID()) || std::none_of(ids.begin(), ids.end(), [&](auto id) { return replacedBy.contains(id); })) {
+            continue;
+        }
+        std::vector<Identifier> newIDs(ids.begin(), ids.end());
+        for (auto& id : newIDs) {
+            if (auto replacement = replacedBy.find(id); replacement != replacedBy.end()) {
+                id = replacement->second;
+            }
+        }
+        node.setInputNodeIDs(newIDs);
+    }
+    circuit.removeNodes(foldedCalls);
+    // per-iteration inputs of later rounds may be computed after the first call
+    circuit.restoreTopologicalOrder();
+    return numberOfLoops;
+}
+
+}  // namespace
+
+size_t foldRepeatedRounds(core::ModuleObjectWrapper& module, size_t minIterations) {
+    size_t numberOfLoops = 0;
+    for (const auto& name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        numberOfLoops += foldRounds(module, circuit, minIterations);
+    }
+    return numberOfLoops;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_ROUNDFOLDING_H
+#define FUSE_ROUNDFOLDING_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Folds chains of calls to the same round function into loop nodes, e.g. the rounds of AES, SHA-256 or Keccak-f
+ * once they are outlined into subcircuits by the frontend or by frequent subcircuit replacement.
+ *
+ * A chain consists of calls to a circuit with c outputs where each call passes the c outputs of the previous call in order
+ * as its first c inputs and no other node uses the outputs of a call except the next one. The first call of each chain
+ * becomes a loop node with the chain's length as iterations, see node.fbs, and the users of the last call read the loop's outputs.
+ * Inputs that differ between the calls, such as round keys, become per-iteration inputs of the loop if they directly follow
+ * the carried values; chains with other differing inputs are not folded. The remaining inputs are loop-invariant.
+ *
+ * @param module the module whose circuits are compressed
+ * @param minIterations minimal number of calls in a chain to fold it into a loop
+ * @return the number of created loop nodes
+ */
+size_t foldRepeatedRounds(core::ModuleObjectWrapper& module, size_t minIterations = 2);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_ROUNDFOLDING_H */
@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "SubcircuitInlining.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace fuse::passes {
+
+namespace {
+
+struct Call {
+    uint64_t nodeID;
+    std::string callee;
+    size_t numberOfInputs;
+};
+
+struct CircuitInfo {
+    size_t size = 0;
+    size_t numberOfInputs = 0;
+    std::vector<Call> calls;
+    // loops are never inlined but still keep their body alive
+    std::vector<std::string> loopBodies;
+};
+
+CircuitInfo getCircuitInfo(const core::CircuitReadOnly& circuit) {
+    CircuitInfo info;
+    info.numberOfInputs = circuit.getNumberOfInputs();
+    circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+        if (!node.isInputNode() && !node.isOutputNode()) {
+            ++info.size;
+        }
+        if (node.isSubcircuitNode()) {
+            info.calls.push_back({node.getNodeID(), node.getSubCircuitName(), node.getNumberOfInputs()});
+        }
+        if (node.isLoopNode()) {
+            info.loopBodies.push_back(node.getSubCircuitName());
+        }
+    });
+    return info;
+}
+
+}  // namespace
+
+size_t inlineSubcircuits(core::ModuleObjectWrapper& module, const InliningOptions& options) {
+    size_t numberOfInlinedCalls = 0;
+    std::unordered_set<std::string> calledBefore;
+
+    for (size_t round = 0; round < options.maxDepth; ++round) {
+        std::unordered_map<std::string, CircuitInfo> infos;
+        std::unordered_map<std::string, size_t> callCounts;
+        for (const auto& name : module.getAllCircuitNames()) {
+            infos[name] = getCircuitInfo(*std::as_const(module).getCircuitWithName(name));
+        }
+        for (const auto& [name, info] : infos) {
+            for (const auto& call : info.calls) {
+                ++callCounts[call.callee];
+                calledBefore.insert(call.callee);
+            }
+            for (const auto& body : info.loopBodies) {
+                ++callCounts[body];
+            }
+        }
+        auto shouldInline = [&](const std::string& caller, const std::string& callee) {
+            auto info = infos.find(callee);
+            if (callee == caller || info == infos.end()) {
+                return false;
+            }
+            return info->second.size <= options.maxCalleeSize || (callCounts[callee] == 1 && info->second.size <= options.maxSingleCallSize);
+        };
+
+        size_t inlinedInRound = 0;
+        for (const auto& [caller, info] : infos) {
+            std::unordered_map<uint64_t, core::CircuitObjectWrapper> callsToInline;
+            for (const auto& call : info.calls) {
+                // SIMD calls pass several sets of inputs to the callee at once
+                if (!shouldInline(caller, call.callee) || call.numberOfInputs != infos.at(call.callee).numberOfInputs) {
+                    continue;
+                }
+                callsToInline.emplace(call.nodeID, module.getCircuitWithName(call.callee));
+            }
+            if (callsToInline.empty()) {
+                continue;
+            }
+            module.getCircuitWithName(caller).inlineCalls(callsToInline);
+            inlinedInRound += callsToInline.size();
+        }
+        numberOfInlinedCalls += inlinedInRound;
+        if (inlinedInRound == 0) {
+            break;
+        }
+    }
+
+    if (options.removeUnusedCircuits) {
+        std::unordered_set<std::string> stillCalled;
+        for (const auto& name : module.getAllCircuitNames()) {
+            auto info = getCircuitInfo(*std::as_const(module).getCircuitWithName(name));
+            for (const auto& call : info.calls) {
+                stillCalled.insert(call.callee);
+            }
+            stillCalled.insert(info.loopBodies.begin(), info.loopBodies.end());
+        }
+        for (const auto& name : module.getAllCircuitNames()) {
+            if (calledBefore.contains(name) && !stillCalled.contains(name) && name != module.getEntryCircuitName()) {
+                module.removeCircuit(name);
+            }
+        }
+    }
+    return numberOfInlinedCalls;
+}
+
+}  // namespace fuse::passes
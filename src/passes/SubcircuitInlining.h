@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_SUBCIRCUITINLINING_H
+#define FUSE_SUBCIRCUITINLINING_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+struct InliningOptions {
+    // callees with at most this many nodes (without inputs and outputs) are inlined at every call
+    size_t maxCalleeSize = 16;
+    // callees that are only called once are inlined up to this size, as inlining them does not grow the module
+    size_t maxSingleCallSize = 1024;
+    // maximal number of inlining rounds, i.e. nesting depth of calls that are flattened
+    size_t maxDepth = 8;
+    // remove circuits that are no longer called after inlining
+    bool removeUnusedCircuits = true;
+};
+
+/**
+ * @brief Replaces calls to small subcircuits by the nodes of the callee to avoid the per-call overhead in the backends
+ * and to allow vectorization across former call boundaries.
+ *
+ * Calls whose outputs are used with offsets or via SelectOffset nodes are rewired to the respective callee outputs.
+ * Calls inside inlined callees are considered again in the next round, up to maxDepth rounds.
+ * Recursive calls and SIMD calls (with a multiple of the callee's inputs) are never inlined.
+ *
+ * @param module the module whose calls are inlined
+ * @param options size, call count and depth heuristics
+ * @return the number of inlined calls
+ */
+size_t inlineSubcircuits(core::ModuleObjectWrapper& module, const InliningOptions& options = {});
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_SUBCIRCUITINLINING_H */
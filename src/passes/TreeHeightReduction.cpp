@@ -0,0 +1,285 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "TreeHeightReduction.h"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "NodeSuccessorsAnalysis.h"
+
+namespace fuse::passes {
+
+namespace {
+
+bool isAssociativeOperation(core::ir::PrimitiveOperation operation) {
+    using op = core::ir::PrimitiveOperation;
+    return operation == op::And || operation == op::Or || operation == op::Xor || operation == op::Add || operation == op::Mul;
+}
+
+bool isExpensiveOperation(core::ir::PrimitiveOperation operation) {
+    using op = core::ir::PrimitiveOperation;
+    switch (operation) {
+        case op::And:
+        case op::Or:
+        case op::Nand:
+        case op::Nor:
+        case op::Mux:
+        case op::Mul:
+        case op::Square:
+        case op::Div:
+        case op::Gt:
+        case op::Ge:
+        case op::Lt:
+        case op::Le:
+        case op::Eq:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isFloatingPointNode(const core::NodeReadOnly& node) {
+    using pt = core::ir::PrimitiveType;
+    for (auto& type : node.getOutputDataTypes()) {
+        if (type->getPrimitiveType() == pt::Float || type->getPrimitiveType() == pt::Double) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+class TreeHeightReducer {
+   public:
+    explicit TreeHeightReducer(bool onlyCountExpensiveOperations) : onlyCountExpensiveOperations_(onlyCountExpensiveOperations) {}
+
+    void visit(core::CircuitObjectWrapper& circuit) {
+        successors_ = getNodeSuccessors(circuit);
+        std::vector<Identifier> order;
+        for (auto node : circuit) {
+            order.push_back(node.getNodeID());
+            nodes_.emplace(node.getNodeID(), node);
+        }
+
+        bool changed = false;
+        for (auto nodeID : order) {
+            auto node = nodes_.at(nodeID);
+            depths_[nodeID] = computeDepth(node);
+            if (isChainRoot(node)) {
+                changed |= rebalanceChain(node);
+            }
+        }
+
+        // the rebalanced nodes may now use leaves that are stored after them
+        if (changed) {
+            circuit.restoreTopologicalOrder();
+        }
+    }
+
+   private:
+    using Identifier = uint64_t;
+    using Offset = uint32_t;
+    using Operand = std::pair<Identifier, Offset>;
+
+    /*
+     * The first component is the depth that is minimized, the second one is the depth over all operations
+     * and is used to break ties if only expensive operations are counted.
+     */
+    using Depth = std::pair<uint64_t, uint64_t>;
+
+    Depth operationCost(core::ir::PrimitiveOperation operation) const {
+        using op = core::ir::PrimitiveOperation;
+        if (operation == op::Input || operation == op::Output || operation == op::Constant) {
+            return {0, 0};
+        }
+        if (onlyCountExpensiveOperations_) {
+            return {isExpensiveOperation(operation) ? 1 : 0, 1};
+        }
+        return {1, 1};
+    }
+
+    Depth combine(const Depth& lhs, const Depth& rhs, core::ir::PrimitiveOperation operation) const {
+        auto cost = operationCost(operation);
+        return {std::max(lhs.first, rhs.first) + cost.first, std::max(lhs.second, rhs.second) + cost.second};
+    }
+
+    Depth getDepth(Identifier nodeID) const {
+        auto it = depths_.find(nodeID);
+        return it == depths_.end() ? Depth{0, 0} : it->second;
+    }
+
+    Depth computeDepth(const core::NodeReadOnly& node) const {
+        Depth depth{0, 0};
+        for (auto inputID : node.getInputNodeIDs()) {
+            auto inputDepth = getDepth(inputID);
+            depth = {std::max(depth.first, inputDepth.first), std::max(depth.second, inputDepth.second)};
+        }
+        auto cost = operationCost(node.getOperation());
+        return {depth.first + cost.first, depth.second + cost.second};
+    }
+
+    static bool isChainNode(const core::NodeReadOnly& node, core::ir::PrimitiveOperation operation) {
+        return node.getOperation() == operation && node.getNumberOfInputs() == 2 && node.getNumberOfOutputs() == 1;
+    }
+
+    Operand getOperand(const core::NodeReadOnly& node, size_t inputNumber) const {
+        Offset offset = node.usesInputOffsets() ? node.getInputOffsets()[inputNumber] : 0;
+        return {node.getInputNodeIDs()[inputNumber], offset};
+    }
+
+    /**
+     * @brief Returns true if the node is used exactly once and that use is an operand of a node with the same operation.
+     */
+    bool isInnerChainNode(const core::NodeReadOnly& node) const {
+        auto it = successors_.find(node.getNodeID());
+        if (it == successors_.end() || it->second.size() != 1) {
+            return false;
+        }
+        const auto successor = nodes_.at(*it->second.begin());
+        if (!isChainNode(successor, node.getOperation())) {
+            return false;
+        }
+        auto inputIDs = successor.getInputNodeIDs();
+        return std::count(inputIDs.begin(), inputIDs.end(), node.getNodeID()) == 1;
+    }
+
+    bool isChainRoot(const core::NodeReadOnly& node) const {
+        if (!isAssociativeOperation(node.getOperation()) || !isChainNode(node, node.getOperation())) {
+            return false;
+        }
+        // floating point addition and multiplication are not associative
+        using op = core::ir::PrimitiveOperation;
+        if ((node.getOperation() == op::Add || node.getOperation() == op::Mul) && isFloatingPointNode(node)) {
+            return false;
+        }
+        return !isInnerChainNode(node);
+    }
+
+    void collectChain(const core::NodeReadOnly& root, std::vector<Operand>& leaves, std::vector<Identifier>& innerNodes) const {
+        std::vector<Operand> stack = {getOperand(root, 1), getOperand(root, 0)};
+        while (!stack.empty()) {
+            auto operand = stack.back();
+            stack.pop_back();
+            const auto operandNode = nodes_.at(operand.first);
+            if (operand.second == 0 && isChainNode(operandNode, root.getOperation()) && isInnerChainNode(operandNode)) {
+                innerNodes.push_back(operand.first);
+                stack.push_back(getOperand(operandNode, 1));
+                stack.push_back(getOperand(operandNode, 0));
+            } else {
+                leaves.push_back(operand);
+            }
+        }
+    }
+
+    void setOperands(core::NodeObjectWrapper& node, const Operand& lhs, const Operand& rhs) {
+        std::vector<uint64_t> inputIDs = {lhs.first, rhs.first};
+        node.setInputNodeIDs(inputIDs);
+        std::vector<uint32_t> inputOffsets;
+        if (lhs.second != 0 || rhs.second != 0) {
+            inputOffsets = {lhs.second, rhs.second};
+        }
+        node.setInputOffsets(inputOffsets);
+    }
+
+    /**
+     * @brief Rebuilds the chain below the root by always combining the two shallowest operands.
+     * This yields a tree of minimal height for the given leaf depths.
+     *
+     * @return true if the chain was rebuilt, false if this would not reduce the depth of the root
+     */
+    bool rebalanceChain(core::NodeObjectWrapper& root) {
+        std::vector<Operand> operands;
+        std::vector<Identifier> innerNodes;
+        collectChain(root, operands, innerNodes);
+        if (operands.size() < 3) {
+            return false;
+        }
+        const auto operation = root.getOperation();
+        const size_t numberOfLeaves = operands.size();
+
+        // the operand index breaks ties between equally deep operands deterministically
+        using Entry = std::pair<Depth, size_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        std::vector<Depth> operandDepths;
+        for (size_t index = 0; index < numberOfLeaves; ++index) {
+            operandDepths.push_back(getDepth(operands[index].first));
+            queue.emplace(operandDepths.back(), index);
+        }
+        std::vector<std::pair<size_t, size_t>> combinations;
+        while (queue.size() > 1) {
+            auto lhs = queue.top();
+            queue.pop();
+            auto rhs = queue.top();
+            queue.pop();
+            combinations.emplace_back(lhs.second, rhs.second);
+            operandDepths.push_back(combine(lhs.first, rhs.first, operation));
+            queue.emplace(operandDepths.back(), operandDepths.size() - 1);
+        }
+        if (!(operandDepths.back() < depths_.at(root.getNodeID()))) {
+            return false;
+        }
+
+        // reuse the inner nodes for the new tree, the root computes the last combination
+        innerNodes.push_back(root.getNodeID());
+        for (auto nodeID : innerNodes) {
+            for (auto inputID : nodes_.at(nodeID).getInputNodeIDs()) {
+                successors_[inputID].erase(nodeID);
+            }
+        }
+        for (size_t index = 0; index < combinations.size(); ++index) {
+            auto nodeID = innerNodes[index];
+            auto node = nodes_.at(nodeID);
+            const auto& lhs = operands[combinations[index].first];
+            const auto& rhs = operands[combinations[index].second];
+            setOperands(node, lhs, rhs);
+            successors_[lhs.first].insert(nodeID);
+            successors_[rhs.first].insert(nodeID);
+            depths_[nodeID] = operandDepths[numberOfLeaves + index];
+            operands.emplace_back(nodeID, 0);
+        }
+        return true;
+    }
+
+    const bool onlyCountExpensiveOperations_;
+    std::unordered_map<Identifier, core::NodeObjectWrapper> nodes_;
+    std::unordered_map<Identifier, std::unordered_set<Identifier>> successors_;
+    std::unordered_map<Identifier, Depth> depths_;
+};
+
+void reduceTreeHeight(core::CircuitObjectWrapper& circuit, bool onlyCountExpensiveOperations) {
+    TreeHeightReducer reducer(onlyCountExpensiveOperations);
+    reducer.visit(circuit);
+}
+
+void reduceTreeHeight(core::ModuleObjectWrapper& module, bool onlyCountExpensiveOperations) {
+    for (auto name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        reduceTreeHeight(circuit, onlyCountExpensiveOperations);
+    }
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_TREEHEIGHTREDUCTION_H
+#define FUSE_TREEHEIGHTREDUCTION_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Rebalances chains of associative and commutative operations (And, Or, Xor, Add, Mul) into trees of minimal height.
+ *
+ * A chain consists of nodes with the same operation where every node but the root is only used by its successor in the chain,
+ * e.g. the n-ary accumulations produced by the frontends. Its leaves are combined in the order of their depth,
+ * s.t. deep inputs are placed close to the root. The chain keeps its number of nodes and the root keeps its identifier.
+ *
+ * @param circuit mutable circuit where the chains are rebalanced
+ * @param onlyCountExpensiveOperations if true, only non-linear operations (e.g. And for Boolean, Mul for arithmetic circuits)
+ * increase the depth, similar to getNodeInstructionDepths. Otherwise, every operation counts.
+ */
+void reduceTreeHeight(core::CircuitObjectWrapper& circuit, bool onlyCountExpensiveOperations = false);
+
+/**
+ * @brief Rebalances the chains of associative operations in every circuit inside the module.
+ */
+void reduceTreeHeight(core::ModuleObjectWrapper& module, bool onlyCountExpensiveOperations = false);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_TREEHEIGHTREDUCTION_H */
@@ -0,0 +1,360 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "VectorizationCostModel.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+#include "DepthAnalysis.h"
+
+namespace fuse::passes {
+
+/*
+VectorizationCostModel Member Functions
+ */
+
+size_t VectorizationCostModel::getPaddedWidth(size_t width) const {
+    size_t granularity = std::max<size_t>(paddingGranularity, 1);
+    return (width + granularity - 1) / granularity * granularity;
+}
+
+double VectorizationCostModel::getGateCost(core::ir::PrimitiveOperation operation, size_t width) const {
+    double lanes = static_cast<double>(getPaddedWidth(width));
+    if (isNonlinear(operation)) {
+        return gateCost + messageCost + lanes * (laneCost + nonlinearLaneCost);
+    }
+    return gateCost + lanes * laneCost;
+}
+
+VectorizationCostModel VectorizationCostModel::booleanGMW() {
+    using op = core::ir::PrimitiveOperation;
+    VectorizationCostModel model;
+    model.protocol = "BooleanGMW";
+    model.roundCost = 1000.0;
+    model.messageCost = 50.0;
+    model.gateCost = 10.0;
+    model.laneCost = 0.05;
+    model.nonlinearLaneCost = 0.1;
+    model.paddingGranularity = 8;
+    model.nonlinearOperations = {op::And, op::Or, op::Nand, op::Nor, op::Mux};
+    return model;
+}
+
+VectorizationCostModel VectorizationCostModel::BMR() {
+    using op = core::ir::PrimitiveOperation;
+    VectorizationCostModel model;
+    model.protocol = "BMR";
+    model.roundCost = 0.0;
+    model.messageCost = 20.0;
+    model.gateCost = 10.0;
+    model.laneCost = 0.05;
+    model.nonlinearLaneCost = 4.0;
+    model.paddingGranularity = 1;
+    model.nonlinearOperations = {op::And, op::Or, op::Nand, op::Nor, op::Mux};
+    return model;
+}
+
+namespace {
+
+bool isVectorizableOperation(core::ir::PrimitiveOperation operation) {
+    using op = core::ir::PrimitiveOperation;
+    switch (operation) {
+        case op::And:
+        case op::Xor:
+        case op::Not:
+        case op::Or:
+        case op::Nand:
+        case op::Nor:
+        case op::Xnor:
+        case op::Gt:
+        case op::Ge:
+        case op::Lt:
+        case op::Le:
+        case op::Eq:
+        case op::Add:
+        case op::Mul:
+        case op::Div:
+        case op::Neg:
+        case op::Sub:
+        case op::Mux:
+        case op::Square:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Indexes the circuit and its depths once, s.t. many plans can be created and estimated cheaply.
+ */
+class VectorizationPlanner {
+   public:
+    explicit VectorizationPlanner(const core::CircuitReadOnly& circuit) {
+        circuit.topologicalTraversal([&](const core::NodeReadOnly& node) {
+            auto inputs = node.getInputNodeIDs();
+            positions_[node.getNodeID()] = nodes_.size();
+            nodes_.push_back({node.getNodeID(), node.getOperation(), {inputs.begin(), inputs.end()}, node.getNumberOfOutputs()});
+        });
+
+        // the schedules enumerate the nodes in the same topological order as nodes_
+        auto schedule = computeLevelSchedule(circuit);
+        for (size_t pos = 0; pos < nodes_.size(); ++pos) {
+            nodeDepths_[nodes_[pos].id] = schedule.asapLevels[pos];
+        }
+        std::unordered_set<core::ir::PrimitiveOperation> operations;
+        for (const auto& node : nodes_) {
+            if (isVectorizableOperation(node.operation) && node.numberOfOutputs == 1) {
+                operations.insert(node.operation);
+            }
+        }
+        for (auto operation : operations) {
+            auto instructionSchedule = computeLevelSchedule(circuit, operation);
+            auto& levels = levels_[operation];
+            for (size_t level = 0; level < instructionSchedule.getNumberOfLevels(); ++level) {
+                for (auto pos : instructionSchedule.getASAPLayer(level)) {
+                    if (nodes_[pos].operation == operation && nodes_[pos].numberOfOutputs == 1) {
+                        levels[level].push_back(nodes_[pos].id);
+                    }
+                }
+            }
+        }
+    }
+
+    VectorizationPlan plan(const VectorizationCostModel& model, int maxDistance, size_t maxWidth) const {
+        VectorizationPlan result;
+        result.maxDistance = maxDistance;
+        result.maxWidth = maxWidth;
+        for (const auto& [operation, levels] : levels_) {
+            for (const auto& [instructionDepth, candidates] : levels) {
+                planLevel(model, operation, candidates, maxDistance, maxWidth, result.groups);
+            }
+        }
+        result.estimatedCost = estimate(model, result.groups);
+        result.estimatedCostWithoutVectorization = estimate(model, {});
+        return result;
+    }
+
+    double estimate(const VectorizationCostModel& model, const std::vector<std::vector<uint64_t>>& groups) const {
+        // every node that is not replaced forms its own unit, each group forms one unit
+        const size_t numberOfUnits = nodes_.size() + groups.size();
+        std::vector<size_t> unitOf(nodes_.size());
+        std::vector<bool> isUnit(numberOfUnits, true);
+        for (size_t pos = 0; pos < nodes_.size(); ++pos) {
+            unitOf[pos] = pos;
+        }
+        double gateCosts = 0.0;
+        std::vector<core::ir::PrimitiveOperation> unitOperation(numberOfUnits);
+        for (size_t group = 0; group < groups.size(); ++group) {
+            size_t unit = nodes_.size() + group;
+            for (auto nodeID : groups[group]) {
+                size_t pos = positions_.at(nodeID);
+                unitOf[pos] = unit;
+                isUnit[pos] = false;
+                unitOperation[unit] = nodes_[pos].operation;
+            }
+            gateCosts += model.getGateCost(unitOperation[unit], groups[group].size());
+        }
+        for (size_t pos = 0; pos < nodes_.size(); ++pos) {
+            unitOperation[pos] = nodes_[pos].operation;
+            if (isUnit[pos] && isVectorizableOperation(nodes_[pos].operation)) {
+                gateCosts += model.getGateCost(nodes_[pos].operation, nodes_[pos].numberOfOutputs);
+            }
+        }
+
+        // compute the number of rounds on the graph of units, fails if the groups introduce a cycle
+        std::vector<std::vector<size_t>> unitSuccessors(numberOfUnits);
+        std::vector<size_t> numberOfPredecessors(numberOfUnits, 0);
+        for (size_t pos = 0; pos < nodes_.size(); ++pos) {
+            size_t unit = unitOf[pos];
+            for (auto inputID : nodes_[pos].inputs) {
+                auto inputPos = positions_.find(inputID);
+                if (inputPos == positions_.end()) {
+                    continue;
+                }
+                size_t inputUnit = unitOf[inputPos->second];
+                if (inputUnit == unit) {
+                    return std::numeric_limits<double>::infinity();
+                }
+                unitSuccessors[inputUnit].push_back(unit);
+                ++numberOfPredecessors[unit];
+            }
+        }
+        std::deque<size_t> ready;
+        size_t numberOfActiveUnits = 0;
+        for (size_t unit = 0; unit < numberOfUnits; ++unit) {
+            if (isUnit[unit]) {
+                ++numberOfActiveUnits;
+                if (numberOfPredecessors[unit] == 0) {
+                    ready.push_back(unit);
+                }
+            }
+        }
+        std::vector<size_t> rounds(numberOfUnits, 0);
+        size_t maxRounds = 0;
+        size_t numberOfProcessedUnits = 0;
+        while (!ready.empty()) {
+            size_t unit = ready.front();
+            ready.pop_front();
+            ++numberOfProcessedUnits;
+            if (model.isNonlinear(unitOperation[unit])) {
+                ++rounds[unit];
+            }
+            maxRounds = std::max(maxRounds, rounds[unit]);
+            for (auto successor : unitSuccessors[unit]) {
+                rounds[successor] = std::max(rounds[successor], rounds[unit]);
+                if (--numberOfPredecessors[successor] == 0) {
+                    ready.push_back(successor);
+                }
+            }
+        }
+        if (numberOfProcessedUnits != numberOfActiveUnits) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return static_cast<double>(maxRounds) * model.roundCost + gateCosts;
+    }
+
+   private:
+    struct NodeInfo {
+        uint64_t id;
+        core::ir::PrimitiveOperation operation;
+        std::vector<uint64_t> inputs;
+        size_t numberOfOutputs;
+    };
+
+    void planLevel(const VectorizationCostModel& model, core::ir::PrimitiveOperation operation, const std::vector<uint64_t>& candidates,
+                   int maxDistance, size_t maxWidth, std::vector<std::vector<uint64_t>>& groups) const {
+        if (candidates.size() < 2) {
+            return;
+        }
+        // only keep nodes close to the median depth, like vectorizeInstructions
+        std::vector<int64_t> depths;
+        for (auto nodeID : candidates) {
+            depths.push_back(nodeDepths_.at(nodeID));
+        }
+        std::sort(depths.begin(), depths.end());
+        int64_t medianDepth = depths.size() % 2 == 0 ? (depths[depths.size() / 2 - 1] + depths[depths.size() / 2]) / 2 : depths[depths.size() / 2];
+        std::vector<uint64_t> selected;
+        for (auto nodeID : candidates) {
+            if (std::abs(medianDepth - static_cast<int64_t>(nodeDepths_.at(nodeID))) <= maxDistance) {
+                selected.push_back(nodeID);
+            }
+        }
+        const size_t n = selected.size();
+        if (n < 2) {
+            return;
+        }
+        // nodes of similar depth end up in the same group
+        std::stable_sort(selected.begin(), selected.end(), [&](uint64_t lhs, uint64_t rhs) { return nodeDepths_.at(lhs) < nodeDepths_.at(rhs); });
+
+        size_t widthLimit = n;
+        if (model.maxWidth != 0) {
+            widthLimit = std::min(widthLimit, model.maxWidth);
+        }
+        if (maxWidth != 0) {
+            widthLimit = std::min(widthLimit, maxWidth);
+        }
+        // split the level into g groups of balanced width and take the cheapest g, g = n means no vectorization
+        size_t bestNumberOfGroups = n;
+        double bestCost = std::numeric_limits<double>::infinity();
+        for (size_t numberOfGroups = (n + widthLimit - 1) / widthLimit; numberOfGroups <= n; ++numberOfGroups) {
+            size_t width = n / numberOfGroups;
+            size_t numberOfWiderGroups = n % numberOfGroups;
+            double cost = numberOfWiderGroups * model.getGateCost(operation, width + 1) + (numberOfGroups - numberOfWiderGroups) * model.getGateCost(operation, width);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestNumberOfGroups = numberOfGroups;
+            }
+        }
+
+        size_t width = n / bestNumberOfGroups;
+        size_t numberOfWiderGroups = n % bestNumberOfGroups;
+        auto it = selected.begin();
+        for (size_t group = 0; group < bestNumberOfGroups; ++group) {
+            size_t groupWidth = group < numberOfWiderGroups ? width + 1 : width;
+            if (groupWidth >= 2) {
+                groups.emplace_back(it, it + groupWidth);
+            }
+            it += groupWidth;
+        }
+    }
+
+    std::vector<NodeInfo> nodes_;
+    std::unordered_map<uint64_t, size_t> positions_;
+    std::unordered_map<uint64_t, uint64_t> nodeDepths_;
+    std::map<core::ir::PrimitiveOperation, std::map<uint64_t, std::vector<uint64_t>>> levels_;
+};
+
+double estimateVectorizationCost(const core::CircuitReadOnly& circuit, const VectorizationCostModel& model, const std::vector<std::vector<uint64_t>>& groups) {
+    VectorizationPlanner planner(circuit);
+    return planner.estimate(model, groups);
+}
+
+VectorizationPlan planVectorization(const core::CircuitReadOnly& circuit, const VectorizationCostModel& model, int maxDistance, size_t maxWidth) {
+    VectorizationPlanner planner(circuit);
+    return planner.plan(model, maxDistance, maxWidth);
+}
+
+VectorizationPlan autoTuneVectorization(const core::CircuitReadOnly& circuit, const VectorizationCostModel& model) {
+    const std::vector<int> maxDistances = {0, 1, 2, 4, 8, 16, std::numeric_limits<int>::max() / 2};
+    const std::vector<size_t> maxWidths = {0, 8, 16, 32, 64};
+
+    VectorizationPlanner planner(circuit);
+    VectorizationPlan bestPlan;
+    bestPlan.estimatedCost = std::numeric_limits<double>::infinity();
+    for (auto maxDistance : maxDistances) {
+        for (auto maxWidth : maxWidths) {
+            auto plan = planner.plan(model, maxDistance, maxWidth);
+            if (plan.estimatedCost < bestPlan.estimatedCost) {
+                bestPlan = std::move(plan);
+            }
+        }
+    }
+    return bestPlan;
+}
+
+VectorizationPlan vectorizeWithCostModel(core::CircuitObjectWrapper& circuit, const VectorizationCostModel& model, bool autoTune, int maxDistance) {
+    auto plan = autoTune ? autoTuneVectorization(circuit, model) : planVectorization(circuit, model, maxDistance);
+    // keep the circuit as it is if vectorization does not pay off
+    if (!(plan.estimatedCost < plan.estimatedCostWithoutVectorization)) {
+        plan.groups.clear();
+        plan.estimatedCost = plan.estimatedCostWithoutVectorization;
+    }
+    if (!plan.groups.empty()) {
+        circuit.replaceNodesBySIMDNodes(plan.groups);
+    }
+    return plan;
+}
+
+void vectorizeWithCostModel(core::ModuleObjectWrapper& module, const VectorizationCostModel& model, bool autoTune, int maxDistance) {
+    for (auto name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        vectorizeWithCostModel(circuit, model, autoTune, maxDistance);
+    }
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_VECTORIZATIONCOSTMODEL_H
+#define FUSE_VECTORIZATIONCOSTMODEL_H
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+/**
+ * @brief Protocol-specific cost model used to choose SIMD group sizes.
+ *
+ * The estimated cost of a circuit is its depth w.r.t. the non-linear operations times the round cost
+ * plus the cost of every (SIMD or scalar) gate: each gate has a fixed overhead, non-linear gates additionally send a message,
+ * and each lane is paid for after rounding the width up to a multiple of paddingGranularity.
+ * The default values of the profiles are relative costs that can be calibrated for a concrete setup.
+ */
+struct VectorizationCostModel {
+    std::string protocol;
+    // cost of one communication round, i.e. of one layer of non-linear gates
+    double roundCost = 0.0;
+    // fixed cost of sending the message of one non-linear gate
+    double messageCost = 0.0;
+    // fixed cost of every gate, e.g. for creating and scheduling it
+    double gateCost = 0.0;
+    // cost of a single (possibly padded) lane of a gate
+    double laneCost = 0.0;
+    // additional cost of a single (possibly padded) lane of a non-linear gate, e.g. for multiplication triples or garbled rows
+    double nonlinearLaneCost = 0.0;
+    // gate widths are padded to a multiple of this value
+    size_t paddingGranularity = 1;
+    // maximum number of lanes of a SIMD gate, 0 means unlimited
+    size_t maxWidth = 0;
+    std::unordered_set<core::ir::PrimitiveOperation> nonlinearOperations;
+
+    bool isNonlinear(core::ir::PrimitiveOperation operation) const { return nonlinearOperations.contains(operation); }
+    size_t getPaddedWidth(size_t width) const;
+    double getGateCost(core::ir::PrimitiveOperation operation, size_t width) const;
+
+    /**
+     * @brief Boolean GMW: every layer of non-linear gates costs one round, shares are packed into bytes.
+     */
+    static VectorizationCostModel booleanGMW();
+
+    /**
+     * @brief BMR: constant number of rounds, but every lane of a non-linear gate costs a garbled table.
+     */
+    static VectorizationCostModel BMR();
+};
+
+struct VectorizationPlan {
+    // groups of node IDs that are replaced by one SIMD node each
+    std::vector<std::vector<uint64_t>> groups;
+    double estimatedCost = 0.0;
+    double estimatedCostWithoutVectorization = 0.0;
+    int maxDistance = 0;
+    size_t maxWidth = 0;
+};
+
+/**
+ * @brief Estimates the cost of the circuit if the given groups were replaced by SIMD nodes.
+ *
+ * @return the estimated cost or infinity if the groups would introduce a cyclic dependency
+ */
+double estimateVectorizationCost(const core::CircuitReadOnly& circuit, const VectorizationCostModel& model, const std::vector<std::vector<uint64_t>>& groups);
+
+/**
+ * @brief Chooses SIMD groups for all vectorizable operations with the cost model.
+ * Like vectorizeInstructions, candidates share the same instruction depth and
+ * differ at most by maxDistance from the median node depth of their level.
+ * The number of groups per level is chosen s.t. the estimated cost of the level is minimal.
+ *
+ * @param maxWidth maximum number of lanes per group in addition to the limit of the model, 0 means unlimited
+ */
+VectorizationPlan planVectorization(const core::CircuitReadOnly& circuit, const VectorizationCostModel& model, int maxDistance = 1, size_t maxWidth = 0);
+
+/**
+ * @brief Searches maximum distances and widths for the plan with the lowest estimated cost.
+ */
+VectorizationPlan autoTuneVectorization(const core::CircuitReadOnly& circuit, const VectorizationCostModel& model);
+
+/**
+ * @brief Vectorizes the circuit with the plan of the lowest estimated cost for the protocol profile.
+ *
+ * @param autoTune if true, the parameters are chosen by autoTuneVectorization, otherwise the given maxDistance is used
+ * @return the plan that was applied
+ */
+VectorizationPlan vectorizeWithCostModel(core::CircuitObjectWrapper& circuit, const VectorizationCostModel& model, bool autoTune = true, int maxDistance = 1);
+
+/**
+ * @brief Vectorizes every circuit in the module with vectorizeWithCostModel.
+ */
+void vectorizeWithCostModel(core::ModuleObjectWrapper& module, const VectorizationCostModel& model, bool autoTune = true, int maxDistance = 1);
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_VECTORIZATIONCOSTMODEL_H */
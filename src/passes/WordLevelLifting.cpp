@@ -0,0 +1,697 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "WordLevelLifting.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "NodeSuccessorsAnalysis.h"
+#include "OperandWidths.h"
+
+namespace fuse::passes {
+
+namespace {
+
+using op = core::ir::PrimitiveOperation;
+using Identifier = uint64_t;
+using Offset = uint32_t;
+
+uint64_t getMask(size_t width) { return width >= 64 ? ~0ULL : (1ULL << width) - 1; }
+
+int64_t signExtend(uint64_t value, size_t width) {
+    return width >= 64 ? static_cast<int64_t>(value) : static_cast<int64_t>(value << (64 - width)) >> (64 - width);
+}
+
+/**
+ * @brief A cone of Boolean gates (in topological order) whose leaves are constants or the bits of two words.
+ */
+struct BitCone {
+    struct Ref {
+        enum class Kind { Constant, OperandBit, Gate } kind;
+        size_t index;  // constant value, gate index or operand bit
+        size_t operand = 0;
+    };
+    struct Gate {
+        op operation;
+        std::vector<Ref> inputs;
+    };
+    struct Operand {
+        Identifier split;
+        Identifier word;
+        Offset wordOffset;
+        size_t width;
+        std::optional<bool> isSigned;
+        std::optional<core::ir::DataTypeTableT> wordType;
+    };
+
+    std::vector<Gate> gates;
+    std::vector<Identifier> gateIDs;
+    std::vector<Ref> outputs;
+    std::vector<Operand> operands;
+
+    // evaluates the cone on 64 pairs of operands at once, one pair per bit of the masks
+    std::vector<uint64_t> simulate(const std::vector<uint64_t>& aBits, const std::vector<uint64_t>& bBits) const {
+        std::vector<uint64_t> values(gates.size());
+        auto get = [&](const Ref& ref) -> uint64_t {
+            switch (ref.kind) {
+                case Ref::Kind::Constant:
+                    return ref.index ? ~0ULL : 0ULL;
+                case Ref::Kind::OperandBit:
+                    return ref.operand == 0 ? aBits[ref.index] : bBits[ref.index];
+                default:
+                    return values[ref.index];
+            }
+        };
+        for (size_t g = 0; g < gates.size(); ++g) {
+            const auto& gate = gates[g];
+            uint64_t value = get(gate.inputs.at(0));
+            for (size_t in = 1; in < gate.inputs.size(); ++in) {
+                switch (gate.operation) {
+                    case op::And:
+                    case op::Nand:
+                        value &= get(gate.inputs[in]);
+                        break;
+                    case op::Or:
+                    case op::Nor:
+                        value |= get(gate.inputs[in]);
+                        break;
+                    default:
+                        value ^= get(gate.inputs[in]);
+                        break;
+                }
+            }
+            bool negate = gate.operation == op::Not || gate.operation == op::Nand || gate.operation == op::Nor || gate.operation == op::Xnor;
+            values[g] = negate ? ~value : value;
+        }
+        std::vector<uint64_t> result;
+        for (const auto& output : outputs) {
+            result.push_back(get(output));
+        }
+        return result;
+    }
+};
+
+struct Lifting {
+    op operation;
+    bool swapOperands;
+};
+
+/**
+ * @brief Reduced ordered binary decision diagrams over the operand bits of a cone, used to prove that a cone computes a word-level operation.
+ * Variable 2i is bit i of the first operand and variable 2i + 1 bit i of the second one; this interleaved order keeps adders,
+ * subtractors and comparators linear in the width. Once more than maxNodes nodes exist, the manager is exhausted and all results are invalid.
+ */
+class Bdd {
+   public:
+    using Function = uint32_t;
+    static constexpr Function kFalse = 0;
+    static constexpr Function kTrue = 1;
+
+    explicit Bdd(size_t maxNodes) : maxNodes_(std::min<size_t>(maxNodes, size_t{1} << 28)) {
+        nodes_.push_back({kTerminal, kFalse, kFalse});
+        nodes_.push_back({kTerminal, kTrue, kTrue});
+    }
+
+    bool isExhausted() const { return exhausted_; }
+
+    Function variable(size_t index) { return makeNode(static_cast<uint32_t>(index), kFalse, kTrue); }
+
+    Function conjunction(Function f, Function g) { return apply(Operation::And, f, g); }
+    Function disjunction(Function f, Function g) { return apply(Operation::Or, f, g); }
+    Function exclusiveOr(Function f, Function g) { return apply(Operation::Xor, f, g); }
+    Function negation(Function f) { return apply(Operation::Xor, f, kTrue); }
+
+   private:
+    enum class Operation { And, Or, Xor };
+    static constexpr uint32_t kTerminal = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        uint32_t variable;
+        Function low;
+        Function high;
+    };
+
+    Function makeNode(uint32_t variable, Function low, Function high) {
+        if (low == high) {
+            return low;
+        }
+        const uint64_t key = (uint64_t{variable} << 56) | (uint64_t{low} << 28) | high;
+        if (auto node = unique_.find(key); node != unique_.end()) {
+            return node->second;
+        }
+        if (nodes_.size() >= maxNodes_) {
+            exhausted_ = true;
+            return kFalse;
+        }
+        nodes_.push_back({variable, low, high});
+        unique_.emplace(key, nodes_.size() - 1);
+        return nodes_.size() - 1;
+    }
+
+    Function apply(Operation operation, Function f, Function g) {
+        if (exhausted_) {
+            return kFalse;
+        }
+        switch (operation) {
+            case Operation::And:
+                if (f == kFalse || g == kFalse) return kFalse;
+                if (f == kTrue || f == g) return g;
+                if (g == kTrue) return f;
+                break;
+            case Operation::Or:
+                if (f == kTrue || g == kTrue) return kTrue;
+                if (f == kFalse || f == g) return g;
+                if (g == kFalse) return f;
+                break;
+            case Operation::Xor:
+                if (f == g) return kFalse;
+                if (f == kFalse) return g;
+                if (g == kFalse) return f;
+                break;
+        }
+        if (f > g) {
+            std::swap(f, g);
+        }
+        auto& cache = caches_[static_cast<size_t>(operation)];
+        const uint64_t key = (uint64_t{f} << 32) | g;
+        if (auto result = cache.find(key); result != cache.end()) {
+            return result->second;
+        }
+        const auto fNode = nodes_[f];
+        const auto gNode = nodes_[g];
+        const uint32_t top = std::min(fNode.variable, gNode.variable);
+        const Function low = apply(operation, fNode.variable == top ? fNode.low : f, gNode.variable == top ? gNode.low : g);
+        const Function high = apply(operation, fNode.variable == top ? fNode.high : f, gNode.variable == top ? gNode.high : g);
+        const Function result = makeNode(top, low, high);
+        cache.emplace(key, result);
+        return result;
+    }
+
+    size_t maxNodes_;
+    bool exhausted_ = false;
+    std::vector<Node> nodes_;
+    std::unordered_map<uint64_t, Function> unique_;
+    std::unordered_map<uint64_t, Function> caches_[3];
+};
+
+// the functions of the output bits of the cone
+std::vector<Bdd::Function> buildConeFunctions(Bdd& bdd, const BitCone& cone) {
+    std::vector<Bdd::Function> values(cone.gates.size());
+    auto get = [&](const BitCone::Ref& ref) {
+        switch (ref.kind) {
+            case BitCone::Ref::Kind::Constant:
+                return ref.index ? Bdd::kTrue : Bdd::kFalse;
+            case BitCone::Ref::Kind::OperandBit:
+                return bdd.variable(2 * ref.index + ref.operand);
+            default:
+                return values[ref.index];
+        }
+    };
+    for (size_t g = 0; g < cone.gates.size() && !bdd.isExhausted(); ++g) {
+        const auto& gate = cone.gates[g];
+        Bdd::Function value = get(gate.inputs.at(0));
+        for (size_t in = 1; in < gate.inputs.size(); ++in) {
+            switch (gate.operation) {
+                case op::And:
+                case op::Nand:
+                    value = bdd.conjunction(value, get(gate.inputs[in]));
+                    break;
+                case op::Or:
+                case op::Nor:
+                    value = bdd.disjunction(value, get(gate.inputs[in]));
+                    break;
+                default:
+                    value = bdd.exclusiveOr(value, get(gate.inputs[in]));
+                    break;
+            }
+        }
+        bool negate = gate.operation == op::Not || gate.operation == op::Nand || gate.operation == op::Nor || gate.operation == op::Xnor;
+        values[g] = negate ? bdd.negation(value) : value;
+    }
+    std::vector<Bdd::Function> result;
+    for (const auto& output : cone.outputs) {
+        result.push_back(get(output));
+    }
+    return result;
+}
+
+// the functions of the output bits of the lifted operation, built from textbook ripple-carry and shift-and-add circuits
+std::vector<Bdd::Function> buildReferenceFunctions(Bdd& bdd, op operation, bool swapOperands, size_t width, bool isSigned) {
+    using Word = std::vector<Bdd::Function>;
+    Word a(width), b(width);
+    for (size_t bit = 0; bit < width; ++bit) {
+        a[bit] = bdd.variable(2 * bit);
+        b[bit] = bdd.variable(2 * bit + 1);
+    }
+    if (swapOperands) {
+        std::swap(a, b);
+    }
+    auto add = [&](const Word& x, const Word& y, Bdd::Function carry) {
+        Word sum(width);
+        for (size_t bit = 0; bit < width; ++bit) {
+            auto propagate = bdd.exclusiveOr(x[bit], y[bit]);
+            sum[bit] = bdd.exclusiveOr(propagate, carry);
+            carry = bdd.disjunction(bdd.conjunction(x[bit], y[bit]), bdd.conjunction(propagate, carry));
+        }
+        return sum;
+    };
+    auto invert = [&](Word x) {
+        for (auto& bit : x) {
+            bit = bdd.negation(bit);
+        }
+        return x;
+    };
+    // signed comparisons are unsigned comparisons with inverted sign bits
+    auto less = [&](Word x, Word y) {
+        if (isSigned) {
+            x.back() = bdd.negation(x.back());
+            y.back() = bdd.negation(y.back());
+        }
+        Bdd::Function result = Bdd::kFalse;
+        for (size_t bit = 0; bit < width; ++bit) {
+            auto differ = bdd.exclusiveOr(x[bit], y[bit]);
+            result = bdd.disjunction(bdd.conjunction(differ, y[bit]), bdd.conjunction(bdd.negation(differ), result));
+        }
+        return result;
+    };
+
+    switch (operation) {
+        case op::Add:
+            return add(a, b, Bdd::kFalse);
+        case op::Sub:
+            return add(a, invert(b), Bdd::kTrue);
+        case op::Mul: {
+            Word product(width, Bdd::kFalse);
+            for (size_t shift = 0; shift < width && !bdd.isExhausted(); ++shift) {
+                Word partial(width, Bdd::kFalse);
+                for (size_t bit = shift; bit < width; ++bit) {
+                    partial[bit] = bdd.conjunction(a[bit - shift], b[shift]);
+                }
+                product = add(product, partial, Bdd::kFalse);
+            }
+            return product;
+        }
+        case op::Eq: {
+            Bdd::Function equal = Bdd::kTrue;
+            for (size_t bit = 0; bit < width; ++bit) {
+                equal = bdd.conjunction(equal, bdd.negation(bdd.exclusiveOr(a[bit], b[bit])));
+            }
+            return {equal};
+        }
+        case op::Lt:
+            return {less(a, b)};
+        case op::Gt:
+            return {less(b, a)};
+        case op::Le:
+            return {bdd.negation(less(b, a))};
+        case op::Ge:
+            return {bdd.negation(less(a, b))};
+        default:
+            throw std::logic_error("No reference implementation for word-level operation");
+    }
+}
+
+
+class WordLevelLifter {
+   public:
+    WordLevelLifter(core::CircuitObjectWrapper& circuit, const WordLevelLiftingOptions& options) : circuit_(circuit), options_(options) {}
+
+    size_t run() {
+        for (auto node : circuit_) {
+            positions_[node.getNodeID()] = nodes_.size();
+            nodes_.push_back(node);
+        }
+        auto successors = getNodeSuccessors(circuit_);
+
+        std::vector<std::pair<size_t, Lifting>> liftings;
+        for (size_t pos = 0; pos < nodes_.size(); ++pos) {
+            const auto& node = nodes_[pos];
+            std::vector<std::pair<Identifier, Offset>> outputBits;
+            bool isWord = node.getOperation() == op::Merge;
+            if (isWord) {
+                auto inputs = node.getInputNodeIDs();
+                for (size_t in = 0; in < inputs.size(); ++in) {
+                    outputBits.emplace_back(inputs[in], node.usesInputOffsets() ? node.getInputOffsets()[in] : 0);
+                }
+            } else if (isBooleanGate(node.getOperation())) {
+                // comparators end in a single bit that leaves the Boolean part of the circuit
+                bool leavesBooleanPart = false;
+                for (auto successor : successors[node.getNodeID()]) {
+                    auto successorOperation = nodes_[positions_.at(successor)].getOperation();
+                    leavesBooleanPart |= !isBooleanGate(successorOperation) && successorOperation != op::Merge;
+                }
+                if (!leavesBooleanPart) {
+                    continue;
+                }
+                outputBits.emplace_back(node.getNodeID(), 0);
+            } else {
+                continue;
+            }
+
+            auto cone = buildCone(outputBits);
+            if (!cone || cone->operands.size() != 2 || cone->operands[0].width != cone->operands[1].width || cone->operands[0].width > 64 ||
+                (isWord && outputBits.size() != cone->operands[0].width)) {
+                continue;
+            }
+            auto lifting = classify(*cone, isWord);
+            if (lifting) {
+                liftings.emplace_back(pos, *lifting);
+                operandsOf_[pos] = {cone->operands[0], cone->operands[1]};
+                maybeDead_.insert(cone->gateIDs.begin(), cone->gateIDs.end());
+                maybeDead_.insert(cone->operands[0].split);
+                maybeDead_.insert(cone->operands[1].split);
+            }
+        }
+
+        for (const auto& [pos, lifting] : liftings) {
+            auto [a, b] = operandsOf_.at(pos);
+            if (lifting.swapOperands) {
+                std::swap(a, b);
+            }
+            std::vector<Identifier> inputs = {a.word, b.word};
+            std::vector<Offset> offsets = {a.wordOffset, b.wordOffset};
+            auto& node = nodes_[pos];
+            node.setPrimitiveOperation(lifting.operation);
+            node.setInputNodeIDs(inputs);
+            if (a.wordOffset == 0 && b.wordOffset == 0) {
+                node.setInputOffsets({});
+            } else {
+                node.setInputOffsets(offsets);
+            }
+            // the node now reads two words instead of the bits of the Merge node
+            if (a.wordType && b.wordType) {
+                core::DataTypeObjectWrapper aType(&*a.wordType);
+                core::DataTypeObjectWrapper bType(&*b.wordType);
+                node.setInputDataTypes({&aType, &bType});
+            } else {
+                node.setInputDataTypes(std::vector<const core::DataTypeReadOnly*>{});
+            }
+        }
+        removeUnusedBitLevelNodes();
+        return liftings.size();
+    }
+
+   private:
+    // removes the gates and Split nodes of lifted cones that are not used by the remaining circuit anymore
+    void removeUnusedBitLevelNodes() {
+        if (maybeDead_.empty()) {
+            return;
+        }
+        auto successors = getNodeSuccessors(circuit_);
+        std::unordered_set<Identifier> dead;
+        std::vector<Identifier> workingSet;
+        for (auto id : maybeDead_) {
+            if (successors[id].empty()) {
+                workingSet.push_back(id);
+            }
+        }
+        while (!workingSet.empty()) {
+            auto id = workingSet.back();
+            workingSet.pop_back();
+            if (!dead.insert(id).second) {
+                continue;
+            }
+            for (auto input : nodes_[positions_.at(id)].getInputNodeIDs()) {
+                successors[input].erase(id);
+                if (maybeDead_.contains(input) && successors[input].empty()) {
+                    workingSet.push_back(input);
+                }
+            }
+        }
+        circuit_.removeNodes(dead);
+    }
+
+    std::optional<BitCone> buildCone(const std::vector<std::pair<Identifier, Offset>>& outputBits) const {
+        BitCone cone;
+        std::unordered_map<Identifier, size_t> gateIndex;
+
+        // leaves are constants or bits of (at most two) Split nodes, everything else ends the search
+        auto getLeaf = [&](Identifier id, Offset offset) -> std::optional<BitCone::Ref> {
+            const auto& node = nodes_[positions_.at(id)];
+            if (node.getOperation() == op::Split && node.getNumberOfInputs() == 1) {
+                auto operand = std::find_if(cone.operands.begin(), cone.operands.end(), [&](const auto& o) { return o.split == id; });
+                if (operand == cone.operands.end()) {
+                    if (cone.operands.size() == 2) {
+                        return std::nullopt;
+                    }
+                    BitCone::Operand newOperand{id, node.getInputNodeIDs()[0], node.usesInputOffsets() ? node.getInputOffsets()[0] : 0, node.getNumberOfOutputs(), std::nullopt};
+                    auto types = node.getInputDataTypes();
+                    if (!types.empty()) {
+                        core::ir::DataTypeTableT wordType;
+                        wordType.primitive_type = types[0]->getPrimitiveType();
+                        wordType.security_level = types[0]->getSecurityLevel();
+                        auto shape = types[0]->getShape();
+                        wordType.shape.assign(shape.begin(), shape.end());
+                        newOperand.wordType = wordType;
+                        switch (types[0]->getPrimitiveType()) {
+                            case core::ir::PrimitiveType::Int8:
+                            case core::ir::PrimitiveType::Int16:
+                            case core::ir::PrimitiveType::Int32:
+                            case core::ir::PrimitiveType::Int64:
+                                newOperand.isSigned = true;
+                                break;
+                            case core::ir::PrimitiveType::UInt8:
+                            case core::ir::PrimitiveType::UInt16:
+                            case core::ir::PrimitiveType::UInt32:
+                            case core::ir::PrimitiveType::UInt64:
+                                newOperand.isSigned = false;
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+                    cone.operands.push_back(newOperand);
+                    operand = cone.operands.end() - 1;
+                }
+                return BitCone::Ref{BitCone::Ref::Kind::OperandBit, offset, static_cast<size_t>(std::distance(cone.operands.begin(), operand))};
+            }
+            if (node.isConstantNode() && offset == 0 && node.getConstantType()->getPrimitiveType() == core::ir::PrimitiveType::Bool) {
+                return BitCone::Ref{BitCone::Ref::Kind::Constant, node.getConstantBool() ? 1u : 0u};
+            }
+            return std::nullopt;
+        };
+        auto isGate = [&](Identifier id, Offset offset) {
+            const auto& node = nodes_[positions_.at(id)];
+            return offset == 0 && isBooleanGate(node.getOperation()) && node.getNumberOfOutputs() <= 1;
+        };
+
+        // iterative post-order traversal, cones of multipliers are too deep for recursion
+        std::vector<Identifier> stack;
+        for (auto [id, offset] : outputBits) {
+            if (isGate(id, offset)) {
+                stack.push_back(id);
+            }
+        }
+        while (!stack.empty()) {
+            Identifier id = stack.back();
+            if (gateIndex.contains(id)) {
+                stack.pop_back();
+                continue;
+            }
+            const auto& node = nodes_[positions_.at(id)];
+            auto inputs = node.getInputNodeIDs();
+            BitCone::Gate gate{node.getOperation(), {}};
+            bool ready = true;
+            for (size_t in = 0; in < inputs.size(); ++in) {
+                Offset offset = node.usesInputOffsets() ? node.getInputOffsets()[in] : 0;
+                if (isGate(inputs[in], offset)) {
+                    auto index = gateIndex.find(inputs[in]);
+                    if (index == gateIndex.end()) {
+                        stack.push_back(inputs[in]);
+                        ready = false;
+                    } else {
+                        gate.inputs.push_back({BitCone::Ref::Kind::Gate, index->second});
+                    }
+                    continue;
+                }
+                auto leaf = getLeaf(inputs[in], offset);
+                if (!leaf) {
+                    return std::nullopt;
+                }
+                gate.inputs.push_back(*leaf);
+            }
+            if (!ready) {
+                continue;
+            }
+            if (gate.inputs.empty()) {
+                return std::nullopt;
+            }
+            stack.pop_back();
+            gateIndex[id] = cone.gates.size();
+            cone.gates.push_back(std::move(gate));
+            cone.gateIDs.push_back(id);
+            if (cone.gates.size() > options_.maxConeSize) {
+                return std::nullopt;
+            }
+        }
+
+        for (auto [id, offset] : outputBits) {
+            if (isGate(id, offset)) {
+                cone.outputs.push_back({BitCone::Ref::Kind::Gate, gateIndex.at(id)});
+            } else {
+                auto leaf = getLeaf(id, offset);
+                if (!leaf) {
+                    return std::nullopt;
+                }
+                cone.outputs.push_back(*leaf);
+            }
+        }
+        return cone;
+    }
+
+    std::optional<Lifting> classify(const BitCone& cone, bool isWord) const {
+        const size_t width = cone.operands[0].width;
+        const uint64_t mask = getMask(width);
+        const auto isSigned = cone.operands[0].isSigned == cone.operands[1].isSigned ? cone.operands[0].isSigned : std::nullopt;
+        auto less = [&](uint64_t a, uint64_t b) { return *isSigned ? signExtend(a, width) < signExtend(b, width) : a < b; };
+
+        // candidate operations in order of preference with their reference implementation
+        std::vector<std::pair<Lifting, std::function<uint64_t(uint64_t, uint64_t)>>> candidates;
+        if (isWord) {
+            candidates.push_back({{op::Add, false}, [](uint64_t a, uint64_t b) { return a + b; }});
+            candidates.push_back({{op::Sub, false}, [](uint64_t a, uint64_t b) { return a - b; }});
+            candidates.push_back({{op::Sub, true}, [](uint64_t a, uint64_t b) { return b - a; }});
+            candidates.push_back({{op::Mul, false}, [](uint64_t a, uint64_t b) { return a * b; }});
+        } else {
+            candidates.push_back({{op::Eq, false}, [](uint64_t a, uint64_t b) { return uint64_t(a == b); }});
+            if (isSigned) {
+                candidates.push_back({{op::Lt, false}, [=](uint64_t a, uint64_t b) { return uint64_t(less(a, b)); }});
+                candidates.push_back({{op::Gt, false}, [=](uint64_t a, uint64_t b) { return uint64_t(less(b, a)); }});
+                candidates.push_back({{op::Le, false}, [=](uint64_t a, uint64_t b) { return uint64_t(!less(b, a)); }});
+                candidates.push_back({{op::Ge, false}, [=](uint64_t a, uint64_t b) { return uint64_t(!less(a, b)); }});
+            }
+        }
+        std::vector<bool> alive(candidates.size(), true);
+
+        auto check = [&](const std::vector<std::pair<uint64_t, uint64_t>>& lanes) {
+            std::vector<uint64_t> aBits(width, 0), bBits(width, 0);
+            for (size_t lane = 0; lane < lanes.size(); ++lane) {
+                for (size_t bit = 0; bit < width; ++bit) {
+                    aBits[bit] |= ((lanes[lane].first >> bit) & 1) << lane;
+                    bBits[bit] |= ((lanes[lane].second >> bit) & 1) << lane;
+                }
+            }
+            auto outputs = cone.simulate(aBits, bBits);
+            bool anyAlive = false;
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                for (size_t lane = 0; lane < lanes.size() && alive[c]; ++lane) {
+                    uint64_t expected = candidates[c].second(lanes[lane].first, lanes[lane].second) & (isWord ? mask : 1);
+                    uint64_t actual = 0;
+                    for (size_t bit = 0; bit < outputs.size(); ++bit) {
+                        actual |= ((outputs[bit] >> lane) & 1) << bit;
+                    }
+                    alive[c] = expected == actual;
+                }
+                anyAlive |= alive[c];
+            }
+            return anyAlive;
+        };
+
+        std::vector<std::pair<uint64_t, uint64_t>> lanes;
+        auto flush = [&]() {
+            bool anyAlive = lanes.empty() || check(lanes);
+            lanes.clear();
+            return anyAlive;
+        };
+        auto add = [&](uint64_t a, uint64_t b) {
+            lanes.emplace_back(a & mask, b & mask);
+            return lanes.size() < 64 || flush();
+        };
+
+        const bool isExhaustive = 2 * width <= 16;
+        if (isExhaustive) {
+            for (uint64_t a = 0; a <= mask; ++a) {
+                for (uint64_t b = 0; b <= mask; ++b) {
+                    if (!add(a, b)) {
+                        return std::nullopt;
+                    }
+                }
+            }
+        } else {
+            const uint64_t signBit = 1ULL << (width - 1);
+            const std::vector<uint64_t> corners = {0, 1, 2, mask, mask - 1, signBit, signBit - 1, signBit + 1};
+            for (auto a : corners) {
+                for (auto b : corners) {
+                    if (!add(a, b)) {
+                        return std::nullopt;
+                    }
+                }
+            }
+            std::mt19937_64 random(width);
+            for (size_t vector = 0; vector < options_.numberOfTestVectors; ++vector) {
+                if (!add(random(), random())) {
+                    return std::nullopt;
+                }
+            }
+        }
+        if (!flush()) {
+            return std::nullopt;
+        }
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            // the simulation is exhaustive for narrow operands and only filters candidates for wider ones
+            if (alive[c] && (isExhaustive || isEquivalent(cone, candidates[c].first, isSigned.value_or(false)))) {
+                return candidates[c].first;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // compares the canonical diagrams of the cone and of the operation, gives up if they exceed options_.maxDiagramNodes
+    bool isEquivalent(const BitCone& cone, const Lifting& lifting, bool isSigned) const {
+        Bdd bdd(options_.maxDiagramNodes);
+        auto reference = buildReferenceFunctions(bdd, lifting.operation, lifting.swapOperands, cone.operands[0].width, isSigned);
+        auto actual = buildConeFunctions(bdd, cone);
+        return !bdd.isExhausted() && reference == actual;
+    }
+
+    core::CircuitObjectWrapper& circuit_;
+    const WordLevelLiftingOptions& options_;
+    std::vector<core::NodeObjectWrapper> nodes_;
+    std::unordered_map<Identifier, size_t> positions_;
+    std::unordered_map<size_t, std::pair<BitCone::Operand, BitCone::Operand>> operandsOf_;
+    std::unordered_set<Identifier> maybeDead_;
+};
+
+}  // namespace
+
+size_t liftWordLevelOperations(core::CircuitObjectWrapper& circuit, const WordLevelLiftingOptions& options) {
+    WordLevelLifter lifter(circuit, options);
+    return lifter.run();
+}
+
+size_t liftWordLevelOperations(core::ModuleObjectWrapper& module, const WordLevelLiftingOptions& options) {
+    size_t lifted = 0;
+    for (const auto& name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        lifted += liftWordLevelOperations(circuit, options);
+    }
+    return lifted;
+}
+
+}  // namespace fuse::passes
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_WORDLEVELLIFTING_H
+#define FUSE_WORDLEVELLIFTING_H
+
+#include "ModuleWrapper.h"
+
+namespace fuse::passes {
+
+struct WordLevelLiftingOptions {
+    // Boolean cones with more gates are not considered
+    size_t maxConeSize = 1 << 16;
+    // number of random test vectors that filter the candidate operations for operands that are too wide for exhaustive simulation
+    size_t numberOfTestVectors = 1024;
+    // node limit of the decision diagrams that prove the remaining candidates for wide operands
+    size_t maxDiagramNodes = 1 << 20;
+};
+
+/**
+ * @brief Replaces Boolean adders, subtractors, multipliers and comparators over the bits of two words by a single Add, Sub, Mul,
+ * Lt, Le, Gt, Ge or Eq node on these words.
+ *
+ * A candidate is a Merge node of n bits (or a Boolean gate that is used by a non-Boolean node for comparators) whose cone consists of
+ * Boolean gates and constants only and that reads all bits from exactly two Split nodes of width n. Split and Merge are the
+ * conversions between words and bits, so the lifted node reads the words before the Split nodes and produces the word of the Merge node.
+ * Candidates are classified by bit-parallel simulation of their cone, which is exhaustive for operands of up to 8 bits. For wider operands,
+ * corner cases and numberOfTestVectors random vectors only filter the candidate operations; a cone is lifted only once
+ * its output bits are proven equal to the operation by comparing reduced ordered BDDs. Cones whose diagrams exceed maxDiagramNodes,
+ * which happens for wide multipliers, are left unchanged. Comparators are only lifted if the signedness of the words is known.
+ * Gates and Split nodes of lifted cones that are no longer used are removed afterwards.
+ *
+ * @param circuit mutable circuit where the word-level operations are lifted
+ * @param options limits for the cone size and the verification
+ * @return the number of lifted nodes
+ */
+size_t liftWordLevelOperations(core::CircuitObjectWrapper& circuit, const WordLevelLiftingOptions& options = {});
+
+/**
+ * @brief Lifts the word-level operations in every circuit inside the module.
+ */
+size_t liftWordLevelOperations(core::ModuleObjectWrapper& module, const WordLevelLiftingOptions& options = {});
+
+}  // namespace fuse::passes
+
+#endif /* FUSE_WORDLEVELLIFTING_H */
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "OptimizationCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#ifndef FUSE_VERSION
+#define FUSE_VERSION "unknown"
+#endif
+
+namespace fuse::util {
+
+namespace {
+
+// 64 bit FNV-1a
+uint64_t hashBytes(const char* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// writes to a temporary file first, so concurrent builds never read a partially written entry.
+// Every writer uses its own temporary file, the rename is atomic and the last writer wins.
+void writeEntry(const std::filesystem::path& entry, const std::function<void(const std::string&)>& write) {
+    std::stringstream suffix;
+    suffix << "." << std::hex << std::hash<std::thread::id>{}(std::this_thread::get_id()) << "-" << std::random_device{}() << ".tmp";
+    auto temporary = entry;
+    temporary += suffix.str();
+    write(temporary.string());
+    std::filesystem::rename(temporary, entry);
+}
+
+// results of older FUSE versions or cache formats are never reused
+std::string getVersion() { return std::string(FUSE_VERSION) + "/" + std::to_string(OptimizationCache::kVersion); }
+
+// everything the key is computed from: keys are not collision-free, so a hit is only served if the stored input is identical
+std::string getInputRecord(core::CircuitContext& circuit, const std::string& passDescription) {
+    std::string record = getVersion() + "\n" + passDescription + "\n";
+    record.append(circuit.getBufferPointer(), circuit.getBufferSize());
+    return record;
+}
+
+std::filesystem::path getInputRecordPath(const std::filesystem::path& entry) {
+    auto path = entry;
+    path += ".input";
+    return path;
+}
+
+bool hasInputRecord(const std::filesystem::path& entry, const std::string& record) {
+    std::ifstream file(getInputRecordPath(entry), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::string stored((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return stored == record;
+}
+
+void writeInputRecord(const std::filesystem::path& entry, const std::string& record) {
+    writeEntry(getInputRecordPath(entry), [&](const std::string& path) {
+        std::ofstream file(path, std::ios::binary);
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+    });
+}
+
+}  // namespace
+
+OptimizationCache::OptimizationCache(std::filesystem::path cacheDirectory) : cacheDirectory_(std::move(cacheDirectory)) {
+    std::filesystem::create_directories(cacheDirectory_);
+}
+
+std::string OptimizationCache::computeKey(core::CircuitContext& circuit, const std::string& passDescription) {
+    circuit.packCircuit();
+    const std::string version = getVersion();
+    std::stringstream key;
+    key << std::hex << std::setfill('0')
+        << std::setw(16) << hashBytes(circuit.getBufferPointer(), circuit.getBufferSize())
+        << "-" << std::dec << circuit.getBufferSize() << "-" << std::hex
+        << std::setw(16) << hashBytes(passDescription.data(), passDescription.size(), hashBytes(version.data(), version.size()));
+    return key.str();
+}
+
+core::ModuleContext OptimizationCache::getOrComputeModule(core::CircuitContext& circuit, const std::string& passDescription,
+                                                          const std::function<core::ModuleContext(core::CircuitContext&)>& optimize) {
+    const auto entry = cacheDirectory_ / (computeKey(circuit, passDescription) + ".mfs");
+    const auto record = getInputRecord(circuit, passDescription);
+    const bool isCached = std::filesystem::exists(entry) && std::filesystem::exists(getInputRecordPath(entry));
+    core::ModuleContext module;
+    if (isCached && hasInputRecord(entry, record)) {
+        ++hits_;
+        module.readModuleFromFile(entry.string());
+        return module;
+    }
+    ++misses_;
+    module = optimize(circuit);
+    // a different input with the same key keeps its entry
+    if (!isCached) {
+        writeInputRecord(entry, record);
+        writeEntry(entry, [&](const std::string& path) { module.writeModuleToFile(path); });
+    }
+    return module;
+}
+
+void OptimizationCache::getOrComputeCircuit(core::CircuitContext& circuit, const std::string& passDescription,
+                                            const std::function<void(core::CircuitContext&)>& optimize) {
+    const auto entry = cacheDirectory_ / (computeKey(circuit, passDescription) + ".cfs");
+    const auto record = getInputRecord(circuit, passDescription);
+    const bool isCached = std::filesystem::exists(entry) && std::filesystem::exists(getInputRecordPath(entry));
+    if (isCached && hasInputRecord(entry, record)) {
+        ++hits_;
+        circuit.readCircuitFromFile(entry.string());
+        return;
+    }
+    ++misses_;
+    optimize(circuit);
+    // a different input with the same key keeps its entry
+    if (!isCached) {
+        writeInputRecord(entry, record);
+        writeEntry(entry, [&](const std::string& path) { circuit.writeCircuitToFile(path); });
+    }
+}
+
+}  // namespace fuse::util
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FUSE_OPTIMIZATIONCACHE_H
+#define FUSE_OPTIMIZATIONCACHE_H
+
+#include <filesystem>
+#include <functional>
+#include <string>
+
+#include "IR.h"
+
+namespace fuse::util {
+
+/**
+ * @brief Content-addressed on-disk cache for the results of expensive optimizations like frequent subcircuit replacement or vectorization.
+ *
+ * Entries are keyed by a hash of the serialized input circuit together with a description of the pass and its parameters,
+ * e.g. "fsr:threshold=28:mode=0", and the FUSE and cache version. Unchanged inputs with unchanged parameters are read
+ * from the cache instead of being optimized again. Every entry stores its input next to it, which is compared on a hit,
+ * so inputs whose keys collide are optimized instead of receiving the result of another input.
+ */
+class OptimizationCache {
+   public:
+    /// bump when a cached pass changes its results without a new FUSE version
+    static constexpr int kVersion = 2;
+
+    explicit OptimizationCache(std::filesystem::path cacheDirectory);
+
+    /**
+     * @brief Computes the cache key for the circuit and pass description, packs the circuit if it is unpacked.
+     */
+    static std::string computeKey(core::CircuitContext& circuit, const std::string& passDescription);
+
+    /**
+     * @brief Returns the cached module for the circuit or runs optimize on it and caches the result.
+     *
+     * @param circuit the input circuit, may be modified by optimize
+     * @param passDescription pass name and all parameters that influence the result
+     * @param optimize the optimization producing the module
+     */
+    core::ModuleContext getOrComputeModule(core::CircuitContext& circuit, const std::string& passDescription,
+                                           const std::function<core::ModuleContext(core::CircuitContext&)>& optimize);
+
+    /**
+     * @brief Replaces the circuit by its cached optimized version or runs optimize on it in place and caches the result.
+     *
+     * @param circuit the circuit to optimize in place
+     * @param passDescription pass name and all parameters that influence the result
+     * @param optimize the in-place optimization
+     */
+    void getOrComputeCircuit(core::CircuitContext& circuit, const std::string& passDescription,
+                             const std::function<void(core::CircuitContext&)>& optimize);
+
+    size_t getNumberOfHits() const { return hits_; }
+
+    size_t getNumberOfMisses() const { return misses_; }
+
+   private:
+    std::filesystem::path cacheDirectory_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+}  // namespace fuse::util
+
+#endif /* FUSE_OPTIMIZATIONCACHE_H */
@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "BitWidthNarrowing.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+using pt = fuse::core::ir::PrimitiveType;
+
+TEST(BitWidthNarrowing, NarrowsBoundedArithmetic) {
+    fuse::frontend::CircuitBuilder circuitBuilder("narrowing");
+    auto uintType = circuitBuilder.addDataType(pt::UInt32);
+    auto boolType = circuitBuilder.addDataType(pt::Bool);
+    auto a = circuitBuilder.addInputNode({uintType}, "max_value:100");
+    auto b = circuitBuilder.addInputNode({uintType}, "max_value:100");
+    auto unbounded = circuitBuilder.addInputNode({uintType});
+    auto product = circuitBuilder.addNode(op::Mul, {a, b});
+    auto sum = circuitBuilder.addNode(op::Add, {a, b});
+    auto threshold = circuitBuilder.addConstantNodeWithPayload(uint32_t{50});
+    auto comparison = circuitBuilder.addNode(op::Gt, {sum, threshold});
+    auto wide = circuitBuilder.addNode(op::Add, {product, unbounded});
+    auto inputComparison = circuitBuilder.addNode(op::Gt, {a, b});
+    auto productOutput = circuitBuilder.addOutputNode({uintType}, {product});
+    circuitBuilder.addOutputNode({boolType}, {comparison});
+    circuitBuilder.addOutputNode({uintType}, {wide});
+    circuitBuilder.addOutputNode({boolType}, {inputComparison});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    auto ranges = fuse::passes::analyzeValueRanges(circuit);
+    EXPECT_EQ(ranges.at(product).maxValue, 10000);
+    EXPECT_EQ(ranges.at(sum).maxValue, 200);
+    EXPECT_EQ(ranges.at(comparison).type, pt::Bool);
+    EXPECT_EQ(ranges.at(wide).maxValue, 0xFFFFFFFF);
+
+    // only the comparison of the inputs is narrowed to 8 bits: the sum and the product are cheapest in arithmetic GMW,
+    // where truncating a and b needs conversions, and the product would have to be extended for its two wide users
+    EXPECT_EQ(fuse::passes::narrowBitWidths(circuit), 1);
+    EXPECT_EQ(circuit.getNodeWithID(inputComparison).getInputDataTypeAt(0).getPrimitiveType(), pt::UInt8);
+    EXPECT_EQ(circuit.getNodeWithID(comparison).getInputNodeIDs()[0], sum);
+    EXPECT_EQ(circuit.getNodeWithID(productOutput).getInputNodeIDs()[0], product);
+    EXPECT_EQ(circuit.getNodeWithID(wide).getInputNodeIDs()[0], product);
+
+    // a and b are truncated once for the comparison
+    size_t numberOfConversions = 0;
+    for (auto node : circuit) {
+        numberOfConversions += node.isNodeWithCustomOp() && node.getCustomOperationName() == fuse::passes::kConvertOperationName;
+    }
+    EXPECT_EQ(numberOfConversions, 2);
+    EXPECT_EQ(fuse::passes::narrowBitWidths(circuit), 0);
+}
+
+TEST(BitWidthNarrowing, NarrowsRegionsWithoutExtensions) {
+    fuse::frontend::CircuitBuilder circuitBuilder("narrowing");
+    auto uintType = circuitBuilder.addDataType(pt::UInt32);
+    auto boolType = circuitBuilder.addDataType(pt::Bool);
+    auto condition = circuitBuilder.addInputNode({boolType});
+    auto a = circuitBuilder.addInputNode({uintType}, "max_value:100");
+    auto b = circuitBuilder.addInputNode({uintType}, "max_value:100");
+    auto selected = circuitBuilder.addNode(op::Mux, {condition, a, b});
+    auto threshold = circuitBuilder.addConstantNodeWithPayload(uint32_t{50});
+    auto comparison = circuitBuilder.addNode(op::Gt, {selected, threshold});
+    circuitBuilder.addOutputNode({boolType}, {comparison});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    // the selected value is only compared, so it never has to be extended back to 32 bits
+    EXPECT_EQ(fuse::passes::narrowBitWidths(circuit), 2);
+    EXPECT_EQ(circuit.getNodeWithID(selected).getOutputDataTypeAt(0).getPrimitiveType(), pt::UInt8);
+    EXPECT_EQ(circuit.getNodeWithID(comparison).getInputNodeIDs()[0], selected);
+    EXPECT_EQ(circuit.getNodeWithID(comparison).getInputDataTypeAt(0).getPrimitiveType(), pt::UInt8);
+
+    // the operands of a narrowed multiplication are arithmetic shares that are truncated with conversions
+    fuse::frontend::CircuitBuilder productBuilder("narrowing");
+    uintType = productBuilder.addDataType(pt::UInt32);
+    boolType = productBuilder.addDataType(pt::Bool);
+    a = productBuilder.addInputNode({uintType}, "max_value:100");
+    b = productBuilder.addInputNode({uintType}, "max_value:100");
+    auto product = productBuilder.addNode(op::Mul, {a, b});
+    auto productThreshold = productBuilder.addConstantNodeWithPayload(uint32_t{5000});
+    productBuilder.addOutputNode({boolType}, {productBuilder.addNode(op::Gt, {product, productThreshold})});
+    productBuilder.finish();
+    fuse::core::CircuitContext productContext(productBuilder);
+    auto productCircuit = productContext.getMutableCircuitWrapper();
+    EXPECT_EQ(fuse::passes::narrowBitWidths(productCircuit), 0);
+
+    // a multiplication whose result is extended again saves less than the extension costs
+    fuse::frontend::CircuitBuilder wideBuilder("narrowing");
+    uintType = wideBuilder.addDataType(pt::UInt32);
+    a = wideBuilder.addInputNode({uintType}, "max_value:100");
+    b = wideBuilder.addInputNode({uintType}, "max_value:100");
+    wideBuilder.addOutputNode({uintType}, {wideBuilder.addNode(op::Mul, {a, b})});
+    wideBuilder.finish();
+    fuse::core::CircuitContext wideContext(wideBuilder);
+    auto wideCircuit = wideContext.getMutableCircuitWrapper();
+    EXPECT_EQ(fuse::passes::narrowBitWidths(wideCircuit), 0);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <utility>
+
+#include "CallVectorization.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "PlaintextInterpreter.hpp"
+
+namespace fuse::tests::passes {
+
+TEST(CallVectorization, IndependentCalls) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto callee = moduleBuilder.addCircuit("callee");
+
+    // callee: (x, y) -> (x AND y, x XOR y)
+    auto calleeBool = callee->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = callee->addInputNode({calleeBool});
+    auto y = callee->addInputNode({calleeBool});
+    callee->addOutputNode({calleeBool}, {callee->addNode(fuse::core::ir::PrimitiveOperation::And, {x, y})});
+    callee->addOutputNode({calleeBool}, {callee->addNode(fuse::core::ir::PrimitiveOperation::Xor, {x, y})});
+
+    // main: three independent calls and one call that depends on the first one
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    std::vector<uint64_t> inputs;
+    for (int i = 0; i < 6; ++i) {
+        inputs.push_back(main->addInputNode({mainBool}));
+    }
+    auto call0 = main->addCallToSubcircuitNode({inputs[0], inputs[1]}, "callee");
+    auto call1 = main->addCallToSubcircuitNode({inputs[2], inputs[3]}, "callee");
+    auto call2 = main->addCallToSubcircuitNode({inputs[4], inputs[5]}, "callee");
+    auto call3 = main->addCallToSubcircuitNode(std::vector<uint64_t>{call0, call0}, std::vector<unsigned int>{0, 1}, "callee");
+    auto out1 = main->addSelectOffsetNode(call1, 1);
+    auto out2 = main->addSelectOffsetNode(call2, 0);
+    main->addOutputNode({mainBool}, {call3});
+    main->addOutputNode({mainBool}, {out1});
+    main->addOutputNode({mainBool}, {out2});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::vectorizeCalls(module), 1);
+
+    auto circuit = module.getCircuitWithName("main");
+    // 6 inputs, 1 SIMD call, 1 dependent call, 2 select offsets, 3 outputs
+    EXPECT_EQ(circuit.getNumberOfNodes(), 13);
+
+    uint64_t simdCallID = 0;
+    for (auto node : circuit) {
+        if (node.isSubcircuitNode() && node.getNumberOfInputs() == 6) {
+            simdCallID = node.getNodeID();
+            EXPECT_EQ(node.getNumberOfOutputs(), 6);
+            EXPECT_EQ(node.getSubCircuitName(), "callee");
+        }
+    }
+    ASSERT_NE(simdCallID, 0);
+
+    // the j-th call's outputs start at offset 2 * j
+    auto dependentCall = circuit.getNodeWithID(call3);
+    EXPECT_EQ(dependentCall.getInputNodeIDs()[0], simdCallID);
+    EXPECT_EQ(dependentCall.getInputOffsets()[0], 0);
+    EXPECT_EQ(dependentCall.getInputOffsets()[1], 1);
+    EXPECT_EQ(circuit.getNodeWithID(out1).getInputOffsets()[0], 3);
+    EXPECT_EQ(circuit.getNodeWithID(out2).getInputOffsets()[0], 4);
+}
+
+TEST(CallVectorization, SimdCallsComputeTheSameOutputs) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto callee = moduleBuilder.addCircuit("callee");
+
+    // callee: (x, y) -> (x AND y, x XOR y)
+    auto calleeBool = callee->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = callee->addInputNode({calleeBool});
+    auto y = callee->addInputNode({calleeBool});
+    callee->addOutputNode({calleeBool}, {callee->addNode(fuse::core::ir::PrimitiveOperation::And, {x, y})});
+    callee->addOutputNode({calleeBool}, {callee->addNode(fuse::core::ir::PrimitiveOperation::Xor, {x, y})});
+
+    // main: three independent calls whose outputs are all used, and one call that depends on the first one
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    std::vector<uint64_t> inputs;
+    for (int i = 0; i < 6; ++i) {
+        inputs.push_back(main->addInputNode({mainBool}));
+    }
+    auto call0 = main->addCallToSubcircuitNode({inputs[0], inputs[1]}, "callee");
+    auto call1 = main->addCallToSubcircuitNode({inputs[2], inputs[3]}, "callee");
+    auto call2 = main->addCallToSubcircuitNode({inputs[4], inputs[5]}, "callee");
+    auto call3 = main->addCallToSubcircuitNode(std::vector<uint64_t>{call0, call0}, std::vector<unsigned int>{0, 1}, "callee");
+    main->addOutputNode({mainBool}, {call3});
+    main->addOutputNode({mainBool}, {main->addSelectOffsetNode(call3, 1)});
+    main->addOutputNode({mainBool}, {call1});
+    main->addOutputNode({mainBool}, {main->addSelectOffsetNode(call1, 1)});
+    main->addOutputNode({mainBool}, {call2});
+    main->addOutputNode({mainBool}, {main->addSelectOffsetNode(call2, 1)});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    auto outputIDs = module.getCircuitWithName("main").getOutputNodeIDs();
+    const std::vector<uint64_t> outputs(outputIDs.begin(), outputIDs.end());
+
+    fuse::backend::PlaintextInterpreter<bool> interpreter;
+    auto evaluateAll = [&]() {
+        std::vector<std::vector<bool>> results;
+        for (unsigned assignment = 0; assignment < (1u << inputs.size()); ++assignment) {
+            std::unordered_map<uint64_t, bool> values;
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                values[inputs[i]] = (assignment >> i) & 1;
+            }
+            interpreter.evaluate(std::as_const(module), values);
+            std::vector<bool> result;
+            for (auto output : outputs) {
+                result.push_back(values.at(output));
+            }
+            results.push_back(std::move(result));
+        }
+        return results;
+    };
+
+    auto before = evaluateAll();
+    ASSERT_EQ(fuse::passes::vectorizeCalls(module), 1);
+    EXPECT_EQ(evaluateAll(), before);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "CircuitDeduplication.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+namespace {
+
+void buildHelper(fuse::frontend::CircuitBuilder* circuit) {
+    auto boolType = circuit->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuit->addInputNode({boolType});
+    auto b = circuit->addInputNode({boolType});
+    circuit->addOutputNode({boolType}, {circuit->addNode(fuse::core::ir::PrimitiveOperation::And, {a, b})});
+}
+
+void buildWrapper(fuse::frontend::CircuitBuilder* circuit, const std::string& callee) {
+    auto boolType = circuit->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuit->addInputNode({boolType});
+    auto b = circuit->addInputNode({boolType});
+    circuit->addOutputNode({boolType}, {circuit->addCallToSubcircuitNode({a, b}, callee)});
+}
+
+}  // namespace
+
+TEST(CircuitDeduplication, HashIgnoresNodeIDs) {
+    fuse::frontend::CircuitBuilder circuitBuilder("helper");
+    buildHelper(&circuitBuilder);
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto hashBefore = fuse::passes::computeStructuralHash(*context.getReadOnlyCircuit());
+
+    // shift all node IDs
+    auto circuit = context.getMutableCircuitWrapper();
+    for (auto node : circuit) {
+        node.setNodeID(node.getNodeID() + 100);
+        std::vector<uint64_t> inputs(node.getInputNodeIDs().begin(), node.getInputNodeIDs().end());
+        for (auto& input : inputs) {
+            input += 100;
+        }
+        node.setInputNodeIDs(inputs);
+    }
+    std::vector<uint64_t> inputs(circuit.getInputNodeIDs().begin(), circuit.getInputNodeIDs().end());
+    std::vector<uint64_t> outputs(circuit.getOutputNodeIDs().begin(), circuit.getOutputNodeIDs().end());
+    for (auto& id : inputs) {
+        id += 100;
+    }
+    for (auto& id : outputs) {
+        id += 100;
+    }
+    circuit.setInputNodeIDs(inputs);
+    circuit.setOutputNodeIDs(outputs);
+
+    EXPECT_EQ(fuse::passes::computeStructuralHash(circuit), hashBefore);
+    circuit.setName("renamed");
+    EXPECT_EQ(fuse::passes::computeStructuralHash(circuit), hashBefore);
+}
+
+TEST(CircuitDeduplication, MergesIdenticalCircuits) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    buildHelper(moduleBuilder.addCircuit("helperA"));
+    buildHelper(moduleBuilder.addCircuit("helperB"));
+    // the wrappers only become identical after their callees are merged
+    buildWrapper(moduleBuilder.addCircuit("wrapperA"), "helperA");
+    buildWrapper(moduleBuilder.addCircuit("wrapperB"), "helperB");
+
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    main->addOutputNode({boolType}, {main->addCallToSubcircuitNode({a, b}, "wrapperA")});
+    main->addOutputNode({boolType}, {main->addCallToSubcircuitNode({a, b}, "wrapperB")});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::deduplicateCircuits(module), 2);
+
+    auto names = module.getAllCircuitNames();
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, (std::vector<std::string>{"helperA", "main", "wrapperA"}));
+
+    auto mainCircuit = module.getCircuitWithName("main");
+    for (auto node : mainCircuit) {
+        if (node.isSubcircuitNode()) {
+            EXPECT_EQ(node.getSubCircuitName(), "wrapperA");
+        }
+    }
+    auto wrapper = module.getCircuitWithName("wrapperA");
+    for (auto node : wrapper) {
+        if (node.isSubcircuitNode()) {
+            EXPECT_EQ(node.getSubCircuitName(), "helperA");
+        }
+    }
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "CostEstimation.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+TEST(CostEstimation, BooleanCircuit) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto c = circuitBuilder.addInputNode({boolType});
+    auto x = circuitBuilder.addNode(op::And, {a, b});
+    auto y = circuitBuilder.addNode(op::Xor, {x, c});
+    auto z = circuitBuilder.addNode(op::And, {y, a});
+    circuitBuilder.addOutputNode({boolType}, {z});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto estimate = fuse::passes::estimateCost(*circuit);
+    EXPECT_EQ(estimate.circuitName, "main");
+    EXPECT_DOUBLE_EQ(estimate.numberOfNodes, 7);
+    EXPECT_DOUBLE_EQ(estimate.numberOfAndGates, 2);
+    EXPECT_DOUBLE_EQ(estimate.numberOfMultiplications, 0);
+    EXPECT_DOUBLE_EQ(estimate.multiplicativeDepth, 2);
+    EXPECT_DOUBLE_EQ(estimate.operationCounts.at("And"), 2);
+    EXPECT_DOUBLE_EQ(estimate.operationCounts.at("Xor"), 1);
+    EXPECT_DOUBLE_EQ(estimate.simdWidths.at(1), 7);
+
+    ASSERT_EQ(estimate.protocols.size(), 3);
+    const auto& gmw = estimate.protocols[0];
+    EXPECT_EQ(gmw.protocol, "BooleanGmw");
+    EXPECT_DOUBLE_EQ(gmw.bytes, 0.5);
+    EXPECT_DOUBLE_EQ(gmw.rounds, 2);
+    const auto& bmr = estimate.protocols[1];
+    EXPECT_EQ(bmr.protocol, "Bmr");
+    EXPECT_GT(bmr.bytes, gmw.bytes);
+    EXPECT_DOUBLE_EQ(bmr.rounds, 2);
+    const auto& arithmetic = estimate.protocols[2];
+    EXPECT_EQ(arithmetic.protocol, "ArithmeticGmw");
+    EXPECT_DOUBLE_EQ(arithmetic.unsupportedOperations, 3);
+
+    auto json = fuse::passes::toJSON(estimate);
+    EXPECT_NE(json.find("\"circuit\": \"main\""), std::string::npos);
+    EXPECT_NE(json.find("\"And\": 2"), std::string::npos);
+    EXPECT_NE(json.find("\"protocol\": \"BooleanGmw\", \"bytes\": 0.5, \"rounds\": 2"), std::string::npos);
+
+    // names are escaped, including control characters
+    estimate.circuitName = "a\"b\\\n\tc\x01";
+    json = fuse::passes::toJSON(estimate);
+    EXPECT_NE(json.find(R"("circuit": "a\"b\\\n\tc\u0001")"), std::string::npos);
+}
+
+TEST(CostEstimation, ExpandsCalls) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto helper = moduleBuilder.addCircuit("helper");
+
+    auto helperBool = helper->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = helper->addInputNode({helperBool});
+    auto y = helper->addInputNode({helperBool});
+    helper->addOutputNode({helperBool}, {helper->addNode(op::And, {x, y})});
+
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({mainBool});
+    auto b = main->addInputNode({mainBool});
+    auto c = main->addInputNode({mainBool});
+    auto d = main->addInputNode({mainBool});
+    auto call = main->addCallToSubcircuitNode({a, b}, "helper");
+    // SIMD call with two lanes
+    auto simdCall = main->addCallToSubcircuitNode({a, b, c, d}, "helper");
+    main->addOutputNode({mainBool}, {call});
+    main->addOutputNode({mainBool}, {simdCall});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getReadOnlyModule();
+    auto estimate = fuse::passes::estimateCost(*module);
+    // 4 inputs, 2 outputs and 3 times the 4 nodes of the helper
+    EXPECT_DOUBLE_EQ(estimate.numberOfNodes, 18);
+    EXPECT_DOUBLE_EQ(estimate.numberOfAndGates, 3);
+    EXPECT_DOUBLE_EQ(estimate.multiplicativeDepth, 1);
+    EXPECT_DOUBLE_EQ(estimate.simdWidths.at(1), 10);
+    EXPECT_DOUBLE_EQ(estimate.simdWidths.at(2), 4);
+    EXPECT_DOUBLE_EQ(estimate.protocols[0].bytes, 0.75);
+    EXPECT_DOUBLE_EQ(estimate.protocols[0].rounds, 1);
+}
+
+TEST(CostEstimation, RejectsRecursiveCalls) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({mainBool});
+    main->addOutputNode({mainBool}, {main->addCallToSubcircuitNode({a}, "main")});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getReadOnlyModule();
+    EXPECT_THROW(fuse::passes::estimateCost(*module), std::logic_error);
+}
+
+}  // namespace fuse::tests::passes
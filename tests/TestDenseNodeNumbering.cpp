@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "DenseNodeNumbering.h"
+#include "IR.h"
+#include "LivenessAnalysis.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+TEST(DenseNodeNumbering, RenumbersInTopologicalOrder) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt8);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto bits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, a);
+    auto x = circuitBuilder.addNode(op::And, {bits, bits}, {0, 7});
+    auto output = circuitBuilder.addOutputNode({wordType}, {x});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    // sparse IDs like the wire numbers of Bristol circuits and a node placed after its user
+    auto negation = circuit.addNodeWithID(1000);
+    negation.setPrimitiveOperation(op::Not);
+    std::vector<uint64_t> negationInputs{b};
+    negation.setInputNodeIDs(negationInputs);
+    auto outputNode = circuit.getNodeWithID(output);
+    std::vector<uint64_t> outputInputs{x, 1000};
+    outputNode.setInputNodeIDs(outputInputs);
+    std::vector<uint32_t> outputOffsets{0, 0};
+    outputNode.setInputOffsets(outputOffsets);
+    circuit.getNodeWithID(x).setNodeID(500);
+    outputNode.replaceInputBy(x, 500);
+    EXPECT_FALSE(fuse::passes::hasDenseNodeIDs(circuit));
+
+    fuse::passes::renumberNodesDensely(circuit);
+    EXPECT_TRUE(fuse::passes::hasDenseNodeIDs(circuit));
+    EXPECT_EQ(circuit.getStringValueForAttribute(fuse::passes::kDenseNodeIDsAttribute), "true");
+    ASSERT_EQ(circuit.getNumberOfNodes(), 6);
+
+    std::vector<uint64_t> ids;
+    for (auto node : circuit) {
+        ids.push_back(node.getNodeID());
+        for (auto input : node.getInputNodeIDs()) {
+            EXPECT_LT(input, node.getNodeID());
+        }
+    }
+    EXPECT_EQ(ids, std::vector<uint64_t>({0, 1, 2, 3, 4, 5}));
+
+    auto outputs = circuit.getOutputNodeIDs();
+    ASSERT_EQ(outputs.size(), 1);
+    auto newOutput = circuit.getNodeWithID(outputs[0]);
+    EXPECT_TRUE(newOutput.isOutputNode());
+    ASSERT_EQ(newOutput.getInputNodeIDs().size(), 2);
+    auto andNode = circuit.getNodeWithID(newOutput.getInputNodeIDs()[0]);
+    EXPECT_EQ(andNode.getOperation(), op::And);
+    // offsets into the split are kept
+    EXPECT_EQ(std::vector<uint32_t>(andNode.getInputOffsets().begin(), andNode.getInputOffsets().end()), std::vector<uint32_t>({0, 7}));
+    EXPECT_TRUE(circuit.getNodeWithID(andNode.getInputNodeIDs()[0]).isSplitNode());
+    EXPECT_EQ(circuit.getNodeWithID(newOutput.getInputNodeIDs()[1]).getOperation(), op::Not);
+    for (auto input : circuit.getInputNodeIDs()) {
+        EXPECT_TRUE(circuit.getNodeWithID(input).isInputNode());
+    }
+
+    // analyses index by ID on densely numbered circuits
+    auto liveness = fuse::passes::analyzeLiveness(circuit);
+    EXPECT_EQ(liveness.evaluationOrder, ids);
+    EXPECT_EQ(liveness.lastUse.back(), fuse::passes::LivenessInfo::kLiveOut);
+
+    // removing a node breaks the numbering even though the mark is still set
+    circuit.removeNode(newOutput.getInputNodeIDs()[1]);
+    EXPECT_FALSE(fuse::passes::hasDenseNodeIDs(circuit));
+}
+
+TEST(DenseNodeNumbering, RenumbersAllCircuitsOfModule) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto helper = moduleBuilder.addCircuit("helper");
+    auto helperBool = helper->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = helper->addInputNode({helperBool});
+    helper->addOutputNode({helperBool}, {helper->addNode(op::Not, {x})});
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({mainBool});
+    main->addOutputNode({mainBool}, {main->addCallToSubcircuitNode({a}, "helper")});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    fuse::passes::renumberNodesDensely(module);
+    for (const auto& name : module.getAllCircuitNames()) {
+        auto circuit = module.getCircuitWithName(name);
+        EXPECT_TRUE(fuse::passes::hasDenseNodeIDs(circuit)) << name;
+    }
+}
+
+}  // namespace fuse::tests::passes
@@ -27,6 +27,8 @@
 #include "BristolFrontend.h"
 #include "DOTBackend.h"
 #include "DepthAnalysis.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
 
 namespace fuse::tests::passes {
 
@@ -66,4 +68,40 @@ TEST(DepthAnalysis, instructionDepth) {
     }
 }
 
+TEST(DepthAnalysis, levelSchedule) {
+    using op = fuse::core::ir::PrimitiveOperation;
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto x = circuitBuilder.addNode(op::And, {a, b});
+    auto y = circuitBuilder.addNode(op::Xor, {x, b});
+    auto z = circuitBuilder.addNode(op::And, {a, b});
+    circuitBuilder.addOutputNode({boolType}, {y});
+    circuitBuilder.addOutputNode({boolType}, {z});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto schedule = fuse::passes::computeLevelSchedule(*circuit);
+    ASSERT_EQ(schedule.nodeIDs.size(), 7);
+    EXPECT_EQ(schedule.nodeIDs[2], x);
+    EXPECT_EQ(schedule.nodeIDs[3], y);
+    EXPECT_EQ(schedule.nodeIDs[4], z);
+    EXPECT_EQ(schedule.getNumberOfLevels(), 4);
+    EXPECT_EQ(schedule.asapLevels, std::vector<uint32_t>({0, 0, 1, 2, 1, 3, 2}));
+    EXPECT_EQ(schedule.alapLevels, std::vector<uint32_t>({0, 0, 1, 2, 2, 3, 3}));
+    EXPECT_EQ(schedule.getSlack(4), 1);
+    EXPECT_EQ(schedule.getSlack(2), 0);
+    auto asapLayer = schedule.getASAPLayer(1);
+    EXPECT_EQ(std::vector<size_t>(asapLayer.begin(), asapLayer.end()), std::vector<size_t>({2, 4}));
+    auto alapLayer = schedule.getALAPLayer(2);
+    EXPECT_EQ(std::vector<size_t>(alapLayer.begin(), alapLayer.end()), std::vector<size_t>({3, 4}));
+
+    // only AND gates start a new level
+    auto andSchedule = fuse::passes::computeLevelSchedule(*circuit, op::And);
+    EXPECT_EQ(andSchedule.getNumberOfLevels(), 2);
+    EXPECT_EQ(andSchedule.asapLevels, std::vector<uint32_t>({0, 0, 1, 1, 1, 1, 1}));
+    EXPECT_EQ(andSchedule.alapLevels, std::vector<uint32_t>({0, 0, 1, 1, 1, 1, 1}));
+}
+
 }  // namespace fuse::tests::passes
@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "FrequentSubcircuitMining.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+namespace {
+
+// main: four independent copies of (a AND b) XOR c
+void buildRepeatedCones(fuse::frontend::CircuitBuilder& circuitBuilder) {
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    for (int i = 0; i < 4; ++i) {
+        auto a = circuitBuilder.addInputNode({boolType});
+        auto b = circuitBuilder.addInputNode({boolType});
+        auto c = circuitBuilder.addInputNode({boolType});
+        auto conjunction = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {a, b});
+        auto result = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Xor, {conjunction, c});
+        circuitBuilder.addOutputNode({boolType}, {result});
+    }
+    circuitBuilder.finish();
+}
+
+}  // namespace
+
+TEST(FrequentSubcircuitMining, FindsRepeatedCone) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    buildRepeatedCones(circuitBuilder);
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto mined = fuse::passes::mineFrequentSubcircuits(*circuit);
+    EXPECT_TRUE(mined.completed);
+    ASSERT_EQ(mined.patterns.size(), 1);
+    EXPECT_EQ(mined.patterns[0].numberOfNodes, 2);
+    EXPECT_EQ(mined.patterns[0].embeddings.size(), 4);
+}
+
+TEST(FrequentSubcircuitMining, ReplacesInMemory) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    buildRepeatedCones(circuitBuilder);
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto numberOfNodes = context.getReadOnlyCircuit()->getNumberOfNodes();
+
+    auto replaced = fuse::passes::replaceFrequentSubcircuitsInMemory(context);
+    EXPECT_TRUE(replaced.completed);
+    ASSERT_EQ(replaced.replacedPatterns.size(), 1);
+    EXPECT_EQ(replaced.replacedPatterns[0].embeddings.size(), 4);
+
+    // every cone of two nodes became a single call
+    auto module = replaced.module.getReadOnlyModule();
+    auto main = module->getEntryCircuit();
+    EXPECT_EQ(main->getNumberOfNodes(), numberOfNodes - 4);
+    EXPECT_EQ(module->getAllCircuitNames().size(), 2);
+    size_t numberOfCalls = 0;
+    main->topologicalTraversal([&](const fuse::core::NodeReadOnly& node) {
+        if (node.isSubcircuitNode()) {
+            ++numberOfCalls;
+        }
+    });
+    EXPECT_EQ(numberOfCalls, 4);
+}
+
+TEST(FrequentSubcircuitMining, StopsAtDeadline) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    buildRepeatedCones(circuitBuilder);
+    fuse::core::CircuitContext context(circuitBuilder);
+
+    fuse::passes::FrequentSubcircuitOptions options;
+    options.deadline = std::chrono::steady_clock::now();
+    auto mined = fuse::passes::mineFrequentSubcircuits(*context.getReadOnlyCircuit(), options);
+    EXPECT_FALSE(mined.completed);
+}
+
+}  // namespace fuse::tests::passes
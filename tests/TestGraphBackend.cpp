@@ -21,8 +21,11 @@
  */
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "BristolFrontend.h"
 #include "DOTBackend.h"
@@ -78,4 +81,46 @@ TEST(GraphBackend, DistgraphToGlasgow) {
     of.flush();
 }
 
+TEST(GraphBackend, ParallelGlasgowMatchesSequential) {
+    const std::string outputDir = "../../tests/outputs/optimizations/glasgow_parallel/";
+    std::filesystem::create_directories(outputDir);
+
+    auto context = fuse::frontend::loadFUSEFromBristol("../../tests/resources/subgraph/subgraph.txt");
+    auto circ = context.getMutableCircuitWrapper();
+    const std::string graphFile = outputDir + "graph.csv";
+    {
+        std::ofstream of(graphFile, std::ios::trunc);
+        of << fuse::backend::generateGlasgowgraphFrom(circ);
+    }
+
+    std::vector<std::string> patternFiles;
+    std::ifstream inf("../../tests/resources/graph_translate/distgraph_patterns.txt", std::ios::in);
+    std::string cur_line;
+    while (std::getline(inf, cur_line) && !cur_line.empty()) {
+        patternFiles.push_back(outputDir + "pattern_" + std::to_string(patternFiles.size()) + ".csv");
+        std::ofstream of(patternFiles.back(), std::ios::trunc);
+        of << fuse::backend::translateDistgraphToGlasgow(cur_line);
+    }
+    ASSERT_FALSE(patternFiles.empty());
+
+    auto readMappings = [](const std::string& file) {
+        std::ifstream mappings(file, std::ios::in);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(mappings, line);) {
+            lines.push_back(line);
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    };
+
+    // sequential search writes mappings<i>, the parallel one mappings<ctr>_<i> with ctr = 1000
+    auto parallelCounts = fuse::backend::glasgowParallelSubgraphFinding(outputDir, 1000, graphFile, patternFiles, 2);
+    ASSERT_EQ(parallelCounts.size(), patternFiles.size());
+    for (size_t i = 0; i < patternFiles.size(); ++i) {
+        auto sequentialCount = fuse::backend::glasglowSubgraphFinding(outputDir, i, graphFile, patternFiles[i]);
+        EXPECT_EQ(parallelCounts[i], sequentialCount);
+        EXPECT_EQ(readMappings(outputDir + "mappings1000_" + std::to_string(i)), readMappings(outputDir + "mappings" + std::to_string(i)));
+    }
+}
+
 }  // namespace fuse::tests::passes
@@ -23,6 +23,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <unordered_set>
 
 #include "BristolFrontend.h"
 #include "DOTBackend.h"
@@ -62,4 +63,31 @@ TEST(CompleteInstructionVectorization, simple) {
     of.flush();
 }
 
+TEST(BatchedInstructionVectorization, simple) {
+    const std::string optimizable = "../../examples/bristol_circuits/int_add8_size.bristol";
+    const std::string output = "../../tests/outputs/optimizations/batchedvectorgraph.txt";
+    std::ofstream of(output);
+
+    auto sequentialContext = fuse::frontend::loadFUSEFromBristol(optimizable);
+    auto sequentialCirc = sequentialContext.getMutableCircuitWrapper();
+    fuse::passes::vectorizeInstructions(sequentialCirc, core::ir::PrimitiveOperation::Xor, 2, 10);
+
+    auto batchedContext = fuse::frontend::loadFUSEFromBristol(optimizable);
+    auto batchedCirc = batchedContext.getMutableCircuitWrapper();
+    fuse::passes::vectorizeInstructions(batchedCirc, core::ir::PrimitiveOperation::Xor, 2, 10, false, true);
+    of << fuse::backend::generateDotCodeFrom(batchedCirc);
+    of.flush();
+
+    EXPECT_EQ(batchedCirc.getNumberOfNodes(), sequentialCirc.getNumberOfNodes());
+
+    // every node may only use nodes that come before it
+    std::unordered_set<uint64_t> seen;
+    for (auto node : batchedCirc) {
+        for (auto inputID : node.getInputNodeIDs()) {
+            EXPECT_TRUE(seen.contains(inputID));
+        }
+        seen.insert(node.getNodeID());
+    }
+}
+
 }  // namespace fuse::tests::passes
@@ -0,0 +1,226 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IR.h"
+#include "LibrarySubcircuitReplacement.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+namespace {
+
+// the textbook full adder as emitted by frontends: sum = (a ^ b) ^ c, carry = (a & b) ^ ((a ^ b) & c)
+void buildTextbookFullAdder(fuse::frontend::CircuitBuilder& circuitBuilder) {
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto c = circuitBuilder.addInputNode({boolType});
+    auto t = circuitBuilder.addNode(op::Xor, {a, b});
+    circuitBuilder.addOutputNode({boolType}, {circuitBuilder.addNode(op::Xor, {t, c})});
+    auto generate = circuitBuilder.addNode(op::And, {a, b});
+    auto propagate = circuitBuilder.addNode(op::And, {t, c});
+    circuitBuilder.addOutputNode({boolType}, {circuitBuilder.addNode(op::Xor, {generate, propagate})});
+}
+
+struct RippleCarryAdder {
+    uint64_t sum0;
+    uint64_t sum1;
+    uint64_t carry1;
+};
+
+/*
+ * main adds two 2-bit numbers with textbook full adders, the second one with swapped operands,
+ * and contains a third adder whose intermediate value is used elsewhere; full_adder needs only one AND gate.
+ */
+RippleCarryAdder buildModule(fuse::frontend::ModuleBuilder& moduleBuilder, bool withPattern = false) {
+    if (withPattern) {
+        buildTextbookFullAdder(*moduleBuilder.addCircuit("full_adder_textbook"));
+    }
+    {
+        auto adder = moduleBuilder.addCircuit("full_adder");
+        auto boolType = adder->addDataType(fuse::core::ir::PrimitiveType::Bool);
+        auto a = adder->addInputNode({boolType});
+        auto b = adder->addInputNode({boolType});
+        auto c = adder->addInputNode({boolType});
+        auto ac = adder->addNode(op::Xor, {a, c});
+        auto bc = adder->addNode(op::Xor, {b, c});
+        adder->addOutputNode({boolType}, {adder->addNode(op::Xor, {ac, b})});
+        adder->addOutputNode({boolType}, {adder->addNode(op::Xor, {adder->addNode(op::And, {ac, bc}), c})});
+    }
+    auto main = moduleBuilder.addCircuit("main");
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x0 = main->addInputNode({boolType});
+    auto y0 = main->addInputNode({boolType});
+    auto x1 = main->addInputNode({boolType});
+    auto y1 = main->addInputNode({boolType});
+    auto carryIn = main->addInputNode({boolType});
+
+    auto t0 = main->addNode(op::Xor, {x0, y0});
+    auto sum0 = main->addNode(op::Xor, {t0, carryIn});
+    auto carry0 = main->addNode(op::Xor, {main->addNode(op::And, {x0, y0}), main->addNode(op::And, {t0, carryIn})});
+
+    auto t1 = main->addNode(op::Xor, {y1, x1});
+    auto sum1 = main->addNode(op::Xor, {carry0, t1});
+    auto carry1 = main->addNode(op::Xor, {main->addNode(op::And, {t1, carry0}), main->addNode(op::And, {y1, x1})});
+
+    auto t2 = main->addNode(op::Xor, {x0, y1});
+    auto sum2 = main->addNode(op::Xor, {t2, carryIn});
+    auto carry2 = main->addNode(op::Xor, {main->addNode(op::And, {x0, y1}), main->addNode(op::And, {t2, carryIn})});
+
+    RippleCarryAdder outputs;
+    outputs.sum0 = main->addOutputNode(std::vector<size_t>{boolType}, {sum0});
+    outputs.sum1 = main->addOutputNode(std::vector<size_t>{boolType}, {sum1});
+    outputs.carry1 = main->addOutputNode(std::vector<size_t>{boolType}, {carry1});
+    main->addOutputNode(std::vector<size_t>{boolType}, {sum2});
+    main->addOutputNode(std::vector<size_t>{boolType}, {carry2});
+    main->addOutputNode(std::vector<size_t>{boolType}, {t2});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+    return outputs;
+}
+
+size_t countNodes(fuse::core::CircuitObjectWrapper circuit, op operation) {
+    size_t count = 0;
+    for (auto node : circuit) {
+        count += node.getOperation() == operation ? 1 : 0;
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST(LibrarySubcircuitReplacement, ReplacesEmbeddingsByCalls) {
+    fuse::frontend::CircuitBuilder patternBuilder("full_adder_textbook");
+    buildTextbookFullAdder(patternBuilder);
+    patternBuilder.finish();
+    fuse::core::CircuitContext patternContext(patternBuilder);
+    auto pattern = patternContext.getReadOnlyCircuit();
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto outputs = buildModule(moduleBuilder);
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    // the intermediate value of the third adder is an output of main, so it cannot be replaced
+    EXPECT_EQ(fuse::passes::findEmbeddings(*pattern, *context.getReadOnlyModule()->getEntryCircuit()).size(), 2);
+    EXPECT_THROW(fuse::passes::replaceLibrarySubcircuit(module, *pattern, "carry_lookahead_adder"), std::logic_error);
+    EXPECT_EQ(fuse::passes::replaceLibrarySubcircuit(module, *pattern, "full_adder"), 2);
+
+    auto main = module.getEntryCircuit();
+    EXPECT_EQ(countNodes(main, op::CallSubcircuit), 2);
+    EXPECT_EQ(countNodes(main, op::And), 2);
+    auto firstCall = main.getNodeWithID(main.getNodeWithID(outputs.sum0).getInputNodeIDs()[0]);
+    auto secondCall = main.getNodeWithID(main.getNodeWithID(outputs.sum1).getInputNodeIDs()[0]);
+    EXPECT_EQ(firstCall.getOperation(), op::CallSubcircuit);
+    EXPECT_EQ(firstCall.getSubCircuitName(), "full_adder");
+    EXPECT_EQ(firstCall.getNumberOfOutputs(), 2);
+    EXPECT_EQ(secondCall.getOperation(), op::CallSubcircuit);
+    EXPECT_EQ(main.getNodeWithID(outputs.carry1).getInputNodeIDs()[0], secondCall.getNodeID());
+    EXPECT_EQ(main.getNodeWithID(outputs.carry1).getInputOffsets()[0], 1);
+    // the carry of the first adder feeds the second one
+    EXPECT_EQ(secondCall.getInputNodeIDs()[2], firstCall.getNodeID());
+    EXPECT_EQ(secondCall.getInputOffsets()[2], 1);
+    // the implementation is left unchanged
+    EXPECT_EQ(countNodes(module.getCircuitWithName("full_adder"), op::And), 1);
+}
+
+TEST(LibrarySubcircuitReplacement, InlinesImplementation) {
+    fuse::frontend::CircuitBuilder patternBuilder("full_adder_textbook");
+    buildTextbookFullAdder(patternBuilder);
+    patternBuilder.finish();
+    fuse::core::CircuitContext patternContext(patternBuilder);
+    auto pattern = patternContext.getReadOnlyCircuit();
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    buildModule(moduleBuilder);
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    EXPECT_EQ(countNodes(module.getEntryCircuit(), op::And), 6);
+    EXPECT_EQ(fuse::passes::replaceLibrarySubcircuit(module, *pattern, "full_adder", true), 2);
+    auto main = module.getEntryCircuit();
+    EXPECT_EQ(countNodes(main, op::CallSubcircuit), 0);
+    EXPECT_EQ(countNodes(main, op::And), 4);
+}
+
+TEST(LibrarySubcircuitReplacement, UsesPackedPatternOfSameModule) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto outputs = buildModule(moduleBuilder, true);
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    // the pattern still points into the serialized module, which is unpacked by the pass
+    auto pattern = std::as_const(module).getCircuitWithName("full_adder_textbook");
+    EXPECT_EQ(fuse::passes::replaceLibrarySubcircuit(module, *pattern, "full_adder"), 2);
+    auto main = module.getEntryCircuit();
+    EXPECT_EQ(countNodes(main, op::CallSubcircuit), 2);
+    EXPECT_EQ(main.getNodeWithID(main.getNodeWithID(outputs.sum1).getInputNodeIDs()[0]).getSubCircuitName(), "full_adder");
+    // the pattern itself is left unchanged
+    EXPECT_EQ(countNodes(module.getCircuitWithName("full_adder_textbook"), op::And), 2);
+    EXPECT_EQ(countNodes(module.getCircuitWithName("full_adder_textbook"), op::CallSubcircuit), 0);
+}
+
+TEST(LibrarySubcircuitReplacement, MatchesOnlyValuesOfTheSameWidth) {
+    // overflow check of an 8-bit addition: (a + b) < a
+    fuse::frontend::CircuitBuilder patternBuilder("overflow8");
+    auto patternType = patternBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt8);
+    auto boolType = patternBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = patternBuilder.addInputNode({patternType});
+    auto b = patternBuilder.addInputNode({patternType});
+    patternBuilder.addOutputNode({boolType}, {patternBuilder.addNode(op::Lt, {patternBuilder.addNode(op::Add, {a, b}), a})});
+    patternBuilder.finish();
+    fuse::core::CircuitContext patternContext(patternBuilder);
+    auto pattern = patternContext.getReadOnlyCircuit();
+
+    fuse::frontend::CircuitBuilder targetBuilder("main");
+    auto wideType = targetBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto narrowType = targetBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt8);
+    auto targetBoolType = targetBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = targetBuilder.addInputNode({wideType});
+    auto y = targetBuilder.addInputNode({wideType});
+    auto u = targetBuilder.addInputNode({narrowType});
+    auto v = targetBuilder.addInputNode({narrowType});
+    targetBuilder.addOutputNode({targetBoolType}, {targetBuilder.addNode(op::Lt, {targetBuilder.addNode(op::Add, {x, y}), x})});
+    auto narrowSum = targetBuilder.addNode(op::Add, {u, v});
+    auto narrowOverflow = targetBuilder.addNode(op::Lt, {narrowSum, u});
+    targetBuilder.addOutputNode({targetBoolType}, {narrowOverflow});
+    targetBuilder.finish();
+    fuse::core::CircuitContext targetContext(targetBuilder);
+
+    // the 32-bit addition has the same structure but must not be replaced by an 8-bit implementation
+    auto embeddings = fuse::passes::findEmbeddings(*pattern, *targetContext.getReadOnlyCircuit());
+    ASSERT_EQ(embeddings.size(), 1);
+    EXPECT_EQ(embeddings[0].inputs, (std::vector<std::pair<uint64_t, uint32_t>>{{u, 0}, {v, 0}}));
+    EXPECT_EQ(embeddings[0].outputs, (std::vector<std::pair<uint64_t, uint32_t>>{{narrowOverflow, 0}}));
+    EXPECT_EQ(embeddings[0].nodes.size(), 2);
+    for (const auto& [patternNode, targetNode] : embeddings[0].nodes) {
+        EXPECT_TRUE(targetNode == narrowSum || targetNode == narrowOverflow) << targetNode;
+    }
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "IR.h"
+#include "LivenessAnalysis.h"
+#include "ModuleBuilder.h"
+#include "PlaintextInterpreter.hpp"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+TEST(LivenessAnalysis, LastUses) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto x = circuitBuilder.addNode(op::And, {a, b});
+    auto y = circuitBuilder.addNode(op::Xor, {x, a});
+    auto output = circuitBuilder.addOutputNode({boolType}, {y});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto liveness = fuse::passes::analyzeLiveness(*circuit);
+    ASSERT_EQ(liveness.evaluationOrder, std::vector<uint64_t>({a, b, x, y, output}));
+    EXPECT_EQ(liveness.lastUse, std::vector<size_t>({3, 2, 3, 4, fuse::passes::LivenessInfo::kLiveOut}));
+    EXPECT_TRUE(liveness.getValuesFreedAfter(0).empty());
+    EXPECT_TRUE(liveness.getValuesFreedAfter(1).empty());
+    auto freedAfterX = liveness.getValuesFreedAfter(2);
+    EXPECT_EQ(std::vector<uint64_t>(freedAfterX.begin(), freedAfterX.end()), std::vector<uint64_t>({b}));
+    auto freedAfterY = liveness.getValuesFreedAfter(3);
+    EXPECT_EQ(std::vector<uint64_t>(freedAfterY.begin(), freedAfterY.end()), std::vector<uint64_t>({a, x}));
+    auto freedAfterOutput = liveness.getValuesFreedAfter(4);
+    EXPECT_EQ(std::vector<uint64_t>(freedAfterOutput.begin(), freedAfterOutput.end()), std::vector<uint64_t>({y}));
+    EXPECT_EQ(liveness.maxLiveValues, 3);
+
+    auto keepingInputs = fuse::passes::analyzeLiveness(*circuit, true);
+    EXPECT_EQ(keepingInputs.lastUse[0], fuse::passes::LivenessInfo::kLiveOut);
+    EXPECT_EQ(keepingInputs.lastUse[1], fuse::passes::LivenessInfo::kLiveOut);
+    EXPECT_TRUE(keepingInputs.getValuesFreedAfter(2).empty());
+}
+
+TEST(LivenessAnalysis, UsesThroughOffsets) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt8);
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto bits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, a);
+    auto low = circuitBuilder.addNode(op::Not, {bits}, {0});
+    auto high = circuitBuilder.addNode(op::And, {low, bits}, {0, 7});
+    circuitBuilder.addOutputNode({boolType}, {high});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto liveness = fuse::passes::analyzeLiveness(*circuit);
+    // the split is used until its last offset is read
+    EXPECT_EQ(liveness.lastUse[1], 3);
+    EXPECT_EQ(liveness.lastUse[0], 1);
+}
+
+TEST(LivenessAnalysis, InterpreterKeepsOnlyInputsAndOutputs) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto x = circuitBuilder.addNode(op::And, {a, b});
+    auto y = circuitBuilder.addNode(op::Xor, {x, a});
+    auto output = circuitBuilder.addOutputNode({boolType}, {y});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    fuse::backend::PlaintextInterpreter<bool> interpreter;
+    std::unordered_map<uint64_t, bool> environment{{a, true}, {b, true}};
+    interpreter.evaluate(*circuit, environment);
+    EXPECT_EQ(environment.size(), 3);
+    EXPECT_FALSE(environment.contains(x));
+    EXPECT_FALSE(environment.contains(y));
+    EXPECT_EQ(environment.at(output), false);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+
+#include "IR.h"
+#include "LocalComputationHoisting.h"
+#include "ModuleBuilder.h"
+#include "PlaintextInterpreter.hpp"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+using Ownership = fuse::passes::Ownership;
+
+TEST(LocalComputationHoisting, HoistsSingleOwnerComputations) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a1 = main->addInputNode({boolType}, "owner:1");
+    auto a2 = main->addInputNode({boolType}, "owner:1");
+    auto b = main->addInputNode({boolType}, "owner:2");
+    // party 1 computes a1 AND a2 on its own, party 2 computes NOT b
+    auto localAnd = main->addNode(op::And, {a1, a2});
+    auto localNot = main->addNode(op::Not, {b});
+    auto secureXor = main->addNode(op::Xor, {localAnd, b});
+    auto out1 = main->addOutputNode(std::vector<size_t>{boolType}, {secureXor});
+    auto out2 = main->addOutputNode(std::vector<size_t>{boolType}, {localNot});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    {
+        auto ownership = fuse::passes::analyzeOwnership(*std::as_const(module).getEntryCircuit());
+        EXPECT_EQ(ownership.at(localAnd), (Ownership{Ownership::Kind::Party, "1"}));
+        EXPECT_EQ(ownership.at(localNot), (Ownership{Ownership::Kind::Party, "2"}));
+        EXPECT_EQ(ownership.at(secureXor).kind, Ownership::Kind::Secure);
+    }
+
+    EXPECT_EQ(fuse::passes::hoistLocalComputations(module), 2);
+
+    auto entry = module.getEntryCircuit();
+    for (auto node : entry) {
+        EXPECT_FALSE(node.getOperation() == op::And || node.getOperation() == op::Not);
+    }
+    // a1 and a2 are only needed by party 1's local circuit, b is still shared
+    auto inputs = entry.getInputNodeIDs();
+    ASSERT_EQ(inputs.size(), 3);
+    EXPECT_EQ(inputs[0], b);
+    auto hoistedAnd = entry.getNodeWithID(entry.getNodeWithID(secureXor).getInputNodeIDs()[0]);
+    EXPECT_TRUE(hoistedAnd.isInputNode());
+    EXPECT_EQ(hoistedAnd.getStringValueForAttribute("owner"), "1");
+    EXPECT_EQ(hoistedAnd.getStringValueForAttribute("local_circuit"), "main_local_1");
+    EXPECT_EQ(hoistedAnd.getStringValueForAttribute("local_output"), "0");
+    auto hoistedNot = entry.getNodeWithID(entry.getNodeWithID(out2).getInputNodeIDs()[0]);
+    EXPECT_EQ(hoistedNot.getStringValueForAttribute("local_circuit"), "main_local_2");
+    EXPECT_EQ(entry.getNodeWithID(out1).getInputNodeIDs()[0], secureXor);
+
+    // party 1 evaluates its part in cleartext
+    auto local = module.getCircuitWithName("main_local_1");
+    EXPECT_EQ(local.getStringValueForAttribute("local_owner"), "1");
+    ASSERT_EQ(local.getNumberOfInputs(), 2);
+    ASSERT_EQ(local.getNumberOfOutputs(), 1);
+    fuse::backend::PlaintextInterpreter<bool> interpreter;
+    std::unordered_map<uint64_t, bool> values{{a1, true}, {a2, false}};
+    interpreter.evaluate(local, values);
+    EXPECT_FALSE(values.at(local.getOutputNodeIDs()[0]));
+}
+
+TEST(LocalComputationHoisting, EvaluatesHoistedConstants) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto intType = main->addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto x = main->addInputNode({intType}, "owner:1");
+    auto y = main->addInputNode({intType}, "owner:2");
+    // party 1 computes x + 1 on its own, the constant is copied into its local circuit
+    auto one = main->addConstantNodeWithPayload(uint32_t{1});
+    auto increment = main->addNode(op::Add, {x, one});
+    main->addOutputNode(std::vector<size_t>{intType}, {main->addNode(op::Mul, {increment, y})});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::hoistLocalComputations(module), 1);
+
+    auto local = module.getCircuitWithName("main_local_1");
+    bool hasConstant = false;
+    for (auto node : local) {
+        hasConstant |= node.isConstantNode();
+    }
+    EXPECT_TRUE(hasConstant);
+    fuse::backend::PlaintextInterpreter<uint32_t> interpreter;
+    std::unordered_map<uint64_t, uint32_t> values{{x, 41}};
+    interpreter.evaluate(local, values);
+    EXPECT_EQ(values.at(local.getOutputNodeIDs()[0]), 42);
+}
+
+TEST(LocalComputationHoisting, KeepsSecureComputations) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType}, "owner:1");
+    auto b = main->addInputNode({boolType}, "owner:2");
+    main->addOutputNode(std::vector<size_t>{boolType}, {main->addNode(op::And, {a, b})});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::hoistLocalComputations(module), 0);
+    EXPECT_EQ(module.getAllCircuitNames().size(), 1);
+    EXPECT_EQ(module.getEntryCircuit().getNumberOfInputs(), 2);
+}
+
+}  // namespace fuse::tests::passes
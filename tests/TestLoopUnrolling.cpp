@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "CostEstimation.h"
+#include "IR.h"
+#include "LoopUnrolling.h"
+#include "ModuleBuilder.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+namespace {
+// round function with the carried values (x, y) and the loop-invariant key k: (x, y) -> (y ^ k, x & y)
+void addRoundFunction(fuse::frontend::CircuitBuilder* round) {
+    auto boolType = round->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = round->addInputNode({boolType});
+    auto y = round->addInputNode({boolType});
+    auto k = round->addInputNode({boolType});
+    round->addOutputNode({boolType}, {round->addNode(op::Xor, {y, k})});
+    round->addOutputNode({boolType}, {round->addNode(op::And, {x, y})});
+}
+}  // namespace
+
+TEST(LoopUnrolling, UnrollsIntoCallChain) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    addRoundFunction(moduleBuilder.addCircuit("round"));
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    auto k = main->addInputNode({boolType});
+    auto loop = main->addLoopNode({a, b, k}, {0, 0, 0}, "round", 3, 2);
+    auto first = main->addOutputNode(std::vector<size_t>{boolType}, {loop}, std::vector<unsigned int>{0});
+    auto second = main->addOutputNode(std::vector<size_t>{boolType}, {loop}, std::vector<unsigned int>{1});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    {
+        auto loopNode = std::as_const(module).getEntryCircuit()->getNodeWithID(loop);
+        EXPECT_TRUE(loopNode->isLoopNode());
+        EXPECT_EQ(fuse::passes::getNumberOfIterations(*loopNode), 3);
+    }
+    auto before = fuse::passes::estimateCost(module);
+    EXPECT_DOUBLE_EQ(before.numberOfAndGates, 3);
+    EXPECT_DOUBLE_EQ(before.multiplicativeDepth, 3);
+
+    EXPECT_EQ(fuse::passes::unrollLoops(module), 1);
+    auto circuit = module.getEntryCircuit();
+    std::vector<uint64_t> calls;
+    for (auto node : circuit) {
+        EXPECT_FALSE(node.isLoopNode());
+        if (node.isSubcircuitNode()) {
+            EXPECT_EQ(node.getSubCircuitName(), "round");
+            EXPECT_EQ(node.getNumberOfOutputs(), 2);
+            calls.push_back(node.getNodeID());
+        }
+    }
+    ASSERT_EQ(calls.size(), 3);
+    auto firstCall = circuit.getNodeWithID(calls[0]);
+    EXPECT_EQ(std::vector<uint64_t>(firstCall.getInputNodeIDs().begin(), firstCall.getInputNodeIDs().end()), std::vector<uint64_t>({a, b, k}));
+    for (size_t i = 1; i < calls.size(); ++i) {
+        auto call = circuit.getNodeWithID(calls[i]);
+        EXPECT_EQ(std::vector<uint64_t>(call.getInputNodeIDs().begin(), call.getInputNodeIDs().end()),
+                  std::vector<uint64_t>({calls[i - 1], calls[i - 1], k}));
+        EXPECT_EQ(std::vector<uint32_t>(call.getInputOffsets().begin(), call.getInputOffsets().end()), std::vector<uint32_t>({0, 1, 0}));
+    }
+    auto secondOutput = circuit.getNodeWithID(second);
+    EXPECT_EQ(secondOutput.getInputNodeIDs()[0], calls[2]);
+    EXPECT_EQ(secondOutput.getInputOffsets()[0], 1);
+    EXPECT_EQ(circuit.getNodeWithID(first).getInputNodeIDs()[0], calls[2]);
+
+    auto after = fuse::passes::estimateCost(module);
+    EXPECT_DOUBLE_EQ(after.numberOfAndGates, before.numberOfAndGates);
+    EXPECT_DOUBLE_EQ(after.multiplicativeDepth, before.multiplicativeDepth);
+}
+
+TEST(LoopUnrolling, LoopWithoutIterationsForwardsInitialValues) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    addRoundFunction(moduleBuilder.addCircuit("round"));
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    auto k = main->addInputNode({boolType});
+    auto loop = main->addLoopNode({a, b, k}, {0, 0, 0}, "round", 0, 2);
+    auto output = main->addOutputNode(std::vector<size_t>{boolType}, {loop}, std::vector<unsigned int>{1});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::unrollLoops(module), 1);
+    auto circuit = module.getEntryCircuit();
+    EXPECT_EQ(circuit.getNumberOfNodes(), 4);
+    EXPECT_EQ(circuit.getNodeWithID(output).getInputNodeIDs()[0], b);
+}
+
+TEST(LoopUnrolling, RejectsInvalidLoops) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    addRoundFunction(moduleBuilder.addCircuit("round"));
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    // the loop-invariant key is missing
+    auto loop = main->addLoopNode({a, b}, {0, 0}, "round", 2, 2);
+    main->addOutputNode({boolType}, {loop});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_THROW(fuse::passes::unrollLoops(module), std::logic_error);
+
+    auto node = module.getEntryCircuit().getNodeWithID(loop);
+    node.setNodeAnnotations("iterations:many");
+    EXPECT_THROW(fuse::passes::getNumberOfIterations(node), std::logic_error);
+    EXPECT_EQ(fuse::passes::getNumberOfPerIterationInputs(node), 0);
+    node.setNodeAnnotations("iterations:2,per_iteration_inputs:all");
+    EXPECT_THROW(fuse::passes::getNumberOfPerIterationInputs(node), std::logic_error);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "DepthAnalysis.h"
+#include "IR.h"
+#include "LivenessAnalysis.h"
+#include "MemoryAwareScheduling.h"
+#include "ModuleBuilder.h"
+#include "PlaintextInterpreter.hpp"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+TEST(MemoryAwareScheduling, ReducesPeakLiveValues) {
+    fuse::frontend::CircuitBuilder circuitBuilder("wideFront");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = circuitBuilder.addInputNode({boolType});
+    auto y = circuitBuilder.addInputNode({boolType});
+    // the whole front is computed before it is reduced
+    std::vector<uint64_t> front;
+    for (int i = 0; i < 8; ++i) {
+        front.push_back(circuitBuilder.addNode(i % 2 == 0 ? op::Not : op::Xor, i % 2 == 0 ? std::vector<uint64_t>{x} : std::vector<uint64_t>{x, y}));
+    }
+    auto sum = front[0];
+    for (size_t i = 1; i < front.size(); ++i) {
+        sum = circuitBuilder.addNode(op::Xor, {sum, front[i]});
+    }
+    auto result = circuitBuilder.addNode(op::And, {sum, y});
+    auto output = circuitBuilder.addOutputNode({boolType}, {result});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+    const size_t before = fuse::passes::analyzeLiveness(circuit).maxLiveValues;
+    const auto depths = fuse::passes::computeLevelSchedule(circuit, op::And).getNumberOfLevels();
+
+    const size_t after = fuse::passes::scheduleForPeakMemory(circuit);
+    EXPECT_LT(after, before);
+    EXPECT_EQ(after, fuse::passes::analyzeLiveness(circuit).maxLiveValues);
+    EXPECT_EQ(fuse::passes::computeLevelSchedule(circuit, op::And).getNumberOfLevels(), depths);
+
+    // the new order is topological and the inputs stay in front
+    std::unordered_set<uint64_t> seen;
+    for (auto node : circuit) {
+        for (auto input : node.getInputNodeIDs()) {
+            EXPECT_TRUE(seen.contains(input)) << node.getNodeID();
+        }
+        seen.insert(node.getNodeID());
+    }
+    EXPECT_EQ((*circuit.begin()).getNodeID(), x);
+    EXPECT_EQ(circuit.getNumberOfNodes(), seen.size());
+
+    // (4 * NOT x) XOR (4 * (x XOR y)) = 0
+    fuse::backend::PlaintextInterpreter<bool> interpreter;
+    std::unordered_map<uint64_t, bool> values{{x, true}, {y, true}};
+    interpreter.evaluate(circuit, values);
+    EXPECT_FALSE(values.at(output));
+
+    // the order is kept if it cannot be improved
+    EXPECT_EQ(fuse::passes::scheduleForPeakMemory(circuit), after);
+}
+
+}  // namespace fuse::tests::passes
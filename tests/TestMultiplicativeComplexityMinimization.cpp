@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "BristolFrontend.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "MultiplicativeComplexityMinimization.h"
+
+namespace fuse::tests::passes {
+
+TEST(MultiplicativeComplexityMinimization, Majority) {
+    fuse::frontend::CircuitBuilder circuitBuilder("majority");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto c = circuitBuilder.addInputNode({boolType});
+
+    // maj(a, b, c) = (a AND b) XOR (a AND c) XOR (b AND c) = ((a XOR b) AND (a XOR c)) XOR a
+    auto ab = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {a, b});
+    auto ac = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {a, c});
+    auto bc = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {b, c});
+    auto xor1 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Xor, {ab, ac});
+    auto xor2 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Xor, {xor1, bc});
+    circuitBuilder.addOutputNode({boolType}, {xor2});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto wrapper = context.getMutableCircuitWrapper();
+    auto report = fuse::passes::minimizeMultiplicativeComplexity(wrapper);
+
+    EXPECT_EQ(report.nonlinearGatesBefore, 3);
+    EXPECT_EQ(report.nonlinearGatesAfter, 1);
+    EXPECT_EQ(fuse::passes::countNonlinearGates(wrapper), 1);
+}
+
+TEST(MultiplicativeComplexityMinimization, BristolCircuits) {
+    const std::vector<std::string> optimizable = {"../../examples/bristol_circuits/int_add8_size.bristol",
+                                                  "../../examples/bristol_circuits/FP-add.bristol",
+                                                  "../../examples/bristol_circuits/aes_128.bristol"};
+    const std::string output = "../../tests/outputs/optimizations/multiplicative_complexity.txt";
+    std::ofstream of(output);
+
+    for (const auto& test : optimizable) {
+        auto context = fuse::frontend::loadFUSEFromBristol(test);
+        auto circ = context.getMutableCircuitWrapper();
+        auto report = fuse::passes::minimizeMultiplicativeComplexity(circ);
+        of << test << ": " << report.nonlinearGatesBefore << " -> " << report.nonlinearGatesAfter << " non-linear gates\n";
+        EXPECT_LE(report.nonlinearGatesAfter, report.nonlinearGatesBefore);
+    }
+}
+
+}  // namespace fuse::tests::passes
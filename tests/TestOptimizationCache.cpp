@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "OptimizationCache.h"
+
+namespace fuse::tests::util {
+
+namespace {
+
+fuse::core::CircuitContext buildCircuit(fuse::core::ir::PrimitiveOperation operation) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    circuitBuilder.addOutputNode({boolType}, {circuitBuilder.addNode(operation, {a, b})});
+    return fuse::core::CircuitContext(circuitBuilder);
+}
+
+}  // namespace
+
+TEST(OptimizationCache, ServesUnchangedCircuitsFromCache) {
+    auto cacheDirectory = std::filesystem::temp_directory_path() / "fuse_optimization_cache_test";
+    std::filesystem::remove_all(cacheDirectory);
+    fuse::util::OptimizationCache cache(cacheDirectory);
+
+    size_t optimizations = 0;
+    auto optimize = [&](fuse::core::CircuitContext& circuit) {
+        ++optimizations;
+        auto mutableCircuit = circuit.getMutableCircuitWrapper();
+        for (auto node : mutableCircuit) {
+            if (node.getOperation() == fuse::core::ir::PrimitiveOperation::And) {
+                node.setPrimitiveOperation(fuse::core::ir::PrimitiveOperation::Xor);
+            }
+        }
+    };
+
+    auto first = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    cache.getOrComputeCircuit(first, "rewrite", optimize);
+    auto second = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    cache.getOrComputeCircuit(second, "rewrite", optimize);
+    EXPECT_EQ(optimizations, 1);
+    EXPECT_EQ(cache.getNumberOfHits(), 1);
+
+    // the cached result is the optimized circuit
+    second.getReadOnlyCircuit()->topologicalTraversal([](const fuse::core::NodeReadOnly& node) {
+        EXPECT_NE(node.getOperation(), fuse::core::ir::PrimitiveOperation::And);
+    });
+
+    // different parameters or a different circuit miss the cache
+    auto third = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    cache.getOrComputeCircuit(third, "rewrite:threshold=2", optimize);
+    auto fourth = buildCircuit(fuse::core::ir::PrimitiveOperation::Or);
+    cache.getOrComputeCircuit(fourth, "rewrite", optimize);
+    EXPECT_EQ(optimizations, 3);
+    EXPECT_EQ(cache.getNumberOfMisses(), 3);
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+TEST(OptimizationCache, CachesModules) {
+    auto cacheDirectory = std::filesystem::temp_directory_path() / "fuse_optimization_cache_module_test";
+    std::filesystem::remove_all(cacheDirectory);
+    fuse::util::OptimizationCache cache(cacheDirectory);
+
+    auto toModule = [](fuse::core::CircuitContext& circuit) {
+        fuse::frontend::ModuleBuilder moduleBuilder;
+        moduleBuilder.addSerializedCircuit(circuit.getBufferPointer(), circuit.getBufferSize());
+        moduleBuilder.setEntryCircuitName("main");
+        return fuse::core::ModuleContext(moduleBuilder);
+    };
+
+    auto first = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    auto computed = cache.getOrComputeModule(first, "module", toModule);
+    auto second = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    auto cached = cache.getOrComputeModule(second, "module", toModule);
+    EXPECT_EQ(cache.getNumberOfHits(), 1);
+    EXPECT_EQ(cached.getReadOnlyModule()->getEntryCircuitName(), "main");
+    EXPECT_EQ(cached.getBufferSize(), computed.getBufferSize());
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+TEST(OptimizationCache, ConcurrentWritersUseSeparateTemporaryFiles) {
+    auto cacheDirectory = std::filesystem::temp_directory_path() / "fuse_optimization_cache_concurrency_test";
+    std::filesystem::remove_all(cacheDirectory);
+
+    // all threads miss the cache and write the same entry at the same time
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 8; ++i) {
+        writers.emplace_back([&] {
+            fuse::util::OptimizationCache cache(cacheDirectory);
+            auto circuit = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+            cache.getOrComputeCircuit(circuit, "identity", [](fuse::core::CircuitContext&) {});
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    // one entry and the input it was computed from
+    std::vector<std::string> extensions;
+    for (const auto& file : std::filesystem::directory_iterator(cacheDirectory)) {
+        extensions.push_back(file.path().extension().string());
+    }
+    std::sort(extensions.begin(), extensions.end());
+    EXPECT_EQ(extensions, (std::vector<std::string>{".cfs", ".input"}));
+
+    fuse::util::OptimizationCache cache(cacheDirectory);
+    auto circuit = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    cache.getOrComputeCircuit(circuit, "identity", [](fuse::core::CircuitContext&) {});
+    EXPECT_EQ(cache.getNumberOfHits(), 1);
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+TEST(OptimizationCache, CollidingKeysMissTheCache) {
+    auto cacheDirectory = std::filesystem::temp_directory_path() / "fuse_optimization_cache_collision_test";
+    std::filesystem::remove_all(cacheDirectory);
+    fuse::util::OptimizationCache cache(cacheDirectory);
+
+    size_t optimizations = 0;
+    auto optimize = [&](fuse::core::CircuitContext&) { ++optimizations; };
+    auto first = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    cache.getOrComputeCircuit(first, "identity", optimize);
+
+    // pretend that the entry belongs to another input with the same key
+    auto entry = cacheDirectory / (fuse::util::OptimizationCache::computeKey(first, "identity") + ".cfs.input");
+    ASSERT_TRUE(std::filesystem::exists(entry));
+    {
+        std::ofstream file(entry, std::ios::binary | std::ios::trunc);
+        file << "another circuit";
+    }
+
+    auto second = buildCircuit(fuse::core::ir::PrimitiveOperation::And);
+    cache.getOrComputeCircuit(second, "identity", optimize);
+    EXPECT_EQ(optimizations, 2);
+    EXPECT_EQ(cache.getNumberOfHits(), 0);
+    EXPECT_EQ(second.getReadOnlyCircuit()->getNumberOfNodes(), first.getReadOnlyCircuit()->getNumberOfNodes());
+
+    std::filesystem::remove_all(cacheDirectory);
+}
+
+}  // namespace fuse::tests::util
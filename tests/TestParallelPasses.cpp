@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "DeadNodeEliminator.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "ParallelFor.h"
+#include "ParallelPasses.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+namespace {
+// main calls helper, helper calls leaf, unused and recursive are not called by main, recursive calls itself
+void buildModule(fuse::frontend::ModuleBuilder& moduleBuilder) {
+    for (const std::string name : {"main", "helper", "leaf", "unused", "recursive"}) {
+        auto circuit = moduleBuilder.addCircuit(name);
+        auto boolType = circuit->addDataType(fuse::core::ir::PrimitiveType::Bool);
+        auto a = circuit->addInputNode({boolType});
+        auto b = circuit->addInputNode({boolType});
+        auto result = circuit->addNode(op::And, {a, b});
+        // dead node
+        circuit->addNode(op::Xor, {a, b});
+        if (name == "main") {
+            result = circuit->addCallToSubcircuitNode({result, b}, "helper");
+        } else if (name == "helper") {
+            result = circuit->addCallToSubcircuitNode({result, a}, "leaf");
+        } else if (name == "recursive") {
+            result = circuit->addCallToSubcircuitNode({result, a}, "recursive");
+        }
+        circuit->addOutputNode({boolType}, {result});
+    }
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+}
+}  // namespace
+
+TEST(ParallelPasses, ParallelForVisitsEveryIndexOnce) {
+    std::vector<std::atomic<int>> visits(1000);
+    fuse::core::util::parallelFor(visits.size(), [&](size_t i) { ++visits[i]; }, 4);
+    EXPECT_TRUE(std::all_of(visits.begin(), visits.end(), [](const auto& count) { return count == 1; }));
+
+    EXPECT_THROW(fuse::core::util::parallelFor(
+                     10, [](size_t i) { if (i == 7) throw std::logic_error("failed"); }, 4),
+                 std::logic_error);
+}
+
+TEST(ParallelPasses, RunsOnAllCircuits) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    buildModule(moduleBuilder);
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    std::atomic<size_t> numberOfCircuits = 0;
+    fuse::passes::runOnAllCircuits(
+        module, [&](fuse::core::CircuitObjectWrapper& circuit) {
+            circuit.setStringValueForAttribute("visited", "true");
+            ++numberOfCircuits;
+        },
+        4);
+    EXPECT_EQ(numberOfCircuits, 5);
+    for (const auto& name : module.getAllCircuitNames()) {
+        EXPECT_EQ(module.getCircuitWithName(name).getStringValueForAttribute("visited"), "true") << name;
+    }
+}
+
+TEST(ParallelPasses, RespectsCallGraphOrder) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    buildModule(moduleBuilder);
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    auto levels = fuse::passes::getCallGraphLevels(module);
+    ASSERT_EQ(levels.size(), 4);
+    std::sort(levels[0].begin(), levels[0].end());
+    EXPECT_EQ(levels[0], std::vector<std::string>({"leaf", "unused"}));
+    EXPECT_EQ(levels[1], std::vector<std::string>({"helper"}));
+    EXPECT_EQ(levels[2], std::vector<std::string>({"main"}));
+    EXPECT_EQ(levels[3], std::vector<std::string>({"recursive"}));
+
+    std::mutex orderMutex;
+    std::vector<std::string> order;
+    fuse::passes::runInCallGraphOrder(
+        module, [&](fuse::core::CircuitObjectWrapper& circuit) {
+            std::lock_guard lock(orderMutex);
+            order.push_back(circuit.getName());
+        },
+        4);
+    ASSERT_EQ(order.size(), 5);
+    auto position = [&](const std::string& name) { return std::find(order.begin(), order.end(), name) - order.begin(); };
+    EXPECT_LT(position("leaf"), position("helper"));
+    EXPECT_LT(position("helper"), position("main"));
+}
+
+TEST(ParallelPasses, EliminatesDeadNodesConcurrently) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    buildModule(moduleBuilder);
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+
+    fuse::passes::eliminateDeadNodes(module, true, 4);
+    auto names = module.getAllCircuitNames();
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ(names, std::vector<std::string>({"helper", "leaf", "main"}));
+    for (const auto& name : names) {
+        auto circuit = module.getCircuitWithName(name);
+        for (auto node : circuit) {
+            EXPECT_NE(node.getOperation(), op::Xor) << name;
+        }
+    }
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "PartialEvaluation.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+TEST(PartialEvaluation, SpecializesCircuitForKnownInputs) {
+    fuse::frontend::CircuitBuilder circuitBuilder("partialEvaluation");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = circuitBuilder.addInputNode({boolType});
+    auto y = circuitBuilder.addInputNode({boolType});
+    auto key = circuitBuilder.addInputNode({boolType});
+    // (x AND key) XOR (y AND NOT key), with key = false this is y
+    auto andX = circuitBuilder.addNode(op::And, {x, key});
+    auto notKey = circuitBuilder.addNode(op::Not, {key});
+    auto andY = circuitBuilder.addNode(op::And, {y, notKey});
+    auto result = circuitBuilder.addNode(op::Xor, {andX, andY});
+    auto output = circuitBuilder.addOutputNode({boolType}, {result});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+    const size_t numberOfNodes = circuit.getNumberOfNodes();
+
+    EXPECT_THROW(fuse::passes::evaluatePartially(circuit, {{andX, fuse::passes::PublicValue::fromBool(false)}}), std::logic_error);
+
+    auto removed = fuse::passes::evaluatePartially(circuit, {{key, fuse::passes::PublicValue::fromBool(false)}});
+    EXPECT_GT(removed, 0);
+    EXPECT_LT(circuit.getNumberOfNodes(), numberOfNodes);
+    EXPECT_EQ(circuit.getNumberOfInputs(), 2);
+    EXPECT_EQ(circuit.getNodeWithID(output).getInputNodeIDs()[0], y);
+    for (auto node : circuit) {
+        EXPECT_NE(node.getOperation(), op::And);
+    }
+}
+
+TEST(PartialEvaluation, SpecializesCallees) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    {
+        // select(a, b, useA) = useA ? a : b, written with gates
+        auto select = moduleBuilder.addCircuit("select");
+        auto boolType = select->addDataType(fuse::core::ir::PrimitiveType::Bool);
+        auto a = select->addInputNode({boolType});
+        auto b = select->addInputNode({boolType});
+        auto useA = select->addInputNode({boolType});
+        auto andA = select->addNode(op::And, {a, useA});
+        auto notUseA = select->addNode(op::Not, {useA});
+        auto andB = select->addNode(op::And, {b, notUseA});
+        select->addOutputNode({boolType}, {select->addNode(op::Xor, {andA, andB})});
+        // and of the selector with itself, constant once the selector is known
+        select->addOutputNode({boolType}, {select->addNode(op::And, {useA, useA})});
+    }
+    auto main = moduleBuilder.addCircuit("main");
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = main->addInputNode({boolType});
+    auto y = main->addInputNode({boolType});
+    auto mode = main->addInputNode({boolType});
+    auto call = main->addCallToSubcircuitNode(std::vector<size_t>{}, {x, y, mode}, {0, 0, 0}, "select", std::vector<size_t>{boolType, boolType});
+    auto secondCall = main->addCallToSubcircuitNode(std::vector<size_t>{}, {y, x, mode}, {0, 0, 0}, "select", std::vector<size_t>{boolType, boolType});
+    auto combined = main->addNode(op::Xor, {call, secondCall});
+    auto selected = main->addOutputNode(std::vector<size_t>{boolType}, {combined});
+    auto flag = main->addOutputNode(std::vector<size_t>{boolType}, {call}, std::vector<unsigned int>{1});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    // both calls pass the same constant and share one specialization
+    EXPECT_EQ(fuse::passes::evaluatePartially(module, {{mode, fuse::passes::PublicValue::fromBool(true)}}), 1);
+
+    auto entry = module.getEntryCircuit();
+    EXPECT_EQ(entry.getNumberOfInputs(), 2);
+    auto specializedName = entry.getNodeWithID(call).getSubCircuitName();
+    EXPECT_NE(specializedName, "select");
+    EXPECT_EQ(entry.getNodeWithID(call).getNumberOfInputs(), 2);
+    EXPECT_EQ(entry.getNodeWithID(secondCall).getSubCircuitName(), specializedName);
+
+    // the specialized callee forwards its first input and no longer has any gates
+    auto specialized = module.getCircuitWithName(specializedName);
+    EXPECT_EQ(specialized.getNumberOfInputs(), 2);
+    for (auto node : specialized) {
+        EXPECT_FALSE(node.getOperation() == op::And || node.getOperation() == op::Not) << node.getNodeID();
+    }
+    // the constant second output is substituted in the caller
+    EXPECT_TRUE(entry.getNodeWithID(entry.getNodeWithID(flag).getInputNodeIDs()[0]).isConstantNode());
+    EXPECT_EQ(entry.getNodeWithID(selected).getInputNodeIDs()[0], combined);
+
+    // the original callee is unused and the input is unchanged
+    auto original = module.getCircuitWithName("select");
+    EXPECT_EQ(original.getNumberOfInputs(), 3);
+}
+
+TEST(PartialEvaluation, FoldsCallsWithOnlyConstantArguments) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    {
+        auto xorGate = moduleBuilder.addCircuit("xorGate");
+        auto boolType = xorGate->addDataType(fuse::core::ir::PrimitiveType::Bool);
+        auto a = xorGate->addInputNode({boolType});
+        auto b = xorGate->addInputNode({boolType});
+        xorGate->addOutputNode({boolType}, {xorGate->addNode(op::Xor, {a, b})});
+    }
+    auto main = moduleBuilder.addCircuit("main");
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = main->addInputNode({boolType});
+    auto k1 = main->addInputNode({boolType});
+    auto k2 = main->addInputNode({boolType});
+    auto call = main->addCallToSubcircuitNode(std::vector<size_t>{}, {k1, k2}, {0, 0}, "xorGate", std::vector<size_t>{boolType});
+    auto output = main->addOutputNode(std::vector<size_t>{boolType}, {main->addNode(op::And, {call, x})});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::evaluatePartially(module, {{k1, fuse::passes::PublicValue::fromBool(true)}, {k2, fuse::passes::PublicValue::fromBool(false)}}), 1);
+
+    // the call is replaced by its constant result instead of a call without inputs, true AND x is x
+    auto entry = module.getEntryCircuit();
+    EXPECT_EQ(entry.getNumberOfInputs(), 1);
+    for (auto node : entry) {
+        EXPECT_FALSE(node.isSubcircuitNode()) << node.getNodeID();
+    }
+    EXPECT_EQ(entry.getNodeWithID(output).getInputNodeIDs()[0], x);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "DOTBackend.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "PeepholeRewriter.h"
+
+namespace fuse::tests::passes {
+
+TEST(PeepholeRewriter, BooleanIdentities) {
+    const std::string output = "../../tests/outputs/optimizations/peephole_booleans.txt";
+    std::ofstream of(output);
+
+    fuse::frontend::CircuitBuilder circuitBuilder("peepholeBoolean");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+
+    auto in1 = circuitBuilder.addInputNode({boolType});
+    auto in2 = circuitBuilder.addInputNode({boolType});
+    auto zero = circuitBuilder.addConstantNodeWithPayload(false);
+
+    // (in1 AND in1) XOR 0 = in1
+    auto and1 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {in1, in1});
+    auto xor1 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Xor, {and1, zero});
+    auto out1 = circuitBuilder.addOutputNode({boolType}, {xor1});
+
+    // NOT NOT in2 = in2
+    auto not1 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Not, {in2});
+    auto not2 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Not, {not1});
+    auto out2 = circuitBuilder.addOutputNode({boolType}, {not2});
+
+    // Mux(in1, in2 AND 0, 0) = 0
+    auto and2 = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {in2, zero});
+    auto mux = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Mux, {in1, and2, zero});
+    auto out3 = circuitBuilder.addOutputNode({boolType}, {mux});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto wrapper = context.getMutableCircuitWrapper();
+    of << fuse::backend::generateDotCodeFrom(wrapper);
+    of << "\nOptimized:\n";
+
+    auto numberOfRewrites = fuse::passes::applyPeepholeRewrites(wrapper);
+    of << fuse::backend::generateDotCodeFrom(wrapper);
+    of.flush();
+
+    EXPECT_GT(numberOfRewrites, 0);
+    EXPECT_EQ(wrapper.getNodeWithID(out1).getInputNodeIDs()[0], in1);
+    EXPECT_EQ(wrapper.getNodeWithID(out2).getInputNodeIDs()[0], in2);
+    EXPECT_EQ(wrapper.getNodeWithID(out3).getInputNodeIDs()[0], zero);
+    // inputs, constant and outputs are the only remaining nodes
+    EXPECT_EQ(wrapper.getNumberOfNodes(), 6);
+}
+
+TEST(PeepholeRewriter, SplitOfMerge) {
+    fuse::frontend::CircuitBuilder circuitBuilder("peepholeSplitMerge");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+
+    std::vector<uint64_t> bits;
+    for (int i = 0; i < 8; ++i) {
+        bits.push_back(circuitBuilder.addInputNode({boolType}));
+    }
+    auto merge = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Merge, bits);
+    auto split = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, merge);
+    auto select = circuitBuilder.addSelectOffsetNode(split, 3);
+    auto out = circuitBuilder.addOutputNode({boolType}, {select});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto wrapper = context.getMutableCircuitWrapper();
+    fuse::passes::applyPeepholeRewrites(wrapper);
+
+    auto outNode = wrapper.getNodeWithID(out);
+    EXPECT_EQ(outNode.getInputNodeIDs()[0], bits[3]);
+    EXPECT_EQ(outNode.getInputOffsets()[0], 0);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "PreprocessingManifest.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+using fuse::passes::MpcProtocol;
+using fuse::passes::PreprocessingResource;
+
+TEST(PreprocessingManifest, BooleanCircuit) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto c = circuitBuilder.addInputNode({boolType});
+    auto x = circuitBuilder.addNode(op::And, {a, b});
+    auto y = circuitBuilder.addNode(op::Xor, {x, c});
+    circuitBuilder.addOutputNode({boolType}, {circuitBuilder.addNode(op::And, {y, a})});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto gmw = fuse::passes::computePreprocessingManifest(*circuit);
+    ASSERT_EQ(gmw.demands.size(), 1);
+    EXPECT_EQ(gmw.demands.at({PreprocessingResource::BooleanTriple, 1, 1}), 2);
+    EXPECT_EQ(gmw.getTotals(PreprocessingResource::BooleanTriple).at(1), 2);
+    EXPECT_TRUE(gmw.getTotals(PreprocessingResource::ArithmeticTriple).empty());
+
+    auto bmr = fuse::passes::computePreprocessingManifest(*circuit, MpcProtocol::Bmr);
+    ASSERT_EQ(bmr.demands.size(), 1);
+    EXPECT_EQ(bmr.demands.at({PreprocessingResource::ObliviousTransfer, 128, 1}), 2);
+
+    auto json = fuse::passes::toJSON(gmw);
+    EXPECT_NE(json.find("{\"resource\": \"BooleanTriple\", \"bitWidth\": 1, \"simdWidth\": 1, \"count\": 2}"), std::string::npos);
+    EXPECT_NE(json.find("\"BooleanTriple\": {\"1\": 2}"), std::string::npos);
+}
+
+TEST(PreprocessingManifest, CountsConversionsOnce) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto product = circuitBuilder.addNode(op::Mul, {a, b});
+    auto square = circuitBuilder.addNode(op::Square, {a});
+    // compared in Boolean GMW, so product and a are converted to Boolean sharings once
+    auto greater = circuitBuilder.addNode(op::Gt, {product, a});
+    auto less = circuitBuilder.addNode(op::Lt, {product, a});
+    // the 1-bit comparison result is converted back into an arithmetic sharing
+    auto sum = circuitBuilder.addNode(op::Add, {greater, square});
+    auto outputSum = circuitBuilder.addOutputNode({wordType}, {sum});
+    circuitBuilder.addOutputNode({wordType}, {less});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+    for (auto id : {a, b, product, square, sum, outputSum}) {
+        circuit.getNodeWithID(id).setStringValueForAttribute(fuse::passes::kProtocolAttribute, "ArithmeticGmw");
+    }
+
+    auto manifest = fuse::passes::computePreprocessingManifest(circuit);
+    EXPECT_EQ(manifest.demands.at({PreprocessingResource::ArithmeticTriple, 32, 1}), 1);
+    EXPECT_EQ(manifest.demands.at({PreprocessingResource::SquarePair, 32, 1}), 1);
+    // two 32-bit conversions with 31 AND gates each and two 32-bit comparisons
+    EXPECT_EQ(manifest.demands.at({PreprocessingResource::BooleanTriple, 1, 1}), 2 * 31 + 2 * 32);
+    EXPECT_EQ(manifest.demands.at({PreprocessingResource::SharedBit, 1, 1}), 1);
+    EXPECT_EQ(manifest.demands.size(), 4);
+
+    circuit.getNodeWithID(greater).setStringValueForAttribute(fuse::passes::kProtocolAttribute, "Yao");
+    EXPECT_THROW(fuse::passes::computePreprocessingManifest(circuit), std::logic_error);
+}
+
+TEST(PreprocessingManifest, ScalesSimdCalls) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto helper = moduleBuilder.addCircuit("helper");
+
+    auto helperBool = helper->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = helper->addInputNode({helperBool});
+    auto y = helper->addInputNode({helperBool});
+    helper->addOutputNode({helperBool}, {helper->addNode(op::And, {x, y})});
+
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({mainBool});
+    auto b = main->addInputNode({mainBool});
+    auto c = main->addInputNode({mainBool});
+    auto d = main->addInputNode({mainBool});
+    main->addOutputNode({mainBool}, {main->addCallToSubcircuitNode({a, b}, "helper")});
+    // SIMD call with two lanes
+    main->addOutputNode({mainBool}, {main->addCallToSubcircuitNode({a, b, c, d}, "helper")});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getReadOnlyModule();
+    auto manifest = fuse::passes::computePreprocessingManifest(*module);
+    EXPECT_EQ(manifest.demands.at({PreprocessingResource::BooleanTriple, 1, 1}), 1);
+    EXPECT_EQ(manifest.demands.at({PreprocessingResource::BooleanTriple, 1, 2}), 1);
+    EXPECT_EQ(manifest.getTotals(PreprocessingResource::BooleanTriple).at(1), 3);
+
+    auto entryCircuit = module->getEntryCircuit();
+    EXPECT_THROW(fuse::passes::computePreprocessingManifest(*entryCircuit), std::logic_error);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,176 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "ProtocolAssignment.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+using fuse::passes::MpcProtocol;
+
+TEST(ProtocolAssignment, ArithmeticCircuitStaysArithmetic) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto c = circuitBuilder.addInputNode({wordType});
+    auto product = circuitBuilder.addNode(op::Mul, {a, b});
+    auto sum = circuitBuilder.addNode(op::Add, {product, c});
+    auto output = circuitBuilder.addOutputNode({wordType}, {sum});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto assignment = fuse::passes::assignProtocols(*circuit);
+    EXPECT_EQ(assignment.nodeProtocols.size(), 6);
+    for (auto id : {a, b, c, product, sum, output}) {
+        EXPECT_EQ(assignment.nodeProtocols.at(id), MpcProtocol::ArithmeticGmw);
+    }
+    EXPECT_EQ(assignment.numberOfConversions, 0);
+    EXPECT_DOUBLE_EQ(assignment.conversionCost, 0.0);
+}
+
+TEST(ProtocolAssignment, ConvertsBeforeComparison) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto c = circuitBuilder.addInputNode({wordType});
+    auto product = circuitBuilder.addNode(op::Mul, {a, b});
+    auto greater = circuitBuilder.addNode(op::Gt, {product, c});
+    auto output = circuitBuilder.addOutputNode({boolType}, {greater});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    auto assignment = fuse::passes::assignAndAnnotateProtocols(circuit);
+    EXPECT_EQ(assignment.nodeProtocols.at(product), MpcProtocol::ArithmeticGmw);
+    auto comparisonProtocol = assignment.nodeProtocols.at(greater);
+    EXPECT_NE(comparisonProtocol, MpcProtocol::ArithmeticGmw);
+    EXPECT_EQ(assignment.nodeProtocols.at(c), comparisonProtocol);
+    EXPECT_EQ(assignment.nodeProtocols.at(output), comparisonProtocol);
+    // only the product is converted
+    EXPECT_EQ(assignment.numberOfConversions, 1);
+    EXPECT_GT(assignment.conversionCost, 0.0);
+
+    EXPECT_EQ(circuit.getNodeWithID(product).getStringValueForAttribute(fuse::passes::kProtocolAttribute), "ArithmeticGmw");
+    EXPECT_EQ(circuit.getNodeWithID(greater).getStringValueForAttribute(fuse::passes::kProtocolAttribute),
+              fuse::passes::getProtocolName(comparisonProtocol));
+}
+
+TEST(ProtocolAssignment, ConvertsSharedValueOncePerProtocol) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto product = circuitBuilder.addNode(op::Mul, {a, b});
+    std::vector<uint64_t> comparisons;
+    for (int i = 0; i < 4; ++i) {
+        comparisons.push_back(circuitBuilder.addNode(op::Eq, {product, circuitBuilder.addInputNode({wordType})}));
+    }
+    for (auto comparison : comparisons) {
+        circuitBuilder.addOutputNode({boolType}, {comparison});
+    }
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto assignment = fuse::passes::assignProtocols(*circuit);
+    EXPECT_EQ(assignment.nodeProtocols.at(product), MpcProtocol::ArithmeticGmw);
+    for (auto comparison : comparisons) {
+        EXPECT_EQ(assignment.nodeProtocols.at(comparison), assignment.nodeProtocols.at(comparisons[0]));
+    }
+    EXPECT_EQ(assignment.numberOfConversions, 1);
+}
+
+TEST(ProtocolAssignment, CustomCostModel) {
+    // a cost model without arithmetic sharing
+    struct BooleanOnlyCostModel : fuse::passes::ProtocolCostModel {
+        double getOperationCost(const fuse::core::NodeReadOnly& node, MpcProtocol protocol, size_t bitWidth) const override {
+            if (protocol == MpcProtocol::ArithmeticGmw) {
+                return std::numeric_limits<double>::infinity();
+            }
+            return ProtocolCostModel::getOperationCost(node, protocol, bitWidth);
+        }
+    };
+
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto product = circuitBuilder.addNode(op::Mul, {a, b});
+    circuitBuilder.addOutputNode({wordType}, {product});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getReadOnlyCircuit();
+
+    auto assignment = fuse::passes::assignProtocols(*circuit, BooleanOnlyCostModel());
+    for (const auto& [id, protocol] : assignment.nodeProtocols) {
+        EXPECT_NE(protocol, MpcProtocol::ArithmeticGmw);
+    }
+    EXPECT_EQ(assignment.numberOfConversions, 0);
+}
+
+TEST(ProtocolAssignment, AnnotationsKeepOtherAttributes) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto a = circuitBuilder.addInputNode({wordType});
+    circuitBuilder.addOutputNode({wordType}, {a});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    auto node = circuit.getNodeWithID(a);
+    node.setNodeAnnotations("cond:3,val:8");
+    node.setStringValueForAttribute("protocol", "Bmr");
+    node.setStringValueForAttribute("protocol", "BooleanGmw");
+    EXPECT_EQ(node.getStringValueForAttribute("cond"), "3");
+    EXPECT_EQ(node.getStringValueForAttribute("val"), "8");
+    EXPECT_EQ(node.getStringValueForAttribute("protocol"), "BooleanGmw");
+    EXPECT_EQ(fuse::passes::getProtocolFromName("BooleanGmw"), MpcProtocol::BooleanGmw);
+    EXPECT_FALSE(fuse::passes::getProtocolFromName("Yao").has_value());
+}
+
+TEST(ProtocolAssignment, AnnotationKeysMatchWholeKeys) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto input = circuitBuilder.addInputNode({boolType}, "local_owner:1,owner:2");
+    circuitBuilder.addOutputNode({boolType}, {input});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+    auto node = circuit.getNodeWithID(input);
+
+    EXPECT_EQ(node.getStringValueForAttribute("owner"), "2");
+    EXPECT_EQ(node.getStringValueForAttribute("local_owner"), "1");
+    node.setStringValueForAttribute("owner", "3");
+    EXPECT_EQ(node.getNodeAnnotations(), "local_owner:1,owner:3");
+
+    // a key that only occurs as the suffix of another key is appended
+    node.setNodeAnnotations("local_owner:1");
+    EXPECT_EQ(node.getStringValueForAttribute("owner"), "");
+    node.setStringValueForAttribute("owner", "2");
+    EXPECT_EQ(node.getNodeAnnotations(), "local_owner:1,owner:2");
+}
+
+}  // namespace fuse::tests::passes
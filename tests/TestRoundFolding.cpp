@@ -0,0 +1,216 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "CostEstimation.h"
+#include "IR.h"
+#include "LoopUnrolling.h"
+#include "ModuleBuilder.h"
+#include "RoundFolding.h"
+
+namespace fuse::tests::passes {
+
+using op = fuse::core::ir::PrimitiveOperation;
+
+namespace {
+// round function with the carried values (x, y) and the loop-invariant key k: (x, y) -> (y ^ k, x & y)
+void addRoundFunction(fuse::frontend::CircuitBuilder* round) {
+    auto boolType = round->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = round->addInputNode({boolType});
+    auto y = round->addInputNode({boolType});
+    auto k = round->addInputNode({boolType});
+    round->addOutputNode({boolType}, {round->addNode(op::Xor, {y, k})});
+    round->addOutputNode({boolType}, {round->addNode(op::And, {x, y})});
+}
+
+uint64_t addRoundCall(fuse::frontend::CircuitBuilder* circuit, size_t boolType, const std::vector<uint64_t>& inputs, const std::vector<unsigned int>& offsets) {
+    return circuit->addCallToSubcircuitNode(std::vector<size_t>{}, inputs, offsets, "round", std::vector<size_t>{boolType, boolType});
+}
+}  // namespace
+
+TEST(RoundFolding, FoldsCallChainIntoLoop) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    addRoundFunction(moduleBuilder.addCircuit("round"));
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    auto k = main->addInputNode({boolType});
+    auto state = addRoundCall(main, boolType, {a, b, k}, {0, 0, 0});
+    for (int i = 0; i < 9; ++i) {
+        state = addRoundCall(main, boolType, {state, state, k}, {0, 1, 0});
+    }
+    auto output = main->addOutputNode(std::vector<size_t>{boolType}, {state}, std::vector<unsigned int>{1});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    auto before = fuse::passes::estimateCost(module);
+
+    EXPECT_EQ(fuse::passes::foldRepeatedRounds(module), 1);
+    auto circuit = module.getEntryCircuit();
+    // inputs, the loop and the output
+    ASSERT_EQ(circuit.getNumberOfNodes(), 5);
+    auto outputNode = circuit.getNodeWithID(output);
+    auto loop = circuit.getNodeWithID(outputNode.getInputNodeIDs()[0]);
+    EXPECT_TRUE(loop.isLoopNode());
+    EXPECT_EQ(loop.getSubCircuitName(), "round");
+    EXPECT_EQ(fuse::passes::getNumberOfIterations(loop), 10);
+    EXPECT_EQ(std::vector<uint64_t>(loop.getInputNodeIDs().begin(), loop.getInputNodeIDs().end()), std::vector<uint64_t>({a, b, k}));
+    EXPECT_EQ(outputNode.getInputOffsets()[0], 1);
+
+    auto folded = fuse::passes::estimateCost(module);
+    EXPECT_DOUBLE_EQ(folded.numberOfAndGates, before.numberOfAndGates);
+    EXPECT_DOUBLE_EQ(folded.multiplicativeDepth, before.multiplicativeDepth);
+
+    // unrolling restores the chain of calls
+    EXPECT_EQ(fuse::passes::unrollLoops(module), 1);
+    EXPECT_EQ(circuit.getNumberOfNodes(), 14);
+    EXPECT_DOUBLE_EQ(fuse::passes::estimateCost(module).numberOfAndGates, before.numberOfAndGates);
+}
+
+TEST(RoundFolding, FoldsRoundKeysIntoPerIterationInputs) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    addRoundFunction(moduleBuilder.addCircuit("round"));
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    std::vector<uint64_t> roundKeys{main->addInputNode({boolType}), main->addInputNode({boolType}), main->addInputNode({boolType})};
+    auto state = addRoundCall(main, boolType, {a, b, roundKeys[0]}, {0, 0, 0});
+    state = addRoundCall(main, boolType, {state, state, roundKeys[1]}, {0, 1, 0});
+    state = addRoundCall(main, boolType, {state, state, roundKeys[2]}, {0, 1, 0});
+    // the key of the last round is derived after the first rounds
+    roundKeys.push_back(main->addNode(op::Not, {roundKeys[2]}));
+    state = addRoundCall(main, boolType, {state, state, roundKeys[3]}, {0, 1, 0});
+    auto output = main->addOutputNode(std::vector<size_t>{boolType}, {state}, std::vector<unsigned int>{1});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    auto before = fuse::passes::estimateCost(module);
+
+    EXPECT_EQ(fuse::passes::foldRepeatedRounds(module), 1);
+    auto circuit = module.getEntryCircuit();
+    auto loop = circuit.getNodeWithID(circuit.getNodeWithID(output).getInputNodeIDs()[0]);
+    ASSERT_TRUE(loop.isLoopNode());
+    EXPECT_EQ(fuse::passes::getNumberOfIterations(loop), 4);
+    EXPECT_EQ(fuse::passes::getNumberOfPerIterationInputs(loop), 1);
+    EXPECT_EQ(loop.getNumberOfOutputs(), 2);
+    std::vector<uint64_t> expectedInputs{a, b};
+    expectedInputs.insert(expectedInputs.end(), roundKeys.begin(), roundKeys.end());
+    EXPECT_EQ(std::vector<uint64_t>(loop.getInputNodeIDs().begin(), loop.getInputNodeIDs().end()), expectedInputs);
+    // the derived key is computed before the loop
+    bool keyComputed = false;
+    for (auto node : circuit) {
+        keyComputed |= node.getNodeID() == roundKeys[3];
+        if (node.isLoopNode()) {
+            EXPECT_TRUE(keyComputed);
+        }
+    }
+
+    // every unrolled round receives its own key
+    EXPECT_EQ(fuse::passes::unrollLoops(module), 1);
+    std::vector<uint64_t> keysOfCalls;
+    for (auto node : circuit) {
+        if (node.isSubcircuitNode()) {
+            keysOfCalls.push_back(node.getInputNodeIDs()[2]);
+        }
+    }
+    EXPECT_EQ(keysOfCalls, roundKeys);
+    EXPECT_DOUBLE_EQ(fuse::passes::estimateCost(module).numberOfAndGates, before.numberOfAndGates);
+}
+
+TEST(RoundFolding, KeepsChainsWithOtherUses) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    addRoundFunction(moduleBuilder.addCircuit("round"));
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    auto k0 = main->addInputNode({boolType});
+    auto k1 = main->addInputNode({boolType});
+    // different round keys
+    auto first = addRoundCall(main, boolType, {a, b, k0}, {0, 0, 0});
+    auto second = addRoundCall(main, boolType, {first, first, k1}, {0, 1, 0});
+    // the state after the second round is also an output
+    auto third = addRoundCall(main, boolType, {second, second, k1}, {0, 1, 0});
+    auto fourth = addRoundCall(main, boolType, {third, third, k1}, {0, 1, 0});
+    main->addOutputNode(std::vector<size_t>{boolType}, {fourth}, std::vector<unsigned int>{0});
+    main->addOutputNode(std::vector<size_t>{boolType}, {second}, std::vector<unsigned int>{0});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::foldRepeatedRounds(module, 3), 0);
+    // the first two rounds with their keys and the last two rounds with the shared key
+    EXPECT_EQ(fuse::passes::foldRepeatedRounds(module), 2);
+    auto circuit = module.getEntryCircuit();
+    auto firstLoop = circuit.getNodeWithID(first);
+    EXPECT_TRUE(firstLoop.isLoopNode());
+    EXPECT_EQ(fuse::passes::getNumberOfPerIterationInputs(firstLoop), 1);
+    EXPECT_EQ(std::vector<uint64_t>(firstLoop.getInputNodeIDs().begin(), firstLoop.getInputNodeIDs().end()), std::vector<uint64_t>({a, b, k0, k1}));
+    EXPECT_TRUE(circuit.getNodeWithID(third).isLoopNode());
+    EXPECT_EQ(fuse::passes::getNumberOfIterations(circuit.getNodeWithID(third)), 2);
+    EXPECT_EQ(fuse::passes::getNumberOfPerIterationInputs(circuit.getNodeWithID(third)), 0);
+    EXPECT_EQ(circuit.getNodeWithID(third).getInputNodeIDs()[0], first);
+}
+
+TEST(RoundFolding, KeepsChainsWithDifferingInputsAfterInvariantOnes) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    {
+        // (x, y, c, k) -> (y ^ k, x & c), the round key follows the invariant input c
+        auto round = moduleBuilder.addCircuit("round");
+        auto boolType = round->addDataType(fuse::core::ir::PrimitiveType::Bool);
+        auto x = round->addInputNode({boolType});
+        auto y = round->addInputNode({boolType});
+        auto c = round->addInputNode({boolType});
+        auto k = round->addInputNode({boolType});
+        round->addOutputNode({boolType}, {round->addNode(op::Xor, {y, k})});
+        round->addOutputNode({boolType}, {round->addNode(op::And, {x, c})});
+    }
+    auto boolType = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({boolType});
+    auto b = main->addInputNode({boolType});
+    auto c = main->addInputNode({boolType});
+    auto k0 = main->addInputNode({boolType});
+    auto k1 = main->addInputNode({boolType});
+    auto first = addRoundCall(main, boolType, {a, b, c, k0}, {0, 0, 0, 0});
+    auto second = addRoundCall(main, boolType, {first, first, c, k1}, {0, 1, 0, 0});
+    main->addOutputNode(std::vector<size_t>{boolType}, {second}, std::vector<unsigned int>{0});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::foldRepeatedRounds(module), 0);
+    EXPECT_TRUE(module.getEntryCircuit().getNodeWithID(first).isSubcircuitNode());
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "SubcircuitInlining.h"
+
+namespace fuse::tests::passes {
+
+TEST(SubcircuitInlining, MultiOutputCalls) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto helper = moduleBuilder.addCircuit("helper");
+
+    // helper: (x, y) -> (x AND y, x XOR y)
+    auto helperBool = helper->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = helper->addInputNode({helperBool});
+    auto y = helper->addInputNode({helperBool});
+    helper->addOutputNode({helperBool}, {helper->addNode(fuse::core::ir::PrimitiveOperation::And, {x, y})});
+    helper->addOutputNode({helperBool}, {helper->addNode(fuse::core::ir::PrimitiveOperation::Xor, {x, y})});
+
+    // main: the second call uses the XOR output of the first call as both inputs
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({mainBool});
+    auto b = main->addInputNode({mainBool});
+    auto call0 = main->addCallToSubcircuitNode({a, b}, "helper");
+    auto call1 = main->addCallToSubcircuitNode(std::vector<uint64_t>{call0, call0}, std::vector<unsigned int>{1, 1}, "helper");
+    auto select = main->addSelectOffsetNode(call1, 1);
+    main->addOutputNode({mainBool}, {call1});
+    main->addOutputNode({mainBool}, {select});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    EXPECT_EQ(fuse::passes::inlineSubcircuits(module), 2);
+    EXPECT_EQ(module.getAllCircuitNames(), std::vector<std::string>{"main"});
+
+    auto circuit = module.getCircuitWithName("main");
+    // 2 inputs, 2 x (AND, XOR), 1 select offset, 2 outputs
+    EXPECT_EQ(circuit.getNumberOfNodes(), 9);
+    for (auto node : circuit) {
+        EXPECT_FALSE(node.isSubcircuitNode());
+        auto inputs = node.getInputNodeIDs();
+        if (node.getOperation() == fuse::core::ir::PrimitiveOperation::And && inputs[0] != a) {
+            // the second AND reads the first XOR
+            EXPECT_EQ(circuit.getNodeWithID(inputs[0]).getOperation(), fuse::core::ir::PrimitiveOperation::Xor);
+            EXPECT_FALSE(node.usesInputOffsets() && node.getInputOffsets()[0] != 0);
+        }
+        if (node.getOperation() == fuse::core::ir::PrimitiveOperation::SelectOffset) {
+            EXPECT_EQ(circuit.getNodeWithID(inputs[0]).getOperation(), fuse::core::ir::PrimitiveOperation::Xor);
+        }
+    }
+}
+
+TEST(SubcircuitInlining, KeepsLargeCallees) {
+    fuse::frontend::ModuleBuilder moduleBuilder;
+    auto main = moduleBuilder.addCircuit("main");
+    auto helper = moduleBuilder.addCircuit("helper");
+
+    auto helperBool = helper->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto x = helper->addInputNode({helperBool});
+    auto y = helper->addInputNode({helperBool});
+    auto value = helper->addNode(fuse::core::ir::PrimitiveOperation::And, {x, y});
+    for (int i = 0; i < 4; ++i) {
+        value = helper->addNode(fuse::core::ir::PrimitiveOperation::Xor, {value, x});
+    }
+    helper->addOutputNode({helperBool}, {value});
+
+    auto mainBool = main->addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = main->addInputNode({mainBool});
+    auto b = main->addInputNode({mainBool});
+    main->addOutputNode({mainBool}, {main->addCallToSubcircuitNode({a, b}, "helper")});
+    main->addOutputNode({mainBool}, {main->addCallToSubcircuitNode({b, a}, "helper")});
+    moduleBuilder.setEntryCircuitName("main");
+    moduleBuilder.finish();
+
+    fuse::core::ModuleContext context(moduleBuilder);
+    auto module = context.getMutableModuleWrapper();
+    fuse::passes::InliningOptions options;
+    options.maxCalleeSize = 4;
+    EXPECT_EQ(fuse::passes::inlineSubcircuits(module, options), 0);
+    EXPECT_EQ(module.getAllCircuitNames().size(), 2);
+}
+
+}  // namespace fuse::tests::passes
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include "DepthAnalysis.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "TreeHeightReduction.h"
+
+namespace fuse::tests::passes {
+
+TEST(TreeHeightReduction, AndChain) {
+    fuse::frontend::CircuitBuilder circuitBuilder("and_chain");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+
+    // ((((((x0 AND x1) AND x2) AND x3) AND x4) AND x5) AND x6) AND x7
+    auto chain = circuitBuilder.addInputNode({boolType});
+    for (int i = 1; i < 8; ++i) {
+        auto input = circuitBuilder.addInputNode({boolType});
+        chain = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {chain, input});
+    }
+    auto output = circuitBuilder.addOutputNode({boolType}, {chain});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto wrapper = context.getMutableCircuitWrapper();
+    EXPECT_EQ(fuse::passes::getNodeInstructionDepths(wrapper, fuse::core::ir::PrimitiveOperation::And).at(output), 7);
+
+    fuse::passes::reduceTreeHeight(wrapper, true);
+
+    EXPECT_EQ(wrapper.getNumberOfNodes(), 16);
+    EXPECT_EQ(fuse::passes::getNodeInstructionDepths(wrapper, fuse::core::ir::PrimitiveOperation::And).at(output), 3);
+}
+
+TEST(TreeHeightReduction, AddChainWithSharedIntermediate) {
+    fuse::frontend::CircuitBuilder circuitBuilder("add_chain");
+    auto intType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+
+    std::vector<uint64_t> inputs;
+    for (int i = 0; i < 6; ++i) {
+        inputs.push_back(circuitBuilder.addInputNode({intType}));
+    }
+    // the intermediate sum x0 + x1 + x2 is an output as well and must remain intact
+    auto sum = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Add, {inputs[0], inputs[1]});
+    sum = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Add, {sum, inputs[2]});
+    auto shared = sum;
+    for (int i = 3; i < 6; ++i) {
+        sum = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::Add, {sum, inputs[i]});
+    }
+    auto sharedOutput = circuitBuilder.addOutputNode({intType}, {shared});
+    auto output = circuitBuilder.addOutputNode({intType}, {sum});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto wrapper = context.getMutableCircuitWrapper();
+    auto depthsBefore = fuse::passes::getNodeDepths(wrapper);
+
+    fuse::passes::reduceTreeHeight(wrapper);
+
+    auto depthsAfter = fuse::passes::getNodeDepths(wrapper);
+    EXPECT_EQ(depthsAfter.at(sharedOutput), depthsBefore.at(sharedOutput));
+    EXPECT_LT(depthsAfter.at(output), depthsBefore.at(output));
+    EXPECT_EQ(wrapper.getNodeWithID(shared).getOperation(), fuse::core::ir::PrimitiveOperation::Add);
+}
+
+}  // namespace fuse::tests::passes
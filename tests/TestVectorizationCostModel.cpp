@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <unordered_set>
+
+#include "BristolFrontend.h"
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "VectorizationCostModel.h"
+
+namespace fuse::tests::passes {
+
+TEST(VectorizationCostModel, Profiles) {
+    auto gmw = fuse::passes::VectorizationCostModel::booleanGMW();
+    EXPECT_EQ(gmw.getPaddedWidth(1), 8);
+    EXPECT_EQ(gmw.getPaddedWidth(9), 16);
+    EXPECT_LT(gmw.getGateCost(fuse::core::ir::PrimitiveOperation::Xor, 8), gmw.getGateCost(fuse::core::ir::PrimitiveOperation::And, 8));
+
+    auto bmr = fuse::passes::VectorizationCostModel::BMR();
+    EXPECT_EQ(bmr.getPaddedWidth(9), 9);
+    EXPECT_EQ(bmr.roundCost, 0.0);
+}
+
+TEST(VectorizationCostModel, DependentGroupIsRejected) {
+    fuse::frontend::CircuitBuilder circuitBuilder("dependent_ands");
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({boolType});
+    auto b = circuitBuilder.addInputNode({boolType});
+    auto x = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {a, b});
+    auto y = circuitBuilder.addNode(fuse::core::ir::PrimitiveOperation::And, {x, b});
+    circuitBuilder.addOutputNode({boolType}, {y});
+    circuitBuilder.finish();
+
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto wrapper = context.getMutableCircuitWrapper();
+    auto model = fuse::passes::VectorizationCostModel::booleanGMW();
+
+    EXPECT_TRUE(std::isinf(fuse::passes::estimateVectorizationCost(wrapper, model, {{x, y}})));
+    EXPECT_EQ(fuse::passes::estimateVectorizationCost(wrapper, model, {}), 2 * model.roundCost + 2 * model.getGateCost(fuse::core::ir::PrimitiveOperation::And, 1));
+    EXPECT_TRUE(fuse::passes::planVectorization(wrapper, model).groups.empty());
+}
+
+TEST(VectorizationCostModel, AutoTuneBristolCircuits) {
+    const std::vector<std::string> circuits = {"../../examples/bristol_circuits/int_add8_size.bristol",
+                                               "../../examples/bristol_circuits/aes_128.bristol"};
+    for (const auto& model : {fuse::passes::VectorizationCostModel::booleanGMW(), fuse::passes::VectorizationCostModel::BMR()}) {
+        for (const auto& path : circuits) {
+            auto context = fuse::frontend::loadFUSEFromBristol(path);
+            auto circ = context.getMutableCircuitWrapper();
+            auto numberOfNodesBefore = circ.getNumberOfNodes();
+            auto plan = fuse::passes::vectorizeWithCostModel(circ, model);
+
+            EXPECT_LE(plan.estimatedCost, plan.estimatedCostWithoutVectorization);
+            EXPECT_LE(circ.getNumberOfNodes(), numberOfNodesBefore);
+
+            // every node may only use nodes that come before it
+            std::unordered_set<uint64_t> seen;
+            for (auto node : circ) {
+                for (auto inputID : node.getInputNodeIDs()) {
+                    EXPECT_TRUE(seen.contains(inputID));
+                }
+                seen.insert(node.getNodeID());
+            }
+        }
+    }
+}
+
+}  // namespace fuse::tests::passes
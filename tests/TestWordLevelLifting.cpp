@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Nora Khayata
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "IR.h"
+#include "ModuleBuilder.h"
+#include "WordLevelLifting.h"
+
+namespace fuse::tests::passes {
+
+TEST(WordLevelLifting, RippleCarryAdderAndComparator) {
+    using op = fuse::core::ir::PrimitiveOperation;
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt8);
+    auto boolType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::Bool);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto aBits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, a);
+    auto bBits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, b);
+
+    // sum = a + b as ripple-carry adder
+    std::vector<uint64_t> sumBits;
+    uint64_t carry = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+        auto halfSum = circuitBuilder.addNode(op::Xor, {aBits, bBits}, {i, i});
+        auto generate = circuitBuilder.addNode(op::And, {aBits, bBits}, {i, i});
+        if (i == 0) {
+            sumBits.push_back(halfSum);
+            carry = generate;
+            continue;
+        }
+        sumBits.push_back(circuitBuilder.addNode(op::Xor, {halfSum, carry}));
+        auto propagate = circuitBuilder.addNode(op::And, {halfSum, carry});
+        carry = circuitBuilder.addNode(op::Or, {generate, propagate});
+    }
+    auto sum = circuitBuilder.addNode(op::Merge, sumBits);
+
+    // a < b as the borrow of a - b
+    uint64_t borrow = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+        auto notA = circuitBuilder.addNode(op::Not, {aBits}, {i});
+        auto generate = circuitBuilder.addNode(op::And, {notA, bBits}, {0, i});
+        if (i == 0) {
+            borrow = generate;
+            continue;
+        }
+        auto equal = circuitBuilder.addNode(op::Xnor, {aBits, bBits}, {i, i});
+        auto propagate = circuitBuilder.addNode(op::And, {equal, borrow});
+        borrow = circuitBuilder.addNode(op::Or, {generate, propagate});
+    }
+
+    circuitBuilder.addOutputNode({wordType}, {sum});
+    circuitBuilder.addOutputNode({boolType}, {borrow});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    EXPECT_EQ(fuse::passes::liftWordLevelOperations(circuit), 2);
+    // 2 inputs, Add, Lt, 2 outputs
+    EXPECT_EQ(circuit.getNumberOfNodes(), 6);
+    auto add = circuit.getNodeWithID(sum);
+    EXPECT_EQ(add.getOperation(), op::Add);
+    EXPECT_EQ(add.getInputNodeIDs()[0], a);
+    EXPECT_EQ(add.getInputNodeIDs()[1], b);
+    auto lessThan = circuit.getNodeWithID(borrow);
+    EXPECT_EQ(lessThan.getOperation(), op::Lt);
+    EXPECT_EQ(lessThan.getInputNodeIDs()[0], a);
+    EXPECT_EQ(lessThan.getInputNodeIDs()[1], b);
+}
+
+TEST(WordLevelLifting, KeepsOtherFunctions) {
+    using op = fuse::core::ir::PrimitiveOperation;
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt8);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto aBits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, a);
+    auto bBits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt8, b);
+
+    // bitwise AND is not an arithmetic operation
+    std::vector<uint64_t> bits;
+    for (unsigned int i = 0; i < 8; ++i) {
+        bits.push_back(circuitBuilder.addNode(op::And, {aBits, bBits}, {i, i}));
+    }
+    circuitBuilder.addOutputNode({wordType}, {circuitBuilder.addNode(op::Merge, bits)});
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+    auto numberOfNodes = circuit.getNumberOfNodes();
+
+    EXPECT_EQ(fuse::passes::liftWordLevelOperations(circuit), 0);
+    EXPECT_EQ(circuit.getNumberOfNodes(), numberOfNodes);
+}
+
+namespace {
+
+// a 32-bit ripple-carry adder; with a flaw, the lowest sum bit is flipped for the single operand pair 0x12345678 + 0x9abcdef0
+uint64_t buildWideAdder(fuse::frontend::CircuitBuilder& circuitBuilder, bool withFlaw) {
+    using op = fuse::core::ir::PrimitiveOperation;
+    auto wordType = circuitBuilder.addDataType(fuse::core::ir::PrimitiveType::UInt32);
+    auto a = circuitBuilder.addInputNode({wordType});
+    auto b = circuitBuilder.addInputNode({wordType});
+    auto aBits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt32, a);
+    auto bBits = circuitBuilder.addSplitNode(fuse::core::ir::PrimitiveType::UInt32, b);
+
+    std::vector<uint64_t> sumBits;
+    uint64_t carry = 0;
+    for (unsigned int i = 0; i < 32; ++i) {
+        auto halfSum = circuitBuilder.addNode(op::Xor, {aBits, bBits}, {i, i});
+        auto generate = circuitBuilder.addNode(op::And, {aBits, bBits}, {i, i});
+        if (i == 0) {
+            sumBits.push_back(halfSum);
+            carry = generate;
+            continue;
+        }
+        sumBits.push_back(circuitBuilder.addNode(op::Xor, {halfSum, carry}));
+        auto propagate = circuitBuilder.addNode(op::And, {halfSum, carry});
+        carry = circuitBuilder.addNode(op::Or, {generate, propagate});
+    }
+    if (withFlaw) {
+        const uint32_t aValue = 0x12345678, bValue = 0x9abcdef0;
+        std::vector<uint64_t> matches;
+        for (unsigned int i = 0; i < 32; ++i) {
+            auto aBit = circuitBuilder.addNode(op::Not, {aBits}, {i});
+            matches.push_back((aValue >> i) & 1 ? circuitBuilder.addNode(op::Not, {aBit}) : aBit);
+            auto bBit = circuitBuilder.addNode(op::Not, {bBits}, {i});
+            matches.push_back((bValue >> i) & 1 ? circuitBuilder.addNode(op::Not, {bBit}) : bBit);
+        }
+        auto isPair = matches[0];
+        for (size_t i = 1; i < matches.size(); ++i) {
+            isPair = circuitBuilder.addNode(op::And, {isPair, matches[i]});
+        }
+        sumBits[0] = circuitBuilder.addNode(op::Xor, {sumBits[0], isPair});
+    }
+    auto sum = circuitBuilder.addNode(op::Merge, sumBits);
+    circuitBuilder.addOutputNode({wordType}, {sum});
+    return sum;
+}
+
+}  // namespace
+
+TEST(WordLevelLifting, ProvesWideAdder) {
+    using op = fuse::core::ir::PrimitiveOperation;
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    auto sum = buildWideAdder(circuitBuilder, false);
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+
+    EXPECT_EQ(fuse::passes::liftWordLevelOperations(circuit), 1);
+    auto add = circuit.getNodeWithID(sum);
+    EXPECT_EQ(add.getOperation(), op::Add);
+    // the lifted node reads two words instead of the bits of the Merge node
+    auto inputTypes = std::as_const(add).getInputDataTypes();
+    ASSERT_EQ(inputTypes.size(), 2);
+    EXPECT_EQ(inputTypes[0]->getPrimitiveType(), fuse::core::ir::PrimitiveType::UInt32);
+    EXPECT_EQ(inputTypes[1]->getPrimitiveType(), fuse::core::ir::PrimitiveType::UInt32);
+}
+
+TEST(WordLevelLifting, KeepsWideAdderThatDiffersOnOnePair) {
+    fuse::frontend::CircuitBuilder circuitBuilder("main");
+    buildWideAdder(circuitBuilder, true);
+    fuse::core::CircuitContext context(circuitBuilder);
+    auto circuit = context.getMutableCircuitWrapper();
+    auto numberOfNodes = circuit.getNumberOfNodes();
+
+    // the flaw passes the simulation but not the proof
+    EXPECT_EQ(fuse::passes::liftWordLevelOperations(circuit), 0);
+    EXPECT_EQ(circuit.getNumberOfNodes(), numberOfNodes);
+}
+
+}  // namespace fuse::tests::passes